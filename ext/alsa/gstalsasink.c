@@ -34,6 +34,24 @@
  *
  * Play an Ogg/Vorbis file and output audio via ALSA.
  *
+ * ## Low latency playback
+ *
+ * With #GstAlsaSink:low-latency the sink writes directly into a mmap of the
+ * device buffer when the device supports it and starts playback as soon as
+ * two periods are queued instead of waiting for the complete buffer to be
+ * filled. Together with small #GstAudioBaseSink:latency-time and
+ * #GstAudioBaseSink:buffer-time values this allows periods of 1 or 2
+ * milliseconds. When the sink is slaved to another clock, the "resample"
+ * #GstAudioBaseSink:slave-method corrects the drift with sub-sample
+ * precision instead of skipping or repeating samples.
+ *
+ * |[
+ * gst-launch-1.0 -v audiotestsrc ! alsasink low-latency=true latency-time=1000 buffer-time=4000 slave-method=resample
+ * ]|
+ *
+ * Play a sine wave with 1 millisecond periods and 4 milliseconds of
+ * buffering.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -61,6 +79,7 @@
 #define DEFAULT_DEVICE		"default"
 #define DEFAULT_DEVICE_NAME	""
 #define DEFAULT_CARD_NAME	""
+#define DEFAULT_LOW_LATENCY	FALSE
 #define SPDIF_PERIOD_SIZE 1536
 #define SPDIF_BUFFER_SIZE 15360
 
@@ -70,6 +89,7 @@ enum
   PROP_DEVICE,
   PROP_DEVICE_NAME,
   PROP_CARD_NAME,
+  PROP_LOW_LATENCY,
   PROP_LAST
 };
 
@@ -198,6 +218,21 @@ gst_alsasink_class_init (GstAlsaSinkClass * klass)
       g_param_spec_string ("card-name", "Card name",
           "Human-readable name of the sound card", DEFAULT_CARD_NAME,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAlsaSink:low-latency:
+   *
+   * Write samples through a mmap of the device buffer when possible and
+   * start playback once two periods are queued. Use this with small
+   * latency-time and buffer-time values. Takes effect the next time the
+   * device is configured.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency", "Low latency",
+          "Use mmap access and start playback early for small periods",
+          DEFAULT_LOW_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -217,6 +252,11 @@ gst_alsasink_set_property (GObject * object, guint prop_id,
         sink->device = g_strdup (DEFAULT_DEVICE);
       }
       break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (sink);
+      sink->low_latency = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -245,6 +285,11 @@ gst_alsasink_get_property (GObject * object, guint prop_id,
           gst_alsa_find_card_name (GST_OBJECT_CAST (sink),
               sink->device, SND_PCM_STREAM_PLAYBACK));
       break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_boolean (value, sink->low_latency);
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -259,6 +304,7 @@ gst_alsasink_init (GstAlsaSink * alsasink)
   alsasink->device = g_strdup (DEFAULT_DEVICE);
   alsasink->handle = NULL;
   alsasink->cached_caps = NULL;
+  alsasink->low_latency = DEFAULT_LOW_LATENCY;
   g_mutex_init (&alsasink->alsa_lock);
   g_mutex_init (&alsasink->delay_lock);
 
@@ -443,7 +489,13 @@ set_hwparams (GstAlsaSink * alsa)
 retry:
   /* choose all parameters */
   CHECK (snd_pcm_hw_params_any (alsa->handle, params), no_config);
-  /* set the interleaved read/write format */
+  /* set the interleaved read/write format, in low latency mode we try to
+   * write through a mmap of the device buffer first */
+  if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED &&
+      snd_pcm_hw_params_set_access (alsa->handle, params, alsa->access) < 0) {
+    GST_INFO_OBJECT (alsa, "mmap access not available, using read/write");
+    alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
+  }
   CHECK (snd_pcm_hw_params_set_access (alsa->handle, params, alsa->access),
       wrong_access);
   /* set the sample format */
@@ -625,16 +677,22 @@ set_swparams (GstAlsaSink * alsa)
 {
   int err;
   snd_pcm_sw_params_t *params;
+  snd_pcm_uframes_t threshold;
 
   snd_pcm_sw_params_malloc (&params);
 
   /* get the current swparams */
   CHECK (snd_pcm_sw_params_current (alsa->handle, params), no_config);
-  /* start the transfer when the buffer is almost full: */
-  /* (buffer_size / avail_min) * avail_min */
+  if (alsa->low_latency_active) {
+    /* start the transfer as soon as two periods are queued */
+    threshold = MIN (2 * alsa->period_size, alsa->buffer_size);
+  } else {
+    /* start the transfer when the buffer is almost full: */
+    /* (buffer_size / avail_min) * avail_min */
+    threshold = (alsa->buffer_size / alsa->period_size) * alsa->period_size;
+  }
   CHECK (snd_pcm_sw_params_set_start_threshold (alsa->handle, params,
-          (alsa->buffer_size / alsa->period_size) * alsa->period_size),
-      start_threshold);
+          threshold), start_threshold);
 
   /* allow the transfer when at least period_size samples can be processed */
   CHECK (snd_pcm_sw_params_set_avail_min (alsa->handle, params,
@@ -819,7 +877,15 @@ alsasink_parse_spec (GstAlsaSink * alsa, GstAudioRingBufferSpec * spec)
   alsa->channels = GST_AUDIO_INFO_CHANNELS (&spec->info);
   alsa->buffer_time = spec->buffer_time;
   alsa->period_time = spec->latency_time;
-  alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
+
+  GST_OBJECT_LOCK (alsa);
+  alsa->low_latency_active = alsa->low_latency && !alsa->iec958;
+  GST_OBJECT_UNLOCK (alsa);
+
+  if (alsa->low_latency_active)
+    alsa->access = SND_PCM_ACCESS_MMAP_INTERLEAVED;
+  else
+    alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
 
   if (spec->type == GST_AUDIO_RING_BUFFER_FORMAT_TYPE_RAW && alsa->channels < 9)
     gst_audio_ring_buffer_set_channel_positions (GST_AUDIO_BASE_SINK
@@ -1035,13 +1101,19 @@ gst_alsasink_write (GstAudioSink * asink, gpointer data, guint length)
   GST_ALSA_SINK_LOCK (asink);
   while (cptr > 0) {
     /* start by doing a blocking wait for free space. Set the timeout
-     * to 4 times the period time */
-    err = snd_pcm_wait (alsa->handle, (4 * alsa->period_time / 1000));
+     * to 4 times the period time, but at least 1 millisecond so that we don't
+     * spin with sub-millisecond periods */
+    err = snd_pcm_wait (alsa->handle, MAX (4 * alsa->period_time / 1000, 1));
     if (err < 0) {
       GST_DEBUG_OBJECT (asink, "wait error, %d", err);
     } else {
       GST_DELAY_SINK_LOCK (asink);
-      err = snd_pcm_writei (alsa->handle, ptr, cptr);
+      /* in low latency mode the samples are copied straight into the mapped
+       * device buffer */
+      if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        err = snd_pcm_mmap_writei (alsa->handle, ptr, cptr);
+      else
+        err = snd_pcm_writei (alsa->handle, ptr, cptr);
       GST_DELAY_SINK_UNLOCK (asink);
     }
 
@@ -74,6 +74,11 @@ struct _GstAlsaSink {
 
   GstCaps *cached_caps;
 
+  /* with LOCK */
+  gboolean low_latency;
+  /* low latency setup of the current configuration */
+  gboolean low_latency_active;
+
   GMutex alsa_lock;
   GMutex delay_lock;
 };
@@ -332,3 +332,27 @@ gst_fd_memory_get_fd (GstMemory * mem)
 
   return ((GstFdMemory *) mem)->fd;
 }
+
+/**
+ * gst_fd_memory_get_flags:
+ * @mem: #GstMemory
+ *
+ * Get the #GstFdMemoryFlags @mem was allocated with. Shared memory uses
+ * the mapping of its parent and returns the flags of the parent.
+ *
+ * Returns: the #GstFdMemoryFlags of @mem
+ *
+ * Since: 1.14
+ */
+GstFdMemoryFlags
+gst_fd_memory_get_flags (GstMemory * mem)
+{
+  g_return_val_if_fail (mem != NULL, GST_FD_MEMORY_FLAG_NONE);
+  g_return_val_if_fail (GST_IS_FD_ALLOCATOR (mem->allocator),
+      GST_FD_MEMORY_FLAG_NONE);
+
+  if (mem->parent)
+    mem = mem->parent;
+
+  return ((GstFdMemory *) mem)->flags;
+}
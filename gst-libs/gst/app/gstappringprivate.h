@@ -0,0 +1,107 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_APP_RING_PRIVATE_H_
+#define _GST_APP_RING_PRIVATE_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* the number of objects a ring holds when nothing else limits it */
+#define GST_APP_RING_DEFAULT_SIZE 1024
+
+/* A bounded single-producer/single-consumer ring of objects. Only the
+ * producer moves @tail and only the consumer moves @head, so pushing and
+ * popping need no lock as long as there is at most one thread pushing and
+ * one thread popping at any time. */
+typedef struct
+{
+  gpointer *data;
+  guint mask;
+
+  volatile gint head;
+  volatile gint tail;
+} GstAppRing;
+
+static inline void
+gst_app_ring_init (GstAppRing * ring, guint size)
+{
+  /* round up to a power of two so that positions can be masked */
+  size = MAX (size, 2);
+  size = 1 << g_bit_storage (size - 1);
+
+  ring->data = g_new0 (gpointer, size);
+  ring->mask = size - 1;
+  ring->head = ring->tail = 0;
+}
+
+static inline void
+gst_app_ring_free (GstAppRing * ring)
+{
+  g_free (ring->data);
+  ring->data = NULL;
+  ring->mask = 0;
+  ring->head = ring->tail = 0;
+}
+
+/* can be called from both sides, the result is a snapshot */
+static inline guint
+gst_app_ring_length (GstAppRing * ring)
+{
+  return (guint) g_atomic_int_get (&ring->tail) -
+      (guint) g_atomic_int_get (&ring->head);
+}
+
+/* producer side, returns FALSE when the ring is full */
+static inline gboolean
+gst_app_ring_push (GstAppRing * ring, gpointer obj)
+{
+  guint tail = (guint) ring->tail;
+
+  if (tail - (guint) g_atomic_int_get (&ring->head) > ring->mask)
+    return FALSE;
+
+  ring->data[tail & ring->mask] = obj;
+  /* publishes the object to the consumer */
+  g_atomic_int_set (&ring->tail, (gint) (tail + 1));
+
+  return TRUE;
+}
+
+/* consumer side, returns NULL when the ring is empty */
+static inline gpointer
+gst_app_ring_pop (GstAppRing * ring)
+{
+  guint head = (guint) ring->head;
+  gpointer obj;
+
+  if (head == (guint) g_atomic_int_get (&ring->tail))
+    return NULL;
+
+  obj = ring->data[head & ring->mask];
+  ring->data[head & ring->mask] = NULL;
+  /* hands the slot back to the producer */
+  g_atomic_int_set (&ring->head, (gint) (head + 1));
+
+  return obj;
+}
+
+G_END_DECLS
+
+#endif /* _GST_APP_RING_PRIVATE_H_ */
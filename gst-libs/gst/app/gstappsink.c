@@ -74,6 +74,7 @@
 #include <string.h>
 
 #include "gstappsink.h"
+#include "gstappringprivate.h"
 
 struct _GstAppSinkPrivate
 {
@@ -98,6 +99,17 @@ struct _GstAppSinkPrivate
   gboolean is_eos;
   gboolean buffer_lists_supported;
 
+  /* lock-free mode, buffers/lists rendered without the lock go to the ring
+   * and are always older than everything in the queue */
+  gboolean lock_free;
+  GstAppRing ring;
+  volatile gint waiting;
+  /* length of the queue, read by the lock-free renderer */
+  volatile gint queue_length;
+
+  /* TRUE when new-samples was emitted and nothing was pulled since */
+  volatile gint samples_notified;
+
   GstAppSinkCallbacks callbacks;
   gpointer user_data;
   GDestroyNotify notify;
@@ -112,6 +124,7 @@ enum
   SIGNAL_EOS,
   SIGNAL_NEW_PREROLL,
   SIGNAL_NEW_SAMPLE,
+  SIGNAL_NEW_SAMPLES,
 
   /* actions */
   SIGNAL_PULL_PREROLL,
@@ -128,6 +141,7 @@ enum
 #define DEFAULT_PROP_DROP		FALSE
 #define DEFAULT_PROP_WAIT_ON_EOS	TRUE
 #define DEFAULT_PROP_BUFFER_LIST	FALSE
+#define DEFAULT_PROP_LOCK_FREE		FALSE
 
 enum
 {
@@ -139,6 +153,7 @@ enum
   PROP_DROP,
   PROP_WAIT_ON_EOS,
   PROP_BUFFER_LIST,
+  PROP_LOCK_FREE,
   PROP_LAST
 };
 
@@ -245,6 +260,23 @@ gst_app_sink_class_init (GstAppSinkClass * klass)
           DEFAULT_PROP_WAIT_ON_EOS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAppSink::lock-free:
+   *
+   * Queue rendered buffers in a bounded lock-free ring when possible, so that
+   * the streaming thread does not contend with the application for the
+   * appsink lock. Samples must then be pulled from one thread at a time.
+   * max-buffers, drop and the new-sample signal keep working, buffers that
+   * would exceed max-buffers take the locked path as before.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_LOCK_FREE,
+      g_param_spec_boolean ("lock-free", "Lock Free",
+          "Queue buffers without taking a lock when possible, samples must be "
+          "pulled from a single thread", DEFAULT_PROP_LOCK_FREE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstAppSink::eos:
    * @appsink: the appsink element that emitted the signal
@@ -296,6 +328,25 @@ gst_app_sink_class_init (GstAppSinkClass * klass)
       g_signal_new ("new-sample", G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST,
       G_STRUCT_OFFSET (GstAppSinkClass, new_sample),
       NULL, NULL, NULL, GST_TYPE_FLOW_RETURN, 0, G_TYPE_NONE);
+  /**
+   * GstAppSink::new-samples:
+   * @appsink: the appsink element that emited the signal
+   *
+   * Signal that new samples are available. Unlike "new-sample", this signal
+   * is only emitted for the first sample that is queued after the application
+   * last pulled, so that the application can take everything that is queued
+   * at once with gst_app_sink_pull_samples() and is not woken up for every
+   * buffer.
+   *
+   * This signal is emitted from the streaming thread and only when the
+   * "emit-signals" property is %TRUE.
+   *
+   * Since: 1.14
+   */
+  gst_app_sink_signals[SIGNAL_NEW_SAMPLES] =
+      g_signal_new ("new-samples", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstAppSinkClass, new_samples),
+      NULL, NULL, NULL, GST_TYPE_FLOW_RETURN, 0, G_TYPE_NONE);
 
   /**
    * GstAppSink::pull-preroll:
@@ -457,6 +508,27 @@ gst_app_sink_init (GstAppSink * appsink)
   priv->drop = DEFAULT_PROP_DROP;
   priv->wait_on_eos = DEFAULT_PROP_WAIT_ON_EOS;
   priv->buffer_lists_supported = DEFAULT_PROP_BUFFER_LIST;
+  priv->lock_free = DEFAULT_PROP_LOCK_FREE;
+}
+
+/* Must be called with priv->mutex */
+static void
+gst_app_sink_queue_push_tail (GstAppSinkPrivate * priv, gpointer obj)
+{
+  g_queue_push_tail (priv->queue, obj);
+  g_atomic_int_inc (&priv->queue_length);
+}
+
+/* Must be called with priv->mutex, returns NULL when the queue is empty */
+static gpointer
+gst_app_sink_queue_pop_head (GstAppSinkPrivate * priv)
+{
+  gpointer obj;
+
+  if ((obj = g_queue_pop_head (priv->queue)))
+    g_atomic_int_add (&priv->queue_length, -1);
+
+  return obj;
 }
 
 static void
@@ -480,7 +552,11 @@ gst_app_sink_dispose (GObject * obj)
   GST_OBJECT_UNLOCK (appsink);
 
   g_mutex_lock (&priv->mutex);
-  while ((queue_obj = g_queue_pop_head (priv->queue)))
+  if (priv->ring.data) {
+    while ((queue_obj = gst_app_ring_pop (&priv->ring)))
+      gst_mini_object_unref (queue_obj);
+  }
+  while ((queue_obj = gst_app_sink_queue_pop_head (priv)))
     gst_mini_object_unref (queue_obj);
   gst_buffer_replace (&priv->preroll, NULL);
   gst_caps_replace (&priv->preroll_caps, NULL);
@@ -499,6 +575,7 @@ gst_app_sink_finalize (GObject * obj)
   g_mutex_clear (&priv->mutex);
   g_cond_clear (&priv->cond);
   g_queue_free (priv->queue);
+  gst_app_ring_free (&priv->ring);
 
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -508,6 +585,7 @@ gst_app_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstAppSink *appsink = GST_APP_SINK_CAST (object);
+  GstAppSinkPrivate *priv = appsink->priv;
 
   switch (prop_id) {
     case PROP_CAPS:
@@ -529,6 +607,14 @@ gst_app_sink_set_property (GObject * object, guint prop_id,
     case PROP_WAIT_ON_EOS:
       gst_app_sink_set_wait_on_eos (appsink, g_value_get_boolean (value));
       break;
+    case PROP_LOCK_FREE:
+      g_mutex_lock (&priv->mutex);
+      /* the ring stays around, pulling keeps draining it */
+      if (priv->ring.data == NULL)
+        gst_app_ring_init (&priv->ring, GST_APP_RING_DEFAULT_SIZE);
+      priv->lock_free = g_value_get_boolean (value);
+      g_mutex_unlock (&priv->mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -571,6 +657,9 @@ gst_app_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_WAIT_ON_EOS:
       g_value_set_boolean (value, gst_app_sink_get_wait_on_eos (appsink));
       break;
+    case PROP_LOCK_FREE:
+      g_value_set_boolean (value, appsink->priv->lock_free);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -607,6 +696,19 @@ gst_app_sink_unlock_stop (GstBaseSink * bsink)
   return TRUE;
 }
 
+/* the number of buffers/lists in the queue and the ring, must be called with
+ * the appsink mutex */
+static guint
+gst_app_sink_queued (GstAppSinkPrivate * priv)
+{
+  guint n = priv->num_buffers;
+
+  if (priv->ring.data)
+    n += gst_app_ring_length (&priv->ring);
+
+  return n;
+}
+
 static void
 gst_app_sink_flush_unlocked (GstAppSink * appsink)
 {
@@ -615,8 +717,13 @@ gst_app_sink_flush_unlocked (GstAppSink * appsink)
 
   GST_DEBUG_OBJECT (appsink, "flush stop appsink");
   priv->is_eos = FALSE;
+  g_atomic_int_set (&priv->samples_notified, FALSE);
   gst_buffer_replace (&priv->preroll, NULL);
-  while ((obj = g_queue_pop_head (priv->queue)))
+  if (priv->ring.data) {
+    while ((obj = gst_app_ring_pop (&priv->ring)))
+      gst_mini_object_unref (obj);
+  }
+  while ((obj = gst_app_sink_queue_pop_head (priv)))
     gst_mini_object_unref (obj);
   priv->num_buffers = 0;
   g_cond_signal (&priv->cond);
@@ -668,7 +775,7 @@ gst_app_sink_setcaps (GstBaseSink * sink, GstCaps * caps)
 
   g_mutex_lock (&priv->mutex);
   GST_DEBUG_OBJECT (appsink, "receiving CAPS");
-  g_queue_push_tail (priv->queue, gst_event_new_caps (caps));
+  gst_app_sink_queue_push_tail (priv, gst_event_new_caps (caps));
   if (!priv->preroll)
     gst_caps_replace (&priv->preroll_caps, caps);
   g_mutex_unlock (&priv->mutex);
@@ -686,7 +793,7 @@ gst_app_sink_event (GstBaseSink * sink, GstEvent * event)
     case GST_EVENT_SEGMENT:
       g_mutex_lock (&priv->mutex);
       GST_DEBUG_OBJECT (appsink, "receiving SEGMENT");
-      g_queue_push_tail (priv->queue, gst_event_ref (event));
+      gst_app_sink_queue_push_tail (priv, gst_event_ref (event));
       if (!priv->preroll)
         gst_event_copy_segment (event, &priv->preroll_segment);
       g_mutex_unlock (&priv->mutex);
@@ -705,7 +812,8 @@ gst_app_sink_event (GstBaseSink * sink, GstEvent * event)
        * Otherwise we might signal EOS before all buffers are
        * consumed, which is a bit confusing for the application
        */
-      while (priv->num_buffers > 0 && !priv->flushing && priv->wait_on_eos)
+      while (gst_app_sink_queued (priv) > 0 && !priv->flushing
+          && priv->wait_on_eos)
         g_cond_wait (&priv->cond, &priv->mutex);
       if (priv->flushing)
         emit = FALSE;
@@ -782,8 +890,14 @@ dequeue_buffer (GstAppSink * appsink)
   GstAppSinkPrivate *priv = appsink->priv;
   GstMiniObject *obj;
 
+  /* everything in the ring was rendered before the queue was used */
+  if (priv->ring.data && (obj = gst_app_ring_pop (&priv->ring))) {
+    GST_DEBUG_OBJECT (appsink, "dequeued buffer/list %p", obj);
+    return obj;
+  }
+
   do {
-    obj = g_queue_pop_head (priv->queue);
+    obj = gst_app_sink_queue_pop_head (priv);
 
     if (GST_IS_BUFFER (obj) || GST_IS_BUFFER_LIST (obj)) {
       GST_DEBUG_OBJECT (appsink, "dequeued buffer/list %p", obj);
@@ -817,6 +931,43 @@ dequeue_buffer (GstAppSink * appsink)
   return obj;
 }
 
+/* Queues @data in the ring without taking the lock. This is only done when
+ * the locked queue is empty, so that the order with caps and segments is
+ * kept, and when there is room below max-buffers. Everything else takes the
+ * locked path. */
+static gboolean
+gst_app_sink_push_lock_free (GstAppSink * appsink, GstMiniObject * data)
+{
+  GstAppSinkPrivate *priv = appsink->priv;
+
+  if (G_UNLIKELY (priv->flushing || priv->last_caps == NULL))
+    return FALSE;
+
+  /* only the streaming thread adds to the queue, it can only shrink behind
+   * our back */
+  if (g_atomic_int_get (&priv->queue_length) != 0)
+    return FALSE;
+
+  if (priv->max_buffers > 0 &&
+      gst_app_ring_length (&priv->ring) >= priv->max_buffers)
+    return FALSE;
+
+  if (!gst_app_ring_push (&priv->ring, gst_mini_object_ref (data))) {
+    gst_mini_object_unref (data);
+    return FALSE;
+  }
+
+  GST_LOG_OBJECT (appsink, "queued buffer/list %p without locking", data);
+
+  if (g_atomic_int_get (&priv->waiting)) {
+    g_mutex_lock (&priv->mutex);
+    g_cond_signal (&priv->cond);
+    g_mutex_unlock (&priv->mutex);
+  }
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_app_sink_render_common (GstBaseSink * psink, GstMiniObject * data,
     gboolean is_list)
@@ -824,9 +975,14 @@ gst_app_sink_render_common (GstBaseSink * psink, GstMiniObject * data,
   GstFlowReturn ret;
   GstAppSink *appsink = GST_APP_SINK_CAST (psink);
   GstAppSinkPrivate *priv = appsink->priv;
-  gboolean emit;
+  gboolean emit, notify;
 
 restart:
+  if (priv->lock_free && gst_app_sink_push_lock_free (appsink, data)) {
+    emit = priv->emit_signals;
+    goto queued;
+  }
+
   g_mutex_lock (&priv->mutex);
   if (priv->flushing)
     goto flushing;
@@ -841,9 +997,10 @@ restart:
   }
 
   GST_DEBUG_OBJECT (appsink, "pushing render buffer/list %p on queue (%d)",
-      data, priv->num_buffers);
+      data, gst_app_sink_queued (priv));
 
-  while (priv->max_buffers > 0 && priv->num_buffers >= priv->max_buffers) {
+  while (priv->max_buffers > 0
+      && gst_app_sink_queued (priv) >= priv->max_buffers) {
     if (priv->drop) {
       GstMiniObject *old;
 
@@ -854,7 +1011,7 @@ restart:
       }
     } else {
       GST_DEBUG_OBJECT (appsink, "waiting for free space, length %d >= %d",
-          priv->num_buffers, priv->max_buffers);
+          gst_app_sink_queued (priv), priv->max_buffers);
 
       if (priv->unlock) {
         /* we are asked to unlock, call the wait_preroll method */
@@ -873,18 +1030,28 @@ restart:
     }
   }
   /* we need to ref the buffer/list when pushing it in the queue */
-  g_queue_push_tail (priv->queue, gst_mini_object_ref (data));
+  gst_app_sink_queue_push_tail (priv, gst_mini_object_ref (data));
   priv->num_buffers++;
   g_cond_signal (&priv->cond);
   emit = priv->emit_signals;
   g_mutex_unlock (&priv->mutex);
 
-  if (priv->callbacks.new_sample) {
-    ret = priv->callbacks.new_sample (appsink, priv->user_data);
-  } else {
-    ret = GST_FLOW_OK;
-    if (emit)
-      g_signal_emit (appsink, gst_app_sink_signals[SIGNAL_NEW_SAMPLE], 0, &ret);
+queued:
+  /* only the first buffer queued after a pull is announced with new-samples */
+  notify = !g_atomic_int_get (&priv->samples_notified) &&
+      g_atomic_int_compare_and_exchange (&priv->samples_notified, FALSE, TRUE);
+
+  ret = GST_FLOW_OK;
+  if (priv->callbacks.new_sample || priv->callbacks.new_samples) {
+    if (priv->callbacks.new_sample)
+      ret = priv->callbacks.new_sample (appsink, priv->user_data);
+    if (ret == GST_FLOW_OK && notify && priv->callbacks.new_samples)
+      ret = priv->callbacks.new_samples (appsink, priv->user_data);
+  } else if (emit) {
+    g_signal_emit (appsink, gst_app_sink_signals[SIGNAL_NEW_SAMPLE], 0, &ret);
+    if (ret == GST_FLOW_OK && notify)
+      g_signal_emit (appsink, gst_app_sink_signals[SIGNAL_NEW_SAMPLES], 0,
+          &ret);
   }
   return ret;
 
@@ -1070,7 +1237,7 @@ gst_app_sink_is_eos (GstAppSink * appsink)
   if (!priv->started)
     goto not_started;
 
-  if (priv->is_eos && priv->num_buffers == 0) {
+  if (priv->is_eos && gst_app_sink_queued (priv) == 0) {
     GST_DEBUG_OBJECT (appsink, "we are EOS and the queue is empty");
     ret = TRUE;
   } else {
@@ -1504,6 +1671,73 @@ not_started:
   }
 }
 
+/* waits until a buffer/list is queued, must be called with the mutex. Returns
+ * FALSE when stopped, EOS or when @end_time passed before anything was queued */
+static gboolean
+gst_app_sink_wait_queued (GstAppSink * appsink, gboolean timeout_valid,
+    gint64 end_time)
+{
+  GstAppSinkPrivate *priv = appsink->priv;
+
+  while (TRUE) {
+    GST_DEBUG_OBJECT (appsink, "trying to grab a buffer");
+    if (!priv->started) {
+      GST_DEBUG_OBJECT (appsink, "we are stopped, return NULL");
+      return FALSE;
+    }
+
+    if (gst_app_sink_queued (priv) > 0)
+      return TRUE;
+
+    if (priv->is_eos) {
+      GST_DEBUG_OBJECT (appsink, "we are EOS, return NULL");
+      return FALSE;
+    }
+
+    /* nothing to return, wait. Lock-free renders only wake us up when they
+     * see the waiting flag, so check again after setting it */
+    GST_DEBUG_OBJECT (appsink, "waiting for a buffer");
+    g_atomic_int_set (&priv->waiting, 1);
+    if (gst_app_sink_queued (priv) > 0) {
+      g_atomic_int_set (&priv->waiting, 0);
+      return TRUE;
+    }
+    if (timeout_valid) {
+      if (!g_cond_wait_until (&priv->cond, &priv->mutex, end_time)) {
+        g_atomic_int_set (&priv->waiting, 0);
+        GST_DEBUG_OBJECT (appsink, "timeout expired, return NULL");
+        return FALSE;
+      }
+    } else {
+      g_cond_wait (&priv->cond, &priv->mutex);
+    }
+    g_atomic_int_set (&priv->waiting, 0);
+  }
+}
+
+/* must be called with the mutex and something queued */
+static GstSample *
+gst_app_sink_dequeue_sample (GstAppSink * appsink)
+{
+  GstAppSinkPrivate *priv = appsink->priv;
+  GstSample *sample;
+  GstMiniObject *obj;
+
+  obj = dequeue_buffer (appsink);
+  if (GST_IS_BUFFER (obj)) {
+    GST_DEBUG_OBJECT (appsink, "we have a buffer %p", obj);
+    sample = gst_sample_new (GST_BUFFER_CAST (obj), priv->last_caps,
+        &priv->last_segment, NULL);
+  } else {
+    GST_DEBUG_OBJECT (appsink, "we have a list %p", obj);
+    sample = gst_sample_new (NULL, priv->last_caps, &priv->last_segment, NULL);
+    gst_sample_set_buffer_list (sample, GST_BUFFER_LIST_CAST (obj));
+  }
+  gst_mini_object_unref (obj);
+
+  return sample;
+}
+
 /**
  * gst_app_sink_try_pull_sample:
  * @appsink: a #GstAppSink
@@ -1530,13 +1764,76 @@ not_started:
 GstSample *
 gst_app_sink_try_pull_sample (GstAppSink * appsink, GstClockTime timeout)
 {
-  GstAppSinkPrivate *priv;
   GstSample *sample = NULL;
-  GstMiniObject *obj;
+
+  gst_app_sink_try_pull_samples (appsink, &sample, 1, timeout);
+
+  return sample;
+}
+
+/**
+ * gst_app_sink_pull_samples:
+ * @appsink: a #GstAppSink
+ * @samples: (out caller-allocates) (array length=n_samples) (transfer full):
+ *     an array that receives the samples
+ * @n_samples: the number of samples @samples can hold
+ *
+ * This function blocks until at least one sample or EOS becomes available or
+ * the appsink element is set to the READY/NULL state, and then takes up to
+ * @n_samples queued samples at once.
+ *
+ * This behaves like calling gst_app_sink_pull_sample() repeatedly, but takes
+ * the appsink lock and wakes up the streaming thread only once for the whole
+ * batch, which matters for streams with many small buffers. When @n_samples
+ * samples are returned, more samples might still be queued.
+ *
+ * Returns: the number of samples stored in @samples, 0 when the appsink is
+ * stopped or EOS. Call gst_sample_unref() on each returned sample after usage.
+ *
+ * Since: 1.14
+ */
+guint
+gst_app_sink_pull_samples (GstAppSink * appsink, GstSample ** samples,
+    guint n_samples)
+{
+  return gst_app_sink_try_pull_samples (appsink, samples, n_samples,
+      GST_CLOCK_TIME_NONE);
+}
+
+/**
+ * gst_app_sink_try_pull_samples:
+ * @appsink: a #GstAppSink
+ * @samples: (out caller-allocates) (array length=n_samples) (transfer full):
+ *     an array that receives the samples
+ * @n_samples: the number of samples @samples can hold
+ * @timeout: the maximum amount of time to wait for the first sample
+ *
+ * This function blocks until at least one sample or EOS becomes available or
+ * the appsink element is set to the READY/NULL state or the timeout expires,
+ * and then takes up to @n_samples queued samples at once.
+ *
+ * See gst_app_sink_pull_samples() for more details.
+ *
+ * Returns: the number of samples stored in @samples, 0 when the appsink is
+ * stopped or EOS or the timeout expires. Call gst_sample_unref() on each
+ * returned sample after usage.
+ *
+ * Since: 1.14
+ */
+guint
+gst_app_sink_try_pull_samples (GstAppSink * appsink, GstSample ** samples,
+    guint n_samples, GstClockTime timeout)
+{
+  GstAppSinkPrivate *priv;
   gboolean timeout_valid;
-  gint64 end_time;
+  gint64 end_time = 0;
+  guint i, n;
 
-  g_return_val_if_fail (GST_IS_APP_SINK (appsink), NULL);
+  g_return_val_if_fail (GST_IS_APP_SINK (appsink), 0);
+  g_return_val_if_fail (samples != NULL || n_samples == 0, 0);
+
+  if (n_samples == 0)
+    return 0;
 
   timeout_valid = GST_CLOCK_TIME_IS_VALID (timeout);
 
@@ -1548,63 +1845,24 @@ gst_app_sink_try_pull_sample (GstAppSink * appsink, GstClockTime timeout)
 
   g_mutex_lock (&priv->mutex);
 
-  while (TRUE) {
-    GST_DEBUG_OBJECT (appsink, "trying to grab a buffer");
-    if (!priv->started)
-      goto not_started;
+  /* anything queued from now on has to be announced with new-samples again */
+  g_atomic_int_set (&priv->samples_notified, FALSE);
 
-    if (priv->num_buffers > 0)
-      break;
-
-    if (priv->is_eos)
-      goto eos;
-
-    /* nothing to return, wait */
-    GST_DEBUG_OBJECT (appsink, "waiting for a buffer");
-    if (timeout_valid) {
-      if (!g_cond_wait_until (&priv->cond, &priv->mutex, end_time))
-        goto expired;
-    } else {
-      g_cond_wait (&priv->cond, &priv->mutex);
-    }
+  if (!gst_app_sink_wait_queued (appsink, timeout_valid, end_time)) {
+    g_mutex_unlock (&priv->mutex);
+    return 0;
   }
 
-  obj = dequeue_buffer (appsink);
-  if (GST_IS_BUFFER (obj)) {
-    GST_DEBUG_OBJECT (appsink, "we have a buffer %p", obj);
-    sample = gst_sample_new (GST_BUFFER_CAST (obj), priv->last_caps,
-        &priv->last_segment, NULL);
-  } else {
-    GST_DEBUG_OBJECT (appsink, "we have a list %p", obj);
-    sample = gst_sample_new (NULL, priv->last_caps, &priv->last_segment, NULL);
-    gst_sample_set_buffer_list (sample, GST_BUFFER_LIST_CAST (obj));
-  }
-  gst_mini_object_unref (obj);
+  n = MIN (n_samples, gst_app_sink_queued (priv));
+  for (i = 0; i < n; i++)
+    samples[i] = gst_app_sink_dequeue_sample (appsink);
+
+  GST_DEBUG_OBJECT (appsink, "pulled %u samples", n);
 
   g_cond_signal (&priv->cond);
   g_mutex_unlock (&priv->mutex);
 
-  return sample;
-
-  /* special conditions */
-expired:
-  {
-    GST_DEBUG_OBJECT (appsink, "timeout expired, return NULL");
-    g_mutex_unlock (&priv->mutex);
-    return NULL;
-  }
-eos:
-  {
-    GST_DEBUG_OBJECT (appsink, "we are EOS, return NULL");
-    g_mutex_unlock (&priv->mutex);
-    return NULL;
-  }
-not_started:
-  {
-    GST_DEBUG_OBJECT (appsink, "we are stopped, return NULL");
-    g_mutex_unlock (&priv->mutex);
-    return NULL;
-  }
+  return n;
 }
 
 /**
@@ -58,6 +58,10 @@ typedef struct _GstAppSinkPrivate GstAppSinkPrivate;
  *       The new sample can be retrieved with
  *       gst_app_sink_pull_sample() either from this callback
  *       or from any other thread.
+ * @new_samples: Called for the first sample that is queued after the
+ *       application last pulled. This callback is called from the
+ *       streaming thread. All queued samples can be retrieved at once
+ *       with gst_app_sink_pull_samples(). Since: 1.14
  *
  * A set of callbacks that can be installed on the appsink with
  * gst_app_sink_set_callbacks().
@@ -66,9 +70,10 @@ typedef struct {
   void          (*eos)              (GstAppSink *appsink, gpointer user_data);
   GstFlowReturn (*new_preroll)      (GstAppSink *appsink, gpointer user_data);
   GstFlowReturn (*new_sample)       (GstAppSink *appsink, gpointer user_data);
+  GstFlowReturn (*new_samples)      (GstAppSink *appsink, gpointer user_data);
 
   /*< private >*/
-  gpointer     _gst_reserved[GST_PADDING];
+  gpointer     _gst_reserved[GST_PADDING - 1];
 } GstAppSinkCallbacks;
 
 struct _GstAppSink
@@ -97,8 +102,11 @@ struct _GstAppSinkClass
   GstSample *   (*try_pull_preroll)  (GstAppSink *appsink, GstClockTime timeout);
   GstSample *   (*try_pull_sample)   (GstAppSink *appsink, GstClockTime timeout);
 
+  /* signals */
+  GstFlowReturn (*new_samples)       (GstAppSink *appsink);
+
   /*< private >*/
-  gpointer     _gst_reserved[GST_PADDING - 2];
+  gpointer     _gst_reserved[GST_PADDING - 3];
 };
 
 GType gst_app_sink_get_type(void);
@@ -128,6 +136,11 @@ GstSample *     gst_app_sink_pull_sample      (GstAppSink *appsink);
 GstSample *     gst_app_sink_try_pull_preroll (GstAppSink *appsink, GstClockTime timeout);
 GstSample *     gst_app_sink_try_pull_sample  (GstAppSink *appsink, GstClockTime timeout);
 
+guint           gst_app_sink_pull_samples     (GstAppSink *appsink, GstSample **samples,
+                                               guint n_samples);
+guint           gst_app_sink_try_pull_samples (GstAppSink *appsink, GstSample **samples,
+                                               guint n_samples, GstClockTime timeout);
+
 void            gst_app_sink_set_callbacks    (GstAppSink * appsink,
                                                GstAppSinkCallbacks *callbacks,
                                                gpointer user_data,
@@ -100,6 +100,7 @@
 #include <string.h>
 
 #include "gstappsrc.h"
+#include "gstappringprivate.h"
 
 struct _GstAppSrcPrivate
 {
@@ -130,6 +131,15 @@ struct _GstAppSrcPrivate
   gboolean emit_signals;
   guint min_percent;
 
+  /* lock-free mode, buffers pushed without the lock go to the ring and
+   * are always older than the ones in the queue */
+  gboolean lock_free;
+  GstAppRing ring;
+  volatile gsize ring_bytes;
+  volatile gint waiting;
+  /* length of the queue, read by the lock-free pusher */
+  volatile gint queue_length;
+
   GstAppSrcCallbacks callbacks;
   gpointer user_data;
   GDestroyNotify notify;
@@ -165,6 +175,7 @@ enum
 #define DEFAULT_PROP_MIN_PERCENT   0
 #define DEFAULT_PROP_CURRENT_LEVEL_BYTES   0
 #define DEFAULT_PROP_DURATION      GST_CLOCK_TIME_NONE
+#define DEFAULT_PROP_LOCK_FREE     FALSE
 
 enum
 {
@@ -182,6 +193,7 @@ enum
   PROP_MIN_PERCENT,
   PROP_CURRENT_LEVEL_BYTES,
   PROP_DURATION,
+  PROP_LOCK_FREE,
   PROP_LAST
 };
 
@@ -399,6 +411,23 @@ gst_app_src_class_init (GstAppSrcClass * klass)
           0, G_MAXUINT64, DEFAULT_PROP_DURATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAppSrc::lock-free:
+   *
+   * Queue pushed buffers in a bounded lock-free ring when possible, so that
+   * push-buffer does not contend with the streaming thread for the appsrc
+   * lock. Buffers, samples, caps and EOS must then be pushed from one thread
+   * at a time. Pushes that would exceed max-bytes or that have to emit
+   * enough-data or block take the locked path as before.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_LOCK_FREE,
+      g_param_spec_boolean ("lock-free", "Lock Free",
+          "Queue buffers without taking a lock when possible, buffers must be "
+          "pushed from a single thread", DEFAULT_PROP_LOCK_FREE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstAppSrc::need-data:
    * @appsrc: the appsrc element that emitted the signal
@@ -555,10 +584,74 @@ gst_app_src_init (GstAppSrc * appsrc)
   priv->max_latency = DEFAULT_PROP_MAX_LATENCY;
   priv->emit_signals = DEFAULT_PROP_EMIT_SIGNALS;
   priv->min_percent = DEFAULT_PROP_MIN_PERCENT;
+  priv->lock_free = DEFAULT_PROP_LOCK_FREE;
 
   gst_base_src_set_live (GST_BASE_SRC (appsrc), DEFAULT_PROP_IS_LIVE);
 }
 
+/* the number of bytes in the queue and the ring */
+static guint64
+gst_app_src_queued_bytes (GstAppSrcPrivate * priv)
+{
+  return priv->queued_bytes + (gsize) g_atomic_pointer_get (&priv->ring_bytes);
+}
+
+/* Must be called with priv->mutex */
+static void
+gst_app_src_queue_push_tail (GstAppSrcPrivate * priv, gpointer obj)
+{
+  g_queue_push_tail (priv->queue, obj);
+  g_atomic_int_inc (&priv->queue_length);
+}
+
+/* Must be called with priv->mutex and a non-empty queue */
+static gpointer
+gst_app_src_queue_pop_head (GstAppSrcPrivate * priv)
+{
+  g_atomic_int_add (&priv->queue_length, -1);
+  return g_queue_pop_head (priv->queue);
+}
+
+/* Must be called with priv->mutex and a non-empty queue */
+static gpointer
+gst_app_src_queue_pop_tail (GstAppSrcPrivate * priv)
+{
+  g_atomic_int_add (&priv->queue_length, -1);
+  return g_queue_pop_tail (priv->queue);
+}
+
+/* Must be called with priv->mutex */
+static gboolean
+gst_app_src_has_queued (GstAppSrcPrivate * priv)
+{
+  if (priv->ring.data && gst_app_ring_length (&priv->ring) > 0)
+    return TRUE;
+
+  return !g_queue_is_empty (priv->queue);
+}
+
+/* Must be called with priv->mutex. Returns FALSE when nothing is queued,
+ * @obj can be a buffer or caps (including NULL caps) */
+static gboolean
+gst_app_src_pop_queued (GstAppSrcPrivate * priv, GstMiniObject ** obj)
+{
+  /* everything in the ring was pushed before the queue was used */
+  if (priv->ring.data && (*obj = gst_app_ring_pop (&priv->ring))) {
+    g_atomic_pointer_add (&priv->ring_bytes,
+        -(gssize) gst_buffer_get_size (GST_BUFFER_CAST (*obj)));
+    return TRUE;
+  }
+
+  if (g_queue_is_empty (priv->queue))
+    return FALSE;
+
+  *obj = gst_app_src_queue_pop_head (priv);
+  if (*obj && GST_IS_BUFFER (*obj))
+    priv->queued_bytes -= gst_buffer_get_size (GST_BUFFER_CAST (*obj));
+
+  return TRUE;
+}
+
 /* Must be called with priv->mutex */
 static void
 gst_app_src_flush_queued (GstAppSrc * src, gboolean retain_last_caps)
@@ -567,8 +660,16 @@ gst_app_src_flush_queued (GstAppSrc * src, gboolean retain_last_caps)
   GstAppSrcPrivate *priv = src->priv;
   GstCaps *requeue_caps = NULL;
 
+  if (priv->ring.data) {
+    while ((obj = gst_app_ring_pop (&priv->ring))) {
+      g_atomic_pointer_add (&priv->ring_bytes,
+          -(gssize) gst_buffer_get_size (GST_BUFFER_CAST (obj)));
+      gst_mini_object_unref (obj);
+    }
+  }
+
   while (!g_queue_is_empty (priv->queue)) {
-    obj = g_queue_pop_head (priv->queue);
+    obj = gst_app_src_queue_pop_head (priv);
     if (obj) {
       if (GST_IS_CAPS (obj) && retain_last_caps) {
         gst_caps_replace (&requeue_caps, GST_CAPS_CAST (obj));
@@ -578,7 +679,7 @@ gst_app_src_flush_queued (GstAppSrc * src, gboolean retain_last_caps)
   }
 
   if (requeue_caps) {
-    g_queue_push_tail (priv->queue, requeue_caps);
+    gst_app_src_queue_push_tail (priv, requeue_caps);
   }
 
   priv->queued_bytes = 0;
@@ -623,6 +724,7 @@ gst_app_src_finalize (GObject * obj)
   g_mutex_clear (&priv->mutex);
   g_cond_clear (&priv->cond);
   g_queue_free (priv->queue);
+  gst_app_ring_free (&priv->ring);
 
   g_free (priv->uri);
 
@@ -702,6 +804,14 @@ gst_app_src_set_property (GObject * object, guint prop_id,
     case PROP_DURATION:
       gst_app_src_set_duration (appsrc, g_value_get_uint64 (value));
       break;
+    case PROP_LOCK_FREE:
+      g_mutex_lock (&priv->mutex);
+      /* the ring stays around, the streaming thread keeps draining it */
+      if (priv->ring.data == NULL)
+        gst_app_ring_init (&priv->ring, GST_APP_RING_DEFAULT_SIZE);
+      priv->lock_free = g_value_get_boolean (value);
+      g_mutex_unlock (&priv->mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -765,6 +875,9 @@ gst_app_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DURATION:
       g_value_set_uint64 (value, gst_app_src_get_duration (appsrc));
       break;
+    case PROP_LOCK_FREE:
+      g_value_set_boolean (value, priv->lock_free);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1143,10 +1256,11 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
   }
 
   while (TRUE) {
+    GstMiniObject *obj;
+
     /* return data as long as we have some */
-    if (!g_queue_is_empty (priv->queue)) {
+    if (gst_app_src_pop_queued (priv, &obj)) {
       guint buf_size;
-      GstMiniObject *obj = g_queue_pop_head (priv->queue);
 
       if (!GST_IS_BUFFER (obj)) {
         GstCaps *next_caps = GST_CAPS (obj);
@@ -1182,8 +1296,6 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
 
       GST_DEBUG_OBJECT (appsrc, "we have buffer %p of size %u", *buf, buf_size);
 
-      priv->queued_bytes -= buf_size;
-
       /* only update the offset when in random_access mode */
       if (priv->stream_type == GST_APP_STREAM_TYPE_RANDOM_ACCESS)
         priv->offset += buf_size;
@@ -1193,7 +1305,8 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
 
       /* see if we go lower than the empty-percent */
       if (priv->min_percent && priv->max_bytes) {
-        if (priv->queued_bytes * 100 / priv->max_bytes <= priv->min_percent)
+        if (gst_app_src_queued_bytes (priv) * 100 / priv->max_bytes <=
+            priv->min_percent)
           /* ignore flushing state, we got a buffer and we will return it now.
            * Errors will be handled in the next round */
           gst_app_src_emit_need_data (appsrc, size);
@@ -1212,7 +1325,7 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
        * signal) we can still be empty because the pushed buffer got flushed or
        * when the application pushes the requested buffer later, we support both
        * possibilities. */
-      if (!g_queue_is_empty (priv->queue))
+      if (gst_app_src_has_queued (priv))
         continue;
 
       /* no buffer yet, maybe we are EOS, if not, block for more data. */
@@ -1222,8 +1335,13 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
     if (G_UNLIKELY (priv->is_eos))
       goto eos;
 
-    /* nothing to return, wait a while for new data or flushing. */
-    g_cond_wait (&priv->cond, &priv->mutex);
+    /* nothing to return, wait a while for new data or flushing. Lock-free
+     * pushes only wake us up when they see the waiting flag, so check again
+     * after setting it */
+    g_atomic_int_set (&priv->waiting, 1);
+    if (!gst_app_src_has_queued (priv))
+      g_cond_wait (&priv->cond, &priv->mutex);
+    g_atomic_int_set (&priv->waiting, 0);
   }
   g_mutex_unlock (&priv->mutex);
   return ret;
@@ -1285,9 +1403,9 @@ gst_app_src_set_caps (GstAppSrc * appsrc, const GstCaps * caps)
     new_caps = caps ? gst_caps_copy (caps) : NULL;
     GST_DEBUG_OBJECT (appsrc, "setting caps to %" GST_PTR_FORMAT, caps);
     if (priv->queue->tail != NULL && GST_IS_CAPS (priv->queue->tail->data)) {
-      gst_caps_unref (g_queue_pop_tail (priv->queue));
+      gst_caps_unref (gst_app_src_queue_pop_tail (priv));
     }
-    g_queue_push_tail (priv->queue, new_caps);
+    gst_app_src_queue_push_tail (priv, new_caps);
     gst_caps_replace (&priv->last_caps, new_caps);
   }
 
@@ -1554,7 +1672,7 @@ gst_app_src_get_current_level_bytes (GstAppSrc * appsrc)
   priv = appsrc->priv;
 
   GST_OBJECT_LOCK (appsrc);
-  queued = priv->queued_bytes;
+  queued = gst_app_src_queued_bytes (priv);
   GST_DEBUG_OBJECT (appsrc, "current level bytes is %" G_GUINT64_FORMAT,
       queued);
   GST_OBJECT_UNLOCK (appsrc);
@@ -1676,6 +1794,52 @@ gst_app_src_get_emit_signals (GstAppSrc * appsrc)
   return result;
 }
 
+/* Queues @buffer in the ring without taking the lock. This is only done
+ * when the locked queue is empty, so that the order is kept, and when there
+ * is room below max-bytes. Everything else takes the locked path. */
+static gboolean
+gst_app_src_push_lock_free (GstAppSrc * appsrc, GstBuffer * buffer,
+    gboolean steal_ref)
+{
+  GstAppSrcPrivate *priv = appsrc->priv;
+  gsize size;
+
+  if (G_UNLIKELY (priv->flushing || priv->is_eos))
+    return FALSE;
+
+  /* only the pusher adds to the queue, it can only shrink behind our back */
+  if (g_atomic_int_get (&priv->queue_length) != 0)
+    return FALSE;
+
+  if (priv->max_bytes &&
+      (gsize) g_atomic_pointer_get (&priv->ring_bytes) >= priv->max_bytes)
+    return FALSE;
+
+  size = gst_buffer_get_size (buffer);
+  if (!steal_ref)
+    gst_buffer_ref (buffer);
+
+  /* account before publishing, the streaming thread subtracts after
+   * popping */
+  g_atomic_pointer_add (&priv->ring_bytes, size);
+  if (!gst_app_ring_push (&priv->ring, buffer)) {
+    g_atomic_pointer_add (&priv->ring_bytes, -(gssize) size);
+    if (!steal_ref)
+      gst_buffer_unref (buffer);
+    return FALSE;
+  }
+
+  GST_LOG_OBJECT (appsrc, "queued buffer %p without locking", buffer);
+
+  if (g_atomic_int_get (&priv->waiting)) {
+    g_mutex_lock (&priv->mutex);
+    g_cond_broadcast (&priv->cond);
+    g_mutex_unlock (&priv->mutex);
+  }
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
     gboolean steal_ref)
@@ -1722,6 +1886,9 @@ gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
     }
   }
 
+  if (priv->lock_free && gst_app_src_push_lock_free (appsrc, buffer, steal_ref))
+    return GST_FLOW_OK;
+
   g_mutex_lock (&priv->mutex);
 
   while (TRUE) {
@@ -1732,10 +1899,10 @@ gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
     if (priv->is_eos)
       goto eos;
 
-    if (priv->max_bytes && priv->queued_bytes >= priv->max_bytes) {
+    if (priv->max_bytes && gst_app_src_queued_bytes (priv) >= priv->max_bytes) {
       GST_DEBUG_OBJECT (appsrc,
           "queue filled (%" G_GUINT64_FORMAT " >= %" G_GUINT64_FORMAT ")",
-          priv->queued_bytes, priv->max_bytes);
+          gst_app_src_queued_bytes (priv), priv->max_bytes);
 
       if (first) {
         gboolean emit;
@@ -1773,7 +1940,7 @@ gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
   GST_DEBUG_OBJECT (appsrc, "queueing buffer %p", buffer);
   if (!steal_ref)
     gst_buffer_ref (buffer);
-  g_queue_push_tail (priv->queue, buffer);
+  gst_app_src_queue_push_tail (priv, buffer);
   priv->queued_bytes += gst_buffer_get_size (buffer);
   g_cond_broadcast (&priv->cond);
   g_mutex_unlock (&priv->mutex);
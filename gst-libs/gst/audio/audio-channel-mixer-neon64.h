@@ -0,0 +1,155 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* aarch64 versions of the float mixing functions for mono and stereo
+ * output. aarch64 always has NEON so these are used without a runtime
+ * check. Every output sample is summed in the same order as in the C
+ * versions. */
+
+#include <arm_neon.h>
+
+/* one frame per iteration, both output channels in one vector */
+static void
+gst_audio_channel_mixer_mix_double_stereo_simd (GstAudioChannelMixer * mix,
+    const gdouble * in_data, gdouble * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  float64x2_t coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = vcombine_f64 (vdup_n_f64 (mix->matrix[in][0]),
+        vdup_n_f64 (mix->matrix[in][1]));
+
+  for (n = 0; n < samples; n++) {
+    res = vdupq_n_f64 (0.0);
+    for (in = 0; in < inchannels; in++)
+      res = vaddq_f64 (res, vmulq_f64 (vdupq_n_f64 (in_data[in]), coef[in]));
+
+    vst1q_f64 (out_data, res);
+    in_data += inchannels;
+    out_data += 2;
+  }
+}
+
+/* two frames per iteration */
+static void
+gst_audio_channel_mixer_mix_double_mono_simd (GstAudioChannelMixer * mix,
+    const gdouble * in_data, gdouble * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  float64x2_t coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = vdupq_n_f64 (mix->matrix[in][0]);
+
+  for (n = 0; n + 1 < samples; n += 2) {
+    res = vdupq_n_f64 (0.0);
+    for (in = 0; in < inchannels; in++)
+      res = vaddq_f64 (res, vmulq_f64 (vcombine_f64 (vld1_f64 (in_data + in),
+                  vld1_f64 (in_data + inchannels + in)), coef[in]));
+
+    vst1q_f64 (out_data, res);
+    in_data += 2 * inchannels;
+    out_data += 2;
+  }
+  if (n < samples) {
+    gdouble r = 0.0;
+
+    for (in = 0; in < inchannels; in++)
+      r += in_data[in] * mix->matrix[in][0];
+    out_data[0] = r;
+  }
+}
+
+/* two frames per iteration, laid out as L R L R */
+static void
+gst_audio_channel_mixer_mix_float_stereo_simd (GstAudioChannelMixer * mix,
+    const gfloat * in_data, gfloat * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  float32x4_t coef[64], res;
+
+  for (in = 0; in < inchannels; in++) {
+    float32x2_t c = vset_lane_f32 (mix->matrix[in][1],
+        vdup_n_f32 (mix->matrix[in][0]), 1);
+
+    coef[in] = vcombine_f32 (c, c);
+  }
+
+  for (n = 0; n + 1 < samples; n += 2) {
+    res = vdupq_n_f32 (0.0);
+    for (in = 0; in < inchannels; in++)
+      res = vaddq_f32 (res,
+          vmulq_f32 (vcombine_f32 (vdup_n_f32 (in_data[in]),
+                  vdup_n_f32 (in_data[inchannels + in])), coef[in]));
+
+    vst1q_f32 (out_data, res);
+    in_data += 2 * inchannels;
+    out_data += 4;
+  }
+  if (n < samples) {
+    gfloat l = 0.0, r = 0.0;
+
+    for (in = 0; in < inchannels; in++) {
+      l += in_data[in] * mix->matrix[in][0];
+      r += in_data[in] * mix->matrix[in][1];
+    }
+    out_data[0] = l;
+    out_data[1] = r;
+  }
+}
+
+/* four frames per iteration */
+static void
+gst_audio_channel_mixer_mix_float_mono_simd (GstAudioChannelMixer * mix,
+    const gfloat * in_data, gfloat * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  float32x4_t coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = vdupq_n_f32 (mix->matrix[in][0]);
+
+  for (n = 0; n + 3 < samples; n += 4) {
+    float32x4_t x;
+
+    res = vdupq_n_f32 (0.0);
+    for (in = 0; in < inchannels; in++) {
+      x = vdupq_n_f32 (in_data[in]);
+      x = vsetq_lane_f32 (in_data[inchannels + in], x, 1);
+      x = vsetq_lane_f32 (in_data[2 * inchannels + in], x, 2);
+      x = vsetq_lane_f32 (in_data[3 * inchannels + in], x, 3);
+      res = vaddq_f32 (res, vmulq_f32 (x, coef[in]));
+    }
+    vst1q_f32 (out_data, res);
+    in_data += 4 * inchannels;
+    out_data += 4;
+  }
+  for (; n < samples; n++) {
+    gfloat r = 0.0;
+
+    for (in = 0; in < inchannels; in++)
+      r += in_data[in] * mix->matrix[in][0];
+    *out_data++ = r;
+    in_data += inchannels;
+  }
+}
@@ -0,0 +1,150 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* SSE2 versions of the float mixing functions for mono and stereo output,
+ * which covers the common downmixes. SSE2 is only used when the compiler
+ * targets it anyway, so no runtime check is needed. Every output sample is
+ * summed in the same order as in the C versions, the results are the
+ * same. */
+
+#include <emmintrin.h>
+
+/* one frame per iteration, both output channels in one vector */
+static void
+gst_audio_channel_mixer_mix_double_stereo_simd (GstAudioChannelMixer * mix,
+    const gdouble * in_data, gdouble * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  __m128d coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = _mm_set_pd (mix->matrix[in][1], mix->matrix[in][0]);
+
+  for (n = 0; n < samples; n++) {
+    res = _mm_setzero_pd ();
+    for (in = 0; in < inchannels; in++)
+      res = _mm_add_pd (res, _mm_mul_pd (_mm_set1_pd (in_data[in]),
+              coef[in]));
+
+    _mm_storeu_pd (out_data, res);
+    in_data += inchannels;
+    out_data += 2;
+  }
+}
+
+/* two frames per iteration */
+static void
+gst_audio_channel_mixer_mix_double_mono_simd (GstAudioChannelMixer * mix,
+    const gdouble * in_data, gdouble * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  __m128d coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = _mm_set1_pd (mix->matrix[in][0]);
+
+  for (n = 0; n + 1 < samples; n += 2) {
+    res = _mm_setzero_pd ();
+    for (in = 0; in < inchannels; in++)
+      res = _mm_add_pd (res, _mm_mul_pd (_mm_set_pd (in_data[inchannels + in],
+                  in_data[in]), coef[in]));
+
+    _mm_storeu_pd (out_data, res);
+    in_data += 2 * inchannels;
+    out_data += 2;
+  }
+  if (n < samples) {
+    gdouble r = 0.0;
+
+    for (in = 0; in < inchannels; in++)
+      r += in_data[in] * mix->matrix[in][0];
+    out_data[0] = r;
+  }
+}
+
+/* two frames per iteration, laid out as L R L R */
+static void
+gst_audio_channel_mixer_mix_float_stereo_simd (GstAudioChannelMixer * mix,
+    const gfloat * in_data, gfloat * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  __m128 coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = _mm_set_ps (mix->matrix[in][1], mix->matrix[in][0],
+        mix->matrix[in][1], mix->matrix[in][0]);
+
+  for (n = 0; n + 1 < samples; n += 2) {
+    res = _mm_setzero_ps ();
+    for (in = 0; in < inchannels; in++) {
+      gfloat a = in_data[in], b = in_data[inchannels + in];
+
+      res = _mm_add_ps (res, _mm_mul_ps (_mm_set_ps (b, b, a, a), coef[in]));
+    }
+    _mm_storeu_ps (out_data, res);
+    in_data += 2 * inchannels;
+    out_data += 4;
+  }
+  if (n < samples) {
+    gfloat l = 0.0, r = 0.0;
+
+    for (in = 0; in < inchannels; in++) {
+      l += in_data[in] * mix->matrix[in][0];
+      r += in_data[in] * mix->matrix[in][1];
+    }
+    out_data[0] = l;
+    out_data[1] = r;
+  }
+}
+
+/* four frames per iteration */
+static void
+gst_audio_channel_mixer_mix_float_mono_simd (GstAudioChannelMixer * mix,
+    const gfloat * in_data, gfloat * out_data, gint samples)
+{
+  gint in, n;
+  gint inchannels = mix->in_channels;
+  __m128 coef[64], res;
+
+  for (in = 0; in < inchannels; in++)
+    coef[in] = _mm_set1_ps (mix->matrix[in][0]);
+
+  for (n = 0; n + 3 < samples; n += 4) {
+    res = _mm_setzero_ps ();
+    for (in = 0; in < inchannels; in++)
+      res = _mm_add_ps (res,
+          _mm_mul_ps (_mm_set_ps (in_data[3 * inchannels + in],
+                  in_data[2 * inchannels + in], in_data[inchannels + in],
+                  in_data[in]), coef[in]));
+
+    _mm_storeu_ps (out_data, res);
+    in_data += 4 * inchannels;
+    out_data += 4;
+  }
+  for (; n < samples; n++) {
+    gfloat r = 0.0;
+
+    for (in = 0; in < inchannels; in++)
+      r += in_data[in] * mix->matrix[in][0];
+    *out_data++ = r;
+    in_data += inchannels;
+  }
+}
@@ -57,6 +57,14 @@ ensure_debug_category (void)
 typedef void (*MixerFunc) (GstAudioChannelMixer * mix, const gpointer src,
     gpointer dst, gint samples);
 
+/* a non-zero coefficient of the matrix */
+typedef struct
+{
+  gint in;
+  gfloat coef;
+  gint coef_int;
+} MixerTap;
+
 struct _GstAudioChannelMixer
 {
   GstAudioChannelMixerFlags flags;
@@ -76,6 +84,15 @@ struct _GstAudioChannelMixer
    * this is matrix * (2^10) as integers */
   gint **matrix_int;
 
+  /* sparse form of the matrix, the non-zero coefficients for output channel
+   * out are taps[tap_offset[out]] up to taps[tap_offset[out + 1]] */
+  MixerTap *taps;
+  gint tap_offset[65];
+
+  /* when every output channel is a copy of one input channel or silent, the
+   * input channel for each output channel or -1 */
+  gint reorder[64];
+
   MixerFunc func;
 
   gpointer tmp;
@@ -103,6 +120,9 @@ gst_audio_channel_mixer_free (GstAudioChannelMixer * mix)
   g_free (mix->matrix_int);
   mix->matrix_int = NULL;
 
+  g_free (mix->taps);
+  mix->taps = NULL;
+
   g_free (mix->tmp);
   mix->tmp = NULL;
 
@@ -664,6 +684,28 @@ gst_audio_channel_mixer_setup_matrix_int (GstAudioChannelMixer * mix)
   }
 }
 
+static void
+gst_audio_channel_mixer_setup_matrix_sparse (GstAudioChannelMixer * mix)
+{
+  gint i, j, n_taps = 0;
+
+  mix->taps = g_new (MixerTap, mix->in_channels * mix->out_channels);
+
+  for (j = 0; j < mix->out_channels; j++) {
+    mix->tap_offset[j] = n_taps;
+    for (i = 0; i < mix->in_channels; i++) {
+      if (mix->matrix[i][j] == 0.0)
+        continue;
+
+      mix->taps[n_taps].in = i;
+      mix->taps[n_taps].coef = mix->matrix[i][j];
+      mix->taps[n_taps].coef_int = mix->matrix_int[i][j];
+      n_taps++;
+    }
+  }
+  mix->tap_offset[mix->out_channels] = n_taps;
+}
+
 static void
 gst_audio_channel_mixer_setup_matrix (GstAudioChannelMixer * mix)
 {
@@ -683,6 +725,7 @@ gst_audio_channel_mixer_setup_matrix (GstAudioChannelMixer * mix)
   gst_audio_channel_mixer_fill_matrix (mix);
 
   gst_audio_channel_mixer_setup_matrix_int (mix);
+  gst_audio_channel_mixer_setup_matrix_sparse (mix);
 
 #ifndef GST_DISABLE_GST_DEBUG
   /* debug */
@@ -806,6 +849,243 @@ gst_audio_channel_mixer_mix_double (GstAudioChannelMixer * mix,
   }
 }
 
+/* The sparse versions only visit the non-zero coefficients, the usual up
+ * and downmix matrices are mostly zeroes. Skipping a zero coefficient does
+ * not change the result. */
+static void
+gst_audio_channel_mixer_mix_int16_sparse (GstAudioChannelMixer * mix,
+    const gint16 * in_data, gint16 * out_data, gint samples)
+{
+  gint out, n, t;
+  gint32 res;
+  gint inchannels, outchannels;
+  const MixerTap *taps = mix->taps;
+
+  inchannels = mix->in_channels;
+  outchannels = mix->out_channels;
+
+  for (n = 0; n < samples; n++) {
+    for (out = 0; out < outchannels; out++) {
+      res = 0;
+      for (t = mix->tap_offset[out]; t < mix->tap_offset[out + 1]; t++)
+        res += in_data[taps[t].in] * taps[t].coef_int;
+
+      /* remove factor from int matrix */
+      res = (res + (1 << (PRECISION_INT - 1))) >> PRECISION_INT;
+      out_data[out] = CLAMP (res, G_MININT16, G_MAXINT16);
+    }
+    in_data += inchannels;
+    out_data += outchannels;
+  }
+}
+
+static void
+gst_audio_channel_mixer_mix_int32_sparse (GstAudioChannelMixer * mix,
+    const gint32 * in_data, gint32 * out_data, gint samples)
+{
+  gint out, n, t;
+  gint64 res;
+  gint inchannels, outchannels;
+  const MixerTap *taps = mix->taps;
+
+  inchannels = mix->in_channels;
+  outchannels = mix->out_channels;
+
+  for (n = 0; n < samples; n++) {
+    for (out = 0; out < outchannels; out++) {
+      res = 0;
+      for (t = mix->tap_offset[out]; t < mix->tap_offset[out + 1]; t++)
+        res += in_data[taps[t].in] * (gint64) taps[t].coef_int;
+
+      /* remove factor from int matrix */
+      res = (res + (1 << (PRECISION_INT - 1))) >> PRECISION_INT;
+      out_data[out] = CLAMP (res, G_MININT32, G_MAXINT32);
+    }
+    in_data += inchannels;
+    out_data += outchannels;
+  }
+}
+
+static void
+gst_audio_channel_mixer_mix_float_sparse (GstAudioChannelMixer * mix,
+    const gfloat * in_data, gfloat * out_data, gint samples)
+{
+  gint out, n, t;
+  gfloat res;
+  gint inchannels, outchannels;
+  const MixerTap *taps = mix->taps;
+
+  inchannels = mix->in_channels;
+  outchannels = mix->out_channels;
+
+  for (n = 0; n < samples; n++) {
+    for (out = 0; out < outchannels; out++) {
+      res = 0.0;
+      for (t = mix->tap_offset[out]; t < mix->tap_offset[out + 1]; t++)
+        res += in_data[taps[t].in] * taps[t].coef;
+
+      out_data[out] = res;
+    }
+    in_data += inchannels;
+    out_data += outchannels;
+  }
+}
+
+static void
+gst_audio_channel_mixer_mix_double_sparse (GstAudioChannelMixer * mix,
+    const gdouble * in_data, gdouble * out_data, gint samples)
+{
+  gint out, n, t;
+  gdouble res;
+  gint inchannels, outchannels;
+  const MixerTap *taps = mix->taps;
+
+  inchannels = mix->in_channels;
+  outchannels = mix->out_channels;
+
+  for (n = 0; n < samples; n++) {
+    for (out = 0; out < outchannels; out++) {
+      res = 0.0;
+      for (t = mix->tap_offset[out]; t < mix->tap_offset[out + 1]; t++)
+        res += in_data[taps[t].in] * taps[t].coef;
+
+      out_data[out] = res;
+    }
+    in_data += inchannels;
+    out_data += outchannels;
+  }
+}
+
+/* Copies the input channels to their output position when all coefficients
+ * are 0 or 1, which is also exact for the integer formats. The samples are
+ * copied as integers of the same width. */
+#define MAKE_REORDER_FUNC(type)                                         \
+static void                                                             \
+gst_audio_channel_mixer_reorder_##type (GstAudioChannelMixer * mix,     \
+    const type * in_data, type * out_data, gint samples)                \
+{                                                                       \
+  gint out, n;                                                          \
+  gint inchannels, outchannels;                                         \
+                                                                        \
+  inchannels = mix->in_channels;                                        \
+  outchannels = mix->out_channels;                                      \
+                                                                        \
+  for (n = 0; n < samples; n++) {                                       \
+    for (out = 0; out < outchannels; out++) {                           \
+      gint in = mix->reorder[out];                                      \
+      out_data[out] = in < 0 ? 0 : in_data[in];                         \
+    }                                                                   \
+    in_data += inchannels;                                              \
+    out_data += outchannels;                                            \
+  }                                                                     \
+}
+
+MAKE_REORDER_FUNC (guint16);
+MAKE_REORDER_FUNC (guint32);
+MAKE_REORDER_FUNC (guint64);
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+# define HAVE_MIXER_SIMD
+# define SIMD_NAME "sse2"
+# include "audio-channel-mixer-x86.h"
+#elif defined (__aarch64__)
+# define HAVE_MIXER_SIMD
+# define SIMD_NAME "neon64"
+# include "audio-channel-mixer-neon64.h"
+#endif
+
+static gboolean
+gst_audio_channel_mixer_is_reorder (GstAudioChannelMixer * mix)
+{
+  gint out, n_taps;
+
+  for (out = 0; out < mix->out_channels; out++) {
+    n_taps = mix->tap_offset[out + 1] - mix->tap_offset[out];
+
+    if (n_taps == 0) {
+      mix->reorder[out] = -1;
+    } else if (n_taps == 1 && mix->taps[mix->tap_offset[out]].coef == 1.0) {
+      mix->reorder[out] = mix->taps[mix->tap_offset[out]].in;
+    } else {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/* pick the fastest function for the format and the matrix */
+static void
+gst_audio_channel_mixer_setup_func (GstAudioChannelMixer * mix)
+{
+  gboolean sparse;
+
+  if (gst_audio_channel_mixer_is_reorder (mix)) {
+    GST_DEBUG ("using reorder function");
+    switch (mix->format) {
+      case GST_AUDIO_FORMAT_S16:
+        mix->func = (MixerFunc) gst_audio_channel_mixer_reorder_guint16;
+        break;
+      case GST_AUDIO_FORMAT_S32:
+      case GST_AUDIO_FORMAT_F32:
+        mix->func = (MixerFunc) gst_audio_channel_mixer_reorder_guint32;
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        mix->func = (MixerFunc) gst_audio_channel_mixer_reorder_guint64;
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+    return;
+  }
+#ifdef HAVE_MIXER_SIMD
+  if (mix->out_channels <= 2 && (mix->format == GST_AUDIO_FORMAT_F32 ||
+          mix->format == GST_AUDIO_FORMAT_F64)) {
+    GST_DEBUG ("using %s function for %d -> %d channels", SIMD_NAME,
+        mix->in_channels, mix->out_channels);
+    if (mix->format == GST_AUDIO_FORMAT_F32)
+      mix->func = mix->out_channels == 1 ?
+          (MixerFunc) gst_audio_channel_mixer_mix_float_mono_simd :
+          (MixerFunc) gst_audio_channel_mixer_mix_float_stereo_simd;
+    else
+      mix->func = mix->out_channels == 1 ?
+          (MixerFunc) gst_audio_channel_mixer_mix_double_mono_simd :
+          (MixerFunc) gst_audio_channel_mixer_mix_double_stereo_simd;
+    return;
+  }
+#endif
+
+  sparse = mix->tap_offset[mix->out_channels] <
+      mix->in_channels * mix->out_channels;
+  GST_DEBUG ("using %s function", sparse ? "sparse" : "dense");
+
+  switch (mix->format) {
+    case GST_AUDIO_FORMAT_S16:
+      mix->func = sparse ?
+          (MixerFunc) gst_audio_channel_mixer_mix_int16_sparse :
+          (MixerFunc) gst_audio_channel_mixer_mix_int16;
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      mix->func = sparse ?
+          (MixerFunc) gst_audio_channel_mixer_mix_int32_sparse :
+          (MixerFunc) gst_audio_channel_mixer_mix_int32;
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      mix->func = sparse ?
+          (MixerFunc) gst_audio_channel_mixer_mix_float_sparse :
+          (MixerFunc) gst_audio_channel_mixer_mix_float;
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      mix->func = sparse ?
+          (MixerFunc) gst_audio_channel_mixer_mix_double_sparse :
+          (MixerFunc) gst_audio_channel_mixer_mix_double;
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
+
 /**
  * gst_audio_channel_mixer_new: (skip):
  * @flags: #GstAudioChannelMixerFlags
@@ -848,24 +1128,8 @@ gst_audio_channel_mixer_new (GstAudioChannelMixerFlags flags,
     mix->out_position[i] = out_position[i];
 
   gst_audio_channel_mixer_setup_matrix (mix);
+  gst_audio_channel_mixer_setup_func (mix);
 
-  switch (mix->format) {
-    case GST_AUDIO_FORMAT_S16:
-      mix->func = (MixerFunc) gst_audio_channel_mixer_mix_int16;
-      break;
-    case GST_AUDIO_FORMAT_S32:
-      mix->func = (MixerFunc) gst_audio_channel_mixer_mix_int32;
-      break;
-    case GST_AUDIO_FORMAT_F32:
-      mix->func = (MixerFunc) gst_audio_channel_mixer_mix_float;
-      break;
-    case GST_AUDIO_FORMAT_F64:
-      mix->func = (MixerFunc) gst_audio_channel_mixer_mix_double;
-      break;
-    default:
-      g_assert_not_reached ();
-      break;
-  }
   return mix;
 }
 
@@ -144,6 +144,8 @@ struct _GstAudioConverter
 typedef gboolean (*AudioChainFunc) (AudioChain * chain, gpointer user_data);
 typedef gpointer *(*AudioChainAllocFunc) (AudioChain * chain, gsize num_samples,
     gpointer user_data);
+typedef void (*AudioChainStageFunc) (GstAudioConverter * convert,
+    AudioChain * chain, gpointer dst, const gpointer src, gsize num_samples);
 
 struct _AudioChain
 {
@@ -153,6 +155,10 @@ struct _AudioChain
   gpointer make_func_data;
   GDestroyNotify make_func_notify;
 
+  /* processes interleaved samples from src to dst, set for the per-frame
+   * stages that can be fused with their neighbours */
+  AudioChainStageFunc stage_func;
+
   const GstAudioFormatInfo *finfo;
   gint stride;
   gint inc;
@@ -253,6 +259,15 @@ get_opt_uint (GstAudioConverter * convert, const gchar * opt, guint def)
 }
 */
 
+static gboolean
+get_opt_bool (GstAudioConverter * convert, const gchar * opt, gboolean def)
+{
+  gboolean res;
+  if (!gst_structure_get_boolean (convert->config, opt, &res))
+    res = def;
+  return res;
+}
+
 static gint
 get_opt_enum (GstAudioConverter * convert, const gchar * opt, GType type,
     gint def)
@@ -267,6 +282,7 @@ get_opt_enum (GstAudioConverter * convert, const gchar * opt, GType type,
 #define DEFAULT_OPT_DITHER_METHOD GST_AUDIO_DITHER_NONE
 #define DEFAULT_OPT_NOISE_SHAPING_METHOD GST_AUDIO_NOISE_SHAPING_NONE
 #define DEFAULT_OPT_QUANTIZATION 1
+#define DEFAULT_OPT_FUSE_STAGES TRUE
 
 #define GET_OPT_RESAMPLER_METHOD(c) get_opt_enum(c, \
     GST_AUDIO_CONVERTER_OPT_RESAMPLER_METHOD, GST_TYPE_AUDIO_RESAMPLER_METHOD, \
@@ -279,6 +295,8 @@ get_opt_enum (GstAudioConverter * convert, const gchar * opt, GType type,
     DEFAULT_OPT_NOISE_SHAPING_METHOD)
 #define GET_OPT_QUANTIZATION(c) get_opt_uint(c, \
     GST_AUDIO_CONVERTER_OPT_QUANTIZATION, DEFAULT_OPT_QUANTIZATION)
+#define GET_OPT_FUSE_STAGES(c) get_opt_bool(c, \
+    GST_AUDIO_CONVERTER_OPT_FUSE_STAGES, DEFAULT_OPT_FUSE_STAGES)
 
 static gboolean
 copy_config (GQuark field_id, const GValue * value, gpointer user_data)
@@ -559,6 +577,82 @@ do_quantize (AudioChain * chain, gpointer user_data)
   return TRUE;
 }
 
+/* the stage functions below do the same work as the make functions above
+ * on a slice of interleaved samples, they are used when stages are fused */
+static void
+stage_unpack (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  if (src == NULL)
+    gst_audio_format_fill_silence (chain->finfo, dst, num_samples * chain->inc);
+  else if (convert->in_default)
+    memcpy (dst, src, num_samples * chain->stride);
+  else
+    convert->in.finfo->unpack_func (convert->in.finfo,
+        GST_AUDIO_PACK_FLAG_TRUNCATE_RANGE, dst, src, num_samples * chain->inc);
+}
+
+/* unpack and convert_in in one go. Unpacking S16 gives x << 16, which
+ * convert_in divides by 2^31, so dividing by 2^15 gives exactly the same
+ * result */
+static void
+stage_unpack_s16_to_f64 (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  const gint16 *s = src;
+  gdouble *d = dst;
+  gsize i, n = num_samples * chain->inc;
+
+  if (s == NULL) {
+    memset (d, 0, n * sizeof (gdouble));
+    return;
+  }
+  for (i = 0; i < n; i++)
+    d[i] = s[i] * (1.0 / 32768.0);
+}
+
+static void
+stage_convert_in (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  convert->convert_in (dst, src, num_samples * chain->inc);
+}
+
+static void
+stage_mix (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  gpointer in[1] = { src };
+  gpointer out[1] = { dst };
+
+  gst_audio_channel_mixer_samples (convert->mix, in, out, num_samples);
+}
+
+static void
+stage_convert_out (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  convert->convert_out (dst, src, num_samples * chain->inc);
+}
+
+static void
+stage_quantize (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  gpointer in[1] = { src };
+  gpointer out[1] = { dst };
+
+  gst_audio_quantize_samples (convert->quant, in, out, num_samples);
+}
+
+static void
+stage_pack (GstAudioConverter * convert, AudioChain * chain,
+    gpointer dst, const gpointer src, gsize num_samples)
+{
+  convert->out.finfo->pack_func (convert->out.finfo, 0, src, dst,
+      num_samples * convert->out.channels);
+}
+
 static gboolean
 is_intermediate_format (GstAudioFormat format)
 {
@@ -597,6 +691,7 @@ chain_unpack (GstAudioConverter * convert)
   prev->allow_ip = prev->finfo->width <= in->finfo->width;
   prev->pass_alloc = FALSE;
   audio_chain_set_make_func (prev, do_unpack, convert, NULL);
+  prev->stage_func = stage_unpack;
 
   return prev;
 }
@@ -620,6 +715,7 @@ chain_convert_in (GstAudioConverter * convert, AudioChain * prev)
     prev->allow_ip = FALSE;
     prev->pass_alloc = FALSE;
     audio_chain_set_make_func (prev, do_convert_in, convert, NULL);
+    prev->stage_func = stage_convert_in;
   }
   return prev;
 }
@@ -655,6 +751,7 @@ chain_mix (GstAudioConverter * convert, AudioChain * prev)
     prev->allow_ip = FALSE;
     prev->pass_alloc = FALSE;
     audio_chain_set_make_func (prev, do_mix, convert, NULL);
+    prev->stage_func = stage_mix;
   }
   return prev;
 }
@@ -714,6 +811,7 @@ chain_convert_out (GstAudioConverter * convert, AudioChain * prev)
     prev->allow_ip = TRUE;
     prev->pass_alloc = FALSE;
     audio_chain_set_make_func (prev, do_convert_out, convert, NULL);
+    prev->stage_func = stage_convert_out;
   }
   return prev;
 }
@@ -768,6 +866,10 @@ chain_quantize (GstAudioConverter * convert, AudioChain * prev)
     prev->allow_ip = TRUE;
     prev->pass_alloc = TRUE;
     audio_chain_set_make_func (prev, do_quantize, convert, NULL);
+    /* the dither noise depends on the position of the sample in each call,
+     * only quantize in slices when that does not change the output */
+    if (dither == GST_AUDIO_DITHER_NONE)
+      prev->stage_func = stage_quantize;
   }
   return prev;
 }
@@ -787,6 +889,235 @@ chain_pack (GstAudioConverter * convert, AudioChain * prev)
   return prev;
 }
 
+/* size of the temporary slices used between fused stages, small enough to
+ * keep the intermediate samples in the cache */
+#define FUSED_CHUNK_BYTES 8192
+#define MAX_FUSED_STAGES 8
+
+typedef struct
+{
+  AudioChainStageFunc func;
+  AudioChain *chain;
+  gint in_stride;
+  gint out_stride;
+} AudioFusedStage;
+
+typedef struct
+{
+  GstAudioConverter *convert;
+
+  /* the chain elements that were replaced */
+  AudioChain *chains[MAX_FUSED_STAGES];
+  gint n_chains;
+
+  AudioFusedStage stages[MAX_FUSED_STAGES];
+  gint n_stages;
+
+  gsize chunk_frames;
+  gpointer chunk[2];
+  /* input for the first stage when the input is NULL and that stage
+   * can't make silence itself */
+  gpointer silence;
+} AudioChainFused;
+
+static void
+audio_chain_fused_free (AudioChainFused * fused)
+{
+  gint i;
+
+  for (i = 0; i < fused->n_chains; i++)
+    audio_chain_free (fused->chains[i]);
+  g_free (fused->chunk[0]);
+  g_free (fused->chunk[1]);
+  g_free (fused->silence);
+  g_slice_free (AudioChainFused, fused);
+}
+
+/* runs all fused stages on small slices of the samples so that only the
+ * input and the output of the complete run go through memory */
+static gboolean
+do_fused (AudioChain * chain, gpointer user_data)
+{
+  AudioChainFused *fused = user_data;
+  GstAudioConverter *convert = fused->convert;
+  const guint8 *in;
+  gpointer *out;
+  gsize i, num_samples;
+
+  if (chain->prev) {
+    in = audio_chain_get_samples (chain->prev, &num_samples)[0];
+  } else {
+    in = convert->in_data ? convert->in_data[0] : NULL;
+    num_samples = convert->in_frames;
+  }
+  out = audio_chain_alloc_samples (chain, num_samples);
+  GST_LOG ("fused %d stages %p, %p %" G_GSIZE_FORMAT, fused->n_stages, in,
+      out, num_samples);
+
+  for (i = 0; i < num_samples; i += fused->chunk_frames) {
+    gsize n_frames = MIN (fused->chunk_frames, num_samples - i);
+    gpointer src, dst;
+    gint s;
+
+    src = in ? (gpointer) (in + i * fused->stages[0].in_stride) :
+        fused->silence;
+
+    for (s = 0; s < fused->n_stages; s++) {
+      AudioFusedStage *stage = &fused->stages[s];
+
+      if (s == fused->n_stages - 1)
+        dst = (guint8 *) out[0] + i * stage->out_stride;
+      else
+        dst = fused->chunk[s & 1];
+
+      stage->func (convert, stage->chain, dst, src, n_frames);
+      src = dst;
+    }
+  }
+  audio_chain_set_samples (chain, out, num_samples);
+
+  return TRUE;
+}
+
+static void
+fused_add_stage (AudioChainFused * fused, AudioChainStageFunc func,
+    AudioChain * chain, gint in_stride, gint out_stride)
+{
+  AudioFusedStage *stage = &fused->stages[fused->n_stages++];
+
+  stage->func = func;
+  stage->chain = chain;
+  stage->in_stride = in_stride;
+  stage->out_stride = out_stride;
+}
+
+/* replace the chain elements @first up to @last with one element that runs
+ * their stages in a single pass, with @pack the packing into the output
+ * format is done as well */
+static AudioChain *
+chain_fused_new (GstAudioConverter * convert, AudioChain * first,
+    AudioChain * last, gint n_chains, gboolean pack)
+{
+  AudioChainFused *fused;
+  AudioChain *chain;
+  gint i, stride, max_stride = 0;
+
+  fused = g_slice_new0 (AudioChainFused);
+  fused->convert = convert;
+  fused->n_chains = n_chains;
+  for (i = n_chains - 1, chain = last; i >= 0; i--, chain = chain->prev)
+    fused->chains[i] = chain;
+
+  stride = first->prev ? first->prev->stride : convert->in.bpf;
+
+  for (i = 0; i < n_chains; i++) {
+    chain = fused->chains[i];
+
+    if (chain->make_func == do_unpack) {
+      if (convert->in_default && i + 1 < n_chains) {
+        /* the next stage can read the input directly */
+        continue;
+      } else if (convert->in.finfo->format == GST_AUDIO_FORMAT_S16 &&
+          i + 1 < n_chains && fused->chains[i + 1]->make_func == do_convert_in) {
+        i++;
+        fused_add_stage (fused, stage_unpack_s16_to_f64, chain, stride,
+            fused->chains[i]->stride);
+        stride = fused->chains[i]->stride;
+        continue;
+      }
+    }
+    fused_add_stage (fused, chain->stage_func, chain, stride, chain->stride);
+    stride = chain->stride;
+  }
+  if (pack)
+    fused_add_stage (fused, stage_pack, NULL, stride, convert->out.bpf);
+
+  for (i = 0; i < fused->n_stages - 1; i++)
+    max_stride = MAX (max_stride, fused->stages[i].out_stride);
+
+  fused->chunk_frames = MAX (16, FUSED_CHUNK_BYTES / MAX (max_stride, 1));
+  if (max_stride > 0) {
+    fused->chunk[0] = g_malloc (fused->chunk_frames * max_stride);
+    fused->chunk[1] = g_malloc (fused->chunk_frames * max_stride);
+  }
+  if (first->prev == NULL && fused->stages[0].func != stage_unpack &&
+      fused->stages[0].func != stage_unpack_s16_to_f64) {
+    /* only the intermediate formats are read directly from the input and
+     * their silence is all zeroes */
+    fused->silence =
+        g_malloc0 (fused->chunk_frames * fused->stages[0].in_stride);
+  }
+
+  GST_INFO ("fused %d chain elements into %d stages, %" G_GSIZE_FORMAT
+      " frames per slice", n_chains, fused->n_stages, fused->chunk_frames);
+
+  chain = g_slice_new0 (AudioChain);
+  chain->prev = first->prev;
+  if (pack) {
+    chain->finfo = convert->out.finfo;
+    chain->inc = convert->out.channels;
+    chain->stride = convert->out.bpf;
+  } else {
+    chain->finfo = last->finfo;
+    chain->inc = last->inc;
+    chain->stride = last->stride;
+  }
+  chain->blocks = 1;
+  chain->allow_ip = FALSE;
+  chain->pass_alloc = FALSE;
+  audio_chain_set_make_func (chain, do_fused, fused,
+      (GDestroyNotify) audio_chain_fused_free);
+
+  return chain;
+}
+
+/* collapse each run of adjacent per-frame stages into a single element.
+ * The resampler changes the number of frames and stays a separate pass. */
+static void
+chain_fuse (GstAudioConverter * convert)
+{
+  AudioChain *chain, *next = NULL;
+
+  /* all stages work on interleaved samples */
+  if (convert->current_layout != GST_AUDIO_LAYOUT_INTERLEAVED)
+    return;
+
+  chain = convert->chain_end;
+  while (chain) {
+    AudioChain *first = NULL, *last = chain, *fused;
+    gboolean pack;
+    gint n_chains = 0;
+
+    if (chain->stage_func == NULL) {
+      next = chain;
+      chain = chain->prev;
+      continue;
+    }
+    while (chain && chain->stage_func && n_chains < MAX_FUSED_STAGES - 1) {
+      first = chain;
+      chain = chain->prev;
+      n_chains++;
+    }
+    /* the last run can also pack into the output */
+    pack = next == NULL && !convert->out_default;
+
+    if (n_chains + pack < 2) {
+      next = first;
+      continue;
+    }
+    fused = chain_fused_new (convert, first, last, n_chains, pack);
+    if (next) {
+      next->prev = fused;
+    } else {
+      convert->chain_end = fused;
+      /* the chain now produces samples in the output format */
+      if (pack)
+        convert->out_default = TRUE;
+    }
+    next = fused;
+  }
+}
+
 static void
 setup_allocators (GstAudioConverter * convert)
 {
@@ -1165,6 +1496,9 @@ gst_audio_converter_new (GstAudioConverterFlags flags, GstAudioInfo * in_info,
     }
   }
 
+  if (convert->convert == converter_generic && GET_OPT_FUSE_STAGES (convert))
+    chain_fuse (convert);
+
   setup_allocators (convert);
 
   return convert;
@@ -64,6 +64,19 @@ typedef struct _GstAudioConverter GstAudioConverter;
  */
 #define GST_AUDIO_CONVERTER_OPT_QUANTIZATION   "GstAudioConverter.quantization"
 
+/**
+ * GST_AUDIO_CONVERTER_OPT_FUSE_STAGES:
+ *
+ * #G_TYPE_BOOLEAN, Run adjacent conversion steps in a single pass over
+ * small slices of the samples instead of one pass over all samples per
+ * step. The output is the same either way. Only used when the converter
+ * is created.
+ * Default is %TRUE
+ *
+ * Since: 1.14
+ */
+#define GST_AUDIO_CONVERTER_OPT_FUSE_STAGES   "GstAudioConverter.fuse-stages"
+
 
 /**
  * GstAudioConverterFlags:
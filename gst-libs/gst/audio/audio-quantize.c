@@ -49,6 +49,10 @@ struct _GstAudioQuantize
   guint shift;
   guint32 mask, bias;
 
+  /* independent random number generators, one for each dither value,
+   * they are all stepped at once with audio_orc_update_rand() */
+  guint random_size;
+  guint32 *random_buf;
   /* last random number generated per channel for hifreq TPDF dither */
   gpointer last_random;
   /* contains the past quantization errors, error[channels][count] */
@@ -60,17 +64,16 @@ struct _GstAudioQuantize
   /* noise shaping coefficients */
   gpointer coeffs;
   gint n_coeffs;
+  /* the combined error for each channel of a frame */
+  gint32 *ns_error;
 
   QuantizeFunc quantize;
 };
 
+/* saturating add, done without branches so that the loops over the
+ * channels can be vectorized */
 #define ADDSS(res,val) \
-        if (val > 0 && res > 0 && G_MAXINT32 - res <= val){             \
-          res = G_MAXINT32;                                             \
-        } else if (val < 0 && res < 0 && G_MININT32 - res >= val){      \
-          res = G_MININT32;                                             \
-        } else                                                          \
-          res += val;
+        res = CLAMP ((gint64) (res) + (val), G_MININT32, G_MAXINT32);
 
 static void
 gst_audio_quantize_quantize_memcpy (GstAudioQuantize * quant,
@@ -89,27 +92,43 @@ gst_audio_quantize_quantize_int_none_none (GstAudioQuantize * quant,
       samples * quant->stride);
 }
 
-/* This is the base function, implementing a linear congruential generator
- * and returning a pseudo random number between 0 and 2^32 - 1.
- */
+/* This is the linear congruential generator that audio_orc_update_rand()
+ * implements. Here it only spreads the seeds of the generators. */
 static inline guint32
-gst_fast_random_uint32 (void)
+gst_fast_random_uint32 (guint32 * state)
 {
-  static guint32 state = 0xdeadbeef;
-  return (state = state * 1103515245 + 12345);
+  return (*state = *state * 1103515245 + 12345);
 }
 
-static inline gint32
-gst_fast_random_int32 (void)
+static void
+setup_random_buf (GstAudioQuantize * quant, gint len)
 {
-  return (gint32) gst_fast_random_uint32 ();
+  guint32 seed;
+  gint i;
+
+  if (quant->random_size >= len)
+    return;
+
+  quant->random_buf = g_realloc (quant->random_buf, len * sizeof (guint32));
+  /* all generators run through the same sequence, give them seeds that are
+   * far apart so that neighbouring values are not correlated */
+  for (i = quant->random_size; i < len; i++) {
+    seed = (i + 1) * 0x9e3779b9;
+    seed ^= seed >> 16;
+    seed *= 0x7feb352d;
+    seed ^= seed >> 15;
+    quant->random_buf[i] = gst_fast_random_uint32 (&seed);
+  }
+  quant->random_size = len;
 }
 
-/* Assuming dither == 2^n,
+/* Assuming dither == 2^n and rshift == 31 - n,
  * returns one of 2^(n+1) possible random values:
- * -dither <= retval < dither */
-#define RANDOM_INT_DITHER(dither)                                       \
-  (- dither + (gst_fast_random_int32 () & ((dither << 1) - 1)))
+ * -dither <= retval < dither
+ * The top bits of the generator are used, the low bits of a linear
+ * congruential generator have very short periods. */
+#define RANDOM_INT_DITHER(r,rshift,dither)                              \
+  ((gint32) ((r) >> (rshift)) - (dither))
 
 static void
 setup_dither_buf (GstAudioQuantize * quant, gint samples)
@@ -117,8 +136,8 @@ setup_dither_buf (GstAudioQuantize * quant, gint samples)
   gboolean need_init = FALSE;
   gint stride = quant->stride;
   gint i, len = samples * stride;
-  guint shift = quant->shift;
-  guint32 bias;
+  guint shift = quant->shift, rshift;
+  guint32 bias, *r;
   gint32 dither, *d;
 
   if (quant->dither_size < len) {
@@ -130,6 +149,12 @@ setup_dither_buf (GstAudioQuantize * quant, gint samples)
   bias = quant->bias;
   d = quant->dither_buf;
 
+  if (quant->dither != GST_AUDIO_DITHER_NONE) {
+    setup_random_buf (quant, len);
+    audio_orc_update_rand (quant->random_buf, len);
+  }
+  r = quant->random_buf;
+
   switch (quant->dither) {
     case GST_AUDIO_DITHER_NONE:
       if (need_init) {
@@ -140,26 +165,38 @@ setup_dither_buf (GstAudioQuantize * quant, gint samples)
 
     case GST_AUDIO_DITHER_RPDF:
       dither = 1 << (shift);
+      rshift = 31 - shift;
       for (i = 0; i < len; i++)
-        d[i] = bias + RANDOM_INT_DITHER (dither);
+        d[i] = bias + RANDOM_INT_DITHER (r[i], rshift, dither);
       break;
 
     case GST_AUDIO_DITHER_TPDF:
       dither = 1 << (shift - 1);
+      rshift = 32 - shift;
+      for (i = 0; i < len; i++)
+        d[i] = bias + RANDOM_INT_DITHER (r[i], rshift, dither);
+      audio_orc_update_rand (r, len);
       for (i = 0; i < len; i++)
-        d[i] = bias + RANDOM_INT_DITHER (dither) + RANDOM_INT_DITHER (dither);
+        d[i] += RANDOM_INT_DITHER (r[i], rshift, dither);
       break;
 
     case GST_AUDIO_DITHER_TPDF_HF:
     {
-      gint32 tmp, *last_random = quant->last_random;
+      gint32 *last_random = quant->last_random;
 
+      /* the previous random number of a channel is the one a frame
+       * earlier, except for the first frame */
       dither = 1 << (shift - 1);
-      for (i = 0; i < len; i++) {
-        tmp = RANDOM_INT_DITHER (dither);
-        d[i] = bias + tmp - last_random[i % stride];
-        last_random[i % stride] = tmp;
-      }
+      rshift = 32 - shift;
+      for (i = 0; i < MIN (stride, len); i++)
+        d[i] = bias + RANDOM_INT_DITHER (r[i], rshift, dither) -
+            last_random[i];
+      for (; i < len; i++)
+        d[i] = bias + RANDOM_INT_DITHER (r[i], rshift, dither) -
+            RANDOM_INT_DITHER (r[i - stride], rshift, dither);
+      for (i = 0; i < MIN (stride, len); i++)
+        last_random[i] =
+            RANDOM_INT_DITHER (r[len - stride + i], rshift, dither);
       break;
     }
   }
@@ -194,7 +231,7 @@ gst_audio_quantize_quantize_int_dither_feedback (GstAudioQuantize * quant,
     const gpointer src, gpointer dst, gint samples)
 {
   guint32 mask;
-  gint i, len, stride;
+  gint i, c, stride;
   const gint32 *s = src;
   gint32 *dith, *d = dst, v, o, *e, err;
 
@@ -202,25 +239,32 @@ gst_audio_quantize_quantize_int_dither_feedback (GstAudioQuantize * quant,
   setup_error_buf (quant, samples, 1);
 
   stride = quant->stride;
-  len = samples * stride;
   dith = quant->dither_buf;
   e = quant->error_buf;
   mask = ~quant->mask;
 
-  for (i = 0; i < len; i++) {
-    o = v = s[i];
-    /* add dither */
-    err = dith[i];
-    /* remove error */
-    err -= e[i];
-    ADDSS (v, err);
-    v &= mask;
-    /* store new error */
-    e[i + stride] = e[i] + (v - o);
-    /* store result */
-    d[i] = v;
+  /* the error of a channel depends on the previous frame only, process a
+   * frame at a time so that the loop over the channels can be vectorized */
+  for (i = 0; i < samples; i++) {
+    for (c = 0; c < stride; c++) {
+      o = v = s[c];
+      /* add dither */
+      err = dith[c];
+      /* remove error */
+      err -= e[c];
+      ADDSS (v, err);
+      v &= mask;
+      /* store new error */
+      e[c + stride] = e[c] + (v - o);
+      /* store result */
+      d[c] = v;
+    }
+    s += stride;
+    d += stride;
+    dith += stride;
+    e += stride;
   }
-  memmove (e, &e[len], sizeof (gint32) * stride);
+  memmove (quant->error_buf, e, sizeof (gint32) * stride);
 }
 
 #define SHIFT 10
@@ -234,9 +278,9 @@ gst_audio_quantize_quantize_int_dither_noise_shape (GstAudioQuantize * quant,
     const gpointer src, gpointer dst, gint samples)
 {
   guint32 mask;
-  gint i, j, k, len, stride, nc;
+  gint i, j, c, stride, nc;
   const gint32 *s = src;
-  gint32 *c, *dith, *d = dst, v, o, *e, err;
+  gint32 *coeffs, *dith, *d = dst, v, o, *e, *err, *f;
 
   nc = quant->n_coeffs;
 
@@ -244,32 +288,44 @@ gst_audio_quantize_quantize_int_dither_noise_shape (GstAudioQuantize * quant,
   setup_error_buf (quant, samples, nc);
 
   stride = quant->stride;
-  len = samples * stride;
   dith = quant->dither_buf;
   e = quant->error_buf;
-  c = quant->coeffs;
+  coeffs = quant->coeffs;
+  err = quant->ns_error;
   mask = ~quant->mask;
 
-  for (i = 0; i < len; i++) {
-    v = s[i];
-    /* combine and remove error */
-    err = 0;
-    for (j = 0, k = i; j < nc; j++, k += stride)
-      err -= e[k] * c[j];
-    err = (err + SROUND) >> (SREDUCE);
-    ADDSS (v, err);
-    o = v;
-    /* add dither */
-    err = dith[i];
-    ADDSS (v, err);
-    /* quantize */
-    v &= mask;
-    /* store new error with reduced precision */
-    e[k] = (v - o + RROUND) >> REDUCE;
-    /* store result */
-    d[i] = v;
+  /* the errors of a channel depend on its previous frames only, process a
+   * frame at a time with the channels in the inner loops so that those
+   * can be vectorized */
+  for (i = 0; i < samples; i++) {
+    /* combine the errors */
+    for (c = 0; c < stride; c++)
+      err[c] = 0;
+    for (j = 0, f = e; j < nc; j++, f += stride) {
+      for (c = 0; c < stride; c++)
+        err[c] -= f[c] * coeffs[j];
+    }
+    for (c = 0; c < stride; c++) {
+      v = s[c];
+      /* remove error */
+      err[c] = (err[c] + SROUND) >> (SREDUCE);
+      ADDSS (v, err[c]);
+      o = v;
+      /* add dither */
+      ADDSS (v, dith[c]);
+      /* quantize */
+      v &= mask;
+      /* store new error with reduced precision */
+      f[c] = (v - o + RROUND) >> REDUCE;
+      /* store result */
+      d[c] = v;
+    }
+    s += stride;
+    d += stride;
+    dith += stride;
+    e += stride;
   }
-  memmove (e, &e[len], sizeof (gint32) * stride * nc);
+  memmove (quant->error_buf, e, sizeof (gint32) * stride * nc);
 }
 
 #define MAKE_QUANTIZE_FUNC_NAME(name)                                   \
@@ -359,6 +415,7 @@ gst_audio_quantize_setup_noise_shaping (GstAudioQuantize * quant)
     q = quant->coeffs = g_new0 (gint32, n_coeffs);
     for (i = 0; i < n_coeffs; i++)
       q[i] = floor (coeffs[i] * (1 << SHIFT) + 0.5);
+    quant->ns_error = g_new0 (gint32, quant->stride);
   }
   return;
 }
@@ -477,7 +534,9 @@ gst_audio_quantize_free (GstAudioQuantize * quant)
 
   g_free (quant->error_buf);
   g_free (quant->coeffs);
+  g_free (quant->ns_error);
   g_free (quant->last_random);
+  g_free (quant->random_buf);
   g_free (quant->dither_buf);
 
   g_slice_free (GstAudioQuantize, quant);
@@ -496,6 +555,11 @@ gst_audio_quantize_reset (GstAudioQuantize * quant)
   g_free (quant->error_buf);
   quant->error_buf = NULL;
   quant->error_size = 0;
+  g_free (quant->random_buf);
+  quant->random_buf = NULL;
+  quant->random_size = 0;
+  if (quant->last_random)
+    memset (quant->last_random, 0, quant->stride * sizeof (gint32));
 }
 
 /**
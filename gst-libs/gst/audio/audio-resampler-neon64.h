@@ -0,0 +1,544 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* aarch64 versions of the inner products and tap interpolation. aarch64
+ * always has NEON so these are used without a runtime check. The integer
+ * versions accumulate at full width and round exactly like the C versions,
+ * only the order of the float additions differs. */
+
+#include <arm_neon.h>
+
+static inline void
+inner_product_gint16_full_1_neon64 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  gint32 res;
+  int32x4_t sum[2];
+  int16x8_t ta, tb;
+
+  sum[0] = sum[1] = vdupq_n_s32 (0);
+
+  for (i = 0; i < len; i += 8) {
+    ta = vld1q_s16 (a + i);
+    tb = vld1q_s16 (b + i);
+    sum[0] = vmlal_s16 (sum[0], vget_low_s16 (ta), vget_low_s16 (tb));
+    sum[1] = vmlal_high_s16 (sum[1], ta, tb);
+  }
+  res = vaddvq_s32 (vaddq_s32 (sum[0], sum[1]));
+
+  res = (res + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  *o = CLAMP (res, G_MININT16, G_MAXINT16);
+}
+
+static inline void
+inner_product_gint16_linear_1_neon64 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  gint32 res[2];
+  int32x4_t sum[2];
+  int16x8_t ta, tb;
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = vdupq_n_s32 (0);
+
+  for (i = 0; i < len; i += 8) {
+    ta = vld1q_s16 (a + i);
+    tb = vld1q_s16 (c[0] + i);
+    sum[0] = vmlal_s16 (sum[0], vget_low_s16 (ta), vget_low_s16 (tb));
+    sum[0] = vmlal_high_s16 (sum[0], ta, tb);
+    tb = vld1q_s16 (c[1] + i);
+    sum[1] = vmlal_s16 (sum[1], vget_low_s16 (ta), vget_low_s16 (tb));
+    sum[1] = vmlal_high_s16 (sum[1], ta, tb);
+  }
+  res[0] = vaddvq_s32 (sum[0]) >> PRECISION_S16;
+  res[1] = vaddvq_s32 (sum[1]) >> PRECISION_S16;
+  res[0] = ((gint32) (gint16) res[0] - (gint32) (gint16) res[1]) * icoeff[0] +
+      ((gint32) (gint16) res[1] << PRECISION_S16);
+
+  res[0] = (res[0] + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  *o = CLAMP (res[0], G_MININT16, G_MAXINT16);
+}
+
+static inline void
+inner_product_gint16_cubic_1_neon64 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i, j;
+  gint32 res;
+  int32x4_t sum[4];
+  int16x8_t ta, tb;
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride),
+    (gint16 *) ((gint8 *) b + 2 * bstride),
+    (gint16 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = vdupq_n_s32 (0);
+
+  for (i = 0; i < len; i += 8) {
+    ta = vld1q_s16 (a + i);
+    for (j = 0; j < 4; j++) {
+      tb = vld1q_s16 (c[j] + i);
+      sum[j] = vmlal_s16 (sum[j], vget_low_s16 (ta), vget_low_s16 (tb));
+      sum[j] = vmlal_high_s16 (sum[j], ta, tb);
+    }
+  }
+  res = 0;
+  for (j = 0; j < 4; j++)
+    res += (gint32) (gint16) (vaddvq_s32 (sum[j]) >> PRECISION_S16) *
+        (gint32) icoeff[j];
+
+  res = (res + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  *o = CLAMP (res, G_MININT16, G_MAXINT16);
+}
+
+static inline int64x2_t
+madd_gint32_neon64 (int64x2_t sum, int32x4_t ta, int32x4_t tb)
+{
+  sum = vmlal_s32 (sum, vget_low_s32 (ta), vget_low_s32 (tb));
+  return vmlal_high_s32 (sum, ta, tb);
+}
+
+static inline void
+inner_product_gint32_full_1_neon64 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res;
+  int64x2_t sum = vdupq_n_s64 (0);
+
+  for (i = 0; i < len; i += 4)
+    sum = madd_gint32_neon64 (sum, vld1q_s32 (a + i), vld1q_s32 (b + i));
+  res = vaddvq_s64 (sum);
+
+  res = (res + ((gint64) 1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_linear_1_neon64 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res[2];
+  int64x2_t sum[2];
+  int32x4_t ta;
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = vdupq_n_s64 (0);
+
+  for (i = 0; i < len; i += 4) {
+    ta = vld1q_s32 (a + i);
+    sum[0] = madd_gint32_neon64 (sum[0], ta, vld1q_s32 (c[0] + i));
+    sum[1] = madd_gint32_neon64 (sum[1], ta, vld1q_s32 (c[1] + i));
+  }
+  res[0] = vaddvq_s64 (sum[0]) >> PRECISION_S32;
+  res[1] = vaddvq_s64 (sum[1]) >> PRECISION_S32;
+  res[0] = ((gint64) (gint32) res[0] - (gint64) (gint32) res[1]) * icoeff[0] +
+      ((gint64) (gint32) res[1] << PRECISION_S32);
+
+  res[0] = (res[0] + ((gint64) 1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res[0], G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_cubic_1_neon64 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i, j;
+  gint64 res;
+  int64x2_t sum[4];
+  int32x4_t ta;
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride),
+    (gint32 *) ((gint8 *) b + 2 * bstride),
+    (gint32 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = vdupq_n_s64 (0);
+
+  for (i = 0; i < len; i += 4) {
+    ta = vld1q_s32 (a + i);
+    for (j = 0; j < 4; j++)
+      sum[j] = madd_gint32_neon64 (sum[j], ta, vld1q_s32 (c[j] + i));
+  }
+  res = 0;
+  for (j = 0; j < 4; j++)
+    res += (gint64) (gint32) (vaddvq_s64 (sum[j]) >> PRECISION_S32) *
+        (gint64) icoeff[j];
+
+  res = (res + ((gint64) 1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gfloat_full_1_neon64 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  float32x4_t sum[2];
+
+  sum[0] = sum[1] = vdupq_n_f32 (0.0);
+
+  for (i = 0; i < len; i += 8) {
+    sum[0] = vfmaq_f32 (sum[0], vld1q_f32 (a + i + 0), vld1q_f32 (b + i + 0));
+    sum[1] = vfmaq_f32 (sum[1], vld1q_f32 (a + i + 4), vld1q_f32 (b + i + 4));
+  }
+  *o = vaddvq_f32 (vaddq_f32 (sum[0], sum[1]));
+}
+
+static inline void
+inner_product_gfloat_linear_1_neon64 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  gfloat res[2];
+  float32x4_t sum[2], t;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = vdupq_n_f32 (0.0);
+
+  for (i = 0; i < len; i += 4) {
+    t = vld1q_f32 (a + i);
+    sum[0] = vfmaq_f32 (sum[0], t, vld1q_f32 (c[0] + i));
+    sum[1] = vfmaq_f32 (sum[1], t, vld1q_f32 (c[1] + i));
+  }
+  res[0] = vaddvq_f32 (sum[0]);
+  res[1] = vaddvq_f32 (sum[1]);
+  *o = (res[0] - res[1]) * icoeff[0] + res[1];
+}
+
+static inline void
+inner_product_gfloat_cubic_1_neon64 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  float32x4_t sum[4], t, f = vld1q_f32 (icoeff);
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride),
+    (gfloat *) ((gint8 *) b + 2 * bstride),
+    (gfloat *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = vdupq_n_f32 (0.0);
+
+  for (i = 0; i < len; i += 4) {
+    t = vld1q_f32 (a + i);
+    sum[0] = vfmaq_f32 (sum[0], t, vld1q_f32 (c[0] + i));
+    sum[1] = vfmaq_f32 (sum[1], t, vld1q_f32 (c[1] + i));
+    sum[2] = vfmaq_f32 (sum[2], t, vld1q_f32 (c[2] + i));
+    sum[3] = vfmaq_f32 (sum[3], t, vld1q_f32 (c[3] + i));
+  }
+  t = vmulq_laneq_f32 (sum[0], f, 0);
+  t = vfmaq_laneq_f32 (t, sum[1], f, 1);
+  t = vfmaq_laneq_f32 (t, sum[2], f, 2);
+  t = vfmaq_laneq_f32 (t, sum[3], f, 3);
+  *o = vaddvq_f32 (t);
+}
+
+static inline void
+inner_product_gdouble_full_1_neon64 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  float64x2_t sum[2];
+
+  sum[0] = sum[1] = vdupq_n_f64 (0.0);
+
+  for (i = 0; i < len; i += 4) {
+    sum[0] = vfmaq_f64 (sum[0], vld1q_f64 (a + i + 0), vld1q_f64 (b + i + 0));
+    sum[1] = vfmaq_f64 (sum[1], vld1q_f64 (a + i + 2), vld1q_f64 (b + i + 2));
+  }
+  *o = vaddvq_f64 (vaddq_f64 (sum[0], sum[1]));
+}
+
+static inline void
+inner_product_gdouble_linear_1_neon64 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  gdouble res[2];
+  float64x2_t sum[2], t;
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = vdupq_n_f64 (0.0);
+
+  for (i = 0; i < len; i += 2) {
+    t = vld1q_f64 (a + i);
+    sum[0] = vfmaq_f64 (sum[0], t, vld1q_f64 (c[0] + i));
+    sum[1] = vfmaq_f64 (sum[1], t, vld1q_f64 (c[1] + i));
+  }
+  res[0] = vaddvq_f64 (sum[0]);
+  res[1] = vaddvq_f64 (sum[1]);
+  *o = (res[0] - res[1]) * icoeff[0] + res[1];
+}
+
+static inline void
+inner_product_gdouble_cubic_1_neon64 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  float64x2_t sum[4], t;
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride),
+    (gdouble *) ((gint8 *) b + 2 * bstride),
+    (gdouble *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = vdupq_n_f64 (0.0);
+
+  for (i = 0; i < len; i += 2) {
+    t = vld1q_f64 (a + i);
+    sum[0] = vfmaq_f64 (sum[0], t, vld1q_f64 (c[0] + i));
+    sum[1] = vfmaq_f64 (sum[1], t, vld1q_f64 (c[1] + i));
+    sum[2] = vfmaq_f64 (sum[2], t, vld1q_f64 (c[2] + i));
+    sum[3] = vfmaq_f64 (sum[3], t, vld1q_f64 (c[3] + i));
+  }
+  t = vmulq_n_f64 (sum[0], icoeff[0]);
+  t = vfmaq_n_f64 (t, sum[1], icoeff[1]);
+  t = vfmaq_n_f64 (t, sum[2], icoeff[2]);
+  t = vfmaq_n_f64 (t, sum[3], icoeff[3]);
+  *o = vaddvq_f64 (t);
+}
+
+static void
+interpolate_gint16_linear_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint16 *o = op, *a = ap, *ic = icp;
+  int16x4_t t0, t1;
+  int32x4_t tmp;
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride)
+  };
+
+  for (i = 0; i < len; i += 4) {
+    t0 = vld1_s16 (c[0] + i);
+    t1 = vld1_s16 (c[1] + i);
+    tmp = vmulq_n_s32 (vsubl_s16 (t0, t1), ic[0]);
+    tmp = vaddq_s32 (tmp, vshll_n_s16 (t1, PRECISION_S16));
+    vst1_s16 (o + i, vrshrn_n_s32 (tmp, PRECISION_S16));
+  }
+}
+
+static void
+interpolate_gint16_cubic_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint16 *o = op, *a = ap, *ic = icp;
+  int32x4_t tmp;
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride),
+    (gint16 *) ((gint8 *) a + 2 * astride),
+    (gint16 *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 4) {
+    tmp = vmull_n_s16 (vld1_s16 (c[0] + i), ic[0]);
+    tmp = vmlal_n_s16 (tmp, vld1_s16 (c[1] + i), ic[1]);
+    tmp = vmlal_n_s16 (tmp, vld1_s16 (c[2] + i), ic[2]);
+    tmp = vmlal_n_s16 (tmp, vld1_s16 (c[3] + i), ic[3]);
+    vst1_s16 (o + i, vqrshrn_n_s32 (tmp, PRECISION_S16));
+  }
+}
+
+static void
+interpolate_gint32_linear_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint32 *o = op, *a = ap, *ic = icp;
+  int32x2_t t0, t1;
+  int64x2_t tmp;
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) a + 0 * astride),
+    (gint32 *) ((gint8 *) a + 1 * astride)
+  };
+
+  /* (c0 - c1) * ic0 + (c1 << 31), without a 64 bit multiply */
+  for (i = 0; i < len; i += 2) {
+    t0 = vld1_s32 (c[0] + i);
+    t1 = vld1_s32 (c[1] + i);
+    tmp = vmull_n_s32 (t0, ic[0]);
+    tmp = vmlsl_n_s32 (tmp, t1, ic[0]);
+    tmp = vaddq_s64 (tmp, vshll_n_s32 (t1, PRECISION_S32));
+    vst1_s32 (o + i, vrshrn_n_s64 (tmp, PRECISION_S32));
+  }
+}
+
+static void
+interpolate_gint32_cubic_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint32 *o = op, *a = ap, *ic = icp;
+  int64x2_t tmp;
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) a + 0 * astride),
+    (gint32 *) ((gint8 *) a + 1 * astride),
+    (gint32 *) ((gint8 *) a + 2 * astride),
+    (gint32 *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 2) {
+    tmp = vmull_n_s32 (vld1_s32 (c[0] + i), ic[0]);
+    tmp = vmlal_n_s32 (tmp, vld1_s32 (c[1] + i), ic[1]);
+    tmp = vmlal_n_s32 (tmp, vld1_s32 (c[2] + i), ic[2]);
+    tmp = vmlal_n_s32 (tmp, vld1_s32 (c[3] + i), ic[3]);
+    vst1_s32 (o + i, vqrshrn_n_s64 (tmp, PRECISION_S32));
+  }
+}
+
+static void
+interpolate_gfloat_linear_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  float32x4_t t0, t1;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride)
+  };
+
+  for (i = 0; i < len; i += 4) {
+    t0 = vld1q_f32 (c[0] + i);
+    t1 = vld1q_f32 (c[1] + i);
+    vst1q_f32 (o + i, vfmaq_n_f32 (t1, vsubq_f32 (t0, t1), ic[0]));
+  }
+}
+
+static void
+interpolate_gfloat_cubic_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  float32x4_t t;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride),
+    (gfloat *) ((gint8 *) a + 2 * astride),
+    (gfloat *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 4) {
+    t = vmulq_n_f32 (vld1q_f32 (c[0] + i), ic[0]);
+    t = vfmaq_n_f32 (t, vld1q_f32 (c[1] + i), ic[1]);
+    t = vfmaq_n_f32 (t, vld1q_f32 (c[2] + i), ic[2]);
+    t = vfmaq_n_f32 (t, vld1q_f32 (c[3] + i), ic[3]);
+    vst1q_f32 (o + i, t);
+  }
+}
+
+static void
+interpolate_gdouble_linear_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  float64x2_t t0, t1;
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride)
+  };
+
+  for (i = 0; i < len; i += 2) {
+    t0 = vld1q_f64 (c[0] + i);
+    t1 = vld1q_f64 (c[1] + i);
+    vst1q_f64 (o + i, vfmaq_n_f64 (t1, vsubq_f64 (t0, t1), ic[0]));
+  }
+}
+
+static void
+interpolate_gdouble_cubic_neon64 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  float64x2_t t;
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride),
+    (gdouble *) ((gint8 *) a + 2 * astride),
+    (gdouble *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 2) {
+    t = vmulq_n_f64 (vld1q_f64 (c[0] + i), ic[0]);
+    t = vfmaq_n_f64 (t, vld1q_f64 (c[1] + i), ic[1]);
+    t = vfmaq_n_f64 (t, vld1q_f64 (c[2] + i), ic[2]);
+    t = vfmaq_n_f64 (t, vld1q_f64 (c[3] + i), ic[3]);
+    vst1q_f64 (o + i, t);
+  }
+}
+
+MAKE_RESAMPLE_FUNC_STATIC (gint16, full, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gint16, linear, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gint16, cubic, 1, neon64);
+
+MAKE_RESAMPLE_FUNC_STATIC (gint32, full, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gint32, linear, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gint32, cubic, 1, neon64);
+
+MAKE_RESAMPLE_FUNC_STATIC (gfloat, full, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gfloat, linear, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gfloat, cubic, 1, neon64);
+
+MAKE_RESAMPLE_FUNC_STATIC (gdouble, full, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gdouble, linear, 1, neon64);
+MAKE_RESAMPLE_FUNC_STATIC (gdouble, cubic, 1, neon64);
+
+static void
+audio_resampler_check_neon64 (void)
+{
+  GST_DEBUG ("enable aarch64 NEON optimisations");
+  resample_gint16_full_1 = resample_gint16_full_1_neon64;
+  resample_gint16_linear_1 = resample_gint16_linear_1_neon64;
+  resample_gint16_cubic_1 = resample_gint16_cubic_1_neon64;
+
+  interpolate_gint16_linear = interpolate_gint16_linear_neon64;
+  interpolate_gint16_cubic = interpolate_gint16_cubic_neon64;
+
+  resample_gint32_full_1 = resample_gint32_full_1_neon64;
+  resample_gint32_linear_1 = resample_gint32_linear_1_neon64;
+  resample_gint32_cubic_1 = resample_gint32_cubic_1_neon64;
+
+  interpolate_gint32_linear = interpolate_gint32_linear_neon64;
+  interpolate_gint32_cubic = interpolate_gint32_cubic_neon64;
+
+  resample_gfloat_full_1 = resample_gfloat_full_1_neon64;
+  resample_gfloat_linear_1 = resample_gfloat_linear_1_neon64;
+  resample_gfloat_cubic_1 = resample_gfloat_cubic_1_neon64;
+
+  interpolate_gfloat_linear = interpolate_gfloat_linear_neon64;
+  interpolate_gfloat_cubic = interpolate_gfloat_cubic_neon64;
+
+  resample_gdouble_full_1 = resample_gdouble_full_1_neon64;
+  resample_gdouble_linear_1 = resample_gdouble_linear_1_neon64;
+  resample_gdouble_cubic_1 = resample_gdouble_cubic_1_neon64;
+
+  interpolate_gdouble_linear = interpolate_gdouble_linear_neon64;
+  interpolate_gdouble_cubic = interpolate_gdouble_cubic_neon64;
+}
@@ -49,6 +49,42 @@ typedef void (*ResampleFunc) (GstAudioResampler * resampler, gpointer in[],
 typedef void (*DeinterleaveFunc) (GstAudioResampler * resampler,
     gpointer * sbuf, gpointer in[], gsize in_frames);
 
+/* A table of filter taps, @rows rows of @stride bytes. The oversampled
+ * table used for interpolation has @full set to %FALSE, the full table has
+ * one row per phase and a pointer per row in @phases that is set when the
+ * row was calculated.
+ *
+ * Tables are refcounted and, unless they are private to one resampler, are
+ * shared between all resamplers that use the same filter parameters. Shared
+ * tables are completely calculated before they are handed out and are never
+ * modified afterwards. */
+typedef struct
+{
+  /* the parameters the taps are calculated from */
+  gboolean full;
+  gint format_index;
+  GstAudioResamplerMethod method;
+  GstAudioResamplerFilterInterpolation filter_interpolation;
+  gint n_taps;
+  gint oversample;
+  gint rows;
+  gdouble cutoff;
+  gdouble kaiser_beta;
+  gdouble b, c;
+
+  gint ref_count;
+  gboolean shared;
+
+  gsize stride;
+  gpointer taps;
+  gpointer *phases;
+  gpointer mem;
+  gboolean filled;
+} AudioResamplerTable;
+
+/* a block of channels that is resampled by one thread */
+typedef struct _AudioResamplerJob AudioResamplerJob;
+
 struct _GstAudioResampler
 {
   GstAudioResamplerMethod method;
@@ -78,17 +114,15 @@ struct _GstAudioResampler
   /* oversampled main filter table */
   gint oversample;
   gint n_taps;
+  AudioResamplerTable *taps_table;
   gpointer taps;
-  gpointer taps_mem;
   gsize taps_stride;
   gint n_phases;
-  gint alloc_taps;
-  gint alloc_phases;
 
   /* cached taps */
+  AudioResamplerTable *cached_table;
   gpointer *cached_phases;
   gpointer cached_taps;
-  gpointer cached_taps_mem;
   gsize cached_taps_stride;
 
   ConvertTapsFunc convert_taps;
@@ -108,6 +142,13 @@ struct _GstAudioResampler
   gsize samples_len;
   gsize samples_avail;
   gpointer *sbuf;
+
+  /* for resampling blocks of channels in parallel */
+  guint n_jobs;
+  AudioResamplerJob *jobs;
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
 };
 
 #endif /* __GST_AUDIO_RESAMPLER_PRIVATE_H__ */
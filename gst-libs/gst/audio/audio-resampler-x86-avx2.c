@@ -0,0 +1,652 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "audio-resampler-x86-avx2.h"
+
+#if defined (HAVE_IMMINTRIN_H) && defined (__AVX2__) && defined (__FMA__)
+
+#include <immintrin.h>
+
+/* The taps are only 16 byte aligned and the input samples not at all, so
+ * everything is loaded unaligned. Like the SSE versions, the loops can
+ * run past @len into the zero padded end of the taps. */
+
+/* two 16 bit coefficients as they are laid out in memory */
+#define PAIR_EPI16(lo,hi) ((gint32) (((guint32) (guint16) (hi) << 16) | (guint16) (lo)))
+
+static inline __m128
+hadd_256_ps (__m256 v)
+{
+  return _mm_add_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+}
+
+static inline __m128d
+hadd_256_pd (__m256d v)
+{
+  return _mm_add_pd (_mm256_castpd256_pd128 (v), _mm256_extractf128_pd (v, 1));
+}
+
+static inline __m128i
+hadd_256_epi32 (__m256i v)
+{
+  return _mm_add_epi32 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+}
+
+static inline __m128i
+hadd_256_epi64 (__m256i v)
+{
+  return _mm_add_epi64 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+}
+
+static inline void
+inner_product_gint16_full_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum = _mm256_setzero_si256 ();
+  __m128i res;
+
+  for (i = 0; i < len; i += 16) {
+    sum = _mm256_add_epi32 (sum,
+        _mm256_madd_epi16 (_mm256_loadu_si256 ((__m256i *) (a + i)),
+            _mm256_loadu_si256 ((__m256i *) (b + i))));
+  }
+  res = hadd_256_epi32 (sum);
+  res = _mm_add_epi32 (res, _mm_shuffle_epi32 (res, _MM_SHUFFLE (2, 3, 2, 3)));
+  res = _mm_add_epi32 (res, _mm_shuffle_epi32 (res, _MM_SHUFFLE (1, 1, 1, 1)));
+
+  res = _mm_add_epi32 (res, _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  res = _mm_srai_epi32 (res, PRECISION_S16);
+  res = _mm_packs_epi32 (res, res);
+  *o = _mm_extract_epi16 (res, 0);
+}
+
+static inline void
+inner_product_gint16_linear_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum[2], t;
+  __m128i res[2];
+  __m128i f = _mm_set_epi32 (0, 0, PAIR_EPI16 (icoeff[2], icoeff[3]),
+      PAIR_EPI16 (icoeff[0], icoeff[1]));
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_si256 ();
+  f = _mm_unpacklo_epi16 (f, _mm_setzero_si128 ());
+
+  for (i = 0; i < len; i += 16) {
+    t = _mm256_loadu_si256 ((__m256i *) (a + i));
+    sum[0] = _mm256_add_epi32 (sum[0], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[0] + i))));
+    sum[1] = _mm256_add_epi32 (sum[1], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[1] + i))));
+  }
+  res[0] = _mm_srai_epi32 (hadd_256_epi32 (sum[0]), PRECISION_S16);
+  res[1] = _mm_srai_epi32 (hadd_256_epi32 (sum[1]), PRECISION_S16);
+
+  res[0] =
+      _mm_madd_epi16 (res[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  res[1] =
+      _mm_madd_epi16 (res[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  res[0] = _mm_add_epi32 (res[0], res[1]);
+
+  res[0] = _mm_add_epi32 (res[0], _mm_shuffle_epi32 (res[0],
+          _MM_SHUFFLE (2, 3, 2, 3)));
+  res[0] = _mm_add_epi32 (res[0], _mm_shuffle_epi32 (res[0],
+          _MM_SHUFFLE (1, 1, 1, 1)));
+
+  res[0] = _mm_add_epi32 (res[0], _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  res[0] = _mm_srai_epi32 (res[0], PRECISION_S16);
+  res[0] = _mm_packs_epi32 (res[0], res[0]);
+  *o = _mm_extract_epi16 (res[0], 0);
+}
+
+static inline void
+inner_product_gint16_cubic_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum[4], t;
+  __m128i res[4], r[4];
+  __m128i f = _mm_set_epi32 (0, 0, PAIR_EPI16 (icoeff[2], icoeff[3]),
+      PAIR_EPI16 (icoeff[0], icoeff[1]));
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride),
+    (gint16 *) ((gint8 *) b + 2 * bstride),
+    (gint16 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_si256 ();
+  f = _mm_unpacklo_epi16 (f, _mm_setzero_si128 ());
+
+  for (i = 0; i < len; i += 16) {
+    t = _mm256_loadu_si256 ((__m256i *) (a + i));
+    sum[0] = _mm256_add_epi32 (sum[0], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[0] + i))));
+    sum[1] = _mm256_add_epi32 (sum[1], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[1] + i))));
+    sum[2] = _mm256_add_epi32 (sum[2], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[2] + i))));
+    sum[3] = _mm256_add_epi32 (sum[3], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[3] + i))));
+  }
+  res[0] = hadd_256_epi32 (sum[0]);
+  res[1] = hadd_256_epi32 (sum[1]);
+  res[2] = hadd_256_epi32 (sum[2]);
+  res[3] = hadd_256_epi32 (sum[3]);
+
+  /* transpose so that lane n holds the sum of tap row n */
+  r[0] = _mm_unpacklo_epi32 (res[0], res[1]);
+  r[1] = _mm_unpacklo_epi32 (res[2], res[3]);
+  r[2] = _mm_unpackhi_epi32 (res[0], res[1]);
+  r[3] = _mm_unpackhi_epi32 (res[2], res[3]);
+
+  res[0] = _mm_add_epi32 (_mm_unpacklo_epi64 (r[0], r[1]),
+      _mm_unpackhi_epi64 (r[0], r[1]));
+  res[2] = _mm_add_epi32 (_mm_unpacklo_epi64 (r[2], r[3]),
+      _mm_unpackhi_epi64 (r[2], r[3]));
+  res[0] = _mm_add_epi32 (res[0], res[2]);
+
+  res[0] = _mm_srai_epi32 (res[0], PRECISION_S16);
+  res[0] = _mm_madd_epi16 (res[0], f);
+
+  res[0] = _mm_add_epi32 (res[0], _mm_shuffle_epi32 (res[0],
+          _MM_SHUFFLE (2, 3, 2, 3)));
+  res[0] = _mm_add_epi32 (res[0], _mm_shuffle_epi32 (res[0],
+          _MM_SHUFFLE (1, 1, 1, 1)));
+
+  res[0] = _mm_add_epi32 (res[0], _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  res[0] = _mm_srai_epi32 (res[0], PRECISION_S16);
+  res[0] = _mm_packs_epi32 (res[0], res[0]);
+  *o = _mm_extract_epi16 (res[0], 0);
+}
+
+#if defined (__x86_64__)
+/* 32x32->64 bit multiply-accumulate of 8 samples, _mm256_mul_epi32 only uses
+ * the even elements so both halves of each 128 bit lane are unpacked */
+static inline __m256i
+madd_gint32_avx2 (__m256i sum, __m256i ta, __m256i tb)
+{
+  sum = _mm256_add_epi64 (sum, _mm256_mul_epi32 (_mm256_unpacklo_epi32 (ta,
+              ta), _mm256_unpacklo_epi32 (tb, tb)));
+  sum = _mm256_add_epi64 (sum, _mm256_mul_epi32 (_mm256_unpackhi_epi32 (ta,
+              ta), _mm256_unpackhi_epi32 (tb, tb)));
+  return sum;
+}
+
+static inline gint64
+reduce_gint32_avx2 (__m128i sum)
+{
+  sum = _mm_add_epi64 (sum, _mm_unpackhi_epi64 (sum, sum));
+  return _mm_cvtsi128_si64 (sum);
+}
+
+static inline void
+inner_product_gint32_full_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum = _mm256_setzero_si256 ();
+  gint64 res;
+
+  for (i = 0; i < len; i += 8) {
+    sum = madd_gint32_avx2 (sum, _mm256_loadu_si256 ((__m256i *) (a + i)),
+        _mm256_loadu_si256 ((__m256i *) (b + i)));
+  }
+  res = reduce_gint32_avx2 (hadd_256_epi64 (sum));
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_linear_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res;
+  __m256i sum[2], ta;
+  __m128i r[2];
+  __m128i f = _mm_loadu_si128 ((__m128i *) icoeff);
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+    sum[0] = madd_gint32_avx2 (sum[0], ta,
+        _mm256_loadu_si256 ((__m256i *) (c[0] + i)));
+    sum[1] = madd_gint32_avx2 (sum[1], ta,
+        _mm256_loadu_si256 ((__m256i *) (c[1] + i)));
+  }
+  r[0] = _mm_srli_epi64 (hadd_256_epi64 (sum[0]), PRECISION_S32);
+  r[1] = _mm_srli_epi64 (hadd_256_epi64 (sum[1]), PRECISION_S32);
+  r[0] = _mm_mul_epi32 (r[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  r[1] = _mm_mul_epi32 (r[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  res = reduce_gint32_avx2 (_mm_add_epi64 (r[0], r[1]));
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_cubic_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res;
+  __m256i sum[4], ta;
+  __m128i r[4];
+  __m128i f = _mm_loadu_si128 ((__m128i *) icoeff);
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride),
+    (gint32 *) ((gint8 *) b + 2 * bstride),
+    (gint32 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+    sum[0] = madd_gint32_avx2 (sum[0], ta,
+        _mm256_loadu_si256 ((__m256i *) (c[0] + i)));
+    sum[1] = madd_gint32_avx2 (sum[1], ta,
+        _mm256_loadu_si256 ((__m256i *) (c[1] + i)));
+    sum[2] = madd_gint32_avx2 (sum[2], ta,
+        _mm256_loadu_si256 ((__m256i *) (c[2] + i)));
+    sum[3] = madd_gint32_avx2 (sum[3], ta,
+        _mm256_loadu_si256 ((__m256i *) (c[3] + i)));
+  }
+  r[0] = _mm_srli_epi64 (hadd_256_epi64 (sum[0]), PRECISION_S32);
+  r[1] = _mm_srli_epi64 (hadd_256_epi64 (sum[1]), PRECISION_S32);
+  r[2] = _mm_srli_epi64 (hadd_256_epi64 (sum[2]), PRECISION_S32);
+  r[3] = _mm_srli_epi64 (hadd_256_epi64 (sum[3]), PRECISION_S32);
+  r[0] = _mm_mul_epi32 (r[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  r[1] = _mm_mul_epi32 (r[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  r[2] = _mm_mul_epi32 (r[2], _mm_shuffle_epi32 (f, _MM_SHUFFLE (2, 2, 2, 2)));
+  r[3] = _mm_mul_epi32 (r[3], _mm_shuffle_epi32 (f, _MM_SHUFFLE (3, 3, 3, 3)));
+  r[0] = _mm_add_epi64 (r[0], r[1]);
+  r[2] = _mm_add_epi64 (r[2], r[3]);
+  res = reduce_gint32_avx2 (_mm_add_epi64 (r[0], r[2]));
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+#endif
+
+static inline void
+inner_product_gfloat_full_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[2];
+  __m128 res;
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  /* two accumulators to hide the FMA latency, @len is a multiple of 8 */
+  for (; i + 16 <= len; i += 16) {
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 0),
+        _mm256_loadu_ps (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 8),
+        _mm256_loadu_ps (b + i + 8), sum[1]);
+  }
+  if (i < len)
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i),
+        _mm256_loadu_ps (b + i), sum[0]);
+
+  res = hadd_256_ps (_mm256_add_ps (sum[0], sum[1]));
+  res = _mm_add_ps (res, _mm_movehl_ps (res, res));
+  res = _mm_add_ss (res, _mm_shuffle_ps (res, res, 0x55));
+  _mm_store_ss (o, res);
+}
+
+static inline void
+inner_product_gfloat_linear_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  __m256 sum[2], t;
+  __m128 res[2];
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[1] + i), sum[1]);
+  }
+  res[0] = hadd_256_ps (sum[0]);
+  res[1] = hadd_256_ps (sum[1]);
+  res[0] = _mm_fmadd_ps (_mm_sub_ps (res[0], res[1]), _mm_load1_ps (icoeff),
+      res[1]);
+  res[0] = _mm_add_ps (res[0], _mm_movehl_ps (res[0], res[0]));
+  res[0] = _mm_add_ss (res[0], _mm_shuffle_ps (res[0], res[0], 0x55));
+  _mm_store_ss (o, res[0]);
+}
+
+static inline void
+inner_product_gfloat_cubic_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  __m256 sum[4], t;
+  __m128 res[4], f = _mm_loadu_ps (icoeff);
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride),
+    (gfloat *) ((gint8 *) b + 2 * bstride),
+    (gfloat *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_ps ();
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[3] + i), sum[3]);
+  }
+  res[0] = _mm_mul_ps (hadd_256_ps (sum[0]), _mm_shuffle_ps (f, f, 0x00));
+  res[0] = _mm_fmadd_ps (hadd_256_ps (sum[1]), _mm_shuffle_ps (f, f, 0x55),
+      res[0]);
+  res[0] = _mm_fmadd_ps (hadd_256_ps (sum[2]), _mm_shuffle_ps (f, f, 0xaa),
+      res[0]);
+  res[0] = _mm_fmadd_ps (hadd_256_ps (sum[3]), _mm_shuffle_ps (f, f, 0xff),
+      res[0]);
+  res[0] = _mm_add_ps (res[0], _mm_movehl_ps (res[0], res[0]));
+  res[0] = _mm_add_ss (res[0], _mm_shuffle_ps (res[0], res[0], 0x55));
+  _mm_store_ss (o, res[0]);
+}
+
+static inline void
+inner_product_gdouble_full_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  __m256d sum[2];
+  __m128d res;
+
+  sum[0] = sum[1] = _mm256_setzero_pd ();
+
+  for (i = 0; i < len; i += 8) {
+    sum[0] = _mm256_fmadd_pd (_mm256_loadu_pd (a + i + 0),
+        _mm256_loadu_pd (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_pd (_mm256_loadu_pd (a + i + 4),
+        _mm256_loadu_pd (b + i + 4), sum[1]);
+  }
+  res = hadd_256_pd (_mm256_add_pd (sum[0], sum[1]));
+  res = _mm_add_sd (res, _mm_unpackhi_pd (res, res));
+  _mm_store_sd (o, res);
+}
+
+static inline void
+inner_product_gdouble_linear_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  __m256d sum[2], t;
+  __m128d res[2];
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_pd ();
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_loadu_pd (a + i);
+    sum[0] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[1] + i), sum[1]);
+  }
+  res[0] = hadd_256_pd (sum[0]);
+  res[1] = hadd_256_pd (sum[1]);
+  res[0] = _mm_fmadd_pd (_mm_sub_pd (res[0], res[1]), _mm_load1_pd (icoeff),
+      res[1]);
+  res[0] = _mm_add_sd (res[0], _mm_unpackhi_pd (res[0], res[0]));
+  _mm_store_sd (o, res[0]);
+}
+
+static inline void
+inner_product_gdouble_cubic_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  __m256d sum[4], t;
+  __m128d res;
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride),
+    (gdouble *) ((gint8 *) b + 2 * bstride),
+    (gdouble *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_pd ();
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_loadu_pd (a + i);
+    sum[0] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[3] + i), sum[3]);
+  }
+  res = _mm_mul_pd (hadd_256_pd (sum[0]), _mm_set1_pd (icoeff[0]));
+  res = _mm_fmadd_pd (hadd_256_pd (sum[1]), _mm_set1_pd (icoeff[1]), res);
+  res = _mm_fmadd_pd (hadd_256_pd (sum[2]), _mm_set1_pd (icoeff[2]), res);
+  res = _mm_fmadd_pd (hadd_256_pd (sum[3]), _mm_set1_pd (icoeff[3]), res);
+  res = _mm_add_sd (res, _mm_unpackhi_pd (res, res));
+  _mm_store_sd (o, res);
+}
+
+MAKE_RESAMPLE_FUNC (gint16, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, cubic, 1, avx2);
+
+#if defined (__x86_64__)
+MAKE_RESAMPLE_FUNC (gint32, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, cubic, 1, avx2);
+#endif
+
+MAKE_RESAMPLE_FUNC (gfloat, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gdouble, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gdouble, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gdouble, cubic, 1, avx2);
+
+void
+interpolate_gint16_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint16 *o = op, *a = ap, *ic = icp;
+  __m256i ta, tb, t1, t2;
+  __m256i f = _mm256_set1_epi32 (PAIR_EPI16 (ic[0], ic[1]));
+  const __m256i round = _mm256_set1_epi32 (1 << (PRECISION_S16 - 1));
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride)
+  };
+
+  /* unpack and pack both work per 128 bit lane, so the order is kept */
+  for (i = 0; i < len; i += 16) {
+    ta = _mm256_loadu_si256 ((__m256i *) (c[0] + i));
+    tb = _mm256_loadu_si256 ((__m256i *) (c[1] + i));
+
+    t1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f);
+    t2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f);
+
+    t1 = _mm256_srai_epi32 (_mm256_add_epi32 (t1, round), PRECISION_S16);
+    t2 = _mm256_srai_epi32 (_mm256_add_epi32 (t2, round), PRECISION_S16);
+
+    _mm256_storeu_si256 ((__m256i *) (o + i), _mm256_packs_epi32 (t1, t2));
+  }
+}
+
+void
+interpolate_gint16_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint16 *o = op, *a = ap, *ic = icp;
+  __m256i ta, tb, tl1, tl2, th1, th2;
+  __m256i f[2];
+  const __m256i round = _mm256_set1_epi32 (1 << (PRECISION_S16 - 1));
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride),
+    (gint16 *) ((gint8 *) a + 2 * astride),
+    (gint16 *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_set1_epi32 (PAIR_EPI16 (ic[0], ic[1]));
+  f[1] = _mm256_set1_epi32 (PAIR_EPI16 (ic[2], ic[3]));
+
+  for (i = 0; i < len; i += 16) {
+    ta = _mm256_loadu_si256 ((__m256i *) (c[0] + i));
+    tb = _mm256_loadu_si256 ((__m256i *) (c[1] + i));
+
+    tl1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f[0]);
+    th1 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f[0]);
+
+    ta = _mm256_loadu_si256 ((__m256i *) (c[2] + i));
+    tb = _mm256_loadu_si256 ((__m256i *) (c[3] + i));
+
+    tl2 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f[1]);
+    th2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f[1]);
+
+    tl1 = _mm256_add_epi32 (_mm256_add_epi32 (tl1, tl2), round);
+    th1 = _mm256_add_epi32 (_mm256_add_epi32 (th1, th2), round);
+
+    tl1 = _mm256_srai_epi32 (tl1, PRECISION_S16);
+    th1 = _mm256_srai_epi32 (th1, PRECISION_S16);
+
+    _mm256_storeu_si256 ((__m256i *) (o + i), _mm256_packs_epi32 (tl1, th1));
+  }
+}
+
+void
+interpolate_gfloat_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 f[2];
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride)
+  };
+
+  f[0] = _mm256_set1_ps (ic[0]);
+  f[1] = _mm256_set1_ps (ic[1]);
+
+  for (i = 0; i < len; i += 8) {
+    _mm256_storeu_ps (o + i,
+        _mm256_fmadd_ps (_mm256_loadu_ps (c[1] + i), f[1],
+            _mm256_mul_ps (_mm256_loadu_ps (c[0] + i), f[0])));
+  }
+}
+
+void
+interpolate_gfloat_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 f[4], t;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride),
+    (gfloat *) ((gint8 *) a + 2 * astride),
+    (gfloat *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_set1_ps (ic[0]);
+  f[1] = _mm256_set1_ps (ic[1]);
+  f[2] = _mm256_set1_ps (ic[2]);
+  f[3] = _mm256_set1_ps (ic[3]);
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_mul_ps (_mm256_loadu_ps (c[0] + i), f[0]);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[1] + i), f[1], t);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[2] + i), f[2], t);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[3] + i), f[3], t);
+    _mm256_storeu_ps (o + i, t);
+  }
+}
+
+void
+interpolate_gdouble_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  __m256d f[2];
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride)
+  };
+
+  f[0] = _mm256_set1_pd (ic[0]);
+  f[1] = _mm256_set1_pd (ic[1]);
+
+  for (i = 0; i < len; i += 4) {
+    _mm256_storeu_pd (o + i,
+        _mm256_fmadd_pd (_mm256_loadu_pd (c[1] + i), f[1],
+            _mm256_mul_pd (_mm256_loadu_pd (c[0] + i), f[0])));
+  }
+}
+
+void
+interpolate_gdouble_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  __m256d f[4], t;
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride),
+    (gdouble *) ((gint8 *) a + 2 * astride),
+    (gdouble *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_set1_pd (ic[0]);
+  f[1] = _mm256_set1_pd (ic[1]);
+  f[2] = _mm256_set1_pd (ic[2]);
+  f[3] = _mm256_set1_pd (ic[3]);
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_mul_pd (_mm256_loadu_pd (c[0] + i), f[0]);
+    t = _mm256_fmadd_pd (_mm256_loadu_pd (c[1] + i), f[1], t);
+    t = _mm256_fmadd_pd (_mm256_loadu_pd (c[2] + i), f[2], t);
+    t = _mm256_fmadd_pd (_mm256_loadu_pd (c[3] + i), f[3], t);
+    _mm256_storeu_pd (o + i, t);
+  }
+}
+
+#endif
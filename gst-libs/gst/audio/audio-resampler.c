@@ -105,6 +105,7 @@ static const BlackmanQualityMap blackman_qualities[] = {
 #define DEFAULT_OPT_FILTER_INTERPOLATION GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_CUBIC
 #define DEFAULT_OPT_FILTER_OVERSAMPLE 8
 #define DEFAULT_OPT_MAX_PHASE_ERROR 0.1
+#define DEFAULT_OPT_THREADS 1
 
 static gdouble
 get_opt_double (GstStructure * options, const gchar * name, gdouble def)
@@ -124,6 +125,15 @@ get_opt_int (GstStructure * options, const gchar * name, gint def)
   return res;
 }
 
+static guint
+get_opt_uint (GstStructure * options, const gchar * name, guint def)
+{
+  guint res;
+  if (!options || !gst_structure_get_uint (options, name, &res))
+    res = def;
+  return res;
+}
+
 static gint
 get_opt_enum (GstStructure * options, const gchar * name, GType type, gint def)
 {
@@ -160,6 +170,8 @@ get_opt_enum (GstStructure * options, const gchar * name, GType type, gint def)
     GST_AUDIO_RESAMPLER_OPT_FILTER_OVERSAMPLE, DEFAULT_OPT_FILTER_OVERSAMPLE)
 #define GET_OPT_MAX_PHASE_ERROR(options) get_opt_double(options, \
     GST_AUDIO_RESAMPLER_OPT_MAX_PHASE_ERROR, DEFAULT_OPT_MAX_PHASE_ERROR)
+#define GET_OPT_THREADS(options) get_opt_uint(options, \
+    GST_AUDIO_RESAMPLER_OPT_THREADS, DEFAULT_OPT_THREADS)
 
 #include "dbesi0.c"
 #define bessel dbesi0
@@ -829,9 +841,17 @@ static ResampleFunc resample_funcs[] = {
 # endif
 # if defined (__i386__) || defined (__x86_64__)
 #  define CHECK_X86
+/* the AVX2 functions are only built when the compiler can do AVX2 and FMA */
+#  if defined (HAVE_AVX2) && HAVE_AVX2 && defined (HAVE_FMA) && HAVE_FMA
+#   define CHECK_X86_AVX2
+#  endif
 #  include "audio-resampler-x86.h"
 # endif
 #endif
+#if defined (__aarch64__)
+# define CHECK_NEON64
+# include "audio-resampler-neon64.h"
+#endif
 
 static void
 audio_resampler_init (void)
@@ -874,6 +894,12 @@ audio_resampler_init (void)
         }
       }
     }
+#ifdef CHECK_X86_AVX2
+    audio_resampler_check_x86_avx2 ();
+#endif
+#endif
+#ifdef CHECK_NEON64
+    audio_resampler_check_neon64 ();
 #endif
     g_once_init_leave (&init_gonce, 1);
   }
@@ -951,49 +977,390 @@ calculate_kaiser_params (GstAudioResampler * resampler)
       resampler->n_taps, resampler->cutoff);
 }
 
+/* tables bigger than this are not shared and are calculated lazily for each
+ * resampler */
+#define MAX_SHARED_TABLE_SIZE (4 * 1024 * 1024)
+
+static GMutex tables_lock;
+static GHashTable *tables;
+
+static guint
+table_hash (gconstpointer key)
+{
+  const AudioResamplerTable *t = key;
+  guint hash;
+
+  hash = ((guint) t->full << 31) ^ ((guint) t->format_index << 28) ^
+      ((guint) t->method << 24) ^ ((guint) t->filter_interpolation << 20);
+  hash ^= t->n_taps * 31 + t->oversample * 131 + t->rows * 1031;
+  hash ^= g_double_hash (&t->cutoff) ^ g_double_hash (&t->kaiser_beta);
+  hash ^= g_double_hash (&t->b) ^ (g_double_hash (&t->c) << 1);
+
+  return hash;
+}
+
+static gboolean
+table_equal (gconstpointer a, gconstpointer b)
+{
+  const AudioResamplerTable *t1 = a, *t2 = b;
+
+  return t1->full == t2->full && t1->format_index == t2->format_index &&
+      t1->method == t2->method &&
+      t1->filter_interpolation == t2->filter_interpolation &&
+      t1->n_taps == t2->n_taps && t1->oversample == t2->oversample &&
+      t1->rows == t2->rows && t1->cutoff == t2->cutoff &&
+      t1->kaiser_beta == t2->kaiser_beta && t1->b == t2->b && t1->c == t2->c;
+}
+
 static void
-alloc_taps_mem (GstAudioResampler * resampler, gint bps, gint n_taps,
-    gint n_phases)
+table_init_key (AudioResamplerTable * table, GstAudioResampler * resampler,
+    gboolean full, gint rows)
 {
-  if (resampler->alloc_taps >= n_taps && resampler->alloc_phases >= n_phases)
+  memset (table, 0, sizeof (AudioResamplerTable));
+  table->full = full;
+  table->format_index = resampler->format_index;
+  table->method = resampler->method;
+  table->filter_interpolation = resampler->filter_interpolation;
+  table->n_taps = resampler->n_taps;
+  table->oversample = resampler->oversample;
+  table->rows = rows;
+  table->cutoff = resampler->cutoff;
+  table->kaiser_beta = resampler->kaiser_beta;
+  table->b = resampler->b;
+  table->c = resampler->c;
+}
+
+static AudioResamplerTable *
+table_new (GstAudioResampler * resampler, gboolean full, gint rows)
+{
+  AudioResamplerTable *table;
+  gsize phases_size;
+
+  table = g_slice_new (AudioResamplerTable);
+  table_init_key (table, resampler, full, rows);
+  table->ref_count = 1;
+
+  GST_DEBUG ("allocate %s table bps %d n_taps %d rows %d",
+      full ? "full" : "oversampled", resampler->bps, resampler->n_taps, rows);
+
+  table->stride = GST_ROUND_UP_32 (resampler->bps * (resampler->n_taps +
+          TAPS_OVERREAD));
+  phases_size = full ? sizeof (gpointer) * rows : 0;
+
+  table->mem = g_malloc0 (phases_size + rows * table->stride + ALIGN - 1);
+  table->taps = MEM_ALIGN ((gint8 *) table->mem + phases_size, ALIGN);
+  table->phases = full ? table->mem : NULL;
+
+  return table;
+}
+
+static void
+table_unref (AudioResamplerTable * table)
+{
+  if (table->shared) {
+    g_mutex_lock (&tables_lock);
+    if (--table->ref_count > 0) {
+      g_mutex_unlock (&tables_lock);
+      return;
+    }
+    g_hash_table_remove (tables, table);
+    g_mutex_unlock (&tables_lock);
+  } else if (--table->ref_count > 0) {
     return;
+  }
 
-  GST_DEBUG ("allocate bps %d n_taps %d n_phases %d", bps, n_taps, n_phases);
+  GST_DEBUG ("free %s table n_taps %d rows %d",
+      table->full ? "full" : "oversampled", table->n_taps, table->rows);
 
-  resampler->tmp_taps =
-      g_realloc_n (resampler->tmp_taps, n_taps, sizeof (gdouble));
+  g_free (table->mem);
+  g_slice_free (AudioResamplerTable, table);
+}
 
-  resampler->taps_stride = GST_ROUND_UP_32 (bps * (n_taps + TAPS_OVERREAD));
+static void
+set_taps_table (GstAudioResampler * resampler, AudioResamplerTable * table)
+{
+  if (resampler->taps_table)
+    table_unref (resampler->taps_table);
 
-  g_free (resampler->taps_mem);
-  resampler->taps_mem =
-      g_malloc0 (n_phases * resampler->taps_stride + ALIGN - 1);
-  resampler->taps = MEM_ALIGN ((gint8 *) resampler->taps_mem, ALIGN);
-  resampler->alloc_taps = n_taps;
-  resampler->alloc_phases = n_phases;
+  resampler->taps_table = table;
+  resampler->taps = table ? table->taps : NULL;
+  resampler->taps_stride = table ? table->stride : 0;
 }
 
 static void
-alloc_cache_mem (GstAudioResampler * resampler, gint bps, gint n_taps,
-    gint n_phases)
+set_cached_table (GstAudioResampler * resampler, AudioResamplerTable * table)
 {
-  gsize phases_size;
+  if (resampler->cached_table)
+    table_unref (resampler->cached_table);
 
-  resampler->tmp_taps =
-      g_realloc_n (resampler->tmp_taps, n_taps, sizeof (gdouble));
+  resampler->cached_table = table;
+  resampler->cached_taps = table ? table->taps : NULL;
+  resampler->cached_taps_stride = table ? table->stride : 0;
+  resampler->cached_phases = table ? table->phases : NULL;
+}
+
+static void setup_functions (GstAudioResampler * resampler);
+
+/* make sure the taps for @samp_phase are in the full table and advance
+ * @samp_index and @samp_phase to the next output sample */
+static void
+make_full_taps (GstAudioResampler * resampler, gint * samp_index,
+    gint * samp_phase)
+{
+  gdouble icoeff[4];
+
+  switch (resampler->format_index) {
+    case 0:
+      get_taps_gint16_full (resampler, samp_index, samp_phase,
+          (gint16 *) icoeff);
+      break;
+    case 1:
+      get_taps_gint32_full (resampler, samp_index, samp_phase,
+          (gint32 *) icoeff);
+      break;
+    case 2:
+      get_taps_gfloat_full (resampler, samp_index, samp_phase,
+          (gfloat *) icoeff);
+      break;
+    case 3:
+      get_taps_gdouble_full (resampler, samp_index, samp_phase,
+          (gdouble *) icoeff);
+      break;
+  }
+}
+
+/* calculate all rows of @table, which is already set on @resampler */
+static void
+table_fill (GstAudioResampler * resampler, AudioResamplerTable * table)
+{
+  gint i;
+
+  if (!table->full) {
+    gdouble x;
+
+    for (i = 0; i < table->rows; i++) {
+      x = -(table->n_taps / 2) + i / (gdouble) table->oversample;
+      make_taps (resampler, (gint8 *) table->taps + i * table->stride, x,
+          table->n_taps);
+    }
+  } else {
+    gint samp_index = 0, samp_phase;
+
+    /* the full table is filled with the resample functions of the
+     * resampler, n_phases == out_rate here */
+    setup_functions (resampler);
+
+    for (i = 0; i < table->rows; i++) {
+      samp_phase = i;
+      make_full_taps (resampler, &samp_index, &samp_phase);
+    }
+  }
+  table->filled = TRUE;
+}
+
+/* Look up the table with the current parameters of @resampler in the
+ * shared tables or make a new one and set it on @resampler. When @shared is
+ * %FALSE, a private full table is made that is filled lazily by
+ * get_taps_*_full(). This is used after rate updates of variable rate
+ * resamplers, where the rate can change often */
+static void
+resampler_setup_table (GstAudioResampler * resampler, gboolean full,
+    gint rows, gboolean shared)
+{
+  AudioResamplerTable key, *table, *other;
+  gsize size;
+
+  size = rows * GST_ROUND_UP_32 (resampler->bps * (resampler->n_taps +
+          TAPS_OVERREAD));
+
+  if (full && (!shared || size > MAX_SHARED_TABLE_SIZE)) {
+    set_cached_table (resampler, table_new (resampler, TRUE, rows));
+    return;
+  }
+
+  table_init_key (&key, resampler, full, rows);
+
+  g_mutex_lock (&tables_lock);
+  if (tables == NULL)
+    tables = g_hash_table_new (table_hash, table_equal);
+
+  table = g_hash_table_lookup (tables, &key);
+  if (table)
+    table->ref_count++;
+  g_mutex_unlock (&tables_lock);
+
+  if (table == NULL) {
+    /* calculate outside of the lock, another resampler might have made the
+     * same table in the meantime, in which case we use that one */
+    table = table_new (resampler, full, rows);
+    if (full)
+      set_cached_table (resampler, table);
+    else
+      set_taps_table (resampler, table);
+    table_fill (resampler, table);
+
+    g_mutex_lock (&tables_lock);
+    other = g_hash_table_lookup (tables, table);
+    if (other) {
+      other->ref_count++;
+    } else {
+      table->ref_count++;
+      table->shared = TRUE;
+      g_hash_table_add (tables, table);
+    }
+    g_mutex_unlock (&tables_lock);
+
+    if (other)
+      table = other;
+    else
+      GST_DEBUG ("sharing new %s table", full ? "full" : "oversampled");
+  } else {
+    GST_DEBUG ("reusing shared %s table", full ? "full" : "oversampled");
+  }
+
+  if (full)
+    set_cached_table (resampler, table);
+  else
+    set_taps_table (resampler, table);
+}
+
+struct _AudioResamplerJob
+{
+  GstAudioResampler *resampler;
+  /* copy of the resampler with only the blocks of this job */
+  GstAudioResampler block;
+
+  gpointer *in;
+  gsize in_len;
+  gpointer *out;
+  gpointer out0;
+  gsize out_len;
+  gsize consumed;
+};
+
+static GThreadPool *resample_pool;
+
+static void
+resample_job_func (gpointer data, gpointer user_data)
+{
+  AudioResamplerJob *job = data;
+  GstAudioResampler *resampler = job->resampler;
+
+  job->block.resample (&job->block, job->in, job->in_len, job->out,
+      job->out_len, &job->consumed);
+
+  g_mutex_lock (&resampler->lock);
+  if (--resampler->n_pending == 0)
+    g_cond_signal (&resampler->cond);
+  g_mutex_unlock (&resampler->lock);
+}
+
+static void
+setup_threads (GstAudioResampler * resampler)
+{
+  guint n_threads;
+
+  n_threads = GET_OPT_THREADS (resampler->options);
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  n_threads = MIN (n_threads, resampler->blocks);
+  if (n_threads == resampler->n_jobs)
+    return;
+
+  GST_DEBUG ("using %u threads for %d blocks", n_threads, resampler->blocks);
+
+  g_free (resampler->jobs);
+  resampler->jobs = NULL;
+  resampler->n_jobs = n_threads;
+
+  if (n_threads > 1) {
+    static gsize pool_init = 0;
+
+    if (g_once_init_enter (&pool_init)) {
+      GError *err = NULL;
+
+      /* shared by all resamplers, the thread calling
+       * gst_audio_resampler_resample() does one of the jobs itself */
+      resample_pool = g_thread_pool_new (resample_job_func, NULL,
+          g_get_num_processors (), FALSE, &err);
+      if (resample_pool == NULL) {
+        GST_ERROR ("failed to create thread pool: %s", err->message);
+        g_clear_error (&err);
+      }
+      g_once_init_leave (&pool_init, 1);
+    }
+    if (resample_pool == NULL) {
+      resampler->n_jobs = 1;
+      return;
+    }
+    resampler->jobs = g_new0 (AudioResamplerJob, n_threads);
+  }
+}
+
+/* resample the blocks of channels in parallel when configured */
+static void
+resample_blocks (GstAudioResampler * resampler, gpointer * sbuf,
+    gsize in_len, gpointer out[], gsize out_len, gsize * consumed)
+{
+  guint i, n_jobs = resampler->n_jobs;
+  gint first = 0;
+
+  if (n_jobs <= 1) {
+    resampler->resample (resampler, sbuf, in_len, out, out_len, consumed);
+    return;
+  }
+
+  /* a private full table is filled lazily, calculate the phases we are
+   * going to use now so that the jobs only read from it */
+  if (resampler->cached_table && !resampler->cached_table->filled) {
+    gint samp_index = resampler->samp_index;
+    gint samp_phase = resampler->samp_phase;
+    gsize j;
 
-  resampler->cached_taps_stride =
-      GST_ROUND_UP_32 (bps * (n_taps + TAPS_OVERREAD));
+    for (j = 0; j < out_len; j++)
+      make_full_taps (resampler, &samp_index, &samp_phase);
+  }
+
+  for (i = 0; i < n_jobs; i++) {
+    AudioResamplerJob *job = &resampler->jobs[i];
+    gint n_blocks = (resampler->blocks - first) / (n_jobs - i);
+
+    job->resampler = resampler;
+    job->block = *resampler;
+    job->block.blocks = n_blocks;
+    job->in = sbuf + first;
+    job->in_len = in_len;
+    if (resampler->ostride == 1) {
+      job->out = out + first;
+    } else {
+      job->out0 = (gint8 *) out[0] + first * resampler->bps;
+      job->out = &job->out0;
+    }
+    job->out_len = out_len;
+    first += n_blocks;
+  }
 
-  phases_size = sizeof (gpointer) * n_phases;
+  g_mutex_lock (&resampler->lock);
+  resampler->n_pending = n_jobs - 1;
+  g_mutex_unlock (&resampler->lock);
 
-  g_free (resampler->cached_taps_mem);
-  resampler->cached_taps_mem =
-      g_malloc0 (phases_size + n_phases * resampler->cached_taps_stride +
-      ALIGN - 1);
-  resampler->cached_taps =
-      MEM_ALIGN ((gint8 *) resampler->cached_taps_mem + phases_size, ALIGN);
-  resampler->cached_phases = resampler->cached_taps_mem;
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (resample_pool, &resampler->jobs[i], NULL);
+
+  resampler->jobs[0].block.resample (&resampler->jobs[0].block,
+      resampler->jobs[0].in, in_len, resampler->jobs[0].out, out_len,
+      &resampler->jobs[0].consumed);
+
+  g_mutex_lock (&resampler->lock);
+  while (resampler->n_pending > 0)
+    g_cond_wait (&resampler->cond, &resampler->lock);
+  g_mutex_unlock (&resampler->lock);
+
+  /* all blocks advanced the same */
+  *consumed = resampler->jobs[0].consumed;
+  resampler->samp_index = 0;
+  resampler->samp_phase = resampler->jobs[0].block.samp_phase;
 }
 
 static void
@@ -1159,18 +1526,12 @@ resampler_calculate_taps (GstAudioResampler * resampler)
 
   resampler->filter_interpolation = filter_interpolation;
 
-  if (resampler->filter_mode == GST_AUDIO_RESAMPLER_FILTER_MODE_FULL &&
-      resampler->method != GST_AUDIO_RESAMPLER_METHOD_NEAREST) {
-    GST_DEBUG ("setting up filter cache");
-    resampler->n_phases = out_rate;
-    alloc_cache_mem (resampler, bps, n_taps, out_rate);
-  }
+  resampler->tmp_taps =
+      g_realloc_n (resampler->tmp_taps, n_taps, sizeof (gdouble));
 
   if (resampler->filter_interpolation !=
       GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_NONE) {
-    gint i, isize;
-    gdouble x;
-    gpointer taps;
+    gint isize;
 
     switch (resampler->filter_interpolation) {
       default:
@@ -1183,14 +1544,19 @@ resampler_calculate_taps (GstAudioResampler * resampler)
         isize = 4;
         break;
     }
+    resampler_setup_table (resampler, FALSE, oversample + isize, TRUE);
+  } else {
+    set_taps_table (resampler, NULL);
+  }
 
-    alloc_taps_mem (resampler, bps, n_taps, oversample + isize);
-
-    for (i = 0; i < oversample + isize; i++) {
-      x = -(n_taps / 2) + i / (gdouble) oversample;
-      taps = (gint8 *) resampler->taps + i * resampler->taps_stride;
-      make_taps (resampler, taps, x, n_taps);
-    }
+  /* the full table is made from the oversampled table so it goes last */
+  if (resampler->filter_mode == GST_AUDIO_RESAMPLER_FILTER_MODE_FULL &&
+      resampler->method != GST_AUDIO_RESAMPLER_METHOD_NEAREST) {
+    GST_DEBUG ("setting up filter cache");
+    resampler->n_phases = out_rate;
+    resampler_setup_table (resampler, TRUE, out_rate, TRUE);
+  } else {
+    set_cached_table (resampler, NULL);
   }
 }
 
@@ -1375,6 +1741,8 @@ gst_audio_resampler_new (GstAudioResamplerMethod method,
   info = gst_audio_format_get_info (format);
   resampler->bps = GST_AUDIO_FORMAT_INFO_WIDTH (info) / 8;
   resampler->sbuf = g_malloc0 (sizeof (gpointer) * channels);
+  g_mutex_init (&resampler->lock);
+  g_cond_init (&resampler->cond);
 
   non_interleaved =
       (resampler->flags & GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_OUT);
@@ -1552,6 +1920,7 @@ gst_audio_resampler_update (GstAudioResampler * resampler,
 
     resampler_calculate_taps (resampler);
     resampler_dump (resampler);
+    setup_threads (resampler);
 
     if (old_n_taps > 0 && old_n_taps != resampler->n_taps) {
       gpointer *sbuf;
@@ -1584,11 +1953,12 @@ gst_audio_resampler_update (GstAudioResampler * resampler,
 
       resampler->samples_avail += diff;
     }
-  } else if (resampler->filter_mode == GST_AUDIO_RESAMPLER_FILTER_MODE_FULL) {
+  } else if (resampler->filter_mode == GST_AUDIO_RESAMPLER_FILTER_MODE_FULL &&
+      resampler->method != GST_AUDIO_RESAMPLER_METHOD_NEAREST) {
     GST_DEBUG ("setting up filter cache");
     resampler->n_phases = resampler->out_rate;
-    alloc_cache_mem (resampler, resampler->bps, resampler->n_taps,
-        resampler->n_phases);
+    resampler_setup_table (resampler, TRUE, resampler->n_phases,
+        !(resampler->flags & GST_AUDIO_RESAMPLER_FLAG_VARIABLE_RATE));
   }
   setup_functions (resampler);
 
@@ -1608,11 +1978,14 @@ gst_audio_resampler_free (GstAudioResampler * resampler)
 {
   g_return_if_fail (resampler != NULL);
 
-  g_free (resampler->cached_taps_mem);
-  g_free (resampler->taps_mem);
+  set_cached_table (resampler, NULL);
+  set_taps_table (resampler, NULL);
   g_free (resampler->tmp_taps);
   g_free (resampler->samples);
   g_free (resampler->sbuf);
+  g_free (resampler->jobs);
+  g_mutex_clear (&resampler->lock);
+  g_cond_clear (&resampler->cond);
   if (resampler->options)
     gst_structure_free (resampler->options);
   g_slice_free (GstAudioResampler, resampler);
@@ -1761,7 +2134,7 @@ gst_audio_resampler_resample (GstAudioResampler * resampler,
   }
 
   /* resample all channels */
-  resampler->resample (resampler, sbuf, samples_avail, out, out_frames,
+  resample_blocks (resampler, sbuf, samples_avail, out, out_frames,
       &consumed);
 
   GST_LOG ("in %" G_GSIZE_FORMAT ", avail %" G_GSIZE_FORMAT ", consumed %"
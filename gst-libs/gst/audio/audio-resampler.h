@@ -153,6 +153,18 @@ typedef enum {
  */
 #define GST_AUDIO_RESAMPLER_OPT_MAX_PHASE_ERROR "GstAudioResampler.max-phase-error"
 
+/**
+ * GST_AUDIO_RESAMPLER_OPT_THREADS:
+ *
+ * G_TYPE_UINT: the maximum number of threads to use for resampling. The
+ * channels are split into blocks that are resampled in parallel. 0 uses
+ * as many threads as there are CPUs.
+ * 1 is the default.
+ *
+ * Since: 1.14
+ */
+#define GST_AUDIO_RESAMPLER_OPT_THREADS "GstAudioResampler.threads"
+
 /**
  * GstAudioResamplerMethod:
  * @GST_AUDIO_RESAMPLER_METHOD_NEAREST: Duplicates the samples when
@@ -75,6 +75,18 @@ struct _GstAudioBaseSinkPrivate
   GstAudioBaseSinkCustomSlavingCallback custom_slaving_callback;
   gpointer custom_slaving_cb_data;
   GDestroyNotify custom_slaving_cb_notify;
+
+  /* clock rate used by the resample slaving method */
+  GstClockTime rate_num;
+  GstClockTime rate_denom;
+
+  /* resampler for slave-method=resample */
+  GstAudioResampler *resampler;
+  gint resampler_in_rate;
+  /* delay of the samples in the resampler, protected by the object lock */
+  GstClockTime resampler_latency;
+  gpointer resample_buf;
+  gsize resample_buf_size;
 };
 
 /* BaseAudioSink signals and args */
@@ -105,6 +117,10 @@ enum
  * fix itself, or is a permanent offset */
 #define DEFAULT_DISCONT_WAIT        (1 * GST_SECOND)
 
+/* denominator of the resampler rates used when resampling to the master
+ * clock, gives a precision of about 1 ppm */
+#define RESAMPLE_RATE_SCALE         (1 << 20)
+
 enum
 {
   PROP_0,
@@ -143,6 +159,9 @@ static gboolean gst_audio_base_sink_query (GstElement * element, GstQuery *
 
 static GstClock *gst_audio_base_sink_provide_clock (GstElement * elem);
 static inline void gst_audio_base_sink_reset_sync (GstAudioBaseSink * sink);
+static void gst_audio_base_sink_free_resampler (GstAudioBaseSink * sink);
+static gboolean gst_audio_base_sink_can_resample (GstAudioBaseSink * sink);
+static void gst_audio_base_sink_setup_resampler (GstAudioBaseSink * sink);
 static GstClockTime gst_audio_base_sink_get_time (GstClock * clock,
     GstAudioBaseSink * sink);
 static void gst_audio_base_sink_callback (GstAudioRingBuffer * rbuf,
@@ -317,6 +336,8 @@ gst_audio_base_sink_dispose (GObject * object)
   if (sink->priv->custom_slaving_cb_notify)
     sink->priv->custom_slaving_cb_notify (sink->priv->custom_slaving_cb_data);
 
+  gst_audio_base_sink_free_resampler (sink);
+
   if (sink->provided_clock) {
     gst_audio_clock_invalidate (GST_AUDIO_CLOCK (sink->provided_clock));
     gst_object_unref (sink->provided_clock);
@@ -454,6 +475,8 @@ gst_audio_base_sink_query (GstElement * element, GstQuery * query)
           base_latency =
               gst_util_uint64_scale_int (spec->seglatency * spec->segsize,
               GST_SECOND, spec->info.rate * spec->info.bpf);
+          /* the resampler of slave-method=resample delays the samples too */
+          base_latency += basesink->priv->resampler_latency;
           GST_OBJECT_UNLOCK (basesink);
 
           /* we cannot go lower than the buffer size and the min peer latency */
@@ -937,6 +960,9 @@ gst_audio_base_sink_setcaps (GstBaseSink * bsink, GstCaps * caps)
   gst_audio_ring_buffer_activate (sink->ringbuffer, FALSE);
   gst_audio_ring_buffer_release (sink->ringbuffer);
 
+  /* the resampler is created again for the new format when needed */
+  gst_audio_base_sink_free_resampler (sink);
+
   GST_DEBUG_OBJECT (sink, "parse caps");
 
   spec->buffer_time = sink->buffer_time;
@@ -983,6 +1009,11 @@ gst_audio_base_sink_setcaps (GstBaseSink * bsink, GstCaps * caps)
 
   gst_audio_ring_buffer_debug_spec_buff (spec);
 
+  /* create the resampler now so that its delay is part of the latency */
+  if (sink->priv->slave_method == GST_AUDIO_BASE_SINK_SLAVE_RESAMPLE
+      && gst_audio_base_sink_can_resample (sink))
+    gst_audio_base_sink_setup_resampler (sink);
+
   gst_element_post_message (GST_ELEMENT_CAST (bsink),
       gst_message_new_latency (GST_OBJECT (bsink)));
 
@@ -1043,6 +1074,10 @@ gst_audio_base_sink_reset_sync (GstAudioBaseSink * sink)
   sink->priv->discont_time = -1;
   sink->priv->avg_skew = -1;
   sink->priv->last_align = 0;
+  /* this drops the samples still in the history of the resampler, at most
+   * its latency worth of samples */
+  if (sink->priv->resampler)
+    gst_audio_resampler_reset (sink->priv->resampler);
 }
 
 static void
@@ -1140,7 +1175,9 @@ gst_audio_base_sink_wait_event (GstBaseSink * bsink, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:
-      /* now wait till we played everything */
+      /* now wait till we played everything. The samples that are still in
+       * the history of the resampler are not played, this truncates the
+       * stream by at most the resampler latency. */
       ret = gst_audio_base_sink_drain (sink);
       break;
     default:
@@ -1392,6 +1429,10 @@ gst_audio_base_sink_resample_slaving (GstAudioBaseSink * sink,
   if (crate_num == 0)
     crate_denom = crate_num = 1;
 
+  /* remember the rate for resampling the samples */
+  sink->priv->rate_num = crate_num;
+  sink->priv->rate_denom = crate_denom;
+
   /* bring external time to internal time */
   render_start = clock_convert_external (render_start, cinternal, cexternal,
       crate_num, crate_denom);
@@ -1722,6 +1763,120 @@ flushing:
   }
 }
 
+static void
+gst_audio_base_sink_free_resampler (GstAudioBaseSink * sink)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+
+  if (priv->resampler) {
+    gst_audio_resampler_free (priv->resampler);
+    priv->resampler = NULL;
+  }
+  GST_OBJECT_LOCK (sink);
+  priv->resampler_latency = 0;
+  GST_OBJECT_UNLOCK (sink);
+  g_free (priv->resample_buf);
+  priv->resample_buf = NULL;
+  priv->resample_buf_size = 0;
+}
+
+/* check if the samples can be resampled to the rate of the master clock */
+static gboolean
+gst_audio_base_sink_can_resample (GstAudioBaseSink * sink)
+{
+  GstAudioRingBufferSpec *spec = &sink->ringbuffer->spec;
+
+  if (spec->type != GST_AUDIO_RING_BUFFER_FORMAT_TYPE_RAW)
+    return FALSE;
+
+  switch (GST_AUDIO_INFO_FORMAT (&spec->info)) {
+    case GST_AUDIO_FORMAT_S16:
+    case GST_AUDIO_FORMAT_S32:
+    case GST_AUDIO_FORMAT_F32:
+    case GST_AUDIO_FORMAT_F64:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/* create or update the resampler for the rate of the master clock as
+ * calculated by the resample slaving method */
+static void
+gst_audio_base_sink_setup_resampler (GstAudioBaseSink * sink)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+  GstAudioInfo *info = &sink->ringbuffer->spec.info;
+  gint in_rate;
+
+  /* the calibration converts external to internal time as
+   * (external - cexternal) * rate_denom / rate_num, the samples need to be
+   * scaled the same way. Before slaving started the rates are the same. */
+  if (priv->rate_num == 0 || priv->rate_denom == 0)
+    in_rate = RESAMPLE_RATE_SCALE;
+  else
+    in_rate = gst_util_uint64_scale_round (RESAMPLE_RATE_SCALE,
+        priv->rate_num, priv->rate_denom);
+  in_rate = CLAMP (in_rate, RESAMPLE_RATE_SCALE / 2, RESAMPLE_RATE_SCALE * 2);
+
+  if (priv->resampler == NULL) {
+    GstClockTime latency;
+
+    GST_DEBUG_OBJECT (sink, "creating resampler, rate %d/%d", in_rate,
+        RESAMPLE_RATE_SCALE);
+    priv->resampler =
+        gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_CUBIC,
+        GST_AUDIO_RESAMPLER_FLAG_VARIABLE_RATE, GST_AUDIO_INFO_FORMAT (info),
+        GST_AUDIO_INFO_CHANNELS (info), in_rate, RESAMPLE_RATE_SCALE, NULL);
+    priv->resampler_in_rate = in_rate;
+
+    latency = gst_util_uint64_scale_int (gst_audio_resampler_get_max_latency
+        (priv->resampler), GST_SECOND, GST_AUDIO_INFO_RATE (info));
+    GST_DEBUG_OBJECT (sink, "resampler latency %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (latency));
+    GST_OBJECT_LOCK (sink);
+    priv->resampler_latency = latency;
+    GST_OBJECT_UNLOCK (sink);
+  } else if (in_rate != priv->resampler_in_rate) {
+    GST_LOG_OBJECT (sink, "updating resampler, rate %d/%d", in_rate,
+        RESAMPLE_RATE_SCALE);
+    gst_audio_resampler_update (priv->resampler, in_rate, RESAMPLE_RATE_SCALE,
+        NULL);
+    priv->resampler_in_rate = in_rate;
+  }
+}
+
+/* resample @in_samples samples in @in with the resampler set up by
+ * gst_audio_base_sink_setup_resampler(). Returns the number of output
+ * samples in @out, which is valid until the next call. Because the resampler
+ * keeps track of the fractional sample position, drift is corrected with
+ * sub-sample precision instead of dropping or repeating samples. */
+static guint
+gst_audio_base_sink_resample (GstAudioBaseSink * sink, gpointer in,
+    guint in_samples, gpointer * out)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+  GstAudioInfo *info = &sink->ringbuffer->spec.info;
+  gsize out_samples, size;
+
+  out_samples = gst_audio_resampler_get_out_frames (priv->resampler,
+      in_samples);
+  size = out_samples * GST_AUDIO_INFO_BPF (info);
+  if (size > priv->resample_buf_size) {
+    priv->resample_buf = g_realloc (priv->resample_buf, size);
+    priv->resample_buf_size = size;
+  }
+
+  gst_audio_resampler_resample (priv->resampler, &in, in_samples,
+      &priv->resample_buf, out_samples);
+  *out = priv->resample_buf;
+
+  GST_LOG_OBJECT (sink, "resampled %u to %" G_GSIZE_FORMAT " samples",
+      in_samples, out_samples);
+
+  return out_samples;
+}
+
 static gint64
 gst_audio_base_sink_get_alignment (GstAudioBaseSink * sink,
     GstClockTime sample_offset)
@@ -1818,11 +1973,12 @@ gst_audio_base_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   gint out_samples;
   GstClockTime base_time, render_delay, latency;
   GstClock *clock;
-  gboolean sync, slaved, align_next;
+  gboolean sync, slaved, align_next, resample = FALSE;
   GstFlowReturn ret;
   GstSegment clip_seg;
   gint64 time_offset;
   GstBuffer *out = NULL;
+  gpointer data;
 
   sink = GST_AUDIO_BASE_SINK (bsink);
   bclass = GST_AUDIO_BASE_SINK_GET_CLASS (sink);
@@ -2030,6 +2186,21 @@ gst_audio_base_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     /* handle clock slaving */
     gst_audio_base_sink_handle_slaving (sink, render_start, render_stop,
         &render_start, &render_stop);
+    /* resample the samples themselves when we can */
+    resample = (sink->priv->slave_method == GST_AUDIO_BASE_SINK_SLAVE_RESAMPLE
+        && bsink->segment.rate == 1.0
+        && gst_audio_base_sink_can_resample (sink));
+    if (resample) {
+      GstClockTime latency;
+
+      gst_audio_base_sink_setup_resampler (sink);
+
+      /* the resampler outputs the samples delayed by its latency, render them
+       * that much earlier */
+      latency = sink->priv->resampler_latency;
+      render_start = render_start > latency ? render_start - latency : 0;
+      render_stop = render_stop > latency ? render_stop - latency : 0;
+    }
   } else {
     /* no slaving needed but we need to adapt to the clock calibration
      * parameters */
@@ -2143,10 +2314,21 @@ no_align:
   accum = 0;
   align_next = TRUE;
   gst_buffer_map (buf, &info, GST_MAP_READ);
+  data = info.data;
+
+  /* when resampling to the master clock, write the resampled samples as they
+   * are instead of letting the ringbuffer drop or repeat samples */
+  if (G_UNLIKELY (resample)) {
+    samples = gst_audio_base_sink_resample (sink, info.data + offset, samples,
+        &data);
+    out_samples = samples;
+    offset = 0;
+  }
+
   do {
     written =
         gst_audio_ring_buffer_commit (ringbuf, &sample_offset,
-        info.data + offset, samples, out_samples, &accum);
+        (guint8 *) data + offset, samples, out_samples, &accum);
 
     GST_DEBUG_OBJECT (sink, "wrote %u of %u", written, samples);
     /* if we wrote all, we're done */
@@ -2490,6 +2672,7 @@ gst_audio_base_sink_change_state (GstElement * element,
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_audio_ring_buffer_activate (sink->ringbuffer, FALSE);
       gst_audio_ring_buffer_release (sink->ringbuffer);
+      gst_audio_base_sink_free_resampler (sink);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       /* we release again here because the acquire happens when setting the
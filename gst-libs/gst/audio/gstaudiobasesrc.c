@@ -39,6 +39,7 @@
 
 #include <gst/audio/audio.h>
 #include "gstaudiobasesrc.h"
+#include "gstaudioutilsprivate.h"
 
 #include "gst/gst-i18n-plugin.h"
 
@@ -32,16 +32,53 @@
  * abstraction for DMA based ringbuffers as well as a pure software
  * implementations.
  *
+ * The device thread never takes the object lock to update the read or write
+ * pointer: gst_audio_ring_buffer_advance() and
+ * gst_audio_ring_buffer_prepare_read() only use atomic operations, and a
+ * reader or writer waiting for a free segment is woken up with a futex where
+ * available.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <string.h>
 
+#if defined (HAVE_LINUX_FUTEX_H) && defined (HAVE_SYS_SYSCALL_H)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#ifndef FUTEX_WAIT_PRIVATE
+#define FUTEX_WAIT_PRIVATE FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE FUTEX_WAKE
+#endif
+#define USE_FUTEX 1
+#endif
+
 #include <gst/audio/audio.h>
 #include "gstaudioringbuffer.h"
+#include "gstaudioutilsprivate.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_audio_ring_buffer_debug);
 #define GST_CAT_DEFAULT gst_audio_ring_buffer_debug
 
+#define GST_AUDIO_RING_BUFFER_GET_PRIVATE(obj)  \
+   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_AUDIO_RING_BUFFER, GstAudioRingBufferPrivate))
+
+struct _GstAudioRingBufferPrivate
+{
+  /* ATOMIC, incremented every time the segment waiter should recheck the
+   * state of the ringbuffer */
+  gint wakeup;
+
+#ifndef USE_FUTEX
+  /* only protects the wakeup counter for the waiter, never taken for long */
+  GMutex lock;
+  GCond cond;
+#endif
+};
+
 static void gst_audio_ring_buffer_dispose (GObject * object);
 static void gst_audio_ring_buffer_finalize (GObject * object);
 
@@ -63,6 +100,8 @@ gst_audio_ring_buffer_class_init (GstAudioRingBufferClass * klass)
   gobject_class = (GObjectClass *) klass;
   gstaudioringbuffer_class = (GstAudioRingBufferClass *) klass;
 
+  g_type_class_add_private (klass, sizeof (GstAudioRingBufferPrivate));
+
   GST_DEBUG_CATEGORY_INIT (gst_audio_ring_buffer_debug, "ringbuffer", 0,
       "ringbuffer class");
 
@@ -76,6 +115,12 @@ gst_audio_ring_buffer_class_init (GstAudioRingBufferClass * klass)
 static void
 gst_audio_ring_buffer_init (GstAudioRingBuffer * ringbuffer)
 {
+  ringbuffer->priv = GST_AUDIO_RING_BUFFER_GET_PRIVATE (ringbuffer);
+#ifndef USE_FUTEX
+  g_mutex_init (&ringbuffer->priv->lock);
+  g_cond_init (&ringbuffer->priv->cond);
+#endif
+
   ringbuffer->open = FALSE;
   ringbuffer->acquired = FALSE;
   ringbuffer->state = GST_AUDIO_RING_BUFFER_STATE_STOPPED;
@@ -104,6 +149,10 @@ gst_audio_ring_buffer_finalize (GObject * object)
   GstAudioRingBuffer *ringbuffer = GST_AUDIO_RING_BUFFER (object);
 
   g_cond_clear (&ringbuffer->cond);
+#ifndef USE_FUTEX
+  g_mutex_clear (&ringbuffer->priv->lock);
+  g_cond_clear (&ringbuffer->priv->cond);
+#endif
   g_free (ringbuffer->empty_seg);
 
   if (ringbuffer->cb_data_notify != NULL)
@@ -907,9 +956,10 @@ gst_audio_ring_buffer_set_flushing (GstAudioRingBuffer * buf, gboolean flushing)
   g_return_if_fail (GST_IS_AUDIO_RING_BUFFER (buf));
 
   GST_OBJECT_LOCK (buf);
-  buf->flushing = flushing;
+  g_atomic_int_set (&buf->flushing, flushing);
 
   if (flushing) {
+    _gst_audio_ring_buffer_wakeup (buf);
     gst_audio_ring_buffer_pause_unlocked (buf);
   } else {
     gst_audio_ring_buffer_clear_all (buf);
@@ -1325,12 +1375,66 @@ gst_audio_ring_buffer_clear_all (GstAudioRingBuffer * buf)
     rclass->clear_all (buf);
 }
 
+#ifdef USE_FUTEX
+static void
+wakeup_wait (GstAudioRingBuffer * buf, gint wakeup)
+{
+  /* returns right away when the counter changed since the waiter read it */
+  syscall (SYS_futex, &buf->priv->wakeup, FUTEX_WAIT_PRIVATE, wakeup, NULL,
+      NULL, 0);
+}
+
+static void
+wakeup_signal (GstAudioRingBuffer * buf)
+{
+  syscall (SYS_futex, &buf->priv->wakeup, FUTEX_WAKE_PRIVATE, G_MAXINT, NULL,
+      NULL, 0);
+}
+#else
+static void
+wakeup_wait (GstAudioRingBuffer * buf, gint wakeup)
+{
+  GstAudioRingBufferPrivate *priv = buf->priv;
+
+  g_mutex_lock (&priv->lock);
+  if (g_atomic_int_get (&priv->wakeup) == wakeup)
+    g_cond_wait (&priv->cond, &priv->lock);
+  g_mutex_unlock (&priv->lock);
+}
+
+static void
+wakeup_signal (GstAudioRingBuffer * buf)
+{
+  GstAudioRingBufferPrivate *priv = buf->priv;
 
+  g_mutex_lock (&priv->lock);
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+}
+#endif
+
+/* Wake up the reader or writer blocked in wait_segment(). This never takes
+ * the object lock so that it can be called from the device thread, the
+ * waiter rechecks the state of the ringbuffer after waking up. Exported for
+ * the GST_AUDIO_RING_BUFFER_SIGNAL and GST_AUDIO_RING_BUFFER_BROADCAST
+ * macros, which subclasses use to unblock the waiter. */
+void
+_gst_audio_ring_buffer_wakeup (GstAudioRingBuffer * buf)
+{
+  g_atomic_int_inc (&buf->priv->wakeup);
+
+  if (g_atomic_int_get (&buf->waiting)) {
+    GST_LOG_OBJECT (buf, "signal waiter");
+    wakeup_signal (buf);
+  }
+}
+
+/* wait until segdone moves away from @segdone, the ringbuffer stops or starts
+ * flushing */
 static gboolean
-wait_segment (GstAudioRingBuffer * buf)
+wait_segment (GstAudioRingBuffer * buf, gint segdone)
 {
-  gint segments;
-  gboolean wait = TRUE;
+  gint wakeup;
 
   /* buffer must be started now or we deadlock since nobody is reading */
   if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
@@ -1340,54 +1444,49 @@ wait_segment (GstAudioRingBuffer * buf)
       goto no_start;
 
     GST_DEBUG_OBJECT (buf, "start!");
-    segments = g_atomic_int_get (&buf->segdone);
     gst_audio_ring_buffer_start (buf);
-
-    /* After starting, the writer may have wrote segments already and then we
-     * don't need to wait anymore */
-    if (G_LIKELY (g_atomic_int_get (&buf->segdone) != segments))
-      wait = FALSE;
   }
 
-  /* take lock first, then update our waiting flag */
-  GST_OBJECT_LOCK (buf);
-  if (G_UNLIKELY (buf->flushing))
+  /* read the wakeup counter before announcing that we wait and checking the
+   * state, any change after this makes the wait below return immediately */
+  wakeup = g_atomic_int_get (&buf->priv->wakeup);
+  g_atomic_int_set (&buf->waiting, 1);
+
+  if (G_UNLIKELY (g_atomic_int_get (&buf->flushing)))
     goto flushing;
 
   if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
           GST_AUDIO_RING_BUFFER_STATE_STARTED))
     goto not_started;
 
-  if (G_LIKELY (wait)) {
-    if (g_atomic_int_compare_and_exchange (&buf->waiting, 0, 1)) {
-      GST_DEBUG_OBJECT (buf, "waiting..");
-      GST_AUDIO_RING_BUFFER_WAIT (buf);
+  /* the writer may have written segments already, e.g. after starting, and
+   * then we don't need to wait anymore */
+  if (G_LIKELY (g_atomic_int_get (&buf->segdone) == segdone)) {
+    GST_DEBUG_OBJECT (buf, "waiting..");
+    wakeup_wait (buf, wakeup);
 
-      if (G_UNLIKELY (buf->flushing))
-        goto flushing;
+    if (G_UNLIKELY (g_atomic_int_get (&buf->flushing)))
+      goto flushing;
 
-      if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
-              GST_AUDIO_RING_BUFFER_STATE_STARTED))
-        goto not_started;
-    }
+    if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
+            GST_AUDIO_RING_BUFFER_STATE_STARTED))
+      goto not_started;
   }
-  GST_OBJECT_UNLOCK (buf);
+  g_atomic_int_set (&buf->waiting, 0);
 
   return TRUE;
 
   /* ERROR */
 not_started:
   {
-    g_atomic_int_compare_and_exchange (&buf->waiting, 1, 0);
+    g_atomic_int_set (&buf->waiting, 0);
     GST_DEBUG_OBJECT (buf, "stopped processing");
-    GST_OBJECT_UNLOCK (buf);
     return FALSE;
   }
 flushing:
   {
-    g_atomic_int_compare_and_exchange (&buf->waiting, 1, 0);
+    g_atomic_int_set (&buf->waiting, 0);
     GST_DEBUG_OBJECT (buf, "flushing");
-    GST_OBJECT_UNLOCK (buf);
     return FALSE;
   }
 no_start:
@@ -1397,8 +1496,6 @@ no_start:
   }
 }
 
-
-
 #define REORDER_SAMPLE(d, s, l)                 \
 G_STMT_START {                                  \
   gint i;                                       \
@@ -1588,7 +1685,7 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
       }
 
       /* else we need to wait for the segment to become writable. */
-      if (!wait_segment (buf))
+      if (!wait_segment (buf, segdone + buf->segbase))
         goto not_started;
     }
 
@@ -1804,7 +1901,7 @@ gst_audio_ring_buffer_read (GstAudioRingBuffer * buf, guint64 sample,
         break;
 
       /* else we need to wait for the segment to become readable. */
-      if (!wait_segment (buf))
+      if (!wait_segment (buf, segdone + buf->segbase))
         goto not_started;
     }
 
@@ -1926,15 +2023,9 @@ gst_audio_ring_buffer_advance (GstAudioRingBuffer * buf, guint advance)
   /* update counter */
   g_atomic_int_add (&buf->segdone, advance);
 
-  /* the lock is already taken when the waiting flag is set,
-   * we grab the lock as well to make sure the waiter is actually
-   * waiting for the signal */
-  if (g_atomic_int_compare_and_exchange (&buf->waiting, 1, 0)) {
-    GST_OBJECT_LOCK (buf);
-    GST_DEBUG_OBJECT (buf, "signal waiter");
-    GST_AUDIO_RING_BUFFER_SIGNAL (buf);
-    GST_OBJECT_UNLOCK (buf);
-  }
+  /* wake up a waiting reader or writer without taking the object lock, which
+   * might be held by the streaming thread for a long time */
+  _gst_audio_ring_buffer_wakeup (buf);
 }
 
 /**
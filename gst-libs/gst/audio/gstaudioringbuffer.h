@@ -40,6 +40,7 @@ G_BEGIN_DECLS
 typedef struct _GstAudioRingBuffer GstAudioRingBuffer;
 typedef struct _GstAudioRingBufferClass GstAudioRingBufferClass;
 typedef struct _GstAudioRingBufferSpec GstAudioRingBufferSpec;
+typedef struct _GstAudioRingBufferPrivate GstAudioRingBufferPrivate;
 
 /**
  * GstAudioRingBufferCallback:
@@ -158,8 +159,11 @@ struct _GstAudioRingBufferSpec
 
 #define GST_AUDIO_RING_BUFFER_GET_COND(buf) (&(((GstAudioRingBuffer *)buf)->cond))
 #define GST_AUDIO_RING_BUFFER_WAIT(buf)     (g_cond_wait (GST_AUDIO_RING_BUFFER_GET_COND (buf), GST_OBJECT_GET_LOCK (buf)))
-#define GST_AUDIO_RING_BUFFER_SIGNAL(buf)   (g_cond_signal (GST_AUDIO_RING_BUFFER_GET_COND (buf)))
-#define GST_AUDIO_RING_BUFFER_BROADCAST(buf)(g_cond_broadcast (GST_AUDIO_RING_BUFFER_GET_COND (buf)))
+/* signalling also wakes up a reader or writer waiting for a segment */
+#define GST_AUDIO_RING_BUFFER_SIGNAL(buf)   (g_cond_signal (GST_AUDIO_RING_BUFFER_GET_COND (buf)), \
+                                             _gst_audio_ring_buffer_wakeup ((GstAudioRingBuffer *)(buf)))
+#define GST_AUDIO_RING_BUFFER_BROADCAST(buf)(g_cond_broadcast (GST_AUDIO_RING_BUFFER_GET_COND (buf)), \
+                                             _gst_audio_ring_buffer_wakeup ((GstAudioRingBuffer *)(buf)))
 
 /**
  * GstAudioRingBuffer:
@@ -213,8 +217,10 @@ struct _GstAudioRingBuffer {
 
   GDestroyNotify              cb_data_notify;
 
+  GstAudioRingBufferPrivate  *priv;
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING - 1];
+  gpointer _gst_reserved[GST_PADDING - 2];
 };
 
 /**
@@ -345,6 +351,10 @@ void            gst_audio_ring_buffer_advance         (GstAudioRingBuffer *buf,
 
 void            gst_audio_ring_buffer_may_start       (GstAudioRingBuffer *buf, gboolean allowed);
 
+/* do not use this one, use the GST_AUDIO_RING_BUFFER_SIGNAL and
+ * GST_AUDIO_RING_BUFFER_BROADCAST macros */
+void            _gst_audio_ring_buffer_wakeup         (GstAudioRingBuffer *buf);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstAudioRingBuffer, gst_object_unref)
 #endif
@@ -18,6 +18,13 @@
  * @short_description: Base class for RTP payloader
  *
  * Provides a base class for RTP payloaders
+ *
+ * Subclasses that split their input into many packets can use
+ * gst_rtp_base_payload_add_packet() to build the packets. The RTP header of
+ * each packet comes from a buffer pool owned by the base class and the
+ * payload references the memory of the input buffer without copying. The
+ * collected packets are pushed downstream in one #GstBufferList with
+ * gst_rtp_base_payload_push_packets().
  */
 
 #ifdef HAVE_CONFIG_H
@@ -62,8 +69,87 @@ struct _GstRTPBasePayloadPrivate
 
   GstCaps *subclass_srccaps;
   GstCaps *sinkcaps;
+
+  /* packets collected with gst_rtp_base_payload_add_packet() */
+  GstBufferPool *header_pool;
+  GstBufferList *packets;
 };
 
+#define RTP_HEADER_LEN                  12
+#define MAX_PAYLOAD_HEADER_LEN          16
+#define HEADER_POOL_SIZE                (RTP_HEADER_LEN + MAX_PAYLOAD_HEADER_LEN)
+
+/* pool for the RTP headers of gst_rtp_base_payload_add_packet(). The payload
+ * memory appended to the header is removed when a buffer is released so that
+ * the header memory can be reused for the next packet. The header memory is
+ * marked with qdata so that buffers of which downstream replaced or merged
+ * the memory are discarded instead of being reused */
+typedef GstBufferPool GstRTPHeaderPool;
+typedef GstBufferPoolClass GstRTPHeaderPoolClass;
+
+static GType gst_rtp_header_pool_get_type (void);
+
+G_DEFINE_TYPE (GstRTPHeaderPool, gst_rtp_header_pool, GST_TYPE_BUFFER_POOL);
+
+static GQuark header_memory_quark;
+
+static GstFlowReturn
+gst_rtp_header_pool_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
+    GstBufferPoolAcquireParams * params)
+{
+  GstFlowReturn ret;
+
+  ret = GST_BUFFER_POOL_CLASS (gst_rtp_header_pool_parent_class)->alloc_buffer
+      (pool, buffer, params);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (gst_buffer_peek_memory
+          (*buffer, 0)), header_memory_quark, pool, NULL);
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_rtp_header_pool_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstMemory *mem = NULL;
+
+  if (gst_buffer_n_memory (buffer) > 0)
+    mem = gst_buffer_peek_memory (buffer, 0);
+
+  /* only reuse the buffer when the first memory is still our header memory,
+   * the memory tag makes the pool discard it otherwise */
+  if (mem != NULL && gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST (mem),
+          header_memory_quark) == pool) {
+    if (gst_buffer_n_memory (buffer) > 1)
+      gst_buffer_remove_memory_range (buffer, 1, -1);
+    gst_buffer_set_size (buffer, HEADER_POOL_SIZE);
+    GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+  } else {
+    GST_DEBUG_OBJECT (pool, "header memory was replaced, discarding buffer");
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+  }
+
+  GST_BUFFER_POOL_CLASS (gst_rtp_header_pool_parent_class)->release_buffer
+      (pool, buffer);
+}
+
+static void
+gst_rtp_header_pool_class_init (GstRTPHeaderPoolClass * klass)
+{
+  header_memory_quark =
+      g_quark_from_static_string ("GstRTPBasePayloadHeaderMemory");
+
+  klass->alloc_buffer = gst_rtp_header_pool_alloc_buffer;
+  klass->release_buffer = gst_rtp_header_pool_release_buffer;
+}
+
+static void
+gst_rtp_header_pool_init (GstRTPHeaderPool * pool)
+{
+}
+
 /* RTPBasePayload signals and args */
 enum
 {
@@ -138,6 +224,7 @@ static GstStateChangeReturn gst_rtp_base_payload_change_state (GstElement *
     element, GstStateChange transition);
 
 static gboolean gst_rtp_base_payload_negotiate (GstRTPBasePayload * payload);
+static void gst_rtp_base_payload_clear_packets (GstRTPBasePayload * payload);
 
 
 static GstElementClass *parent_class = NULL;
@@ -373,6 +460,10 @@ gst_rtp_base_payload_finalize (GObject * object)
   gst_caps_replace (&rtpbasepayload->priv->subclass_srccaps, NULL);
   gst_caps_replace (&rtpbasepayload->priv->sinkcaps, NULL);
 
+  gst_rtp_base_payload_clear_packets (rtpbasepayload);
+  if (rtpbasepayload->priv->header_pool)
+    gst_object_unref (rtpbasepayload->priv->header_pool);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -410,6 +501,7 @@ gst_rtp_base_payload_sink_event_default (GstRTPBasePayload * rtpbasepayload,
       res = gst_pad_event_default (rtpbasepayload->sinkpad, parent, event);
       gst_segment_init (&rtpbasepayload->segment, GST_FORMAT_UNDEFINED);
       gst_event_replace (&rtpbasepayload->priv->pending_segment, NULL);
+      gst_rtp_base_payload_clear_packets (rtpbasepayload);
       break;
     case GST_EVENT_CAPS:
     {
@@ -1341,6 +1433,149 @@ gst_rtp_base_payload_push (GstRTPBasePayload * payload, GstBuffer * buffer)
   return res;
 }
 
+static void
+gst_rtp_base_payload_clear_packets (GstRTPBasePayload * payload)
+{
+  if (payload->priv->packets) {
+    gst_buffer_list_unref (payload->priv->packets);
+    payload->priv->packets = NULL;
+  }
+}
+
+static gboolean
+gst_rtp_base_payload_ensure_header_pool (GstRTPBasePayload * payload)
+{
+  GstRTPBasePayloadPrivate *priv = payload->priv;
+  GstStructure *config;
+
+  if (G_LIKELY (priv->header_pool))
+    return TRUE;
+
+  priv->header_pool = g_object_new (gst_rtp_header_pool_get_type (), NULL);
+  gst_object_ref_sink (priv->header_pool);
+
+  config = gst_buffer_pool_get_config (priv->header_pool);
+  gst_buffer_pool_config_set_params (config, NULL, HEADER_POOL_SIZE, 0, 0);
+
+  if (!gst_buffer_pool_set_config (priv->header_pool, config) ||
+      !gst_buffer_pool_set_active (priv->header_pool, TRUE)) {
+    GST_ERROR_OBJECT (payload, "failed to set up RTP header pool");
+    gst_object_unref (priv->header_pool);
+    priv->header_pool = NULL;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_base_payload_add_packet:
+ * @payload: a #GstRTPBasePayload
+ * @header: (allow-none) (array length=header_len): payload specific header
+ *   bytes to put in front of the payload
+ * @header_len: the length of @header, at most 16 bytes
+ * @buffer: a #GstBuffer with the payload data
+ * @offset: the offset of the payload in @buffer
+ * @size: the size of the payload in @buffer or -1 for everything after
+ *   @offset
+ * @marker: the value of the marker bit
+ *
+ * Build an RTP packet with @size bytes of @buffer starting at @offset as the
+ * payload and add it to the packets that are pushed with
+ * gst_rtp_base_payload_push_packets().
+ *
+ * The RTP header and @header are written into a buffer from a pool of the
+ * payloader and the memory of @buffer is referenced without copying the
+ * data. The timestamps of @buffer are copied to the packet. The SSRC, payload
+ * type, seqnum and timestamp are set when the packets are pushed.
+ *
+ * All packets pushed together with gst_rtp_base_payload_push_packets() get
+ * the RTP timestamp of the first packet, so the packets of each frame need to
+ * be pushed before adding the packets of the next frame.
+ *
+ * Returns: %TRUE if the packet was added.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_rtp_base_payload_add_packet (GstRTPBasePayload * payload,
+    const guint8 * header, guint header_len, GstBuffer * buffer,
+    gsize offset, gssize size, gboolean marker)
+{
+  GstRTPBasePayloadPrivate *priv;
+  GstBuffer *packet = NULL;
+  GstMapInfo map;
+
+  g_return_val_if_fail (GST_IS_RTP_BASE_PAYLOAD (payload), FALSE);
+  g_return_val_if_fail (header != NULL || header_len == 0, FALSE);
+  g_return_val_if_fail (header_len <= MAX_PAYLOAD_HEADER_LEN, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+
+  priv = payload->priv;
+
+  if (!gst_rtp_base_payload_ensure_header_pool (payload))
+    return FALSE;
+
+  if (gst_buffer_pool_acquire_buffer (priv->header_pool, &packet,
+          NULL) != GST_FLOW_OK)
+    goto no_buffer;
+
+  gst_buffer_map (packet, &map, GST_MAP_WRITE);
+  map.data[0] = GST_RTP_VERSION << 6;
+  map.data[1] = (marker ? 0x80 : 0x00) | (payload->pt & 0x7f);
+  memset (map.data + 2, 0, RTP_HEADER_LEN - 2);
+  if (header_len > 0)
+    memcpy (map.data + RTP_HEADER_LEN, header, header_len);
+  gst_buffer_unmap (packet, &map);
+  gst_buffer_set_size (packet, RTP_HEADER_LEN + header_len);
+
+  if (size != 0)
+    gst_buffer_copy_into (packet, buffer, GST_BUFFER_COPY_MEMORY, offset, size);
+
+  GST_BUFFER_PTS (packet) = GST_BUFFER_PTS (buffer);
+  GST_BUFFER_DTS (packet) = GST_BUFFER_DTS (buffer);
+
+  if (priv->packets == NULL)
+    priv->packets = gst_buffer_list_new ();
+  gst_buffer_list_add (priv->packets, packet);
+
+  return TRUE;
+
+  /* ERRORS */
+no_buffer:
+  {
+    GST_DEBUG_OBJECT (payload, "could not acquire RTP header buffer");
+    return FALSE;
+  }
+}
+
+/**
+ * gst_rtp_base_payload_push_packets:
+ * @payload: a #GstRTPBasePayload
+ *
+ * Push the packets built with gst_rtp_base_payload_add_packet() as one
+ * #GstBufferList with gst_rtp_base_payload_push_list().
+ *
+ * Returns: a #GstFlowReturn, %GST_FLOW_OK when there were no packets.
+ *
+ * Since: 1.14
+ */
+GstFlowReturn
+gst_rtp_base_payload_push_packets (GstRTPBasePayload * payload)
+{
+  GstBufferList *list;
+
+  g_return_val_if_fail (GST_IS_RTP_BASE_PAYLOAD (payload), GST_FLOW_ERROR);
+
+  list = payload->priv->packets;
+  payload->priv->packets = NULL;
+
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  return gst_rtp_base_payload_push_list (payload, list);
+}
+
 static GstStructure *
 gst_rtp_base_payload_create_stats (GstRTPBasePayload * rtpbasepayload)
 {
@@ -1535,6 +1770,12 @@ gst_rtp_base_payload_change_state (GstElement * element,
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_event_replace (&rtpbasepayload->priv->pending_segment, NULL);
+      gst_rtp_base_payload_clear_packets (rtpbasepayload);
+      if (rtpbasepayload->priv->header_pool) {
+        gst_buffer_pool_set_active (rtpbasepayload->priv->header_pool, FALSE);
+        gst_object_unref (rtpbasepayload->priv->header_pool);
+        rtpbasepayload->priv->header_pool = NULL;
+      }
       break;
     default:
       break;
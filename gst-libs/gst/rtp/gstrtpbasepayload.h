@@ -165,6 +165,15 @@ GstFlowReturn   gst_rtp_base_payload_push               (GstRTPBasePayload *payl
 GstFlowReturn   gst_rtp_base_payload_push_list          (GstRTPBasePayload *payload,
                                                          GstBufferList *list);
 
+gboolean        gst_rtp_base_payload_add_packet         (GstRTPBasePayload *payload,
+                                                         const guint8 *header,
+                                                         guint header_len,
+                                                         GstBuffer *buffer,
+                                                         gsize offset, gssize size,
+                                                         gboolean marker);
+
+GstFlowReturn   gst_rtp_base_payload_push_packets       (GstRTPBasePayload *payload);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstRTPBasePayload, gst_object_unref)
 #endif
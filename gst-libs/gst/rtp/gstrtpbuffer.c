@@ -28,6 +28,10 @@
  * #GstBuffer objects that contain RTP payloads. These buffers are typically of
  * 'application/x-rtp' #GstCaps.
  *
+ * When only the fixed header fields of a packet are needed, for example to
+ * sort or drop packets by sequence number, gst_rtp_buffer_peek_header() and
+ * gst_rtp_buffer_list_peek_headers() read and validate them without mapping
+ * the complete packet.
  */
 
 #include "gstrtpbuffer.h"
@@ -368,15 +372,26 @@ gst_rtp_buffer_map (GstBuffer * buffer, GstMapFlags flags, GstRTPBuffer * rtp)
     guint8 *extdata;
     guint16 extlen;
 
-    /* find memory for the extension bits, we find the block for the first 4
-     * bytes, all other extension bytes should also be in this block */
-    if (!gst_buffer_find_memory (buffer, header_len, 4, &idx, &length, &skip))
-      goto wrong_length;
+    if (n_mem == 1) {
+      /* everything is in the first memory, no need to map it again */
+      if (G_UNLIKELY (size < header_len + 4))
+        goto wrong_length;
+
+      extdata = rtp->data[1] = data + header_len;
+      length = size - header_len;
+    } else {
+      /* find memory for the extension bits, we find the block for the first 4
+       * bytes, all other extension bytes should also be in this block */
+      if (!gst_buffer_find_memory (buffer, header_len, 4, &idx, &length,
+              &skip))
+        goto wrong_length;
 
-    if (!gst_buffer_map_range (buffer, idx, length, &rtp->map[1], flags))
-      goto map_failed;
+      if (!gst_buffer_map_range (buffer, idx, length, &rtp->map[1], flags))
+        goto map_failed;
 
-    extdata = rtp->data[1] = rtp->map[1].data + skip;
+      extdata = rtp->data[1] = rtp->map[1].data + skip;
+      length = rtp->map[1].size;
+    }
     /* skip id */
     extdata += 2;
     /* read length as the number of 32 bits words */
@@ -386,7 +401,7 @@ gst_rtp_buffer_map (GstBuffer * buffer, GstMapFlags flags, GstRTPBuffer * rtp)
     extlen += 4;
 
     /* all extension bytes must be in this block */
-    if (G_UNLIKELY (rtp->map[1].size < extlen))
+    if (G_UNLIKELY (length < extlen))
       goto wrong_length;
 
     rtp->size[1] = extlen;
@@ -400,15 +415,26 @@ gst_rtp_buffer_map (GstBuffer * buffer, GstMapFlags flags, GstRTPBuffer * rtp)
   /* check for padding unless flags says to skip */
   if ((data[0] & 0x20) != 0 &&
       (flags & GST_RTP_BUFFER_MAP_FLAG_SKIP_PADDING) == 0) {
-    /* find memory for the padding bits */
-    if (!gst_buffer_find_memory (buffer, bufsize - 1, 1, &idx, &length, &skip))
-      goto wrong_length;
+    guint8 *paddata;
+
+    if (n_mem == 1) {
+      /* the padding is in the first memory that we already mapped */
+      paddata = data;
+      skip = size - 1;
+    } else {
+      /* find memory for the padding bits */
+      if (!gst_buffer_find_memory (buffer, bufsize - 1, 1, &idx, &length,
+              &skip))
+        goto wrong_length;
+
+      if (!gst_buffer_map_range (buffer, idx, length, &rtp->map[3], flags))
+        goto map_failed;
 
-    if (!gst_buffer_map_range (buffer, idx, length, &rtp->map[3], flags))
-      goto map_failed;
+      paddata = rtp->map[3].data;
+    }
 
-    padding = rtp->map[3].data[skip];
-    rtp->data[3] = rtp->map[3].data + skip + 1 - padding;
+    padding = paddata[skip];
+    rtp->data[3] = paddata + skip + 1 - padding;
     rtp->size[3] = padding;
 
     if (skip + 1 < padding)
@@ -511,6 +537,160 @@ gst_rtp_buffer_unmap (GstRTPBuffer * rtp)
   rtp->buffer = NULL;
 }
 
+static inline gboolean
+parse_header (const guint8 * data, gsize bufsize, GstRTPHeaderInfo * info)
+{
+  guint header_len;
+  guint8 pt;
+
+  /* same checks as gst_rtp_buffer_map() */
+  if (G_UNLIKELY ((data[0] & 0xc0) != (GST_RTP_VERSION << 6)))
+    goto wrong_version;
+
+  pt = data[1];
+  if (G_UNLIKELY (pt >= 200 && pt <= 204))
+    goto reserved_pt;
+
+  header_len = GST_RTP_HEADER_LEN + (data[0] & 0x0f) * sizeof (guint32);
+
+  /* the CSRCs and the extension header must fit in the packet, we don't look
+   * at the extension length or the padding */
+  if (G_UNLIKELY (bufsize < header_len + ((data[0] & 0x10) ? 4 : 0)))
+    goto wrong_length;
+
+  info->marker = (pt & 0x80) != 0;
+  info->payload_type = pt & 0x7f;
+  info->seq = GST_READ_UINT16_BE (data + 2);
+  info->timestamp = GST_READ_UINT32_BE (data + 4);
+  info->ssrc = GST_READ_UINT32_BE (data + 8);
+  info->csrc_count = data[0] & 0x0f;
+  info->padding = (data[0] & 0x20) != 0;
+  info->extension = (data[0] & 0x10) != 0;
+  info->header_len = header_len;
+
+  return TRUE;
+
+  /* ERRORS */
+wrong_version:
+  {
+    GST_DEBUG ("version check failed (%d != %d)", data[0] >> 6,
+        GST_RTP_VERSION);
+    return FALSE;
+  }
+reserved_pt:
+  {
+    GST_DEBUG ("reserved PT %d found", pt);
+    return FALSE;
+  }
+wrong_length:
+  {
+    GST_DEBUG ("length check failed");
+    return FALSE;
+  }
+}
+
+static gboolean
+peek_header (GstBuffer * buffer, GstRTPHeaderInfo * info)
+{
+  guint8 header[GST_RTP_HEADER_LEN];
+  GstMemory *mem;
+  GstMapInfo map;
+  gsize bufsize;
+  gboolean res;
+
+  if (G_UNLIKELY (gst_buffer_n_memory (buffer) < 1))
+    return FALSE;
+
+  bufsize = gst_buffer_get_size (buffer);
+
+  /* the fixed header is nearly always in the first memory, only map that one
+   * and copy the header out in the rare case where it is split */
+  mem = gst_buffer_peek_memory (buffer, 0);
+  if (!gst_memory_map (mem, &map, GST_MAP_READ))
+    return FALSE;
+
+  if (G_LIKELY (map.size >= GST_RTP_HEADER_LEN)) {
+    res = parse_header (map.data, bufsize, info);
+    gst_memory_unmap (mem, &map);
+  } else {
+    gst_memory_unmap (mem, &map);
+
+    if (gst_buffer_extract (buffer, 0, header,
+            GST_RTP_HEADER_LEN) != GST_RTP_HEADER_LEN)
+      return FALSE;
+
+    res = parse_header (header, bufsize, info);
+  }
+
+  if (res)
+    info->buffer = buffer;
+
+  return res;
+}
+
+/**
+ * gst_rtp_buffer_peek_header:
+ * @buffer: a #GstBuffer
+ * @info: (out caller-allocates): a #GstRTPHeaderInfo
+ *
+ * Read the fixed RTP header of @buffer into @info. This only maps the memory
+ * containing the header and performs the same version and payload type checks
+ * as gst_rtp_buffer_map(). The length of the header extension and the padding
+ * are not validated.
+ *
+ * Returns: %TRUE if @buffer starts with a valid RTP header.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_rtp_buffer_peek_header (GstBuffer * buffer, GstRTPHeaderInfo * info)
+{
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (info != NULL, FALSE);
+
+  return peek_header (buffer, info);
+}
+
+/**
+ * gst_rtp_buffer_list_peek_headers:
+ * @list: a #GstBufferList
+ * @infos: (out caller-allocates) (array length=n_infos): an array of
+ *     #GstRTPHeaderInfo
+ * @n_infos: the number of elements in @infos
+ *
+ * Read the fixed RTP headers of all buffers in @list in one pass, as with
+ * gst_rtp_buffer_peek_header(). The headers of the valid packets are stored in
+ * list order in @infos, invalid packets are skipped. The @buffer field of each
+ * #GstRTPHeaderInfo can be used to find the packet in @list again, for
+ * example after sorting @infos with gst_rtp_buffer_compare_seqnum().
+ *
+ * Parsing stops when @infos is full, an array with
+ * gst_buffer_list_length() elements is always large enough.
+ *
+ * Returns: the number of valid packets stored in @infos.
+ *
+ * Since: 1.14
+ */
+guint
+gst_rtp_buffer_list_peek_headers (GstBufferList * list,
+    GstRTPHeaderInfo * infos, guint n_infos)
+{
+  guint i, len, n = 0;
+
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (list), 0);
+  g_return_val_if_fail (infos != NULL || n_infos == 0, 0);
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len && n < n_infos; i++) {
+    if (peek_header (gst_buffer_list_get (list, i), &infos[n]))
+      n++;
+    else
+      GST_DEBUG ("dropping invalid packet %d of list %p", i, list);
+  }
+
+  return n;
+}
+
 
 /**
  * gst_rtp_buffer_set_packet_len:
@@ -793,13 +973,16 @@ ensure_buffers (GstRTPBuffer * rtp)
 
   for (i = 0, pos = 0; i < 4; i++) {
     if (rtp->size[i]) {
-      gsize offset = (guint8 *) rtp->data[i] - rtp->map[i].data;
+      /* extension and padding of single memory buffers point into the
+       * header map */
+      GstMapInfo *map = rtp->map[i].memory ? &rtp->map[i] : &rtp->map[0];
+      gsize offset = (guint8 *) rtp->data[i] - map->data;
 
-      if (offset != 0 || rtp->map[i].size != rtp->size[i]) {
+      if (offset != 0 || map->size != rtp->size[i]) {
         GstMemory *mem;
 
         /* make copy */
-        mem = gst_memory_copy (rtp->map[i].memory, offset, rtp->size[i]);
+        mem = gst_memory_copy (map->memory, offset, rtp->size[i]);
 
         /* insert new memory */
         gst_buffer_insert_memory (rtp->buffer, pos, mem);
@@ -38,6 +38,7 @@ G_BEGIN_DECLS
 
 
 typedef struct _GstRTPBuffer GstRTPBuffer;
+typedef struct _GstRTPHeaderInfo GstRTPHeaderInfo;
 
 /**
  * GstRTPBuffer:
@@ -62,6 +63,41 @@ struct _GstRTPBuffer
 #define GST_RTP_BUFFER_INIT { NULL, 0, { NULL, NULL, NULL, NULL}, { 0, 0, 0, 0 }, \
   { GST_MAP_INFO_INIT, GST_MAP_INFO_INIT, GST_MAP_INFO_INIT, GST_MAP_INFO_INIT} }
 
+/**
+ * GstRTPHeaderInfo:
+ * @buffer: the #GstBuffer the header was read from
+ * @seq: the sequence number
+ * @payload_type: the payload type
+ * @csrc_count: the number of CSRCs
+ * @timestamp: the RTP timestamp
+ * @ssrc: the SSRC
+ * @marker: the marker bit
+ * @padding: %TRUE when the padding bit is set
+ * @extension: %TRUE when the extension bit is set
+ * @header_len: the length of the fixed header and the CSRC list
+ *
+ * The fixed header fields of an RTP packet as read by
+ * gst_rtp_buffer_peek_header().
+ *
+ * Since: 1.14
+ */
+struct _GstRTPHeaderInfo
+{
+  GstBuffer   *buffer;
+  guint16      seq;
+  guint8       payload_type;
+  guint8       csrc_count;
+  guint32      timestamp;
+  guint32      ssrc;
+  gboolean     marker;
+  gboolean     padding;
+  gboolean     extension;
+  guint        header_len;
+
+  /*< private >*/
+  gpointer     _gst_reserved[GST_PADDING];
+};
+
 /* creating buffers */
 void            gst_rtp_buffer_allocate_data         (GstBuffer *buffer, guint payload_len,
                                                       guint8 pad_len, guint8 csrc_count);
@@ -78,6 +114,10 @@ guint           gst_rtp_buffer_calc_payload_len      (guint packet_len, guint8 p
 gboolean        gst_rtp_buffer_map                   (GstBuffer *buffer, GstMapFlags flags, GstRTPBuffer *rtp);
 void            gst_rtp_buffer_unmap                 (GstRTPBuffer *rtp);
 
+gboolean        gst_rtp_buffer_peek_header           (GstBuffer *buffer, GstRTPHeaderInfo *info);
+guint           gst_rtp_buffer_list_peek_headers     (GstBufferList *list, GstRTPHeaderInfo *infos,
+                                                      guint n_infos);
+
 void            gst_rtp_buffer_set_packet_len        (GstRTPBuffer *rtp, guint len);
 guint           gst_rtp_buffer_get_packet_len        (GstRTPBuffer *rtp);
 
@@ -28,6 +28,11 @@
  * The videofilter will by default enable QoS on the parent GstBaseTransform
  * to implement frame dropping.
  *
+ * Subclasses that implement transform_frame can allow the conversion of the
+ * next frames to start while the previous ones are still being pushed
+ * downstream with gst_video_filter_set_max_in_flight(). The frames are then
+ * transformed in order on a separate thread.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -43,10 +48,280 @@
 GST_DEBUG_CATEGORY_STATIC (gst_video_filter_debug);
 #define GST_CAT_DEFAULT gst_video_filter_debug
 
+#define GST_VIDEO_FILTER_GET_PRIVATE(obj) \
+    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_VIDEO_FILTER, \
+        GstVideoFilterPrivate))
+
+typedef struct _GstVideoFilterJob GstVideoFilterJob;
+typedef struct _GstVideoFilterPrivate GstVideoFilterPrivate;
+
+/* A frame in flight. Jobs without frames were produced without
+ * transform_frame (in place or passthrough) and only keep their place in the
+ * output order. */
+struct _GstVideoFilterJob
+{
+  GstVideoFrame in_frame;
+  GstVideoFrame out_frame;
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+
+  gboolean done;
+  GstFlowReturn ret;
+  /* dropped by a flush while transform() still owns the output buffer */
+  gboolean flushed;
+};
+
+struct _GstVideoFilterPrivate
+{
+  GMutex lock;
+  GCond cond;
+
+  guint max_in_flight;
+
+  /* all jobs in output order */
+  GQueue jobs;
+  /* jobs waiting for the worker thread */
+  GQueue todo;
+  /* job queued by the last transform() */
+  GstVideoFilterJob *pending;
+
+  GThread *thread;
+  gboolean quit;
+  /* no new worker is started while stopping */
+  gboolean stopping;
+
+  /* result of the last drain, reported until the next flush */
+  GstFlowReturn drain_ret;
+};
+
 #define gst_video_filter_parent_class parent_class
 G_DEFINE_ABSTRACT_TYPE (GstVideoFilter, gst_video_filter,
     GST_TYPE_BASE_TRANSFORM);
 
+static gpointer
+gst_video_filter_worker_func (GstVideoFilter * filter)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstVideoFilterClass *fclass = GST_VIDEO_FILTER_GET_CLASS (filter);
+
+  g_mutex_lock (&priv->lock);
+  while (TRUE) {
+    GstVideoFilterJob *job;
+    GstFlowReturn ret;
+
+    while (!priv->quit && g_queue_is_empty (&priv->todo))
+      g_cond_wait (&priv->cond, &priv->lock);
+
+    if (priv->quit)
+      break;
+
+    job = g_queue_pop_head (&priv->todo);
+    g_mutex_unlock (&priv->lock);
+
+    ret = fclass->transform_frame (filter, &job->in_frame, &job->out_frame);
+
+    gst_video_frame_unmap (&job->out_frame);
+    gst_video_frame_unmap (&job->in_frame);
+    gst_buffer_unref (job->inbuf);
+
+    g_mutex_lock (&priv->lock);
+    job->inbuf = NULL;
+    job->ret = ret;
+    job->done = TRUE;
+    g_cond_broadcast (&priv->cond);
+  }
+  g_mutex_unlock (&priv->lock);
+
+  return NULL;
+}
+
+/* call with the lock */
+static GstVideoFilterJob *
+gst_video_filter_pop_job (GstVideoFilter * filter)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstVideoFilterJob *job;
+
+  job = g_queue_peek_head (&priv->jobs);
+  if (job == NULL)
+    return NULL;
+
+  while (!job->done)
+    g_cond_wait (&priv->cond, &priv->lock);
+
+  return g_queue_pop_head (&priv->jobs);
+}
+
+/* call with the lock, wait until fewer than @limit frames are still being
+ * transformed by the worker */
+static void
+gst_video_filter_wait_busy (GstVideoFilter * filter, guint limit)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+
+  while (TRUE) {
+    GList *walk;
+    guint busy = 0;
+
+    for (walk = priv->jobs.head; walk; walk = walk->next) {
+      if (!((GstVideoFilterJob *) walk->data)->done)
+        busy++;
+    }
+    if (busy < limit)
+      break;
+
+    g_cond_wait (&priv->cond, &priv->lock);
+  }
+}
+
+/* push all frames in flight downstream, call from the streaming thread.
+ * Returns the first error of the frames or of the push, which is kept until
+ * the next flush. */
+static GstFlowReturn
+gst_video_filter_drain (GstVideoFilter * filter)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (filter);
+  GstVideoFilterJob *job;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&priv->lock);
+  while ((job = gst_video_filter_pop_job (filter))) {
+    g_mutex_unlock (&priv->lock);
+
+    if (ret == GST_FLOW_OK)
+      ret = job->ret;
+
+    if (ret == GST_FLOW_OK) {
+      GST_LOG_OBJECT (filter, "draining %" GST_PTR_FORMAT, job->outbuf);
+      ret = gst_pad_push (trans->srcpad, job->outbuf);
+    } else {
+      GST_DEBUG_OBJECT (filter, "dropping frame in flight: %s",
+          gst_flow_get_name (ret));
+      gst_buffer_unref (job->outbuf);
+    }
+    g_slice_free (GstVideoFilterJob, job);
+
+    g_mutex_lock (&priv->lock);
+  }
+  if (ret != GST_FLOW_OK && priv->drain_ret == GST_FLOW_OK)
+    priv->drain_ret = ret;
+  g_mutex_unlock (&priv->lock);
+
+  return ret;
+}
+
+/* drop all frames in flight, only the frame the worker is transforming is
+ * waited for. This can run on the application thread while the streaming
+ * thread is between transform() and generate_output(), the output buffer of
+ * the job queued by that transform() is left to the streaming thread. */
+static void
+gst_video_filter_flush (GstVideoFilter * filter)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstVideoFilterJob *job;
+
+  g_mutex_lock (&priv->lock);
+  /* cancel the jobs the worker did not start yet */
+  while ((job = g_queue_pop_head (&priv->todo))) {
+    gst_video_frame_unmap (&job->out_frame);
+    gst_video_frame_unmap (&job->in_frame);
+    gst_buffer_unref (job->inbuf);
+    job->inbuf = NULL;
+    job->ret = GST_FLOW_FLUSHING;
+    job->done = TRUE;
+  }
+  while ((job = gst_video_filter_pop_job (filter))) {
+    if (job == priv->pending) {
+      job->ret = GST_FLOW_FLUSHING;
+      job->flushed = TRUE;
+      continue;
+    }
+    gst_buffer_unref (job->outbuf);
+    g_slice_free (GstVideoFilterJob, job);
+  }
+  priv->drain_ret = GST_FLOW_OK;
+  g_mutex_unlock (&priv->lock);
+}
+
+/* wait until the worker is done with all frames in flight */
+static void
+gst_video_filter_wait (GstVideoFilter * filter)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstVideoFilterJob *job;
+
+  g_mutex_lock (&priv->lock);
+  while ((job = g_queue_peek_tail (&priv->jobs)) && !job->done)
+    g_cond_wait (&priv->cond, &priv->lock);
+  g_mutex_unlock (&priv->lock);
+}
+
+static void
+gst_video_filter_stop_worker (GstVideoFilter * filter)
+{
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GThread *thread;
+
+  g_mutex_lock (&priv->lock);
+  priv->stopping = TRUE;
+  g_mutex_unlock (&priv->lock);
+
+  gst_video_filter_flush (filter);
+
+  g_mutex_lock (&priv->lock);
+  priv->quit = TRUE;
+  g_cond_broadcast (&priv->cond);
+  thread = priv->thread;
+  priv->thread = NULL;
+  g_mutex_unlock (&priv->lock);
+
+  if (thread)
+    g_thread_join (thread);
+
+  priv->quit = FALSE;
+}
+
+/**
+ * gst_video_filter_set_max_in_flight:
+ * @filter: a #GstVideoFilter
+ * @max_in_flight: maximum number of frames in flight
+ *
+ * Allow up to @max_in_flight frames to be transformed before the oldest
+ * one is pushed downstream. With a value bigger than 1, transform_frame is
+ * called on a separate thread, one frame at a time and in order, so that
+ * the transformation of the next frame can run while the previous frame is
+ * being pushed and the next input buffer is received. This adds
+ * @max_in_flight - 1 frames of latency.
+ *
+ * Frames in flight are pushed downstream before serialized events and before
+ * renegotiation, transform_frame and set_info are never called concurrently.
+ * When the maximum is lowered, the next frame is only transformed once fewer
+ * than @max_in_flight frames are still being transformed.
+ *
+ * This only has an effect on filters that implement transform_frame and
+ * that are not operating in place or in passthrough mode. The default is 1,
+ * every frame is transformed and pushed before the next one is accepted.
+ *
+ * Since: 1.14
+ */
+void
+gst_video_filter_set_max_in_flight (GstVideoFilter * filter,
+    guint max_in_flight)
+{
+  GstVideoFilterPrivate *priv;
+
+  g_return_if_fail (GST_IS_VIDEO_FILTER (filter));
+  g_return_if_fail (max_in_flight > 0);
+
+  priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+
+  g_mutex_lock (&priv->lock);
+  priv->max_in_flight = max_in_flight;
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+}
+
 /* Answer the allocation query downstream. */
 static gboolean
 gst_video_filter_propose_allocation (GstBaseTransform * trans,
@@ -119,15 +394,25 @@ config_failed:
 static gboolean
 gst_video_filter_decide_allocation (GstBaseTransform * trans, GstQuery * query)
 {
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (trans);
   GstBufferPool *pool = NULL;
   GstStructure *config;
-  guint min, max, size;
+  guint min, max, size, extra;
   gboolean update_pool;
   GstCaps *outcaps = NULL;
 
+  g_mutex_lock (&priv->lock);
+  extra = priv->max_in_flight - 1;
+  g_mutex_unlock (&priv->lock);
+
   if (gst_query_get_n_allocation_pools (query) > 0) {
     gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
 
+    /* we keep this many buffers while they are being transformed */
+    min += extra;
+    if (max != 0 && max < min)
+      max = min;
+
     update_pool = TRUE;
   } else {
     GstVideoInfo vinfo;
@@ -136,7 +421,8 @@ gst_video_filter_decide_allocation (GstBaseTransform * trans, GstQuery * query)
     gst_video_info_init (&vinfo);
     gst_video_info_from_caps (&vinfo, outcaps);
     size = vinfo.size;
-    min = max = 0;
+    min = extra;
+    max = 0;
     update_pool = FALSE;
   }
 
@@ -215,6 +501,9 @@ gst_video_filter_set_caps (GstBaseTransform * trans, GstCaps * incaps,
   if (!gst_video_info_from_caps (&out_info, outcaps))
     goto invalid_caps;
 
+  /* never reconfigure while frames are being transformed */
+  gst_video_filter_wait (filter);
+
   fclass = GST_VIDEO_FILTER_GET_CLASS (filter);
   if (fclass->set_info)
     res = fclass->set_info (filter, incaps, &in_info, outcaps, &out_info);
@@ -248,15 +537,81 @@ gst_video_filter_transform (GstBaseTransform * trans, GstBuffer * inbuf,
 {
   GstFlowReturn res;
   GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
   GstVideoFilterClass *fclass;
 
   if (G_UNLIKELY (!filter->negotiated))
     goto unknown_format;
 
   fclass = GST_VIDEO_FILTER_GET_CLASS (filter);
-  if (fclass->transform_frame) {
+  if (fclass->transform_frame && priv->max_in_flight > 1) {
+    GstVideoFilterJob *job;
+
+    job = g_slice_new0 (GstVideoFilterJob);
+
+    if (!gst_video_frame_map (&job->in_frame, &filter->in_info, inbuf,
+            GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF))
+      goto invalid_job_buffer;
+
+    if (!gst_video_frame_map (&job->out_frame, &filter->out_info, outbuf,
+            GST_MAP_WRITE | GST_VIDEO_FRAME_MAP_FLAG_NO_REF)) {
+      gst_video_frame_unmap (&job->in_frame);
+      goto invalid_job_buffer;
+    }
+
+    /* the base class unrefs the input buffer when we return */
+    job->inbuf = gst_buffer_ref (inbuf);
+    job->outbuf = outbuf;
+
+    g_mutex_lock (&priv->lock);
+    /* after lowering the maximum, wait for the frames above it */
+    gst_video_filter_wait_busy (filter, priv->max_in_flight);
+    if (priv->stopping) {
+      /* the worker was stopped, transform the frame right away */
+      g_mutex_unlock (&priv->lock);
+
+      res = fclass->transform_frame (filter, &job->in_frame, &job->out_frame);
+
+      gst_video_frame_unmap (&job->out_frame);
+      gst_video_frame_unmap (&job->in_frame);
+      gst_buffer_unref (job->inbuf);
+      g_slice_free (GstVideoFilterJob, job);
+
+      return res;
+    }
+    if (priv->thread == NULL) {
+      GError *err = NULL;
+
+      priv->thread = g_thread_try_new ("videofilter",
+          (GThreadFunc) gst_video_filter_worker_func, filter, &err);
+      if (priv->thread == NULL) {
+        g_mutex_unlock (&priv->lock);
+        GST_ELEMENT_ERROR (filter, RESOURCE, FAILED, (NULL),
+            ("failed to start thread: %s", err->message));
+        g_clear_error (&err);
+        gst_video_frame_unmap (&job->out_frame);
+        gst_video_frame_unmap (&job->in_frame);
+        gst_buffer_unref (job->inbuf);
+        g_slice_free (GstVideoFilterJob, job);
+        return GST_FLOW_ERROR;
+      }
+    }
+    g_queue_push_tail (&priv->jobs, job);
+    g_queue_push_tail (&priv->todo, job);
+    priv->pending = job;
+    g_cond_broadcast (&priv->cond);
+    g_mutex_unlock (&priv->lock);
+
+    res = GST_FLOW_OK;
+  } else if (fclass->transform_frame) {
     GstVideoFrame in_frame, out_frame;
 
+    /* the worker may still be busy with frames queued before the maximum
+     * was lowered to 1, transform_frame is never called concurrently */
+    g_mutex_lock (&priv->lock);
+    gst_video_filter_wait_busy (filter, 1);
+    g_mutex_unlock (&priv->lock);
+
     if (!gst_video_frame_map (&in_frame, &filter->in_info, inbuf,
             GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF))
       goto invalid_buffer;
@@ -283,6 +638,11 @@ unknown_format:
         ("unknown format"));
     return GST_FLOW_NOT_NEGOTIATED;
   }
+invalid_job_buffer:
+  {
+    g_slice_free (GstVideoFilterJob, job);
+    goto invalid_buffer;
+  }
 invalid_buffer:
   {
     GST_ELEMENT_WARNING (filter, CORE, NOT_IMPLEMENTED, (NULL),
@@ -291,6 +651,235 @@ invalid_buffer:
   }
 }
 
+static GstFlowReturn
+gst_video_filter_submit_input_buffer (GstBaseTransform * trans,
+    gboolean is_discont, GstBuffer * input)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstFlowReturn ret;
+  gboolean in_flight;
+
+  g_mutex_lock (&priv->lock);
+  in_flight = !g_queue_is_empty (&priv->jobs);
+  ret = priv->drain_ret;
+  g_mutex_unlock (&priv->lock);
+
+  /* renegotiation happens when the input is submitted, push what we have
+   * with the old caps first */
+  if (ret == GST_FLOW_OK && in_flight
+      && gst_pad_needs_reconfigure (trans->srcpad))
+    ret = gst_video_filter_drain (filter);
+
+  if (ret != GST_FLOW_OK)
+    goto drain_failed;
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->submit_input_buffer (trans,
+      is_discont, input);
+
+  /* ERRORS */
+drain_failed:
+  {
+    GST_DEBUG_OBJECT (filter, "dropping input, draining failed: %s",
+        gst_flow_get_name (ret));
+    gst_buffer_unref (input);
+    return ret;
+  }
+}
+
+static GstFlowReturn
+gst_video_filter_generate_output (GstBaseTransform * trans,
+    GstBuffer ** outbuf)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstVideoFilterJob *job;
+  GstFlowReturn ret;
+
+  ret = GST_BASE_TRANSFORM_CLASS (parent_class)->generate_output (trans,
+      outbuf);
+
+  g_mutex_lock (&priv->lock);
+  if (priv->pending && priv->pending->flushed) {
+    /* a flush dropped the frames in flight after transform() */
+    g_assert (*outbuf == priv->pending->outbuf);
+    g_slice_free (GstVideoFilterJob, priv->pending);
+    priv->pending = NULL;
+    gst_buffer_unref (*outbuf);
+    *outbuf = NULL;
+    ret = GST_FLOW_FLUSHING;
+    goto done;
+  }
+
+  if (priv->drain_ret != GST_FLOW_OK && ret == GST_FLOW_OK) {
+    /* a drain failed after the input was submitted */
+    if (priv->pending) {
+      g_assert (*outbuf == priv->pending->outbuf);
+      priv->pending = NULL;
+    } else if (*outbuf) {
+      gst_buffer_unref (*outbuf);
+    }
+    *outbuf = NULL;
+    ret = priv->drain_ret;
+    goto done;
+  }
+
+  if (priv->pending) {
+    /* transform() queued the output buffer, it's not ready yet */
+    g_assert (*outbuf == priv->pending->outbuf);
+    priv->pending = NULL;
+    *outbuf = NULL;
+  } else if (*outbuf && !g_queue_is_empty (&priv->jobs)) {
+    /* produced without the worker, keep it behind the frames in flight */
+    job = g_slice_new0 (GstVideoFilterJob);
+    job->outbuf = *outbuf;
+    job->done = TRUE;
+    job->ret = GST_FLOW_OK;
+    g_queue_push_tail (&priv->jobs, job);
+    *outbuf = NULL;
+  }
+
+  if (ret != GST_FLOW_OK || *outbuf != NULL)
+    goto done;
+
+  /* output the oldest frame if it is ready, or if we have too many in
+   * flight */
+  job = g_queue_peek_head (&priv->jobs);
+  if (job == NULL)
+    goto done;
+
+  if (!job->done && g_queue_get_length (&priv->jobs) < priv->max_in_flight)
+    goto done;
+
+  job = gst_video_filter_pop_job (filter);
+  ret = job->ret;
+  if (ret == GST_FLOW_OK)
+    *outbuf = job->outbuf;
+  else
+    gst_buffer_unref (job->outbuf);
+  g_slice_free (GstVideoFilterJob, job);
+
+done:
+  g_mutex_unlock (&priv->lock);
+
+  return ret;
+}
+
+static gboolean
+gst_video_filter_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstFlowReturn ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_STOP:
+      gst_video_filter_flush (filter);
+      break;
+    default:
+      /* the frames in flight belong before the event */
+      if (GST_EVENT_IS_SERIALIZED (event)) {
+        ret = gst_video_filter_drain (filter);
+        if (ret != GST_FLOW_OK)
+          goto drain_failed;
+      }
+      break;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->sink_event (trans, event);
+
+  /* ERRORS */
+drain_failed:
+  {
+    GST_DEBUG_OBJECT (filter, "failing %" GST_PTR_FORMAT ", draining failed: "
+        "%s", event, gst_flow_get_name (ret));
+    gst_event_unref (event);
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_video_filter_query (GstBaseTransform * trans, GstPadDirection direction,
+    GstQuery * query)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  gboolean res;
+
+  res = GST_BASE_TRANSFORM_CLASS (parent_class)->query (trans, direction,
+      query);
+
+  if (res && direction == GST_PAD_SRC
+      && GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
+    GstClockTime min, max, latency;
+    gboolean live;
+    guint extra;
+
+    g_mutex_lock (&priv->lock);
+    extra = priv->max_in_flight - 1;
+    g_mutex_unlock (&priv->lock);
+
+    if (extra > 0 && filter->negotiated
+        && GST_VIDEO_INFO_FPS_N (&filter->out_info) > 0) {
+      latency = gst_util_uint64_scale (extra * GST_SECOND,
+          GST_VIDEO_INFO_FPS_D (&filter->out_info),
+          GST_VIDEO_INFO_FPS_N (&filter->out_info));
+
+      gst_query_parse_latency (query, &live, &min, &max);
+      GST_DEBUG_OBJECT (filter, "adding %" GST_TIME_FORMAT " latency for %u "
+          "frames in flight", GST_TIME_ARGS (latency), extra);
+      min += latency;
+      if (max != GST_CLOCK_TIME_NONE)
+        max += latency;
+      gst_query_set_latency (query, live, min, max);
+    }
+  }
+
+  return res;
+}
+
+static GstStateChangeReturn
+gst_video_filter_change_state (GstElement * element, GstStateChange transition)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (element);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      g_mutex_lock (&priv->lock);
+      priv->stopping = FALSE;
+      priv->drain_ret = GST_FLOW_OK;
+      g_mutex_unlock (&priv->lock);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* the worker must be gone before the subclass is stopped, frames
+       * arriving until the pads are deactivated are transformed right
+       * away */
+      gst_video_filter_stop_worker (filter);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  return ret;
+}
+
+static void
+gst_video_filter_finalize (GObject * object)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (object);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (filter);
+
+  gst_video_filter_stop_worker (filter);
+
+  g_mutex_clear (&priv->lock);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static GstFlowReturn
 gst_video_filter_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
@@ -360,12 +949,23 @@ gst_video_filter_transform_meta (GstBaseTransform * trans, GstBuffer * inbuf,
 static void
 gst_video_filter_class_init (GstVideoFilterClass * g_class)
 {
+  GObjectClass *gobject_class;
+  GstElementClass *element_class;
   GstBaseTransformClass *trans_class;
   GstVideoFilterClass *klass;
 
   klass = (GstVideoFilterClass *) g_class;
+  gobject_class = (GObjectClass *) klass;
+  element_class = (GstElementClass *) klass;
   trans_class = (GstBaseTransformClass *) klass;
 
+  g_type_class_add_private (klass, sizeof (GstVideoFilterPrivate));
+
+  gobject_class->finalize = gst_video_filter_finalize;
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_video_filter_change_state);
+
   trans_class->set_caps = GST_DEBUG_FUNCPTR (gst_video_filter_set_caps);
   trans_class->propose_allocation =
       GST_DEBUG_FUNCPTR (gst_video_filter_propose_allocation);
@@ -379,6 +979,12 @@ gst_video_filter_class_init (GstVideoFilterClass * g_class)
   trans_class->transform_ip = GST_DEBUG_FUNCPTR (gst_video_filter_transform_ip);
   trans_class->transform_meta =
       GST_DEBUG_FUNCPTR (gst_video_filter_transform_meta);
+  trans_class->submit_input_buffer =
+      GST_DEBUG_FUNCPTR (gst_video_filter_submit_input_buffer);
+  trans_class->generate_output =
+      GST_DEBUG_FUNCPTR (gst_video_filter_generate_output);
+  trans_class->sink_event = GST_DEBUG_FUNCPTR (gst_video_filter_sink_event);
+  trans_class->query = GST_DEBUG_FUNCPTR (gst_video_filter_query);
 
   GST_DEBUG_CATEGORY_INIT (gst_video_filter_debug, "videofilter", 0,
       "videofilter");
@@ -388,9 +994,16 @@ static void
 gst_video_filter_init (GstVideoFilter * instance)
 {
   GstVideoFilter *videofilter = GST_VIDEO_FILTER (instance);
+  GstVideoFilterPrivate *priv = GST_VIDEO_FILTER_GET_PRIVATE (videofilter);
 
   GST_DEBUG_OBJECT (videofilter, "gst_video_filter_init");
 
+  g_mutex_init (&priv->lock);
+  g_cond_init (&priv->cond);
+  g_queue_init (&priv->jobs);
+  g_queue_init (&priv->todo);
+  priv->max_in_flight = 1;
+
   videofilter->negotiated = FALSE;
   /* enable QoS */
   gst_base_transform_set_qos_enabled (GST_BASE_TRANSFORM (videofilter), TRUE);
@@ -81,6 +81,9 @@ struct _GstVideoFilterClass {
 
 GType gst_video_filter_get_type (void);
 
+void  gst_video_filter_set_max_in_flight (GstVideoFilter * filter,
+                                          guint max_in_flight);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstVideoFilter, gst_object_unref)
 #endif
@@ -22,11 +22,11 @@
 #include "config.h"
 #endif
 
-#if 0
-#ifdef HAVE_PTHREAD
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#ifndef _GNU_SOURCE
 #define _GNU_SOURCE
-#include <pthread.h>
 #endif
+#include <pthread.h>
 #endif
 
 #include "video-converter.h"
@@ -116,9 +116,13 @@ ensure_debug_category (void)
 #endif /* GST_DISABLE_GST_DEBUG */
 
 typedef void (*GstParallelizedTaskFunc) (gpointer user_data);
+typedef void (*GstParallelizedBandFunc) (gpointer slot_data, gint band);
 
 typedef struct _GstParallelizedTaskRunner GstParallelizedTaskRunner;
 typedef struct _GstParallelizedTaskThread GstParallelizedTaskThread;
+typedef struct _GstParallelizedTaskPool GstParallelizedTaskPool;
+typedef struct _GstParallelizedTaskJob GstParallelizedTaskJob;
+typedef struct _GstParallelizedBandSlot GstParallelizedBandSlot;
 
 struct _GstParallelizedTaskThread
 {
@@ -127,6 +131,46 @@ struct _GstParallelizedTaskThread
   GThread *thread;
 };
 
+/* A job is one slice of a run() that is queued on the shared pool. The
+ * link is embedded so that queueing and stealing back never allocate. */
+struct _GstParallelizedTaskJob
+{
+  GList link;
+  GstParallelizedTaskRunner *runner;
+  guint idx;
+  gboolean queued;
+};
+
+/* Process-wide pool of worker threads shared by all runners that don't
+ * have their own private threads. Workers pick jobs from a single FIFO,
+ * the thread calling run() helps with its own jobs so that a run always
+ * makes progress, even when all workers are busy with other converters. */
+struct _GstParallelizedTaskPool
+{
+  GMutex lock;
+  GCond cond_todo;
+  GQueue jobs;
+
+  guint max_threads;
+  guint n_threads;
+
+  guint *cpus;
+  guint n_cpus;
+};
+
+/* Per-thread state of a banded run. Each thread pulls bands from a shared
+ * counter until all are taken, so a thread that is slowed down by other
+ * work on its core simply ends up doing fewer bands. */
+struct _GstParallelizedBandSlot
+{
+  GstParallelizedTaskRunner *runner;
+  gpointer slot_data;
+
+  /* stats of the last run */
+  guint n_bands;
+  gint64 busy_time;
+};
+
 struct _GstParallelizedTaskRunner
 {
   guint n_threads;
@@ -140,29 +184,45 @@ struct _GstParallelizedTaskRunner
   GCond cond_todo, cond_done;
   gint n_todo, n_done;
   gboolean quit;
+
+  /* when using the shared pool, protected by the pool lock */
+  GstParallelizedTaskPool *pool;
+  GstParallelizedTaskJob *jobs;
+  guint n_pending;
+
+  /* banded runs */
+  GstParallelizedBandSlot *slots;
+  GstParallelizedBandFunc band_func;
+  gint n_bands;
+  volatile gint next_band;
 };
 
+static GstParallelizedTaskPool shared_pool;
+static gsize shared_pool_init = 0;
+
+static void
+gst_parallelized_task_thread_set_affinity (guint cpu)
+{
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  pthread_t thread = pthread_self ();
+  cpu_set_t cpuset;
+  int r;
+
+  CPU_ZERO (&cpuset);
+  CPU_SET (cpu, &cpuset);
+  if ((r = pthread_setaffinity_np (thread, sizeof (cpuset), &cpuset)) != 0)
+    GST_ERROR ("Failed to set thread affinity to cpu %u: %s", cpu,
+        g_strerror (r));
+#else
+  GST_WARNING ("Thread affinity not supported, not pinning to cpu %u", cpu);
+#endif
+}
+
 static gpointer
 gst_parallelized_task_thread_func (gpointer data)
 {
   GstParallelizedTaskThread *self = data;
 
-#if 0
-#ifdef HAVE_PTHREAD
-  {
-    pthread_t thread = pthread_self ();
-    cpu_set_t cpuset;
-    int r;
-
-    CPU_ZERO (&cpuset);
-    CPU_SET (self->idx, &cpuset);
-    if ((r = pthread_setaffinity_np (thread, sizeof (cpuset), &cpuset)) != 0)
-      GST_ERROR ("Failed to set thread affinity for thread %d: %s", self->idx,
-          g_strerror (r));
-  }
-#endif
-#endif
-
   g_mutex_lock (&self->runner->lock);
   self->runner->n_done++;
   if (self->runner->n_done == self->runner->n_threads - 1)
@@ -196,11 +256,192 @@ gst_parallelized_task_thread_func (gpointer data)
   return NULL;
 }
 
+static gboolean
+parse_cpu_list (const gchar * str, guint ** cpus, guint * n_cpus)
+{
+  gchar **items;
+  GArray *array;
+  guint i;
+
+  array = g_array_new (FALSE, FALSE, sizeof (guint));
+  items = g_strsplit (str, ",", -1);
+  for (i = 0; items[i]; i++) {
+    gchar *end;
+    guint64 first, last;
+
+    first = last = g_ascii_strtoull (items[i], &end, 10);
+    if (end == items[i])
+      goto error;
+    if (*end == '-') {
+      gchar *start = end + 1;
+
+      last = g_ascii_strtoull (start, &end, 10);
+      if (end == start || last < first)
+        goto error;
+    }
+    if (*end != '\0' || last >= G_MAXUINT)
+      goto error;
+
+    for (; first <= last; first++) {
+      guint cpu = first;
+      g_array_append_val (array, cpu);
+    }
+  }
+  g_strfreev (items);
+
+  *n_cpus = array->len;
+  *cpus = (guint *) g_array_free (array, array->len == 0);
+
+  return TRUE;
+
+error:
+  {
+    GST_WARNING ("invalid cpu list \"%s\"", str);
+    g_strfreev (items);
+    g_array_free (array, TRUE);
+    return FALSE;
+  }
+}
+
+static GstParallelizedTaskPool *
+gst_parallelized_task_pool_get (void)
+{
+  GstParallelizedTaskPool *pool = &shared_pool;
+
+  if (g_once_init_enter (&shared_pool_init)) {
+    const gchar *env;
+
+    g_mutex_init (&pool->lock);
+    g_cond_init (&pool->cond_todo);
+    g_queue_init (&pool->jobs);
+    pool->max_threads = g_get_num_processors ();
+    pool->n_threads = 0;
+    pool->cpus = NULL;
+    pool->n_cpus = 0;
+
+    if ((env = g_getenv ("GST_VIDEO_CONVERTER_POOL_THREADS"))) {
+      guint64 n = g_ascii_strtoull (env, NULL, 10);
+      if (n > 0 && n < G_MAXUINT)
+        pool->max_threads = n;
+    }
+    if ((env = g_getenv ("GST_VIDEO_CONVERTER_POOL_CPUS")))
+      parse_cpu_list (env, &pool->cpus, &pool->n_cpus);
+
+    g_once_init_leave (&shared_pool_init, 1);
+  }
+  return pool;
+}
+
+static gpointer
+gst_parallelized_task_pool_thread_func (gpointer data)
+{
+  GstParallelizedTaskPool *pool = &shared_pool;
+  guint idx = GPOINTER_TO_UINT (data);
+
+  if (pool->n_cpus > 0)
+    gst_parallelized_task_thread_set_affinity (pool->cpus[idx % pool->n_cpus]);
+
+  g_mutex_lock (&pool->lock);
+  do {
+    GstParallelizedTaskRunner *runner;
+    GstParallelizedTaskJob *job;
+    GList *link;
+
+    while ((link = g_queue_pop_head_link (&pool->jobs)) == NULL)
+      g_cond_wait (&pool->cond_todo, &pool->lock);
+
+    job = link->data;
+    job->queued = FALSE;
+    runner = job->runner;
+    g_mutex_unlock (&pool->lock);
+
+    g_assert (runner->func != NULL);
+
+    runner->func (runner->task_data[job->idx]);
+
+    g_mutex_lock (&pool->lock);
+    if (--runner->n_pending == 0)
+      g_cond_signal (&runner->cond_done);
+  } while (TRUE);
+
+  g_mutex_unlock (&pool->lock);
+
+  return NULL;
+}
+
+/* call with the pool lock. Makes sure there are at least @n_threads workers,
+ * up to the configured maximum. Threads are never stopped again. */
 static void
-gst_parallelized_task_runner_free (GstParallelizedTaskRunner * self)
+gst_parallelized_task_pool_ensure_threads (GstParallelizedTaskPool * pool,
+    guint n_threads)
+{
+  n_threads = MIN (n_threads, pool->max_threads);
+
+  while (pool->n_threads < n_threads) {
+    GThread *thread;
+    GError *err = NULL;
+
+    thread = g_thread_try_new ("videoconvert",
+        gst_parallelized_task_pool_thread_func,
+        GUINT_TO_POINTER (pool->n_threads), &err);
+    if (!thread) {
+      /* not fatal, the caller of run() will do the remaining work */
+      GST_ERROR ("Failed to start pool thread %u: %s", pool->n_threads,
+          err->message);
+      g_clear_error (&err);
+      break;
+    }
+    g_thread_unref (thread);
+    pool->n_threads++;
+  }
+}
+
+/* Start the private threads of @self, the first slice is always done by the
+ * thread calling run() */
+static gboolean
+gst_parallelized_task_runner_start_threads (GstParallelizedTaskRunner * self)
+{
+  guint i;
+  GError *err = NULL;
+
+  self->quit = FALSE;
+  self->n_todo = -1;
+  self->n_done = 0;
+
+  for (i = 1; i < self->n_threads; i++) {
+    self->threads[i].thread =
+        g_thread_try_new ("videoconvert", gst_parallelized_task_thread_func,
+        &self->threads[i], &err);
+    if (!self->threads[i].thread)
+      goto error;
+  }
+
+  g_mutex_lock (&self->lock);
+  while (self->n_done < self->n_threads - 1)
+    g_cond_wait (&self->cond_done, &self->lock);
+  self->n_done = 0;
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+
+error:
+  {
+    GST_ERROR ("Failed to start thread %u: %s", i, err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+}
+
+/* Make the private threads of @self exit and join them. Runners on the shared
+ * pool don't own any threads. */
+static void
+gst_parallelized_task_runner_stop_threads (GstParallelizedTaskRunner * self)
 {
   guint i;
 
+  if (self->pool)
+    return;
+
   g_mutex_lock (&self->lock);
   self->quit = TRUE;
   g_cond_broadcast (&self->cond_todo);
@@ -211,7 +452,38 @@ gst_parallelized_task_runner_free (GstParallelizedTaskRunner * self)
       continue;
 
     g_thread_join (self->threads[i].thread);
+    self->threads[i].thread = NULL;
   }
+}
+
+/* Start the threads again after gst_parallelized_task_runner_stop_threads() */
+static gboolean
+gst_parallelized_task_runner_restart_threads (GstParallelizedTaskRunner * self)
+{
+  if (self->pool)
+    return TRUE;
+
+  if (!gst_parallelized_task_runner_start_threads (self)) {
+    gst_parallelized_task_runner_stop_threads (self);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static void
+gst_parallelized_task_runner_free (GstParallelizedTaskRunner * self)
+{
+  g_free (self->slots);
+
+  if (self->pool) {
+    /* run() only returns when all our jobs are done, nothing to wait for */
+    g_free (self->jobs);
+    g_cond_clear (&self->cond_done);
+    g_free (self);
+    return;
+  }
+
+  gst_parallelized_task_runner_stop_threads (self);
 
   g_mutex_clear (&self->lock);
   g_cond_clear (&self->cond_todo);
@@ -221,22 +493,52 @@ gst_parallelized_task_runner_free (GstParallelizedTaskRunner * self)
 }
 
 static GstParallelizedTaskRunner *
-gst_parallelized_task_runner_new (guint n_threads)
+gst_parallelized_task_runner_new_shared (guint n_threads)
+{
+  GstParallelizedTaskRunner *self;
+  GstParallelizedTaskPool *pool;
+  guint i;
+
+  pool = gst_parallelized_task_pool_get ();
+
+  self = g_new0 (GstParallelizedTaskRunner, 1);
+  self->n_threads = n_threads;
+  self->slots = g_new0 (GstParallelizedBandSlot, n_threads);
+  self->pool = pool;
+  self->jobs = g_new0 (GstParallelizedTaskJob, n_threads);
+  g_cond_init (&self->cond_done);
+
+  for (i = 0; i < n_threads; i++) {
+    self->jobs[i].link.data = &self->jobs[i];
+    self->jobs[i].runner = self;
+    self->jobs[i].idx = i;
+  }
+
+  /* the thread calling run() does one of the slices */
+  g_mutex_lock (&pool->lock);
+  gst_parallelized_task_pool_ensure_threads (pool, n_threads - 1);
+  g_mutex_unlock (&pool->lock);
+
+  return self;
+}
+
+static GstParallelizedTaskRunner *
+gst_parallelized_task_runner_new (guint n_threads, gboolean shared)
 {
   GstParallelizedTaskRunner *self;
   guint i;
-  GError *err = NULL;
 
   if (n_threads == 0)
     n_threads = g_get_num_processors ();
 
+  if (shared)
+    return gst_parallelized_task_runner_new_shared (n_threads);
+
   self = g_new0 (GstParallelizedTaskRunner, 1);
   self->n_threads = n_threads;
+  self->slots = g_new0 (GstParallelizedBandSlot, n_threads);
   self->threads = g_new0 (GstParallelizedTaskThread, n_threads);
 
-  self->quit = FALSE;
-  self->n_todo = -1;
-  self->n_done = 0;
   g_mutex_init (&self->lock);
   g_cond_init (&self->cond_todo);
   g_cond_init (&self->cond_done);
@@ -248,33 +550,63 @@ gst_parallelized_task_runner_new (guint n_threads)
   for (i = 0; i < n_threads; i++) {
     self->threads[i].runner = self;
     self->threads[i].idx = i;
-
-    /* First thread is the one calling run() */
-    if (i > 0) {
-      self->threads[i].thread =
-          g_thread_try_new ("videoconvert", gst_parallelized_task_thread_func,
-          &self->threads[i], &err);
-      if (!self->threads[i].thread)
-        goto error;
-    }
   }
 
-  g_mutex_lock (&self->lock);
-  while (self->n_done < self->n_threads - 1)
-    g_cond_wait (&self->cond_done, &self->lock);
-  self->n_done = 0;
-  g_mutex_unlock (&self->lock);
+  if (!gst_parallelized_task_runner_start_threads (self)) {
+    gst_parallelized_task_runner_free (self);
+    return NULL;
+  }
 
   return self;
+}
 
-error:
-  {
-    GST_ERROR ("Failed to start thread %u: %s", i, err->message);
-    g_clear_error (&err);
+static void
+gst_parallelized_task_runner_run_shared (GstParallelizedTaskRunner * self)
+{
+  GstParallelizedTaskPool *pool = self->pool;
+  guint i, n_jobs = self->n_threads - 1;
 
-    gst_parallelized_task_runner_free (self);
-    return NULL;
+  g_mutex_lock (&pool->lock);
+  for (i = 0; i < n_jobs; i++) {
+    self->jobs[i].queued = TRUE;
+    g_queue_push_tail_link (&pool->jobs, &self->jobs[i].link);
+  }
+  self->n_pending = n_jobs;
+  if (n_jobs > 1)
+    g_cond_broadcast (&pool->cond_todo);
+  else
+    g_cond_signal (&pool->cond_todo);
+  g_mutex_unlock (&pool->lock);
+
+  self->func (self->task_data[n_jobs]);
+
+  g_mutex_lock (&pool->lock);
+  while (self->n_pending > 0) {
+    GstParallelizedTaskJob *job = NULL;
+
+    /* take back our own jobs that no worker picked up yet */
+    for (i = 0; i < n_jobs; i++) {
+      if (self->jobs[i].queued) {
+        job = &self->jobs[i];
+        break;
+      }
+    }
+
+    if (job == NULL) {
+      g_cond_wait (&self->cond_done, &pool->lock);
+      continue;
+    }
+
+    g_queue_unlink (&pool->jobs, &job->link);
+    job->queued = FALSE;
+    g_mutex_unlock (&pool->lock);
+
+    self->func (self->task_data[job->idx]);
+
+    g_mutex_lock (&pool->lock);
+    self->n_pending--;
   }
+  g_mutex_unlock (&pool->lock);
 }
 
 static void
@@ -286,6 +618,11 @@ gst_parallelized_task_runner_run (GstParallelizedTaskRunner * self,
   self->func = func;
   self->task_data = task_data;
 
+  if (self->pool && n_threads > 1) {
+    gst_parallelized_task_runner_run_shared (self);
+    goto done;
+  }
+
   if (n_threads > 1) {
     g_mutex_lock (&self->lock);
     self->n_todo = self->n_threads - 2;
@@ -304,10 +641,115 @@ gst_parallelized_task_runner_run (GstParallelizedTaskRunner * self,
     g_mutex_unlock (&self->lock);
   }
 
+done:
   self->func = NULL;
   self->task_data = NULL;
 }
 
+static void
+gst_parallelized_band_slot_func (GstParallelizedBandSlot * slot)
+{
+  GstParallelizedTaskRunner *runner = slot->runner;
+  gint64 start;
+  gint band;
+
+  start = g_get_monotonic_time ();
+
+  slot->n_bands = 0;
+  while ((band = g_atomic_int_add (&runner->next_band, 1)) < runner->n_bands) {
+    runner->band_func (slot->slot_data, band);
+    slot->n_bands++;
+  }
+
+  slot->busy_time = g_get_monotonic_time () - start;
+}
+
+/* Run @func for each of the @n_bands bands. @slot_data contains the
+ * per-thread data, a band is always processed with the data of the thread
+ * that runs it. */
+static void
+gst_parallelized_task_runner_run_bands (GstParallelizedTaskRunner * self,
+    GstParallelizedBandFunc func, gpointer * slot_data, gint n_bands)
+{
+  gpointer *slots_p;
+  guint i;
+
+  slots_p = g_newa (gpointer, self->n_threads);
+  for (i = 0; i < self->n_threads; i++) {
+    self->slots[i].runner = self;
+    self->slots[i].slot_data = slot_data[i];
+    slots_p[i] = &self->slots[i];
+  }
+
+  self->band_func = func;
+  self->n_bands = n_bands;
+  self->next_band = 0;
+
+  gst_parallelized_task_runner_run (self,
+      (GstParallelizedTaskFunc) gst_parallelized_band_slot_func, slots_p);
+
+  self->band_func = NULL;
+
+  if (self->n_threads > 1) {
+    guint min_bands = G_MAXUINT, max_bands = 0;
+    gint64 min_time = G_MAXINT64, max_time = 0;
+
+    for (i = 0; i < self->n_threads; i++) {
+      min_bands = MIN (min_bands, self->slots[i].n_bands);
+      max_bands = MAX (max_bands, self->slots[i].n_bands);
+      min_time = MIN (min_time, self->slots[i].busy_time);
+      max_time = MAX (max_time, self->slots[i].busy_time);
+    }
+    GST_LOG ("%d bands on %u threads: %u-%u bands, %" G_GINT64_FORMAT
+        "-%" G_GINT64_FORMAT " us per thread", n_bands, self->n_threads,
+        min_bands, max_bands, min_time, max_time);
+  }
+}
+
+/**
+ * gst_video_converter_configure_shared_pool:
+ * @max_threads: maximum number of worker threads, 0 for the number of cores
+ * @cpus: (array length=n_cpus) (allow-none): CPUs to pin the workers to
+ * @n_cpus: number of entries in @cpus
+ *
+ * Configure the process-wide pool of worker threads that is used by all
+ * converters with #GST_VIDEO_CONVERTER_OPT_SHARED_POOL enabled. Worker n
+ * is pinned to @cpus[n % @n_cpus] when @cpus is given.
+ *
+ * The defaults can also be set with the GST_VIDEO_CONVERTER_POOL_THREADS
+ * and GST_VIDEO_CONVERTER_POOL_CPUS (e.g. "0,2,4-7") environment variables.
+ *
+ * This must be called before the first multithreaded converter is created.
+ *
+ * Returns: %TRUE if the configuration was applied, %FALSE when the pool
+ * has already started its threads.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_video_converter_configure_shared_pool (guint max_threads,
+    const guint * cpus, guint n_cpus)
+{
+  GstParallelizedTaskPool *pool;
+  gboolean res = FALSE;
+
+  g_return_val_if_fail (cpus != NULL || n_cpus == 0, FALSE);
+
+  pool = gst_parallelized_task_pool_get ();
+
+  g_mutex_lock (&pool->lock);
+  if (pool->n_threads == 0) {
+    pool->max_threads = max_threads ? max_threads : g_get_num_processors ();
+    g_free (pool->cpus);
+    pool->cpus = n_cpus ? g_memdup (cpus, n_cpus * sizeof (guint)) : NULL;
+    pool->n_cpus = n_cpus;
+    res = TRUE;
+  }
+  g_mutex_unlock (&pool->lock);
+
+  return res;
+}
+
 typedef struct _GstLineCache GstLineCache;
 
 #define SCALE    (8)
@@ -390,6 +832,7 @@ struct _GstVideoConverter
   GstStructure *config;
 
   GstParallelizedTaskRunner *conversion_runner;
+  guint band_lines;
 
   guint16 **tmpline;
 
@@ -498,6 +941,9 @@ struct _GstVideoConverter
     GstVideoScaler **scaler;
   } fv_scaler[4];
   FastConvertFunc fconvert[4];
+
+  /* can be kept in the converter cache when freed */
+  gboolean cacheable;
 };
 
 typedef gpointer (*GstLineCacheAllocLineFunc) (GstLineCache * cache, gint idx,
@@ -549,6 +995,14 @@ gst_line_cache_clear (GstLineCache * cache)
   cache->first = 0;
 }
 
+/* forget the lines of @cache and of all caches before it */
+static void
+gst_line_cache_clear_chain (GstLineCache * cache)
+{
+  for (; cache; cache = cache->prev)
+    gst_line_cache_clear (cache);
+}
+
 static void
 gst_line_cache_free (GstLineCache * cache)
 {
@@ -589,7 +1043,11 @@ static gpointer *
 gst_line_cache_get_lines (GstLineCache * cache, gint idx, gint out_line,
     gint in_line, gint n_lines)
 {
-  if (cache->first + cache->backlog < in_line) {
+  if (cache->lines->len == 0) {
+    /* nothing cached, start producing lines at the requested one instead of
+     * producing all lines since the last one that was cached */
+    cache->first = in_line;
+  } else if (cache->first + cache->backlog < in_line) {
     gint to_remove =
         MIN (in_line - (cache->first + cache->backlog), cache->lines->len);
     if (to_remove > 0) {
@@ -807,6 +1265,8 @@ get_opt_enum (GstVideoConverter * convert, const gchar * opt, GType type,
 #define DEFAULT_OPT_RESAMPLER_TAPS 0
 #define DEFAULT_OPT_DITHER_METHOD GST_VIDEO_DITHER_BAYER
 #define DEFAULT_OPT_DITHER_QUANTIZATION 1
+#define DEFAULT_OPT_SHARED_POOL TRUE
+#define DEFAULT_OPT_BAND_LINES 0
 
 #define GET_OPT_FILL_BORDER(c) get_opt_bool(c, \
     GST_VIDEO_CONVERTER_OPT_FILL_BORDER, DEFAULT_OPT_FILL_BORDER)
@@ -837,6 +1297,10 @@ get_opt_enum (GstVideoConverter * convert, const gchar * opt, GType type,
     DEFAULT_OPT_DITHER_METHOD)
 #define GET_OPT_DITHER_QUANTIZATION(c) get_opt_uint(c, \
     GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION, DEFAULT_OPT_DITHER_QUANTIZATION)
+#define GET_OPT_SHARED_POOL(c) get_opt_bool(c, \
+    GST_VIDEO_CONVERTER_OPT_SHARED_POOL, DEFAULT_OPT_SHARED_POOL)
+#define GET_OPT_BAND_LINES(c) get_opt_uint(c, \
+    GST_VIDEO_CONVERTER_OPT_BAND_LINES, DEFAULT_OPT_BAND_LINES)
 
 #define CHECK_ALPHA_COPY(c) (GET_OPT_ALPHA_MODE(c) == GST_VIDEO_ALPHA_MODE_COPY)
 #define CHECK_ALPHA_SET(c) (GET_OPT_ALPHA_MODE(c) == GST_VIDEO_ALPHA_MODE_SET)
@@ -2237,6 +2701,118 @@ convert_get_alpha_mode (GstVideoConverter * convert)
   return ALPHA_MODE_SET;
 }
 
+static void video_converter_destroy (GstVideoConverter * convert);
+static gboolean copy_config (GQuark field_id, const GValue * value,
+    gpointer user_data);
+
+/* Freed converters are kept in a small LRU cache so that creating a converter
+ * for the same infos and config again, as happens when elements renegotiate
+ * between a few formats, reuses all matrices, line caches, scalers and dither
+ * tables instead of building them again. GST_VIDEO_CONVERTER_CACHE_SIZE sets
+ * the number of converters that are kept, 0 disables the cache. */
+#define DEFAULT_CACHE_SIZE 4
+#define MAX_CACHE_SIZE     64
+
+static GMutex cache_lock;
+/* most recently freed first */
+static GQueue cache_queue = G_QUEUE_INIT;
+static gint cache_size = -1;
+
+static guint
+video_converter_cache_get_size (void)
+{
+  if (cache_size < 0) {
+    const gchar *env = g_getenv ("GST_VIDEO_CONVERTER_CACHE_SIZE");
+
+    if (env)
+      cache_size = MIN (g_ascii_strtoull (env, NULL, 10), MAX_CACHE_SIZE);
+    else
+      cache_size = DEFAULT_CACHE_SIZE;
+  }
+  return cache_size;
+}
+
+static GstVideoConverter *
+video_converter_cache_take (const GstVideoInfo * in_info,
+    const GstVideoInfo * out_info, const GstStructure * config)
+{
+  GstVideoConverter *convert = NULL;
+  GList *walk;
+
+  g_mutex_lock (&cache_lock);
+  for (walk = cache_queue.head; walk; walk = walk->next) {
+    GstVideoConverter *c = walk->data;
+
+    if (gst_video_info_is_equal (&c->in_info, in_info) &&
+        gst_video_info_is_equal (&c->out_info, out_info) &&
+        gst_structure_is_equal (c->config, config)) {
+      g_queue_delete_link (&cache_queue, walk);
+      convert = c;
+      break;
+    }
+  }
+  g_mutex_unlock (&cache_lock);
+
+  if (convert) {
+    if (!gst_parallelized_task_runner_restart_threads
+        (convert->conversion_runner)) {
+      video_converter_destroy (convert);
+      return NULL;
+    }
+    GST_DEBUG ("reusing cached converter %p", convert);
+  }
+
+  return convert;
+}
+
+static gboolean
+video_converter_cache_put (GstVideoConverter * convert)
+{
+  GList *evicted = NULL;
+  guint size;
+
+  g_mutex_lock (&cache_lock);
+  size = video_converter_cache_get_size ();
+  g_mutex_unlock (&cache_lock);
+
+  if (size == 0)
+    return FALSE;
+
+  /* cached converters don't keep any threads around */
+  gst_parallelized_task_runner_stop_threads (convert->conversion_runner);
+
+  g_mutex_lock (&cache_lock);
+  g_queue_push_head (&cache_queue, convert);
+  while (cache_queue.length > size)
+    evicted = g_list_prepend (evicted, g_queue_pop_tail (&cache_queue));
+  g_mutex_unlock (&cache_lock);
+
+  g_list_free_full (evicted, (GDestroyNotify) video_converter_destroy);
+
+  return TRUE;
+}
+
+/**
+ * gst_video_converter_clear_cache:
+ *
+ * Release all converters that were kept for reuse after
+ * gst_video_converter_free().
+ *
+ * Since: 1.14
+ */
+void
+gst_video_converter_clear_cache (void)
+{
+  GList *cached;
+
+  g_mutex_lock (&cache_lock);
+  cached = cache_queue.head;
+  g_queue_init (&cache_queue);
+  g_mutex_unlock (&cache_lock);
+
+  g_list_free_full (cached, (GDestroyNotify) video_converter_destroy);
+}
+
 /**
  * gst_video_converter_new: (skip)
  * @in_info: a #GstVideoInfo
@@ -2255,6 +2831,7 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
     GstStructure * config)
 {
   GstVideoConverter *convert;
+  GstStructure *key;
   GstLineCache *prev;
   const GstVideoFormatInfo *fin, *fout, *finfo;
   gdouble alpha_value;
@@ -2269,6 +2846,18 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
   g_return_val_if_fail (in_info->interlace_mode == out_info->interlace_mode,
       NULL);
 
+  /* default config */
+  key = gst_structure_new_empty ("GstVideoConverter");
+  if (config) {
+    gst_structure_foreach (config, copy_config, key);
+    gst_structure_free (config);
+  }
+
+  if ((convert = video_converter_cache_take (in_info, out_info, key))) {
+    gst_structure_free (key);
+    return convert;
+  }
+
   convert = g_slice_new0 (GstVideoConverter);
 
   fin = in_info->finfo;
@@ -2277,10 +2866,7 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
   convert->in_info = *in_info;
   convert->out_info = *out_info;
 
-  /* default config */
-  convert->config = gst_structure_new_empty ("GstVideoConverter");
-  if (config)
-    gst_video_converter_set_config (convert, config);
+  convert->config = key;
 
   convert->in_maxwidth = GST_VIDEO_INFO_WIDTH (in_info);
   convert->in_maxheight = GST_VIDEO_INFO_HEIGHT (in_info);
@@ -2361,7 +2947,9 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
   /* Magic number of 200 lines */
   if (MAX (convert->out_height, convert->in_height) / n_threads < 200)
     n_threads = (MAX (convert->out_height, convert->in_height) + 199) / 200;
-  convert->conversion_runner = gst_parallelized_task_runner_new (n_threads);
+  convert->conversion_runner = gst_parallelized_task_runner_new (n_threads,
+      GET_OPT_SHARED_POOL (convert));
+  convert->band_lines = GET_OPT_BAND_LINES (convert);
 
   if (video_converter_lookup_fastpath (convert))
     goto done;
@@ -2428,6 +3016,8 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
   setup_allocators (convert);
 
 done:
+  convert->cacheable = TRUE;
+
   return convert;
 
   /* ERRORS */
@@ -2461,15 +3051,32 @@ clear_matrix_data (MatrixData * data)
  *
  * Free @convert
  *
+ * A few freed converters are kept internally so that a following
+ * gst_video_converter_new() with the same infos and config can reuse them.
+ * A converter whose config was changed with gst_video_converter_set_config()
+ * is always released. Kept converters don't hold on to any threads. The
+ * number of kept converters can be set with the
+ * GST_VIDEO_CONVERTER_CACHE_SIZE environment variable, and
+ * gst_video_converter_clear_cache() releases all of them.
+ *
  * Since: 1.6
  */
 void
 gst_video_converter_free (GstVideoConverter * convert)
 {
-  guint i, j;
-
   g_return_if_fail (convert != NULL);
 
+  if (convert->cacheable && video_converter_cache_put (convert))
+    return;
+
+  video_converter_destroy (convert);
+}
+
+static void
+video_converter_destroy (GstVideoConverter * convert)
+{
+  guint i, j;
+
   for (i = 0; i < convert->conversion_runner->n_threads; i++) {
     if (convert->upsample_p && convert->upsample_p[i])
       gst_video_chroma_resample_free (convert->upsample_p[i]);
@@ -2566,9 +3173,9 @@ gst_video_converter_free (GstVideoConverter * convert)
 static gboolean
 copy_config (GQuark field_id, const GValue * value, gpointer user_data)
 {
-  GstVideoConverter *convert = user_data;
+  GstStructure *config = user_data;
 
-  gst_structure_id_set_value (convert->config, field_id, value);
+  gst_structure_id_set_value (config, field_id, value);
 
   return TRUE;
 }
@@ -2598,9 +3205,12 @@ gst_video_converter_set_config (GstVideoConverter * convert,
   g_return_val_if_fail (convert != NULL, FALSE);
   g_return_val_if_fail (config != NULL, FALSE);
 
-  gst_structure_foreach (config, copy_config, convert);
+  gst_structure_foreach (config, copy_config, convert->config);
   gst_structure_free (config);
 
+  /* the state was built for the old config, don't hand it out again */
+  convert->cacheable = FALSE;
+
   return TRUE;
 }
 
@@ -3058,6 +3668,8 @@ typedef struct
   gboolean identity_pack;
   gint lb_width, out_maxwidth;
   GstVideoFrame *dest;
+  gint band_lines, height;
+  gint next_line;
 } ConvertTask;
 
 static void
@@ -3083,6 +3695,23 @@ convert_generic_task (ConvertTask * task)
   }
 }
 
+static void
+convert_generic_band (ConvertTask * task, gint band)
+{
+  task->h_0 = band * task->band_lines;
+  task->h_1 = MIN (task->h_0 + task->band_lines, task->height);
+
+  /* the lines cached for the previous band of this thread are of no use for
+   * a band that does not follow it, start over at the first line of the band
+   * so that the lines in between, which belong to the bands of other threads,
+   * are not produced again */
+  if (task->h_0 != task->next_line)
+    gst_line_cache_clear_chain (task->pack_lines);
+  task->next_line = task->h_1;
+
+  convert_generic_task (task);
+}
+
 static void
 video_converter_generic (GstVideoConverter * convert, const GstVideoFrame * src,
     GstVideoFrame * dest)
@@ -3095,7 +3724,7 @@ video_converter_generic (GstVideoConverter * convert, const GstVideoFrame * src,
   ConvertTask *tasks;
   ConvertTask **tasks_p;
   gint n_threads;
-  gint lines_per_thread;
+  gint band_lines, n_bands;
 
   out_height = convert->out_height;
   out_maxwidth = convert->out_maxwidth;
@@ -3148,8 +3777,13 @@ video_converter_generic (GstVideoConverter * convert, const GstVideoFrame * src,
   tasks = g_newa (ConvertTask, n_threads);
   tasks_p = g_newa (ConvertTask *, n_threads);
 
-  lines_per_thread =
-      GST_ROUND_UP_N ((out_height + n_threads - 1) / n_threads, pack_lines);
+  /* either one equal slice per thread or many small bands that are picked
+   * up by whichever thread is free */
+  band_lines = convert->band_lines;
+  if (band_lines == 0 || n_threads == 1)
+    band_lines = (out_height + n_threads - 1) / n_threads;
+  band_lines = GST_ROUND_UP_N (MAX (band_lines, 1), pack_lines);
+  n_bands = (out_height + band_lines - 1) / band_lines;
 
   for (i = 0; i < n_threads; i++) {
     tasks[i].dest = dest;
@@ -3161,14 +3795,16 @@ video_converter_generic (GstVideoConverter * convert, const GstVideoFrame * src,
     tasks[i].lb_width = lb_width;
     tasks[i].out_maxwidth = out_maxwidth;
 
-    tasks[i].h_0 = i * lines_per_thread;
-    tasks[i].h_1 = MIN ((i + 1) * lines_per_thread, out_height);
+    tasks[i].band_lines = band_lines;
+    tasks[i].height = out_height;
+    tasks[i].next_line = -1;
 
     tasks_p[i] = &tasks[i];
   }
 
-  gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_generic_task, (gpointer) tasks_p);
+  gst_parallelized_task_runner_run_bands (convert->conversion_runner,
+      (GstParallelizedBandFunc) convert_generic_band, (gpointer) tasks_p,
+      n_bands);
 
   if (convert->borderline) {
     for (i = out_y + out_height; i < out_maxheight; i++)
@@ -5180,6 +5816,213 @@ convert_I420_pack_ARGB (GstVideoConverter * convert, const GstVideoFrame * src,
   convert_fill_border (convert, dest);
 }
 
+/* Scale and convert I420/YV12/NV12 to BGRx/BGRA in one pass over the output.
+ * Each output line is scaled vertically and then horizontally into small
+ * per-thread lines that stay in cache and is then converted straight into
+ * the destination. Chroma is scaled at its subsampled size like
+ * convert_scale_planes would do and reused for both lines of a pair. */
+typedef struct
+{
+  const GstVideoFrame *src;
+  GstVideoFrame *dest;
+  gint height_0, height_1;
+
+  /* parameters */
+  MatrixData *data;
+  GstVideoFormat uv_format;
+  gint u_plane, v_plane;
+  gint in_x, in_y;
+  gint in_width, in_cwidth;
+  gint out_x, out_y;
+  gint out_width, out_cwidth;
+  GstVideoScaler *y_hscaler, *y_vscaler;
+  GstVideoScaler *uv_hscaler, *uv_vscaler;
+  guint max_taps;
+  guint8 *tmpline;
+
+  gint band_lines;
+  gint height;
+} FScaleConvertTask;
+
+static guint8 *
+scale_convert_line (GstVideoScaler * vscaler, GstVideoScaler * hscaler,
+    GstVideoFormat format, const GstVideoFrame * src, gint plane, gint in_x,
+    gint in_y, gint in_width, gint out_width, gint line, gpointer * lines,
+    guint8 * vtmp, guint8 * dest)
+{
+  guint8 *s;
+
+  if (vscaler) {
+    guint in_line, n_taps, i;
+
+    gst_video_scaler_get_coeff (vscaler, line, &in_line, &n_taps);
+    for (i = 0; i < n_taps; i++)
+      lines[i] = (guint8 *) FRAME_GET_PLANE_LINE (src, plane,
+          in_y + in_line + i) + in_x;
+
+    gst_video_scaler_vertical (vscaler, format, lines, vtmp, line, in_width);
+    s = vtmp;
+  } else {
+    s = (guint8 *) FRAME_GET_PLANE_LINE (src, plane, in_y + line) + in_x;
+  }
+  if (hscaler) {
+    gst_video_scaler_horizontal (hscaler, format, s, dest, 0, out_width);
+    s = dest;
+  }
+  return s;
+}
+
+static void
+convert_YUV_BGRA_scale_task (FScaleConvertTask * task)
+{
+  gint i, j, c, last_c = -1;
+  gint in_cx, in_cy;
+  guint8 *vtmp_y, *line_y, *vtmp_c, *line_c, *line_u, *line_v;
+  guint8 *sy, *su = NULL, *sv = NULL, *d;
+  gpointer *lines;
+
+  vtmp_y = task->tmpline;
+  line_y = vtmp_y + GST_ROUND_UP_16 (task->in_width);
+  vtmp_c = line_y + GST_ROUND_UP_16 (task->out_width);
+  line_c = vtmp_c + GST_ROUND_UP_16 (task->in_cwidth * 2);
+  line_u = line_c + GST_ROUND_UP_16 (task->out_cwidth * 2);
+  line_v = line_u + GST_ROUND_UP_16 (task->out_cwidth);
+
+  lines = g_newa (gpointer, MAX (task->max_taps, 1));
+
+  in_cx = task->in_x >> 1;
+  in_cy = task->in_y >> 1;
+
+  for (i = task->height_0; i < task->height_1; i++) {
+    d = FRAME_GET_LINE (task->dest, i + task->out_y);
+    d += (task->out_x * 4);
+
+    sy = scale_convert_line (task->y_vscaler, task->y_hscaler,
+        GST_VIDEO_FORMAT_GRAY8, task->src, 0, task->in_x, task->in_y,
+        task->in_width, task->out_width, i, lines, vtmp_y, line_y);
+
+    c = i >> 1;
+    if (c != last_c) {
+      if (task->uv_format == GST_VIDEO_FORMAT_NV12) {
+        guint8 *suv;
+
+        suv = scale_convert_line (task->uv_vscaler, task->uv_hscaler,
+            GST_VIDEO_FORMAT_NV12, task->src, 1, in_cx * 2, in_cy,
+            task->in_cwidth, task->out_cwidth, c, lines, vtmp_c, line_c);
+
+        for (j = 0; j < task->out_cwidth; j++) {
+          line_u[j] = suv[2 * j];
+          line_v[j] = suv[2 * j + 1];
+        }
+        su = line_u;
+        sv = line_v;
+      } else {
+        su = scale_convert_line (task->uv_vscaler, task->uv_hscaler,
+            GST_VIDEO_FORMAT_GRAY8, task->src, task->u_plane, in_cx, in_cy,
+            task->in_cwidth, task->out_cwidth, c, lines, vtmp_c, line_c);
+        sv = scale_convert_line (task->uv_vscaler, task->uv_hscaler,
+            GST_VIDEO_FORMAT_GRAY8, task->src, task->v_plane, in_cx, in_cy,
+            task->in_cwidth, task->out_cwidth, c, lines,
+            vtmp_c + task->in_cwidth, line_c + task->out_cwidth);
+      }
+      last_c = c;
+    }
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    video_orc_convert_I420_BGRA (d, sy, su, sv,
+        task->data->im[0][0], task->data->im[0][2],
+        task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
+        task->out_width);
+#else
+    video_orc_convert_I420_ARGB (d, sy, su, sv,
+        task->data->im[0][0], task->data->im[0][2],
+        task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
+        task->out_width);
+#endif
+  }
+}
+
+static void
+convert_YUV_BGRA_scale_band (FScaleConvertTask * task, gint band)
+{
+  task->height_0 = band * task->band_lines;
+  task->height_1 = MIN (task->height_0 + task->band_lines, task->height);
+
+  convert_YUV_BGRA_scale_task (task);
+}
+
+static void
+convert_YUV_BGRA_scale (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  int i;
+  gint height = convert->out_height;
+  const GstVideoFormatInfo *in_finfo = convert->in_info.finfo;
+  MatrixData *data = &convert->convert_matrix;
+  FScaleConvertTask *tasks;
+  FScaleConvertTask **tasks_p;
+  gint n_threads;
+  gint band_lines, n_bands;
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = g_newa (FScaleConvertTask, n_threads);
+  tasks_p = g_newa (FScaleConvertTask *, n_threads);
+
+  /* keep bands even so that both lines of a chroma pair are done together */
+  band_lines = convert->band_lines;
+  if (band_lines == 0 || n_threads == 1)
+    band_lines = (height + n_threads - 1) / n_threads;
+  band_lines = GST_ROUND_UP_2 (MAX (band_lines, 1));
+  n_bands = (height + band_lines - 1) / band_lines;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].src = src;
+    tasks[i].dest = dest;
+
+    tasks[i].data = data;
+    tasks[i].uv_format =
+        GST_VIDEO_FORMAT_INFO_FORMAT (in_finfo) == GST_VIDEO_FORMAT_NV12 ?
+        GST_VIDEO_FORMAT_NV12 : GST_VIDEO_FORMAT_GRAY8;
+    tasks[i].u_plane = GST_VIDEO_FORMAT_INFO_PLANE (in_finfo, GST_VIDEO_COMP_U);
+    tasks[i].v_plane = GST_VIDEO_FORMAT_INFO_PLANE (in_finfo, GST_VIDEO_COMP_V);
+    tasks[i].in_x = convert->in_x;
+    tasks[i].in_y = convert->in_y;
+    tasks[i].in_width = convert->in_width;
+    tasks[i].in_cwidth = GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (in_finfo,
+        GST_VIDEO_COMP_U, convert->in_width);
+    tasks[i].out_x = convert->out_x;
+    tasks[i].out_y = convert->out_y;
+    tasks[i].out_width = convert->out_width;
+    tasks[i].out_cwidth = GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (in_finfo,
+        GST_VIDEO_COMP_U, convert->out_width);
+    tasks[i].y_hscaler =
+        convert->fh_scaler[0].scaler ? convert->fh_scaler[0].scaler[i] : NULL;
+    tasks[i].y_vscaler =
+        convert->fv_scaler[0].scaler ? convert->fv_scaler[0].scaler[i] : NULL;
+    tasks[i].uv_hscaler =
+        convert->fh_scaler[1].scaler ? convert->fh_scaler[1].scaler[i] : NULL;
+    tasks[i].uv_vscaler =
+        convert->fv_scaler[1].scaler ? convert->fv_scaler[1].scaler[i] : NULL;
+    tasks[i].max_taps = 0;
+    if (tasks[i].y_vscaler)
+      tasks[i].max_taps = gst_video_scaler_get_max_taps (tasks[i].y_vscaler);
+    if (tasks[i].uv_vscaler)
+      tasks[i].max_taps = MAX (tasks[i].max_taps,
+          gst_video_scaler_get_max_taps (tasks[i].uv_vscaler));
+    tasks[i].tmpline = (guint8 *) convert->tmpline[i];
+
+    tasks[i].band_lines = band_lines;
+    tasks[i].height = height;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run_bands (convert->conversion_runner,
+      (GstParallelizedBandFunc) convert_YUV_BGRA_scale_band,
+      (gpointer) tasks_p, n_bands);
+
+  convert_fill_border (convert, dest);
+}
+
 static void
 memset_u24 (guint8 * data, guint8 col[3], unsigned int n)
 {
@@ -5786,6 +6629,146 @@ convert_scale_planes (GstVideoConverter * convert,
   convert_fill_border (convert, dest);
 }
 
+typedef struct
+{
+  const GstVideoFrame *src;
+  GstVideoFrame *dest;
+  gint width, height;
+  gint ws, hs;
+  gint band_tiles;
+  gint ty_0, ty_1;
+} FDetileTask;
+
+/* copies @h lines of one tile, tiles are stored as consecutive lines of
+ * @tile_width bytes. Full tiles use a constant size so that the compiler
+ * turns the copies into vector moves */
+static inline void
+detile_copy (guint8 * d, gint dstride, const guint8 * s, gint tile_width,
+    gint w, gint h)
+{
+  gint i;
+
+  if (w == 64 && tile_width == 64) {
+    for (i = 0; i < h; i++) {
+      memcpy (d, s, 64);
+      d += dstride;
+      s += 64;
+    }
+  } else {
+    for (i = 0; i < h; i++) {
+      memcpy (d, s, w);
+      d += dstride;
+      s += tile_width;
+    }
+  }
+}
+
+static void
+convert_NV12_64Z32_NV12_task (FDetileTask * task)
+{
+  const GstVideoFrame *src = task->src;
+  GstVideoFrame *dest = task->dest;
+  gint ws = task->ws, hs = task->hs, ts = ws + hs;
+  gint tile_width = 1 << ws, tile_height = 1 << hs;
+  gint ntx, tx, ty, w, h, uv_width, uv_height;
+  gint x_tiles[2], y_tiles[2];
+  const guint8 *sy, *suv;
+  gsize offset;
+
+  x_tiles[0] = GST_VIDEO_TILE_X_TILES (FRAME_GET_PLANE_STRIDE (src, 0));
+  y_tiles[0] = GST_VIDEO_TILE_Y_TILES (FRAME_GET_PLANE_STRIDE (src, 0));
+  x_tiles[1] = GST_VIDEO_TILE_X_TILES (FRAME_GET_PLANE_STRIDE (src, 1));
+  y_tiles[1] = GST_VIDEO_TILE_Y_TILES (FRAME_GET_PLANE_STRIDE (src, 1));
+  sy = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
+  suv = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
+
+  ntx = (task->width + tile_width - 1) >> ws;
+  uv_width = GST_ROUND_UP_2 (task->width);
+  uv_height = (task->height + 1) >> 1;
+
+  for (ty = task->ty_0; ty < task->ty_1; ty++) {
+    h = MIN (tile_height, task->height - (ty << hs));
+
+    for (tx = 0; tx < ntx; tx++) {
+      w = MIN (tile_width, task->width - (tx << ws));
+
+      offset = gst_video_tile_get_index (GST_VIDEO_TILE_MODE_ZFLIPZ_2X2,
+          tx, ty, x_tiles[0], y_tiles[0]);
+      detile_copy ((guint8 *) FRAME_GET_PLANE_LINE (dest, 0,
+              ty << hs) + (tx << ws),
+          FRAME_GET_PLANE_STRIDE (dest, 0), sy + (offset << ts), tile_width,
+          w, h);
+
+      /* a row of luma tiles uses one half of a row of UV tiles */
+      offset = gst_video_tile_get_index (GST_VIDEO_TILE_MODE_ZFLIPZ_2X2,
+          tx, ty >> 1, x_tiles[1], y_tiles[1]);
+      offset = (offset << ts) | ((ty & 1) << (ts - 1));
+      detile_copy ((guint8 *) FRAME_GET_PLANE_LINE (dest, 1,
+              ty << (hs - 1)) + (tx << ws), FRAME_GET_PLANE_STRIDE (dest, 1), suv + offset,
+          tile_width, MIN (tile_width, uv_width - (tx << ws)),
+          MIN (tile_height >> 1, uv_height - (ty << (hs - 1))));
+    }
+  }
+}
+
+static void
+convert_NV12_64Z32_NV12_band (FDetileTask * task, gint band)
+{
+  gint n_ty = (task->height + (1 << task->hs) - 1) >> task->hs;
+
+  task->ty_0 = band * task->band_tiles;
+  task->ty_1 = MIN (task->ty_0 + task->band_tiles, n_ty);
+
+  convert_NV12_64Z32_NV12_task (task);
+}
+
+/* detiles whole tiles at a time instead of unpacking every line through the
+ * tile address math of the generic path */
+static void
+convert_NV12_64Z32_NV12 (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  const GstVideoFormatInfo *finfo = convert->in_info.finfo;
+  gint i, ws, hs, n_ty;
+  FDetileTask *tasks;
+  FDetileTask **tasks_p;
+  gint n_threads;
+  gint band_tiles, n_bands;
+
+  ws = GST_VIDEO_FORMAT_INFO_TILE_WS (finfo);
+  hs = GST_VIDEO_FORMAT_INFO_TILE_HS (finfo);
+  n_ty = (convert->in_height + (1 << hs) - 1) >> hs;
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = g_newa (FDetileTask, n_threads);
+  tasks_p = g_newa (FDetileTask *, n_threads);
+
+  /* bands are made of whole rows of tiles */
+  if (convert->band_lines == 0 || n_threads == 1)
+    band_tiles = (n_ty + n_threads - 1) / n_threads;
+  else
+    band_tiles = (convert->band_lines + (1 << hs) - 1) >> hs;
+  band_tiles = MAX (band_tiles, 1);
+  n_bands = (n_ty + band_tiles - 1) / band_tiles;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].src = src;
+    tasks[i].dest = dest;
+
+    tasks[i].width = convert->in_width;
+    tasks[i].height = convert->in_height;
+    tasks[i].ws = ws;
+    tasks[i].hs = hs;
+    tasks[i].band_tiles = band_tiles;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run_bands (convert->conversion_runner,
+      (GstParallelizedBandFunc) convert_NV12_64Z32_NV12_band,
+      (gpointer) tasks_p, n_bands);
+}
+
 static GstVideoFormat
 get_scale_format (GstVideoFormat format, gint plane)
 {
@@ -6191,6 +7174,89 @@ setup_scale (GstVideoConverter * convert)
   return TRUE;
 }
 
+static gboolean
+setup_scale_YUV_BGRA (GstVideoConverter * convert)
+{
+  gint method, cr_method, in_width, in_height, out_width, out_height;
+  gint in_cwidth, in_cheight, out_cwidth, out_cheight;
+  gsize size;
+  guint taps, j;
+  const GstVideoFormatInfo *in_finfo;
+  guint n_threads = convert->conversion_runner->n_threads;
+
+  in_finfo = convert->in_info.finfo;
+
+  method = GET_OPT_RESAMPLER_METHOD (convert);
+  if (method == GST_VIDEO_RESAMPLER_METHOD_NEAREST)
+    cr_method = method;
+  else
+    cr_method = GET_OPT_CHROMA_RESAMPLER_METHOD (convert);
+  taps = GET_OPT_RESAMPLER_TAPS (convert);
+
+  in_width = convert->in_width;
+  in_height = convert->in_height;
+  out_width = convert->out_width;
+  out_height = convert->out_height;
+
+  if (in_width == 0 || in_height == 0 || out_width == 0 || out_height == 0)
+    return FALSE;
+
+  /* the output is converted from a virtual scaled frame in the input format,
+   * so the chroma keeps the input subsampling */
+  in_cwidth =
+      GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (in_finfo, GST_VIDEO_COMP_U, in_width);
+  in_cheight =
+      GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (in_finfo, GST_VIDEO_COMP_U,
+      in_height);
+  out_cwidth =
+      GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (in_finfo, GST_VIDEO_COMP_U,
+      out_width);
+  out_cheight =
+      GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (in_finfo, GST_VIDEO_COMP_U,
+      out_height);
+
+  GST_DEBUG ("fused scale %dx%d -> %dx%d, chroma %dx%d -> %dx%d", in_width,
+      in_height, out_width, out_height, in_cwidth, in_cheight, out_cwidth,
+      out_cheight);
+
+  if (in_width != out_width) {
+    convert->fh_scaler[0].scaler = g_new (GstVideoScaler *, n_threads);
+    convert->fh_scaler[1].scaler = g_new (GstVideoScaler *, n_threads);
+    for (j = 0; j < n_threads; j++) {
+      convert->fh_scaler[0].scaler[j] =
+          gst_video_scaler_new (method, GST_VIDEO_SCALER_FLAG_NONE, taps,
+          in_width, out_width, convert->config);
+      convert->fh_scaler[1].scaler[j] =
+          gst_video_scaler_new (cr_method, GST_VIDEO_SCALER_FLAG_NONE, taps,
+          in_cwidth, out_cwidth, convert->config);
+    }
+  }
+  if (in_height != out_height) {
+    convert->fv_scaler[0].scaler = g_new (GstVideoScaler *, n_threads);
+    convert->fv_scaler[1].scaler = g_new (GstVideoScaler *, n_threads);
+    for (j = 0; j < n_threads; j++) {
+      convert->fv_scaler[0].scaler[j] =
+          gst_video_scaler_new (method, GST_VIDEO_SCALER_FLAG_NONE, taps,
+          in_height, out_height, convert->config);
+      convert->fv_scaler[1].scaler[j] =
+          gst_video_scaler_new (cr_method, GST_VIDEO_SCALER_FLAG_NONE, taps,
+          in_cheight, out_cheight, convert->config);
+    }
+  }
+
+  /* vertical and horizontal result lines for luma and chroma plus the
+   * deinterleaved chroma for NV12, see convert_YUV_BGRA_scale_task() */
+  size = GST_ROUND_UP_16 (in_width) + GST_ROUND_UP_16 (out_width) +
+      GST_ROUND_UP_16 (in_cwidth * 2) + GST_ROUND_UP_16 (out_cwidth * 2) +
+      2 * GST_ROUND_UP_16 (out_cwidth);
+  for (j = 0; j < n_threads; j++) {
+    g_free (convert->tmpline[j]);
+    convert->tmpline[j] = g_malloc0 (size);
+  }
+
+  return TRUE;
+}
+
 /* Fast paths */
 
 typedef struct
@@ -6464,6 +7530,10 @@ static const VideoTransform transforms[] = {
   {GST_VIDEO_FORMAT_YVU9, GST_VIDEO_FORMAT_YVU9, FALSE, FALSE, FALSE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
 
+  /* tiled -> semiplanar */
+  {GST_VIDEO_FORMAT_NV12_64Z32, GST_VIDEO_FORMAT_NV12, TRUE, FALSE, TRUE,
+      FALSE, FALSE, FALSE, FALSE, FALSE, 0, 0, convert_NV12_64Z32_NV12},
+
   /* sempiplanar -> semiplanar */
   {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_NV12, TRUE, FALSE, FALSE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
@@ -6520,6 +7590,20 @@ static const VideoTransform transforms[] = {
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_BGRA},
 
+  /* fused scale + convert */
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_BGRA_scale},
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_BGRA_scale},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_BGRA_scale},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_BGRA_scale},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_BGRA_scale},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_BGRA_scale},
+
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_ARGB},
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
@@ -6631,7 +7715,7 @@ video_converter_lookup_fastpath (GstVideoConverter * convert)
   GstVideoFormat in_format, out_format;
   GstVideoTransferFunction in_transf, out_transf;
   gboolean interlaced, same_matrix, same_primaries, same_size, crop, border;
-  gboolean need_copy, need_set, need_mult;
+  gboolean need_copy, need_set, need_mult, default_site;
   gint width, height;
 
   width = GST_VIDEO_INFO_WIDTH (&convert->in_info);
@@ -6688,7 +7772,23 @@ video_converter_lookup_fastpath (GstVideoConverter * convert)
       || convert->out_width < convert->out_maxwidth
       || convert->out_height < convert->out_maxheight;
 
+  /* the fused scale path scales chroma as a separate plane, only use it for
+   * the sitings gst_video_info_set_format() picks */
+  switch (convert->in_info.chroma_site) {
+    case GST_VIDEO_CHROMA_SITE_UNKNOWN:
+    case GST_VIDEO_CHROMA_SITE_NONE:
+    case GST_VIDEO_CHROMA_SITE_H_COSITED:
+      default_site = TRUE;
+      break;
+    default:
+      default_site = FALSE;
+      break;
+  }
+
   for (i = 0; i < sizeof (transforms) / sizeof (transforms[0]); i++) {
+    if (transforms[i].convert == convert_YUV_BGRA_scale && !default_site)
+      continue;
+
     if (transforms[i].in_format == in_format &&
         transforms[i].out_format == out_format &&
         (transforms[i].keeps_interlaced || !interlaced) &&
@@ -6713,9 +7813,13 @@ video_converter_lookup_fastpath (GstVideoConverter * convert)
       for (j = 0; j < convert->conversion_runner->n_threads; j++)
         convert->tmpline[j] = g_malloc0 (sizeof (guint16) * (width + 8) * 4);
 
-      if (!transforms[i].keeps_size)
+      if (transforms[i].convert == convert_YUV_BGRA_scale) {
+        if (!setup_scale_YUV_BGRA (convert))
+          return FALSE;
+      } else if (!transforms[i].keeps_size) {
         if (!setup_scale (convert))
           return FALSE;
+      }
       if (border)
         setup_borderline (convert);
       return TRUE;
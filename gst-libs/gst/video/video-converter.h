@@ -273,6 +273,30 @@ typedef enum {
  */
 #define GST_VIDEO_CONVERTER_OPT_THREADS   "GstVideoConverter.threads"
 
+/**
+ * GST_VIDEO_CONVERTER_OPT_SHARED_POOL:
+ *
+ * #G_TYPE_BOOLEAN, run the threads of the conversion on the process-wide
+ * pool of worker threads instead of starting private threads for this
+ * converter. See gst_video_converter_configure_shared_pool().
+ * Default %TRUE.
+ *
+ * Since: 1.14
+ */
+#define GST_VIDEO_CONVERTER_OPT_SHARED_POOL   "GstVideoConverter.shared-pool"
+
+/**
+ * GST_VIDEO_CONVERTER_OPT_BAND_LINES:
+ *
+ * #G_TYPE_UINT, when using more than one thread, split the frame into
+ * bands of this many lines that are processed by whichever thread is
+ * available next, instead of giving every thread one equal slice of the
+ * frame. Default 0, one equal slice per thread.
+ *
+ * Since: 1.14
+ */
+#define GST_VIDEO_CONVERTER_OPT_BAND_LINES   "GstVideoConverter.band-lines"
+
 typedef struct _GstVideoConverter GstVideoConverter;
 
 GstVideoConverter *  gst_video_converter_new            (GstVideoInfo *in_info,
@@ -286,6 +310,11 @@ const GstStructure * gst_video_converter_get_config     (GstVideoConverter * con
 void                 gst_video_converter_frame          (GstVideoConverter * convert,
                                                          const GstVideoFrame *src, GstVideoFrame *dest);
 
+gboolean             gst_video_converter_configure_shared_pool (guint max_threads,
+                                                         const guint * cpus, guint n_cpus);
+
+void                 gst_video_converter_clear_cache    (void);
+
 
 G_END_DECLS
 
@@ -0,0 +1,115 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <arm_neon.h>
+
+/* aarch64 always has NEON so these are used without a runtime check. Like
+ * the _lq ORC functions, products and sums wrap around in 16 bits and the
+ * result is (sum + 32) >> 6 with unsigned saturation. */
+
+static inline guint8
+scale_taps_u8_lq_neon (gint16 sum)
+{
+  sum = (gint16) (sum + 32) >> 6;
+  return CLAMP (sum, 0, 255);
+}
+
+static inline uint8x16_t
+pack_taps_u8_lq_neon (int16x8_t s0, int16x8_t s1)
+{
+  const int16x8_t round = vdupq_n_s16 (32);
+
+  s0 = vshrq_n_s16 (vaddq_s16 (s0, round), 6);
+  s1 = vshrq_n_s16 (vaddq_s16 (s1, round), 6);
+
+  return vcombine_u8 (vqmovun_s16 (s0), vqmovun_s16 (s1));
+}
+
+static void
+video_scale_h_ntap_u8_lq_neon (guint8 * d, const guint8 * pixels,
+    const gint16 * taps, gint n_taps, gint count)
+{
+  gint i = 0, j;
+
+  for (; i + 16 <= count; i += 16) {
+    const guint8 *p = pixels + i;
+    const gint16 *t = taps + i;
+    int16x8_t s0, s1;
+
+    s0 = vdupq_n_s16 (0);
+    s1 = vdupq_n_s16 (0);
+
+    for (j = 0; j < n_taps; j++) {
+      uint8x16_t v = vld1q_u8 (p);
+
+      s0 = vmlaq_s16 (s0, vreinterpretq_s16_u16 (vmovl_u8 (vget_low_u8 (v))),
+          vld1q_s16 (t));
+      s1 = vmlaq_s16 (s1, vreinterpretq_s16_u16 (vmovl_u8 (vget_high_u8 (v))),
+          vld1q_s16 (t + 8));
+      p += count;
+      t += count;
+    }
+    vst1q_u8 (d + i, pack_taps_u8_lq_neon (s0, s1));
+  }
+  for (; i < count; i++) {
+    gint16 sum = 0;
+
+    for (j = 0; j < n_taps; j++)
+      sum += (gint16) (pixels[j * count + i] * taps[j * count + i]);
+    d[i] = scale_taps_u8_lq_neon (sum);
+  }
+}
+
+static void
+video_scale_v_ntap_u8_lq_neon (guint8 * d, gpointer srcs[], gint src_inc,
+    const gint16 * taps, gint n_taps, gint count)
+{
+  gint i = 0, j;
+
+  for (; i + 16 <= count; i += 16) {
+    int16x8_t s0, s1;
+
+    s0 = vdupq_n_s16 (0);
+    s1 = vdupq_n_s16 (0);
+
+    for (j = 0; j < n_taps; j++) {
+      uint8x16_t v = vld1q_u8 ((const guint8 *) srcs[j * src_inc] + i);
+
+      s0 = vmlaq_n_s16 (s0,
+          vreinterpretq_s16_u16 (vmovl_u8 (vget_low_u8 (v))), taps[j]);
+      s1 = vmlaq_n_s16 (s1,
+          vreinterpretq_s16_u16 (vmovl_u8 (vget_high_u8 (v))), taps[j]);
+    }
+    vst1q_u8 (d + i, pack_taps_u8_lq_neon (s0, s1));
+  }
+  for (; i < count; i++) {
+    gint16 sum = 0;
+
+    for (j = 0; j < n_taps; j++)
+      sum += (gint16) (((const guint8 *) srcs[j * src_inc])[i] * taps[j]);
+    d[i] = scale_taps_u8_lq_neon (sum);
+  }
+}
+
+static void
+video_scaler_check_neon (void)
+{
+  GST_DEBUG ("enable NEON optimisations");
+  resample_h_ntap_u8_lq = video_scale_h_ntap_u8_lq_neon;
+  resample_v_ntap_u8_lq = video_scale_v_ntap_u8_lq_neon;
+}
@@ -0,0 +1,123 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "video-scaler-x86-avx2.h"
+
+#if defined (HAVE_IMMINTRIN_H) && defined (__AVX2__)
+
+#include <immintrin.h>
+
+/* These produce exactly the same result as the _lq ORC functions: products
+ * and sums wrap around in 16 bits and the result is (sum + 32) >> 6 with
+ * unsigned saturation. */
+
+static inline guint8
+scale_taps_u8_lq (gint16 sum)
+{
+  sum = (gint16) (sum + 32) >> 6;
+  return CLAMP (sum, 0, 255);
+}
+
+static inline void
+store_taps_u8_lq (guint8 * d, __m256i sum)
+{
+  sum = _mm256_add_epi16 (sum, _mm256_set1_epi16 (32));
+  sum = _mm256_srai_epi16 (sum, 6);
+  /* packus works on the 128 bit lanes separately */
+  _mm_storeu_si128 ((__m128i *) d,
+      _mm_packus_epi16 (_mm256_castsi256_si128 (sum),
+          _mm256_extracti128_si256 (sum, 1)));
+}
+
+void
+video_scale_h_ntap_u8_lq_avx2 (guint8 * d, const guint8 * pixels,
+    const gint16 * taps, gint n_taps, gint count)
+{
+  gint i = 0, j;
+
+  for (; i + 32 <= count; i += 32) {
+    const guint8 *p = pixels + i;
+    const gint16 *t = taps + i;
+    __m256i s0, s1, t0, t1;
+
+    s0 = _mm256_setzero_si256 ();
+    s1 = _mm256_setzero_si256 ();
+
+    for (j = 0; j < n_taps; j++) {
+      t0 = _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) p));
+      t1 = _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) (p +
+                  16)));
+      t0 = _mm256_mullo_epi16 (t0, _mm256_loadu_si256 ((const __m256i *) t));
+      t1 = _mm256_mullo_epi16 (t1,
+          _mm256_loadu_si256 ((const __m256i *) (t + 16)));
+      s0 = _mm256_add_epi16 (s0, t0);
+      s1 = _mm256_add_epi16 (s1, t1);
+      p += count;
+      t += count;
+    }
+    store_taps_u8_lq (d + i, s0);
+    store_taps_u8_lq (d + i + 16, s1);
+  }
+  for (; i < count; i++) {
+    gint16 sum = 0;
+
+    for (j = 0; j < n_taps; j++)
+      sum += (gint16) (pixels[j * count + i] * taps[j * count + i]);
+    d[i] = scale_taps_u8_lq (sum);
+  }
+}
+
+void
+video_scale_v_ntap_u8_lq_avx2 (guint8 * d, gpointer srcs[], gint src_inc,
+    const gint16 * taps, gint n_taps, gint count)
+{
+  gint i = 0, j;
+
+  for (; i + 32 <= count; i += 32) {
+    __m256i s0, s1, t0, t1, tap;
+
+    s0 = _mm256_setzero_si256 ();
+    s1 = _mm256_setzero_si256 ();
+
+    for (j = 0; j < n_taps; j++) {
+      const guint8 *p = (const guint8 *) srcs[j * src_inc] + i;
+
+      tap = _mm256_set1_epi16 (taps[j]);
+      t0 = _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) p));
+      t1 = _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) (p +
+                  16)));
+      s0 = _mm256_add_epi16 (s0, _mm256_mullo_epi16 (t0, tap));
+      s1 = _mm256_add_epi16 (s1, _mm256_mullo_epi16 (t1, tap));
+    }
+    store_taps_u8_lq (d + i, s0);
+    store_taps_u8_lq (d + i + 16, s1);
+  }
+  for (; i < count; i++) {
+    gint16 sum = 0;
+
+    for (j = 0; j < n_taps; j++)
+      sum += (gint16) (((const guint8 *) srcs[j * src_inc])[i] * taps[j]);
+    d[i] = scale_taps_u8_lq (sum);
+  }
+}
+
+#endif
@@ -0,0 +1,37 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "video-scaler-x86-avx2.h"
+
+static void
+video_scaler_check_x86 (void)
+{
+#if defined (HAVE_IMMINTRIN_H) && defined (HAVE_AVX2) && HAVE_AVX2 && \
+    defined (__GNUC__)
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2")) {
+    GST_DEBUG ("enable AVX2 optimisations");
+    resample_h_ntap_u8_lq = video_scale_h_ntap_u8_lq_avx2;
+    resample_v_ntap_u8_lq = video_scale_v_ntap_u8_lq_avx2;
+  } else {
+    GST_DEBUG ("AVX2 not supported by the CPU");
+  }
+#else
+  GST_DEBUG ("AVX2 optimisations not enabled");
+#endif
+}
@@ -105,6 +105,45 @@ struct _GstVideoScaler
   gpointer tmpline2;
 };
 
+/* SIMD versions of the low quality n-tap u8 scalers, the horizontal one
+ * works on the pixels and taps that were prepared for ORC */
+typedef void (*GstVideoScalerHTapsFunc) (guint8 * d, const guint8 * pixels,
+    const gint16 * taps, gint n_taps, gint count);
+typedef void (*GstVideoScalerVTapsFunc) (guint8 * d, gpointer srcs[],
+    gint src_inc, const gint16 * taps, gint n_taps, gint count);
+
+static GstVideoScalerHTapsFunc resample_h_ntap_u8_lq = NULL;
+static GstVideoScalerVTapsFunc resample_v_ntap_u8_lq = NULL;
+
+#if defined (__aarch64__)
+# define CHECK_NEON
+# include "video-scaler-neon.h"
+#endif
+#if defined (__i386__) || defined (__x86_64__)
+# define CHECK_X86
+# include "video-scaler-x86.h"
+#endif
+
+static void
+video_scaler_init (void)
+{
+  static gsize init_gonce = 0;
+
+  if (g_once_init_enter (&init_gonce)) {
+    if (g_getenv ("GST_VIDEO_SCALER_NO_SIMD")) {
+      GST_DEBUG ("SIMD optimisations disabled");
+    } else {
+#ifdef CHECK_X86
+      video_scaler_check_x86 ();
+#endif
+#ifdef CHECK_NEON
+      video_scaler_check_neon ();
+#endif
+    }
+    g_once_init_leave (&init_gonce, 1);
+  }
+}
+
 static void
 resampler_zip (GstVideoResampler * resampler, const GstVideoResampler * r1,
     const GstVideoResampler * r2)
@@ -215,6 +254,8 @@ gst_video_scaler_new (GstVideoResamplerMethod method, GstVideoScalerFlags flags,
   g_return_val_if_fail (in_size != 0, NULL);
   g_return_val_if_fail (out_size != 0, NULL);
 
+  video_scaler_init ();
+
   scale = g_slice_new0 (GstVideoScaler);
 
   GST_DEBUG ("%d %u  %u->%u", method, n_taps, in_size, out_size);
@@ -697,6 +738,8 @@ video_scale_h_ntap_u8 (GstVideoScaler * scale,
   if (max_taps == 2) {
     video_orc_resample_h_2tap_u8_lq (d, pixels, pixels + count, taps,
         taps + count, count);
+  } else if (resample_h_ntap_u8_lq) {
+    resample_h_ntap_u8_lq (d, pixels, taps, max_taps, count);
   } else {
     /* first pixels with first tap to temp */
     if (max_taps >= 3) {
@@ -971,8 +1014,11 @@ video_scale_v_4tap_u8 (GstVideoScaler * scale,
   p4 = taps[3];
 
 #ifdef LQ
-  video_orc_resample_v_4tap_u8_lq (d, s1, s2, s3, s4, p1, p2, p3, p4,
-      width * n_elems);
+  if (resample_v_ntap_u8_lq)
+    resample_v_ntap_u8_lq (d, srcs, src_inc, taps, 4, width * n_elems);
+  else
+    video_orc_resample_v_4tap_u8_lq (d, s1, s2, s3, s4, p1, p2, p3, p4,
+        width * n_elems);
 #else
   video_orc_resample_v_4tap_u8 (d, s1, s2, s3, s4, p1, p2, p3, p4,
       width * n_elems);
@@ -1010,6 +1056,11 @@ video_scale_v_ntap_u8 (GstVideoScaler * scale,
   count = width * n_elems;
 
 #ifdef LQ
+  if (resample_v_ntap_u8_lq) {
+    resample_v_ntap_u8_lq (d, srcs, src_inc, taps, max_taps, count);
+    return;
+  }
+
   if (max_taps >= 4) {
     video_orc_resample_v_multaps4_u8_lq (temp, srcs[0], srcs[1 * src_inc],
         srcs[2 * src_inc], srcs[3 * src_inc], taps[0], taps[1], taps[2],
@@ -34,6 +34,12 @@
  * audio mixing element: It will sync input streams correctly and also handle
  * live inputs properly.
  *
+ * With many inputs the mixing can be spread over several threads with the
+ * #GstAdder:n-threads property. When #GstAdder:mix-minus is set, every
+ * requested sink pad gets a src pad with the same number that outputs the
+ * mix of all the other sink pads, as needed for the participants of a
+ * conference. All of these mixes are made in one pass over the inputs.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 audiotestsrc freq=100 ! adder name=mix ! audioconvert ! autoaudiosink audiotestsrc freq=500 ! mix.
@@ -150,10 +156,17 @@ gst_adder_pad_init (GstAdderPad * pad)
   pad->mute = DEFAULT_PAD_MUTE;
 }
 
+#define DEFAULT_N_THREADS 1
+#define DEFAULT_MIX_MINUS FALSE
+#define DEFAULT_ACCUMULATE FALSE
+
 enum
 {
   PROP_0,
-  PROP_FILTER_CAPS
+  PROP_FILTER_CAPS,
+  PROP_N_THREADS,
+  PROP_MIX_MINUS,
+  PROP_ACCUMULATE
 };
 
 /* elementfactory information */
@@ -182,6 +195,13 @@ GST_STATIC_PAD_TEMPLATE ("sink_%u",
     GST_STATIC_CAPS (CAPS)
     );
 
+static GstStaticPadTemplate gst_adder_minus_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS (CAPS)
+    );
+
 static void gst_adder_child_proxy_init (gpointer g_iface, gpointer iface_data);
 
 #define gst_adder_parent_class parent_class
@@ -189,6 +209,7 @@ G_DEFINE_TYPE_WITH_CODE (GstAdder, gst_adder, GST_TYPE_ELEMENT,
     G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY, gst_adder_child_proxy_init));
 
 static void gst_adder_dispose (GObject * object);
+static void gst_adder_finalize (GObject * object);
 static void gst_adder_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_adder_get_property (GObject * object, guint prop_id,
@@ -623,6 +644,30 @@ done:
   return ret;
 }
 
+/* pushes @event on the src pad and on all mix-minus src pads, takes
+ * ownership of the event
+ *
+ * Returns: the result of pushing on the src pad.
+ */
+static gboolean
+gst_adder_push_event (GstAdder * adder, GstEvent * event)
+{
+  GList *minus_pads = NULL, *l;
+
+  GST_OBJECT_LOCK (adder);
+  for (l = GST_ELEMENT_CAST (adder)->srcpads; l; l = l->next) {
+    if (l->data != adder->srcpad)
+      minus_pads = g_list_prepend (minus_pads, gst_object_ref (l->data));
+  }
+  GST_OBJECT_UNLOCK (adder);
+
+  for (l = minus_pads; l; l = l->next)
+    gst_pad_push_event (l->data, gst_event_ref (event));
+  g_list_free_full (minus_pads, gst_object_unref);
+
+  return gst_pad_push_event (adder->srcpad, event);
+}
+
 static gboolean
 gst_adder_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -680,7 +725,7 @@ gst_adder_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
          * We send a flush-start before, to ensure no streaming is done
          * as we need to take the stream lock.
          */
-        gst_pad_push_event (adder->srcpad, gst_event_new_flush_start ());
+        gst_adder_push_event (adder, gst_event_new_flush_start ());
         gst_collect_pads_set_flushing (adder->collect, TRUE);
 
         /* We can't send FLUSH_STOP here since upstream could start pushing data
@@ -729,8 +774,7 @@ gst_adder_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       if (g_atomic_int_compare_and_exchange (&adder->flush_stop_pending,
               TRUE, FALSE)) {
         GST_DEBUG_OBJECT (adder, "pending flush stop");
-        if (!gst_pad_push_event (adder->srcpad,
-                gst_event_new_flush_stop (TRUE))) {
+        if (!gst_adder_push_event (adder, gst_event_new_flush_stop (TRUE))) {
           GST_WARNING_OBJECT (adder, "Sending flush stop event failed");
         }
       }
@@ -849,6 +893,7 @@ gst_adder_class_init (GstAdderClass * klass)
   gobject_class->set_property = gst_adder_set_property;
   gobject_class->get_property = gst_adder_get_property;
   gobject_class->dispose = gst_adder_dispose;
+  gobject_class->finalize = gst_adder_finalize;
 
   g_object_class_install_property (gobject_class, PROP_FILTER_CAPS,
       g_param_spec_boxed ("caps", "Target caps",
@@ -857,10 +902,69 @@ gst_adder_class_init (GstAdderClass * klass)
           "object.", GST_TYPE_CAPS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAdder:n-threads:
+   *
+   * The maximum number of threads to mix with. The samples are split into
+   * ranges that are mixed in parallel when there is enough data, the
+   * result is the same as with one thread. 0 uses one thread per CPU.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Maximum number of threads to mix with (0 = one per CPU)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAdder:mix-minus:
+   *
+   * Add a src pad for every sink pad that is requested while this is set,
+   * with the same number as the sink pad. It outputs the mix of all other
+   * sink pads, which is what a participant of a conference should hear.
+   *
+   * With integer samples and #GstAdder:accumulate not set, these outputs
+   * are made by adding the clipped sum of the inputs before the own input
+   * to the clipped sum of the inputs after it. When the mix clips, this can
+   * differ from what a separate adder with only the other inputs would
+   * output. Set #GstAdder:accumulate to get exactly that mix.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_MIX_MINUS,
+      g_param_spec_boolean ("mix-minus", "Mix minus",
+          "Add a src pad with the mix of all other sink pads for every "
+          "new sink pad", DEFAULT_MIX_MINUS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAdder:accumulate:
+   *
+   * Sum integer samples in a wider integer and clip only the final mix,
+   * instead of clipping after every added input. Loud inputs that cancel
+   * out don't distort the mix then, and the mix-minus outputs are exactly
+   * the mix without the own input. Float samples are never clipped and
+   * are always mixed directly.
+   *
+   * Unsigned samples are mixed around their midpoint in this mode, so that
+   * silent inputs leave the mix silent. The default mode adds the raw
+   * unsigned values, so for unsigned formats the two modes give different
+   * results even when nothing clips.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_ACCUMULATE,
+      g_param_spec_boolean ("accumulate", "Accumulate",
+          "Sum integer samples with more headroom and clip the mix once",
+          DEFAULT_ACCUMULATE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_adder_src_template);
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_adder_sink_template);
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &gst_adder_minus_src_template);
   gst_element_class_set_static_metadata (gstelement_class, "Adder",
       "Generic/Audio", "Add N audio channels together",
       "Thomas Vander Stichele <thomas at apestaart dot org>");
@@ -893,6 +997,12 @@ gst_adder_init (GstAdder * adder)
 
   adder->filter_caps = NULL;
 
+  adder->n_threads = DEFAULT_N_THREADS;
+  g_mutex_init (&adder->lock);
+  g_cond_init (&adder->cond);
+  adder->mix_minus = DEFAULT_MIX_MINUS;
+  adder->accumulate = DEFAULT_ACCUMULATE;
+
   /* keep track of the sinkpads requested */
   adder->collect = gst_collect_pads_new ();
   gst_collect_pads_set_function (adder->collect,
@@ -926,6 +1036,17 @@ gst_adder_dispose (GObject * object)
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_adder_finalize (GObject * object)
+{
+  GstAdder *adder = GST_ADDER (object);
+
+  g_mutex_clear (&adder->lock);
+  g_cond_clear (&adder->cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_adder_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -954,6 +1075,21 @@ gst_adder_set_property (GObject * object, guint prop_id,
       GST_DEBUG_OBJECT (adder, "set new caps %" GST_PTR_FORMAT, new_caps);
       break;
     }
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (adder);
+      adder->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (adder);
+      break;
+    case PROP_MIX_MINUS:
+      GST_OBJECT_LOCK (adder);
+      adder->mix_minus = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (adder);
+      break;
+    case PROP_ACCUMULATE:
+      GST_OBJECT_LOCK (adder);
+      adder->accumulate = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (adder);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -972,6 +1108,21 @@ gst_adder_get_property (GObject * object, guint prop_id, GValue * value,
       gst_value_set_caps (value, adder->filter_caps);
       GST_OBJECT_UNLOCK (adder);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (adder);
+      g_value_set_uint (value, adder->n_threads);
+      GST_OBJECT_UNLOCK (adder);
+      break;
+    case PROP_MIX_MINUS:
+      GST_OBJECT_LOCK (adder);
+      g_value_set_boolean (value, adder->mix_minus);
+      GST_OBJECT_UNLOCK (adder);
+      break;
+    case PROP_ACCUMULATE:
+      GST_OBJECT_LOCK (adder);
+      g_value_set_boolean (value, adder->accumulate);
+      GST_OBJECT_UNLOCK (adder);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -979,6 +1130,46 @@ gst_adder_get_property (GObject * object, guint prop_id, GValue * value,
 }
 
 
+static gboolean
+copy_sticky_event (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  GstPad *minus_srcpad = user_data;
+
+  gst_pad_store_sticky_event (minus_srcpad, *event);
+
+  return TRUE;
+}
+
+/* adds the mix-minus src pad for @pad */
+static void
+gst_adder_add_minus_pad (GstAdder * adder, GstAdderPad * pad, gint padcount)
+{
+  GstPad *minus_srcpad;
+  gchar *name;
+
+  name = g_strdup_printf ("src_%u", padcount);
+  minus_srcpad =
+      gst_pad_new_from_static_template (&gst_adder_minus_src_template, name);
+  GST_DEBUG_OBJECT (adder, "adding mix-minus pad %s", name);
+  g_free (name);
+
+  gst_pad_set_query_function (minus_srcpad,
+      GST_DEBUG_FUNCPTR (gst_adder_src_query));
+  gst_pad_set_event_function (minus_srcpad,
+      GST_DEBUG_FUNCPTR (gst_adder_src_event));
+  GST_PAD_SET_PROXY_CAPS (minus_srcpad);
+
+  GST_OBJECT_LOCK (pad);
+  pad->minus_srcpad = gst_object_ref (minus_srcpad);
+  GST_OBJECT_UNLOCK (pad);
+
+  gst_element_add_pad (GST_ELEMENT_CAST (adder), minus_srcpad);
+
+  /* when added while running, start where the main src pad is */
+  gst_pad_sticky_events_foreach (adder->srcpad, copy_sticky_event,
+      minus_srcpad);
+}
+
 static GstPad *
 gst_adder_request_new_pad (GstElement * element, GstPadTemplate * templ,
     const gchar * unused, const GstCaps * caps)
@@ -987,6 +1178,7 @@ gst_adder_request_new_pad (GstElement * element, GstPadTemplate * templ,
   GstAdder *adder;
   GstPad *newpad;
   gint padcount;
+  gboolean mix_minus;
 
   if (templ->direction != GST_PAD_SINK)
     goto not_sink;
@@ -1012,6 +1204,12 @@ gst_adder_request_new_pad (GstElement * element, GstPadTemplate * templ,
   gst_child_proxy_child_added (GST_CHILD_PROXY (adder), G_OBJECT (newpad),
       GST_OBJECT_NAME (newpad));
 
+  GST_OBJECT_LOCK (adder);
+  mix_minus = adder->mix_minus;
+  GST_OBJECT_UNLOCK (adder);
+  if (mix_minus)
+    gst_adder_add_minus_pad (adder, GST_ADDER_PAD (newpad), padcount);
+
   return newpad;
 
   /* errors */
@@ -1042,6 +1240,21 @@ gst_adder_release_pad (GstElement * element, GstPad * pad)
       GST_OBJECT_NAME (pad));
   if (adder->collect)
     gst_collect_pads_remove_pad (adder->collect, pad);
+
+  if (GST_IS_ADDER_PAD (pad)) {
+    GstPad *minus_srcpad;
+
+    GST_OBJECT_LOCK (pad);
+    minus_srcpad = GST_ADDER_PAD (pad)->minus_srcpad;
+    GST_ADDER_PAD (pad)->minus_srcpad = NULL;
+    GST_OBJECT_UNLOCK (pad);
+
+    if (minus_srcpad) {
+      gst_pad_set_active (minus_srcpad, FALSE);
+      gst_element_remove_pad (element, minus_srcpad);
+      gst_object_unref (minus_srcpad);
+    }
+  }
   gst_element_remove_pad (element, pad);
 }
 
@@ -1061,6 +1274,432 @@ gst_adder_do_clip (GstCollectPads * pads, GstCollectData * data,
   return GST_FLOW_OK;
 }
 
+/* mixing */
+
+/* minimum number of samples times inputs to mix on a thread */
+#define MIN_JOB_WORK 32768
+/* ranges of samples of the jobs are a multiple of this */
+#define JOB_ALIGN 64
+
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gdouble volume;
+  gint volume_i8;
+  gint volume_i16;
+  gint volume_i32;
+
+  /* the mix of all other inputs, for the mix-minus src pad */
+  GstPad *minus_srcpad;
+  GstBuffer *minus_buffer;
+  GstMapInfo minus_map;
+} AdderInput;
+
+typedef struct
+{
+  const GstAudioFormatInfo *finfo;
+  gint bps;
+  /* the first input is mixed in place, it becomes the output buffer */
+  AdderInput *inputs;
+  guint n_inputs;
+  /* sum the inputs in a wider integer of acc_bps bytes */
+  gboolean accumulate;
+  gint acc_bps;
+  /* scratch space for the sums */
+  guint8 *acc;
+} AdderMix;
+
+typedef struct
+{
+  GstAdder *adder;
+  AdderMix *mix;
+  gsize offset;
+  gsize len;
+} AdderJob;
+
+static void
+adder_volume (GstAudioFormat format, gpointer data, const AdderInput * input,
+    gint n)
+{
+  switch (format) {
+    case GST_AUDIO_FORMAT_U8:
+      adder_orc_volume_u8 (data, input->volume_i8, n);
+      break;
+    case GST_AUDIO_FORMAT_S8:
+      adder_orc_volume_s8 (data, input->volume_i8, n);
+      break;
+    case GST_AUDIO_FORMAT_U16:
+      adder_orc_volume_u16 (data, input->volume_i16, n);
+      break;
+    case GST_AUDIO_FORMAT_S16:
+      adder_orc_volume_s16 (data, input->volume_i16, n);
+      break;
+    case GST_AUDIO_FORMAT_U32:
+      adder_orc_volume_u32 (data, input->volume_i32, n);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      adder_orc_volume_s32 (data, input->volume_i32, n);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      adder_orc_volume_f32 (data, input->volume, n);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      adder_orc_volume_f64 (data, input->volume, n);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
+
+/* add @n samples of @data to @out, with the volume of @input or unscaled when
+ * @input is NULL */
+static void
+adder_add (GstAudioFormat format, gpointer out, gpointer data,
+    const AdderInput * input, gint n)
+{
+  if (input == NULL || input->volume == 1.0) {
+    switch (format) {
+      case GST_AUDIO_FORMAT_U8:
+        adder_orc_add_u8 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_S8:
+        adder_orc_add_s8 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_U16:
+        adder_orc_add_u16 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_S16:
+        adder_orc_add_s16 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_U32:
+        adder_orc_add_u32 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        adder_orc_add_s32 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        adder_orc_add_f32 (out, data, n);
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        adder_orc_add_f64 (out, data, n);
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+  } else {
+    switch (format) {
+      case GST_AUDIO_FORMAT_U8:
+        adder_orc_add_volume_u8 (out, data, input->volume_i8, n);
+        break;
+      case GST_AUDIO_FORMAT_S8:
+        adder_orc_add_volume_s8 (out, data, input->volume_i8, n);
+        break;
+      case GST_AUDIO_FORMAT_U16:
+        adder_orc_add_volume_u16 (out, data, input->volume_i16, n);
+        break;
+      case GST_AUDIO_FORMAT_S16:
+        adder_orc_add_volume_s16 (out, data, input->volume_i16, n);
+        break;
+      case GST_AUDIO_FORMAT_U32:
+        adder_orc_add_volume_u32 (out, data, input->volume_i32, n);
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        adder_orc_add_volume_s32 (out, data, input->volume_i32, n);
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        adder_orc_add_volume_f32 (out, data, input->volume, n);
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        adder_orc_add_volume_f64 (out, data, input->volume, n);
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+  }
+}
+
+/* Functions for the accumulate mode. The samples are made signed, scaled with
+ * the volume like the ORC functions do and summed in @acctype. The mix and the
+ * mix-minus outputs are clipped once at the end. Unlike the ORC adds, unsigned
+ * samples have their bias removed before summing. */
+#define MAKE_ACCUMULATE_FUNCS(fmt,type,acctype,vol,shift,bias,min,max)     \
+static void                                                               \
+adder_accumulate_##fmt (acctype * acc, const type * in,                   \
+    const AdderInput * input, gint n)                                     \
+{                                                                         \
+  acctype volume = input->vol;                                            \
+  gint i;                                                                 \
+                                                                          \
+  if (input->volume == 1.0) {                                             \
+    for (i = 0; i < n; i++)                                               \
+      acc[i] += (acctype) in[i] - (bias);                                 \
+  } else {                                                                \
+    for (i = 0; i < n; i++)                                               \
+      acc[i] += (((acctype) in[i] - (bias)) * volume) >> (shift);         \
+  }                                                                       \
+}                                                                         \
+                                                                          \
+static void                                                               \
+adder_clip_##fmt (type * out, const acctype * acc, gint n)                \
+{                                                                         \
+  gint i;                                                                 \
+                                                                          \
+  for (i = 0; i < n; i++)                                                 \
+    out[i] = CLAMP (acc[i], (min), (max)) + (bias);                       \
+}                                                                         \
+                                                                          \
+static void                                                               \
+adder_clip_minus_##fmt (type * out, const acctype * acc, const type * in, \
+    const AdderInput * input, gint n)                                     \
+{                                                                         \
+  acctype volume = input->vol, v;                                         \
+  gint i;                                                                 \
+                                                                          \
+  if (input->volume == 1.0) {                                             \
+    for (i = 0; i < n; i++) {                                             \
+      v = acc[i] - ((acctype) in[i] - (bias));                            \
+      out[i] = CLAMP (v, (min), (max)) + (bias);                          \
+    }                                                                     \
+  } else {                                                                \
+    for (i = 0; i < n; i++) {                                             \
+      v = acc[i] - ((((acctype) in[i] - (bias)) * volume) >> (shift));    \
+      out[i] = CLAMP (v, (min), (max)) + (bias);                          \
+    }                                                                     \
+  }                                                                       \
+}
+
+MAKE_ACCUMULATE_FUNCS (s8, gint8, gint32, volume_i8,
+    VOLUME_UNITY_INT8_BIT_SHIFT, 0, G_MININT8, G_MAXINT8)
+MAKE_ACCUMULATE_FUNCS (u8, guint8, gint32, volume_i8,
+    VOLUME_UNITY_INT8_BIT_SHIFT, 0x80, G_MININT8, G_MAXINT8)
+MAKE_ACCUMULATE_FUNCS (s16, gint16, gint32, volume_i16,
+    VOLUME_UNITY_INT16_BIT_SHIFT, 0, G_MININT16, G_MAXINT16)
+MAKE_ACCUMULATE_FUNCS (u16, guint16, gint32, volume_i16,
+    VOLUME_UNITY_INT16_BIT_SHIFT, 0x8000, G_MININT16, G_MAXINT16)
+MAKE_ACCUMULATE_FUNCS (s32, gint32, gint64, volume_i32,
+    VOLUME_UNITY_INT32_BIT_SHIFT, 0, G_MININT32, G_MAXINT32)
+MAKE_ACCUMULATE_FUNCS (u32, guint32, gint64, volume_i32,
+    VOLUME_UNITY_INT32_BIT_SHIFT, G_GINT64_CONSTANT (0x80000000), G_MININT32,
+    G_MAXINT32)
+
+#define ACCUMULATE_CASE(FMT,fmt,type,acctype)                             \
+  case GST_AUDIO_FORMAT_##FMT:                                            \
+  {                                                                       \
+    acctype *acc = (acctype *) mix->acc + offset;                         \
+                                                                          \
+    for (i = 0; i < n_inputs; i++)                                        \
+      adder_accumulate_##fmt (acc, (type *) inputs[i].map.data + offset,  \
+          &inputs[i], len);                                               \
+    for (i = 0; i < n_inputs; i++) {                                      \
+      if (inputs[i].minus_buffer)                                         \
+        adder_clip_minus_##fmt ((type *) inputs[i].minus_map.data + offset, \
+            acc, (type *) inputs[i].map.data + offset, &inputs[i], len);  \
+    }                                                                     \
+    adder_clip_##fmt ((type *) inputs[0].map.data + offset, acc, len);    \
+    break;                                                                \
+  }
+
+/* mix @len samples starting from sample @offset in the accumulator. The
+ * mix-minus outputs are the sum without the own input, they are made before
+ * the first input is overwritten with the mix. */
+static void
+adder_accumulate_range (AdderMix * mix, gsize offset, gsize len)
+{
+  AdderInput *inputs = mix->inputs;
+  gint i, n_inputs = mix->n_inputs;
+
+  memset (mix->acc + offset * mix->acc_bps, 0, len * mix->acc_bps);
+
+  switch (GST_AUDIO_FORMAT_INFO_FORMAT (mix->finfo)) {
+      ACCUMULATE_CASE (S8, s8, gint8, gint32);
+      ACCUMULATE_CASE (U8, u8, guint8, gint32);
+      ACCUMULATE_CASE (S16, s16, gint16, gint32);
+      ACCUMULATE_CASE (U16, u16, guint16, gint32);
+      ACCUMULATE_CASE (S32, s32, gint32, gint64);
+      ACCUMULATE_CASE (U32, u32, guint32, gint64);
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
+
+/* mix @len samples starting from sample @offset of all inputs */
+static void
+adder_mix_range (AdderMix * mix, gsize offset, gsize len)
+{
+  GstAudioFormat format = GST_AUDIO_FORMAT_INFO_FORMAT (mix->finfo);
+  AdderInput *inputs = mix->inputs;
+  gsize off = offset * mix->bps, size = len * mix->bps;
+  gint i, n_inputs = mix->n_inputs;
+
+  if (mix->accumulate) {
+    adder_accumulate_range (mix, offset, len);
+    return;
+  }
+
+  if (mix->acc) {
+    guint8 *acc = mix->acc + off;
+
+    /* the mix-minus buffers get the sum of all inputs before them and then
+     * the sum of all inputs after them. This makes all of them in one pass
+     * over the inputs in each direction. It needs to be done before the
+     * first input is overwritten by the mix below. */
+    gst_audio_format_fill_silence (mix->finfo, acc, size);
+    for (i = 0; i < n_inputs; i++) {
+      if (inputs[i].minus_buffer)
+        memcpy (inputs[i].minus_map.data + off, acc, size);
+      if (i < n_inputs - 1)
+        adder_add (format, acc, inputs[i].map.data + off, &inputs[i], len);
+    }
+    gst_audio_format_fill_silence (mix->finfo, acc, size);
+    for (i = n_inputs - 1; i >= 0; i--) {
+      if (inputs[i].minus_buffer)
+        adder_add (format, inputs[i].minus_map.data + off, acc, NULL, len);
+      if (i > 0)
+        adder_add (format, acc, inputs[i].map.data + off, &inputs[i], len);
+    }
+  }
+
+  if (inputs[0].volume != 1.0)
+    adder_volume (format, inputs[0].map.data + off, &inputs[0], len);
+  for (i = 1; i < n_inputs; i++)
+    adder_add (format, inputs[0].map.data + off, inputs[i].map.data + off,
+        &inputs[i], len);
+}
+
+static void
+gst_adder_job_func (gpointer data, gpointer user_data)
+{
+  AdderJob *job = data;
+  GstAdder *adder = job->adder;
+
+  adder_mix_range (job->mix, job->offset, job->len);
+
+  g_mutex_lock (&adder->lock);
+  if (--adder->n_pending == 0)
+    g_cond_signal (&adder->cond);
+  g_mutex_unlock (&adder->lock);
+}
+
+/* mix @samples samples of all inputs of @mix, split in ranges that are mixed
+ * in parallel when there is enough work. Every sample is mixed the same way
+ * as without threads so the result does not depend on the number of
+ * threads. */
+static void
+gst_adder_mix (GstAdder * adder, AdderMix * mix, gsize samples)
+{
+  AdderJob *jobs;
+  guint i, n_threads, n_jobs;
+  gsize offset;
+
+  GST_OBJECT_LOCK (adder);
+  n_threads = adder->n_threads;
+  GST_OBJECT_UNLOCK (adder);
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  n_jobs = MIN (n_threads, samples * mix->n_inputs / MIN_JOB_WORK);
+  n_jobs = MIN (n_jobs, samples / JOB_ALIGN);
+
+  if (n_jobs > 1 && adder->pool == NULL) {
+    GError *err = NULL;
+
+    /* the streaming thread mixes one of the ranges itself */
+    adder->pool = g_thread_pool_new (gst_adder_job_func, NULL, -1, FALSE,
+        &err);
+    if (adder->pool == NULL) {
+      GST_WARNING_OBJECT (adder, "failed to create thread pool: %s",
+          err->message);
+      g_clear_error (&err);
+    }
+  }
+
+  if (n_jobs <= 1 || adder->pool == NULL) {
+    adder_mix_range (mix, 0, samples);
+    return;
+  }
+
+  GST_LOG_OBJECT (adder, "mixing %" G_GSIZE_FORMAT " samples of %u inputs "
+      "in %u jobs", samples, mix->n_inputs, n_jobs);
+
+  jobs = g_newa (AdderJob, n_jobs);
+  adder->n_pending = n_jobs - 1;
+
+  for (i = 0, offset = 0; i < n_jobs; i++) {
+    AdderJob *job = &jobs[i];
+
+    job->adder = adder;
+    job->mix = mix;
+    job->offset = offset;
+    if (i == n_jobs - 1)
+      job->len = samples - offset;
+    else
+      job->len = ((samples - offset) / (n_jobs - i)) & ~(JOB_ALIGN - 1);
+    offset += job->len;
+
+    if (i < n_jobs - 1)
+      g_thread_pool_push (adder->pool, job, NULL);
+  }
+  adder_mix_range (mix, jobs[n_jobs - 1].offset, jobs[n_jobs - 1].len);
+
+  g_mutex_lock (&adder->lock);
+  while (adder->n_pending > 0)
+    g_cond_wait (&adder->cond, &adder->lock);
+  g_mutex_unlock (&adder->lock);
+}
+
+static void
+gst_adder_clear_inputs (AdderMix * mix)
+{
+  guint i;
+
+  for (i = 0; i < mix->n_inputs; i++) {
+    if (mix->inputs[i].minus_buffer)
+      gst_buffer_unref (mix->inputs[i].minus_buffer);
+    if (mix->inputs[i].minus_srcpad)
+      gst_object_unref (mix->inputs[i].minus_srcpad);
+  }
+  g_free (mix->inputs);
+  mix->inputs = NULL;
+  mix->n_inputs = 0;
+}
+
+/* prepends the mix-minus src pad of @pad to @list, if it has one */
+static GSList *
+gst_adder_add_minus_srcpad (GSList * list, GstAdderPad * pad)
+{
+  GST_OBJECT_LOCK (pad);
+  if (pad->minus_srcpad)
+    list = g_slist_prepend (list, gst_object_ref (pad->minus_srcpad));
+  GST_OBJECT_UNLOCK (pad);
+
+  return list;
+}
+
+/* pushes @buffer on a mix-minus src pad. Returns @ret, or the error of the
+ * push when @ret was OK. Unlinked and EOS pads are not an error, the other
+ * pads keep getting data. */
+static GstFlowReturn
+gst_adder_push_minus (GstAdder * adder, GstPad * pad, GstBuffer * buffer,
+    GstFlowReturn ret)
+{
+  GstFlowReturn res;
+
+  res = gst_pad_push (pad, buffer);
+  GST_LOG_OBJECT (pad, "pushed mix-minus buffer, result = %s",
+      gst_flow_get_name (res));
+
+  if (ret == GST_FLOW_OK && res < GST_FLOW_EOS)
+    ret = res;
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_adder_collected (GstCollectPads * pads, gpointer user_data)
 {
@@ -1070,9 +1709,11 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
    * - this function is called when all pads have a buffer
    * - get available bytes on all pads.
    * - repeat for each input pad :
-   *   - read available bytes, copy or add to target buffer
+   *   - take available bytes, the first buffer becomes the target buffer
    *   - if there's an EOS event, remove the input channel
-   * - push out the output buffer
+   * - add the other buffers to the target buffer and make the mix-minus
+   *   buffers, possibly on several threads
+   * - push out the output buffers
    *
    * todo:
    * - would be nice to have a mixing mode, where instead of adding we mix
@@ -1081,11 +1722,11 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
    *     mix into a temp (float) buffer and scale afterwards as well
    */
   GstAdder *adder;
-  GSList *collected, *next = NULL;
-  GstFlowReturn ret;
+  GSList *collected, *next = NULL, *minus_full = NULL, *l;
+  GstFlowReturn ret, mret;
   GstBuffer *outbuf = NULL, *gapbuf = NULL;
-  GstMapInfo outmap = { NULL };
-  guint outsize;
+  AdderMix mix;
+  guint i, outsize;
   gint64 next_offset;
   gint64 next_timestamp;
   gint rate, bps, bpf;
@@ -1101,7 +1742,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
 
   if (adder->flush_stop_pending) {
     GST_INFO_OBJECT (adder->srcpad, "send pending flush stop event");
-    if (!gst_pad_push_event (adder->srcpad, gst_event_new_flush_stop (TRUE))) {
+    if (!gst_adder_push_event (adder, gst_event_new_flush_stop (TRUE))) {
       GST_WARNING_OBJECT (adder->srcpad, "Sending flush stop event failed");
     }
 
@@ -1120,7 +1761,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
     event = gst_event_new_stream_start (s_id);
     gst_event_set_group_id (event, gst_util_group_id_next ());
 
-    if (!gst_pad_push_event (adder->srcpad, event)) {
+    if (!gst_adder_push_event (adder, event)) {
       GST_WARNING_OBJECT (adder->srcpad, "Sending stream start event failed");
     }
     adder->send_stream_start = FALSE;
@@ -1132,7 +1773,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
     caps_event = gst_event_new_caps (adder->current_caps);
     GST_INFO_OBJECT (adder->srcpad, "send pending caps event %" GST_PTR_FORMAT,
         caps_event);
-    if (!gst_pad_push_event (adder->srcpad, caps_event)) {
+    if (!gst_adder_push_event (adder, caps_event)) {
       GST_WARNING_OBJECT (adder->srcpad, "Sending caps event failed");
     }
     adder->send_caps = FALSE;
@@ -1163,7 +1804,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
     GST_INFO_OBJECT (adder->srcpad, "sending pending new segment event %"
         GST_SEGMENT_FORMAT, &adder->segment);
     if (event) {
-      if (!gst_pad_push_event (adder->srcpad, event)) {
+      if (!gst_adder_push_event (adder, event)) {
         GST_WARNING_OBJECT (adder->srcpad, "Sending new segment event failed");
       }
     } else {
@@ -1182,12 +1823,25 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
       "starting to cycle through channels, %d bytes available (bps = %d, bpf = %d)",
       outsize, bps, bpf);
 
+  mix.finfo = adder->info.finfo;
+  mix.bps = bps;
+  GST_OBJECT_LOCK (adder);
+  mix.accumulate = adder->accumulate
+      && GST_AUDIO_FORMAT_INFO_IS_INTEGER (mix.finfo);
+  GST_OBJECT_UNLOCK (adder);
+  /* 8 and 16 bits are summed in 32 bits, 32 bits in 64 bits */
+  mix.acc_bps = mix.accumulate ? (bps == 4 ? 8 : 4) : bps;
+  mix.inputs = g_new0 (AdderInput, g_slist_length (pads->data));
+  mix.n_inputs = 0;
+  mix.acc = NULL;
+
   for (collected = pads->data; collected; collected = next) {
     GstCollectData *collect_data;
     GstBuffer *inbuf;
     gboolean is_gap;
     GstAdderPad *pad;
     GstClockTime timestamp, stream_time;
+    AdderInput *input;
 
     /* take next to see if this is the last collectdata */
     next = g_slist_next (collected);
@@ -1207,6 +1861,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
      * case of an empty buffer. */
     if (inbuf == NULL) {
       GST_LOG_OBJECT (adder, "channel %p: no bytes available", collect_data);
+      minus_full = gst_adder_add_minus_srcpad (minus_full, pad);
       continue;
     }
 
@@ -1225,6 +1880,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
       GST_DEBUG_OBJECT (adder, "channel %p: skipping muted pad", collect_data);
       gst_buffer_unref (inbuf);
       GST_OBJECT_UNLOCK (pad);
+      minus_full = gst_adder_add_minus_srcpad (minus_full, pad);
       continue;
     }
 
@@ -1244,6 +1900,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
         else
           gst_buffer_unref (inbuf);
         GST_OBJECT_UNLOCK (pad);
+        minus_full = gst_adder_add_minus_srcpad (minus_full, pad);
         continue;
       }
 
@@ -1252,153 +1909,74 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
 
       /* make data and metadata writable, can simply return the inbuf when we
        * are the only one referencing this buffer. If this is the last (and
-       * only) GAP buffer, it will automatically copy the GAP flag. */
+       * only) GAP buffer, it will automatically copy the GAP flag. The
+       * other buffers are mixed into this one. */
       outbuf = gst_buffer_make_writable (inbuf);
-      gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
-
-      if (pad->volume != 1.0) {
-        switch (adder->info.finfo->format) {
-          case GST_AUDIO_FORMAT_U8:
-            adder_orc_volume_u8 ((gpointer) outmap.data, pad->volume_i8,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_S8:
-            adder_orc_volume_s8 ((gpointer) outmap.data, pad->volume_i8,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_U16:
-            adder_orc_volume_u16 ((gpointer) outmap.data, pad->volume_i16,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_S16:
-            adder_orc_volume_s16 ((gpointer) outmap.data, pad->volume_i16,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_U32:
-            adder_orc_volume_u32 ((gpointer) outmap.data, pad->volume_i32,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_S32:
-            adder_orc_volume_s32 ((gpointer) outmap.data, pad->volume_i32,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_F32:
-            adder_orc_volume_f32 ((gpointer) outmap.data, pad->volume,
-                outmap.size / bps);
-            break;
-          case GST_AUDIO_FORMAT_F64:
-            adder_orc_volume_f64 ((gpointer) outmap.data, pad->volume,
-                outmap.size / bps);
-            break;
-          default:
-            g_assert_not_reached ();
-            break;
-        }
-      }
+      input = &mix.inputs[mix.n_inputs++];
+      input->buffer = outbuf;
+      gst_buffer_map (outbuf, &input->map, GST_MAP_READWRITE);
     } else {
-      if (!is_gap) {
-        /* we had a previous output buffer, mix this non-GAP buffer */
-        GstMapInfo inmap;
-
-        gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
-
-        /* all buffers should have outsize, there are no short buffers because we
-         * asked for the max size above */
-        g_assert (inmap.size == outmap.size);
-
-        GST_LOG_OBJECT (adder, "channel %p: mixing %" G_GSIZE_FORMAT " bytes"
-            " from data %p", collect_data, inmap.size, inmap.data);
-
-        /* further buffers, need to add them */
-        if (pad->volume == 1.0) {
-          switch (adder->info.finfo->format) {
-            case GST_AUDIO_FORMAT_U8:
-              adder_orc_add_u8 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_S8:
-              adder_orc_add_s8 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_U16:
-              adder_orc_add_u16 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_S16:
-              adder_orc_add_s16 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_U32:
-              adder_orc_add_u32 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_S32:
-              adder_orc_add_s32 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_F32:
-              adder_orc_add_f32 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_F64:
-              adder_orc_add_f64 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, inmap.size / bps);
-              break;
-            default:
-              g_assert_not_reached ();
-              break;
-          }
-        } else {
-          switch (adder->info.finfo->format) {
-            case GST_AUDIO_FORMAT_U8:
-              adder_orc_add_volume_u8 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume_i8, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_S8:
-              adder_orc_add_volume_s8 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume_i8, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_U16:
-              adder_orc_add_volume_u16 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume_i16, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_S16:
-              adder_orc_add_volume_s16 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume_i16, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_U32:
-              adder_orc_add_volume_u32 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume_i32, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_S32:
-              adder_orc_add_volume_s32 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume_i32, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_F32:
-              adder_orc_add_volume_f32 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume, inmap.size / bps);
-              break;
-            case GST_AUDIO_FORMAT_F64:
-              adder_orc_add_volume_f64 ((gpointer) outmap.data,
-                  (gpointer) inmap.data, pad->volume, inmap.size / bps);
-              break;
-            default:
-              g_assert_not_reached ();
-              break;
-          }
-        }
-        gst_buffer_unmap (inbuf, &inmap);
-      } else {
+      if (is_gap) {
         /* skip gap buffer */
         GST_LOG_OBJECT (adder, "channel %p: skipping GAP buffer", collect_data);
+        gst_buffer_unref (inbuf);
+        GST_OBJECT_UNLOCK (pad);
+        minus_full = gst_adder_add_minus_srcpad (minus_full, pad);
+        continue;
       }
-      gst_buffer_unref (inbuf);
+
+      /* we had a previous output buffer, mix this non-GAP buffer */
+      input = &mix.inputs[mix.n_inputs++];
+      input->buffer = inbuf;
+      gst_buffer_map (inbuf, &input->map, GST_MAP_READ);
+
+      /* all buffers should have outsize, there are no short buffers because we
+       * asked for the max size above */
+      g_assert (input->map.size == mix.inputs[0].map.size);
+
+      GST_LOG_OBJECT (adder, "channel %p: mixing %" G_GSIZE_FORMAT " bytes"
+          " from data %p", collect_data, input->map.size, input->map.data);
     }
+    input->volume = pad->volume;
+    input->volume_i8 = pad->volume_i8;
+    input->volume_i16 = pad->volume_i16;
+    input->volume_i32 = pad->volume_i32;
+    if (pad->minus_srcpad)
+      input->minus_srcpad = gst_object_ref (pad->minus_srcpad);
     GST_OBJECT_UNLOCK (pad);
   }
 
-  if (outbuf)
-    gst_buffer_unmap (outbuf, &outmap);
+  if (outbuf) {
+    gsize size = mix.inputs[0].map.size;
+    gboolean need_acc = mix.accumulate;
+
+    /* every pad with a mix-minus pad gets its own output buffer */
+    for (i = 0; i < mix.n_inputs; i++) {
+      AdderInput *input = &mix.inputs[i];
+
+      if (input->minus_srcpad == NULL)
+        continue;
+
+      input->minus_buffer = gst_buffer_new_allocate (NULL, size, NULL);
+      gst_buffer_map (input->minus_buffer, &input->minus_map, GST_MAP_WRITE);
+      need_acc = TRUE;
+    }
+    if (need_acc)
+      mix.acc = g_malloc (size / bps * mix.acc_bps);
+
+    gst_adder_mix (adder, &mix, size / bps);
+
+    for (i = 0; i < mix.n_inputs; i++) {
+      AdderInput *input = &mix.inputs[i];
+
+      gst_buffer_unmap (input->buffer, &input->map);
+      if (input->buffer != outbuf)
+        gst_buffer_unref (input->buffer);
+      if (input->minus_buffer)
+        gst_buffer_unmap (input->minus_buffer, &input->minus_map);
+    }
+    g_free (mix.acc);
+  }
 
   if (is_eos)
     goto eos;
@@ -1432,7 +2010,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
     while (tmp) {
       GstEvent *ev = (GstEvent *) tmp->data;
 
-      gst_pad_push_event (adder->srcpad, ev);
+      gst_adder_push_event (adder, ev);
       tmp = g_list_next (tmp);
     }
     g_list_free (adder->pending_events);
@@ -1471,14 +2049,42 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
   adder->offset = next_offset;
   adder->segment.position = next_timestamp;
 
+  /* send out the mix-minus buffers first, pads that did not add anything to
+   * the mix get the complete mix */
+  ret = GST_FLOW_OK;
+  for (i = 0; i < mix.n_inputs; i++) {
+    AdderInput *input = &mix.inputs[i];
+
+    if (input->minus_buffer == NULL)
+      continue;
+
+    gst_buffer_copy_into (input->minus_buffer, outbuf,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+    ret = gst_adder_push_minus (adder, input->minus_srcpad,
+        input->minus_buffer, ret);
+    input->minus_buffer = NULL;
+  }
+  for (l = minus_full; l; l = l->next)
+    ret = gst_adder_push_minus (adder, l->data, gst_buffer_ref (outbuf), ret);
+
   /* send it out */
   GST_LOG_OBJECT (adder, "pushing outbuf %p, timestamp %" GST_TIME_FORMAT
       " offset %" G_GINT64_FORMAT, outbuf,
       GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (outbuf)),
       GST_BUFFER_OFFSET (outbuf));
-  ret = gst_pad_push (adder->srcpad, outbuf);
+  mret = gst_pad_push (adder->srcpad, outbuf);
+
+  GST_LOG_OBJECT (adder, "pushed outbuf, result = %s",
+      gst_flow_get_name (mret));
 
-  GST_LOG_OBJECT (adder, "pushed outbuf, result = %s", gst_flow_get_name (ret));
+  /* an error on a mix-minus pad is only returned when the main src pad
+   * could push */
+  if (mret != GST_FLOW_OK)
+    ret = mret;
+
+done:
+  gst_adder_clear_inputs (&mix);
+  g_slist_free_full (minus_full, gst_object_unref);
 
   return ret;
 
@@ -1492,8 +2098,13 @@ not_negotiated:
 eos:
   {
     GST_DEBUG_OBJECT (adder, "no data available, must be EOS");
-    gst_pad_push_event (adder->srcpad, gst_event_new_eos ());
-    return GST_FLOW_EOS;
+    if (outbuf)
+      gst_buffer_unref (outbuf);
+    if (gapbuf)
+      gst_buffer_unref (gapbuf);
+    gst_adder_push_event (adder, gst_event_new_eos ());
+    ret = GST_FLOW_EOS;
+    goto done;
   }
 }
 
@@ -1532,6 +2143,13 @@ gst_adder_change_state (GstElement * element, GstStateChange transition)
   ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 
   switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* streaming has stopped, no jobs are running anymore */
+      if (adder->pool) {
+        g_thread_pool_free (adder->pool, FALSE, TRUE);
+        adder->pool = NULL;
+      }
+      break;
     default:
       break;
   }
@@ -76,6 +76,19 @@ struct _GstAdder {
   
   gboolean send_stream_start;
   gboolean send_caps;
+
+  /* mix on several threads, the buffers are split into ranges of samples */
+  guint n_threads;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  gint n_pending;
+
+  /* add a src pad with the mix of all other pads for every sink pad */
+  gboolean mix_minus;
+
+  /* sum integer samples in a wider type and clip the mix once */
+  gboolean accumulate;
 };
 
 struct _GstAdderClass {
@@ -99,6 +112,9 @@ struct _GstAdderPad {
   gint volume_i16;
   gint volume_i8;
   gboolean mute;
+
+  /* the src pad with the mix of all other sink pads, or NULL */
+  GstPad *minus_srcpad;
 };
 
 struct _GstAdderPadClass {
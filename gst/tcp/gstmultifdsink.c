@@ -98,6 +98,15 @@
  * buffers to the clients. This behaviour can be disabled by setting the sync
  * property to FALSE. Multifdsink will by default not do QoS and will never
  * drop late buffers.
+ *
+ * When serving a large number of clients, the #GstMultiFdSink:use-epoll
+ * property can be enabled on systems that support it. Multifdsink then only
+ * looks at the clients that reported activity or that have new data to send
+ * instead of checking every client on each wakeup.
+ *
+ * Buffers with memory from a #GstFdAllocator can be sent to the clients
+ * without copying the data through user space by enabling the
+ * #GstMultiFdSink:use-sendfile property.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -105,6 +114,7 @@
 #endif
 
 #include <gst/gst-i18n-plugin.h>
+#include <gst/allocators/gstfdmemory.h>
 
 #include <sys/ioctl.h>
 
@@ -119,6 +129,16 @@
 #include <sys/stat.h>
 #include <netinet/in.h>
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#include <signal.h>
+#include <pthread.h>
+#endif
+
 #ifdef HAVE_FIONREAD_IN_SYS_FILIO
 #include <sys/filio.h>
 #endif
@@ -150,11 +170,18 @@ enum
 
 /* this is really arbitrarily chosen */
 #define DEFAULT_HANDLE_READ             TRUE
+#define DEFAULT_USE_EPOLL               FALSE
+#define DEFAULT_USE_SENDFILE            FALSE
+
+/* maximum number of epoll events collected per call */
+#define EPOLL_EVENTS_MAX                64
 
 enum
 {
   PROP_0,
-  PROP_HANDLE_READ
+  PROP_HANDLE_READ,
+  PROP_USE_EPOLL,
+  PROP_USE_SENDFILE
 };
 
 static void gst_multi_fd_sink_stop_pre (GstMultiHandleSink * mhsink);
@@ -225,6 +252,41 @@ gst_multi_fd_sink_class_init (GstMultiFdSinkClass * klass)
           "Handle client reads and discard the data",
           DEFAULT_HANDLE_READ, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiFdSink:use-epoll:
+   *
+   * Wait for client activity with an edge-triggered epoll set. Only the
+   * clients that reported activity or that received new data while their
+   * descriptor still had room are handled after a wakeup, so the cost of
+   * serving the clients depends on the number of active clients rather than
+   * on the total number of clients. The property is ignored on systems
+   * without epoll and is only read when the element starts.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_EPOLL,
+      g_param_spec_boolean ("use-epoll", "Use epoll",
+          "Use edge-triggered epoll to wait for client activity",
+          DEFAULT_USE_EPOLL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiFdSink:use-sendfile:
+   *
+   * Send buffers that consist of a single fd backed memory, such as the
+   * memory of a #GstFdAllocator or a #GstDmaBufAllocator, with sendfile()
+   * from the memory's file descriptor instead of mapping the memory and
+   * copying it with write(). Buffers with other memory, and descriptors the
+   * kernel can't sendfile() from or with a private mapping, are written as
+   * usual. The number of bytes sent with sendfile() to a client is available
+   * as "sendfile-bytes" in the client statistics.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_SENDFILE,
+      g_param_spec_boolean ("use-sendfile", "Use sendfile",
+          "Send fd backed memory with sendfile() without copying",
+          DEFAULT_USE_SENDFILE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstMultiFdSink::add:
    * @gstmultifdsink: the multifdsink element to emit this signal on
@@ -412,6 +474,11 @@ gst_multi_fd_sink_init (GstMultiFdSink * this)
   mhsink->handle_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   this->handle_read = DEFAULT_HANDLE_READ;
+  this->use_epoll = DEFAULT_USE_EPOLL;
+  this->use_sendfile = DEFAULT_USE_SENDFILE;
+  this->epfd = -1;
+  this->wakeup[0] = this->wakeup[1] = -1;
+  g_queue_init (&this->ready);
 }
 
 /* methods to emit signals */
@@ -492,6 +559,128 @@ gst_multi_fd_sink_get_stats (GstMultiFdSink * sink, int fd)
       handle);
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/* queue @client for the streaming thread. Must be called with the
+ * CLIENTS_LOCK */
+static void
+gst_multi_fd_sink_client_set_ready (GstMultiFdSink * sink,
+    GstTCPClient * client)
+{
+  if (client->ready)
+    return;
+
+  client->ready = TRUE;
+  client->ready_link.data = client;
+  g_queue_push_tail_link (&sink->ready, &client->ready_link);
+}
+
+static void
+gst_multi_fd_sink_client_unset_ready (GstMultiFdSink * sink,
+    GstTCPClient * client)
+{
+  if (!client->ready)
+    return;
+
+  client->ready = FALSE;
+  g_queue_unlink (&sink->ready, &client->ready_link);
+}
+
+static void
+gst_multi_fd_sink_epoll_add (GstMultiFdSink * sink, GstTCPClient * client)
+{
+  struct epoll_event ev = { 0, };
+  GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
+
+  ev.events = EPOLLOUT | EPOLLET;
+  ev.data.ptr = client;
+
+  /* we don't try to read from write only fds */
+  if (sink->handle_read) {
+    gint flags;
+
+    flags = fcntl (client->gfd.fd, F_GETFL, 0);
+    if ((flags & O_ACCMODE) != O_WRONLY)
+      ev.events |= EPOLLIN;
+  }
+
+  if (epoll_ctl (sink->epfd, EPOLL_CTL_ADD, client->gfd.fd, &ev) == 0) {
+    client->in_epoll = TRUE;
+  } else {
+    /* regular files can't be polled but never block either */
+    GST_DEBUG_OBJECT (sink, "%s can't be polled, always writable: %s",
+        mhclient->debug, g_strerror (errno));
+    client->writable = TRUE;
+  }
+}
+
+static gboolean
+gst_multi_fd_sink_epoll_open (GstMultiFdSink * sink)
+{
+  struct epoll_event ev = { 0, };
+
+  if ((sink->epfd = epoll_create (EPOLL_EVENTS_MAX)) < 0)
+    goto no_epoll;
+
+  fcntl (sink->epfd, F_SETFD, FD_CLOEXEC);
+
+  /* the streaming thread is woken up through this pipe when clients were
+   * queued, it is watched by the epoll set like any client */
+  if (pipe (sink->wakeup) < 0)
+    goto no_pipe;
+
+  fcntl (sink->wakeup[0], F_SETFL, O_NONBLOCK);
+  fcntl (sink->wakeup[1], F_SETFL, O_NONBLOCK);
+
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if (epoll_ctl (sink->epfd, EPOLL_CTL_ADD, sink->wakeup[0], &ev) < 0)
+    goto no_pipe;
+
+  /* the epoll fd becomes readable when one of its fds has events, this way
+   * the fdset keeps handling the flushing and the timeouts for us */
+  gst_poll_fd_init (&sink->epoll_gfd);
+  sink->epoll_gfd.fd = sink->epfd;
+  gst_poll_add_fd (sink->fdset, &sink->epoll_gfd);
+  gst_poll_fd_ctl_read (sink->fdset, &sink->epoll_gfd, TRUE);
+
+  return TRUE;
+
+  /* ERRORS */
+no_pipe:
+  {
+    GST_WARNING_OBJECT (sink, "failed to set up wakeup pipe: %s",
+        g_strerror (errno));
+    if (sink->wakeup[0] != -1) {
+      close (sink->wakeup[0]);
+      close (sink->wakeup[1]);
+      sink->wakeup[0] = sink->wakeup[1] = -1;
+    }
+    close (sink->epfd);
+    sink->epfd = -1;
+    return FALSE;
+  }
+no_epoll:
+  {
+    GST_WARNING_OBJECT (sink, "failed to create epoll fd: %s",
+        g_strerror (errno));
+    return FALSE;
+  }
+}
+
+static void
+gst_multi_fd_sink_epoll_close (GstMultiFdSink * sink)
+{
+  if (sink->epfd == -1)
+    return;
+
+  close (sink->wakeup[0]);
+  close (sink->wakeup[1]);
+  sink->wakeup[0] = sink->wakeup[1] = -1;
+  close (sink->epfd);
+  sink->epfd = -1;
+}
+#endif
+
 /* vfuncs */
 
 static GstMultiHandleClient *
@@ -523,16 +712,23 @@ gst_multi_fd_sink_new_client (GstMultiHandleSink * mhsink,
         mhclient->debug, g_strerror (errno));
   }
 
-  /* we always read from a client */
-  gst_poll_add_fd (sink->fdset, &client->gfd);
+#ifdef HAVE_SYS_EPOLL_H
+  if (sink->epfd != -1) {
+    gst_multi_fd_sink_epoll_add (sink, client);
+  } else
+#endif
+  {
+    /* we always read from a client */
+    gst_poll_add_fd (sink->fdset, &client->gfd);
 
-  /* we don't try to read from write only fds */
-  if (sink->handle_read) {
-    gint flags;
+    /* we don't try to read from write only fds */
+    if (sink->handle_read) {
+      gint flags;
 
-    flags = fcntl (handle.fd, F_GETFL, 0);
-    if ((flags & O_ACCMODE) != O_WRONLY) {
-      gst_poll_fd_ctl_read (sink->fdset, &client->gfd, TRUE);
+      flags = fcntl (handle.fd, F_GETFL, 0);
+      if ((flags & O_ACCMODE) != O_WRONLY) {
+        gst_poll_fd_ctl_read (sink->fdset, &client->gfd, TRUE);
+      }
     }
   }
   /* figure out the mode, can't use send() for non sockets */
@@ -569,6 +765,17 @@ gst_multi_fd_sink_hash_changed (GstMultiHandleSink * mhsink)
 {
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
 
+#ifdef HAVE_SYS_EPOLL_H
+  /* restarting the fdset would only make it wait on the epoll fd again, wake
+   * up the thread so that it looks at the ready queue */
+  if (sink->epfd != -1) {
+    if (write (sink->wakeup[1], "W", 1) < 0 && errno != EAGAIN)
+      GST_WARNING_OBJECT (sink, "failed to wake up thread: %s",
+          g_strerror (errno));
+    return;
+  }
+#endif
+
   gst_poll_restart (sink->fdset);
 }
 
@@ -647,6 +854,84 @@ ioctl_failed:
   }
 }
 
+#ifdef HAVE_SYS_SENDFILE_H
+/* sendfile() has no MSG_NOSIGNAL flag, block SIGPIPE in the calling thread
+ * and drop the signal raised for a client that closed the connection */
+static ssize_t
+gst_multi_fd_sink_sendfile_nosignal (gint out_fd, gint in_fd, off_t * offset,
+    size_t count)
+{
+  sigset_t sigpipe, pending, old;
+  struct timespec no_wait = { 0, 0 };
+  gboolean sigpipe_pending;
+  ssize_t ret;
+  gint errsv;
+
+  /* a SIGPIPE that is already pending is not ours to drop */
+  sigemptyset (&sigpipe);
+  sigaddset (&sigpipe, SIGPIPE);
+  sigpending (&pending);
+  sigpipe_pending = sigismember (&pending, SIGPIPE);
+  if (!sigpipe_pending)
+    pthread_sigmask (SIG_BLOCK, &sigpipe, &old);
+
+  ret = sendfile (out_fd, in_fd, offset, count);
+  errsv = errno;
+
+  if (!sigpipe_pending) {
+    if (ret < 0 && errsv == EPIPE) {
+      while (sigtimedwait (&sigpipe, NULL, &no_wait) < 0 && errno == EINTR);
+    }
+    pthread_sigmask (SIG_SETMASK, &old, NULL);
+  }
+
+  errno = errsv;
+  return ret;
+}
+
+/* Send the remaining bytes of @buffer to @client straight from the file
+ * descriptor of its memory. Returns FALSE when @buffer is not backed by a
+ * single fd memory with a shared mapping or when the kernel can't sendfile()
+ * from its descriptor, the buffer has to be mapped and written then. */
+static gboolean
+gst_multi_fd_sink_client_sendfile (GstMultiFdSink * sink,
+    GstTCPClient * client, GstBuffer * buffer, gint * maxsize, ssize_t * wrote)
+{
+  GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
+  GstMemory *mem;
+  off_t offset;
+
+  if (gst_buffer_n_memory (buffer) != 1)
+    return FALSE;
+
+  mem = gst_buffer_peek_memory (buffer, 0);
+  if (!gst_is_fd_memory (mem))
+    return FALSE;
+
+  /* writes to a private mapping don't end up in the file */
+  if (gst_fd_memory_get_flags (mem) & GST_FD_MEMORY_FLAG_MAP_PRIVATE)
+    return FALSE;
+
+  /* fd memory maps the descriptor from the start, the offset of the memory
+   * is the offset in the file */
+  offset = mem->offset + mhclient->bufoffset;
+  *maxsize = mem->size - mhclient->bufoffset;
+
+  *wrote = gst_multi_fd_sink_sendfile_nosignal (mhclient->handle.fd,
+      gst_fd_memory_get_fd (mem), &offset, *maxsize);
+  if (*wrote < 0 && (errno == EINVAL || errno == ENOSYS)) {
+    GST_LOG_OBJECT (sink, "%s can't sendfile from fd %d: %s", mhclient->debug,
+        gst_fd_memory_get_fd (mem), g_strerror (errno));
+    return FALSE;
+  }
+
+  if (*wrote > 0)
+    mhclient->sendfile_bytes += *wrote;
+
+  return TRUE;
+}
+#endif
+
 /* Handle a write on a client,
  * which indicates a read request from a client.
  *
@@ -694,11 +979,12 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
 
     if (!mhclient->sending) {
       /* client is not working on a buffer */
-      if (mhclient->bufpos == -1) {
+      if (CLIENT_BUFPOS (mhsink, mhclient) == -1) {
         /* client is too fast, remove from write queue until new buffer is
-         * available */
+         * available. In epoll mode it is queued again by hash_adding. */
         /* FIXME: specific */
-        gst_poll_fd_ctl_write (sink->fdset, &client->gfd, FALSE);
+        if (sink->epfd == -1)
+          gst_poll_fd_ctl_write (sink->fdset, &client->gfd, FALSE);
 
         /* if we flushed out all of the client buffers, we can stop */
         if (mhclient->flushcount == 0)
@@ -709,6 +995,7 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
         /* client can pick a buffer from the global queue */
         GstBuffer *buf;
         GstClockTime timestamp;
+        gint bufpos;
 
         /* for new connections, we need to find a good spot in the
          * bufqueue to start streaming from */
@@ -719,11 +1006,13 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
           if (position >= 0) {
             /* we got a valid spot in the queue */
             mhclient->new_connection = FALSE;
-            mhclient->bufpos = position;
+            gst_multi_handle_sink_client_set_bufpos (mhsink, mhclient,
+                position);
           } else {
             /* cannot send data to this client yet */
             /* FIXME: specific */
-            gst_poll_fd_ctl_write (sink->fdset, &client->gfd, FALSE);
+            if (sink->epfd == -1)
+              gst_poll_fd_ctl_write (sink->fdset, &client->gfd, FALSE);
             return TRUE;
           }
         }
@@ -733,8 +1022,9 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
           goto flushed;
 
         /* grab buffer */
-        buf = g_array_index (mhsink->bufqueue, GstBuffer *, mhclient->bufpos);
-        mhclient->bufpos--;
+        bufpos = CLIENT_BUFPOS (mhsink, mhclient);
+        buf = g_array_index (mhsink->bufqueue, GstBuffer *, bufpos);
+        gst_multi_handle_sink_client_set_bufpos (mhsink, mhclient, bufpos - 1);
 
         /* update stats */
         timestamp = GST_BUFFER_TIMESTAMP (buf);
@@ -748,7 +1038,7 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
           mhclient->flushcount--;
 
         GST_LOG_OBJECT (sink, "%s client %p at position %d",
-            mhclient->debug, client, mhclient->bufpos);
+            mhclient->debug, client, bufpos - 1);
 
         /* queueing a buffer will ref it */
         mhsinkclass->client_queue_buffer (mhsink, mhclient, buf);
@@ -768,31 +1058,44 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
       /* pick first buffer from list */
       head = GST_BUFFER (mhclient->sending->data);
 
-      if (!gst_buffer_map (head, &info, GST_MAP_READ))
-        g_return_val_if_reached (FALSE);
+#ifdef HAVE_SYS_SENDFILE_H
+      if (sink->use_sendfile
+          && gst_multi_fd_sink_client_sendfile (sink, client, head, &maxsize,
+              &wrote)) {
+        /* sent without copying */
+      } else
+#endif
+      {
+        if (!gst_buffer_map (head, &info, GST_MAP_READ))
+          g_return_val_if_reached (FALSE);
 
-      data = info.data;
-      maxsize = info.size - mhclient->bufoffset;
+        data = info.data;
+        maxsize = info.size - mhclient->bufoffset;
 
-      /* FIXME: specific */
-      /* try to write the complete buffer */
+        /* FIXME: specific */
+        /* try to write the complete buffer */
 #ifdef MSG_NOSIGNAL
 #define FLAGS MSG_NOSIGNAL
 #else
 #define FLAGS 0
 #endif
-      if (client->is_socket) {
-        wrote = send (fd, data + mhclient->bufoffset, maxsize, FLAGS);
-      } else {
-        wrote = write (fd, data + mhclient->bufoffset, maxsize);
+        if (client->is_socket) {
+          wrote = send (fd, data + mhclient->bufoffset, maxsize, FLAGS);
+        } else {
+          wrote = write (fd, data + mhclient->bufoffset, maxsize);
+        }
+        gst_buffer_unmap (head, &info);
       }
-      gst_buffer_unmap (head, &info);
+      mhclient->send_calls++;
 
       if (wrote < 0) {
         /* hmm error.. */
         if (errno == EAGAIN) {
           /* nothing serious, resource was unavailable, try again later */
           more = FALSE;
+          /* wait for the next EPOLLOUT edge */
+          if (client->in_epoll)
+            client->writable = FALSE;
         } else if (errno == ECONNRESET) {
           goto connection_reset;
         } else {
@@ -807,6 +1110,8 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
               mhclient->debug, wrote);
           mhclient->bufoffset += wrote;
           more = FALSE;
+          if (client->in_epoll)
+            client->writable = FALSE;
         } else {
           /* complete buffer was written, we can proceed to the next one */
           mhclient->sending = g_slist_remove (mhclient->sending, head);
@@ -816,7 +1121,7 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
         }
         /* update stats */
         mhclient->bytes_sent += wrote;
-        mhclient->last_activity_time = now;
+        gst_multi_handle_sink_client_set_activity (mhsink, mhclient, now);
         mhsink->bytes_served += wrote;
       }
     }
@@ -855,6 +1160,16 @@ gst_multi_fd_sink_hash_adding (GstMultiHandleSink * mhsink,
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
   GstTCPClient *client = (GstTCPClient *) mhclient;
 
+#ifdef HAVE_SYS_EPOLL_H
+  /* a client with room in its descriptor can be served right away, the
+   * others are queued by their next EPOLLOUT edge */
+  if (sink->epfd != -1) {
+    if (client->writable)
+      gst_multi_fd_sink_client_set_ready (sink, client);
+    return;
+  }
+#endif
+
   gst_poll_fd_ctl_write (sink->fdset, &client->gfd, TRUE);
 }
 
@@ -865,9 +1180,110 @@ gst_multi_fd_sink_hash_removing (GstMultiHandleSink * mhsink,
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
   GstTCPClient *client = (GstTCPClient *) mhclient;
 
+#ifdef HAVE_SYS_EPOLL_H
+  if (sink->epfd != -1) {
+    gst_multi_fd_sink_client_unset_ready (sink, client);
+    if (client->in_epoll) {
+      epoll_ctl (sink->epfd, EPOLL_CTL_DEL, client->gfd.fd, NULL);
+      client->in_epoll = FALSE;
+    }
+    return;
+  }
+#endif
+
   gst_poll_remove_fd (sink->fdset, &client->gfd);
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/* Collect the edges reported by epoll into the ready queue and handle the
+ * queued clients. Clients without activity and without new data are never
+ * looked at. */
+static void
+gst_multi_fd_sink_handle_ready_clients (GstMultiFdSink * sink)
+{
+  struct epoll_event events[EPOLL_EVENTS_MAX];
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GList *link;
+  gint i, n;
+
+  CLIENTS_LOCK (mhsink);
+  do {
+    n = epoll_wait (sink->epfd, events, EPOLL_EVENTS_MAX, 0);
+    for (i = 0; i < n; i++) {
+      GstTCPClient *client = events[i].data.ptr;
+
+      if (client == NULL) {
+        gchar dummy[64];
+
+        /* drain the wakeup pipe */
+        while (read (sink->wakeup[0], dummy, sizeof (dummy)) > 0)
+          continue;
+        continue;
+      }
+      if (events[i].events & EPOLLOUT)
+        client->writable = TRUE;
+      client->events |= events[i].events;
+      gst_multi_fd_sink_client_set_ready (sink, client);
+    }
+  } while (n == EPOLL_EVENTS_MAX);
+
+  if (n < 0 && errno != EINTR)
+    GST_WARNING_OBJECT (sink, "epoll_wait failed: %s (%d)", g_strerror (errno),
+        errno);
+
+  GST_LOG_OBJECT (sink, "%u clients ready", sink->ready.length);
+
+  /* removing a client releases the lock, the ready queue stays consistent
+   * because removed clients are unlinked from it in hash_removing */
+  while ((link = g_queue_pop_head_link (&sink->ready))) {
+    GstTCPClient *client = link->data;
+    GstMultiHandleClient *mhclient = link->data;
+    GList *clink;
+    guint32 revents;
+
+    client->ready = FALSE;
+    revents = client->events;
+    client->events = 0;
+
+    clink = g_hash_table_lookup (mhsink->handle_hash,
+        GINT_TO_POINTER (client->gfd.fd));
+    if (clink == NULL)
+      continue;
+
+    if (mhclient->status != GST_CLIENT_STATUS_FLUSHING
+        && mhclient->status != GST_CLIENT_STATUS_OK) {
+      gst_multi_handle_sink_remove_client_link (mhsink, clink);
+      continue;
+    }
+    if (revents & EPOLLERR) {
+      GST_WARNING_OBJECT (sink, "epoll reports error for %d", client->gfd.fd);
+      mhclient->status = GST_CLIENT_STATUS_ERROR;
+      gst_multi_handle_sink_remove_client_link (mhsink, clink);
+      continue;
+    }
+    if (revents & EPOLLIN) {
+      /* handle client read, this also detects a close */
+      if (!gst_multi_fd_sink_handle_client_read (sink, client)) {
+        gst_multi_handle_sink_remove_client_link (mhsink, clink);
+        continue;
+      }
+    } else if (revents & EPOLLHUP) {
+      mhclient->status = GST_CLIENT_STATUS_CLOSED;
+      gst_multi_handle_sink_remove_client_link (mhsink, clink);
+      continue;
+    }
+    if (client->writable) {
+      /* handle client write */
+      if (!gst_multi_fd_sink_handle_client_write (sink, client)) {
+        gst_multi_handle_sink_remove_client_link (mhsink, clink);
+        continue;
+      }
+    }
+  }
+  CLIENTS_UNLOCK (mhsink);
+}
+#endif
+
 
 /* Handle the clients. Basically does a blocking select for one
  * of the client fds to become read or writable. We also have a
@@ -991,6 +1407,13 @@ gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
   if (fclass->wait)
     fclass->wait (sink, sink->fdset);
 
+#ifdef HAVE_SYS_EPOLL_H
+  if (sink->epfd != -1) {
+    gst_multi_fd_sink_handle_ready_clients (sink);
+    return;
+  }
+#endif
+
   /* Check the clients */
   CLIENTS_LOCK (mhsink);
 
@@ -1069,6 +1492,12 @@ gst_multi_fd_sink_set_property (GObject * object, guint prop_id,
     case PROP_HANDLE_READ:
       multifdsink->handle_read = g_value_get_boolean (value);
       break;
+    case PROP_USE_EPOLL:
+      multifdsink->use_epoll = g_value_get_boolean (value);
+      break;
+    case PROP_USE_SENDFILE:
+      multifdsink->use_sendfile = g_value_get_boolean (value);
+      break;
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1088,6 +1517,12 @@ gst_multi_fd_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_HANDLE_READ:
       g_value_set_boolean (value, multifdsink->handle_read);
       break;
+    case PROP_USE_EPOLL:
+      g_value_set_boolean (value, multifdsink->use_epoll);
+      break;
+    case PROP_USE_SENDFILE:
+      g_value_set_boolean (value, multifdsink->use_sendfile);
+      break;
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1104,6 +1539,15 @@ gst_multi_fd_sink_start_pre (GstMultiHandleSink * mhsink)
   if ((mfsink->fdset = gst_poll_new (TRUE)) == NULL)
     goto socket_pair;
 
+  if (mfsink->use_epoll) {
+#ifdef HAVE_SYS_EPOLL_H
+    if (!gst_multi_fd_sink_epoll_open (mfsink))
+      GST_WARNING_OBJECT (mfsink, "falling back to poll");
+#else
+    GST_WARNING_OBJECT (mfsink, "epoll not supported, falling back to poll");
+#endif
+  }
+
   return TRUE;
 
   /* ERRORS */
@@ -1138,6 +1582,9 @@ gst_multi_fd_sink_stop_post (GstMultiHandleSink * mhsink)
     gst_poll_free (mfsink->fdset);
     mfsink->fdset = NULL;
   }
+#ifdef HAVE_SYS_EPOLL_H
+  gst_multi_fd_sink_epoll_close (mfsink);
+#endif
   g_hash_table_foreach_remove (mhsink->handle_hash, multifdsink_hash_remove,
       mfsink);
 }
@@ -55,6 +55,13 @@ typedef struct {
   GstPollFD gfd;
 
   gboolean is_socket;
+
+  /* epoll mode */
+  gboolean in_epoll;
+  gboolean writable;
+  guint32 events;
+  gboolean ready;
+  GList ready_link;
 } GstTCPClient;
 
 /**
@@ -69,6 +76,14 @@ struct _GstMultiFdSink {
   GstPoll *fdset;
 
   gboolean handle_read;
+
+  gboolean use_sendfile;
+
+  gboolean use_epoll;
+  gint epfd;
+  GstPollFD epoll_gfd;
+  gint wakeup[2];
+  GQueue ready;
 };
 
 struct _GstMultiFdSinkClass {
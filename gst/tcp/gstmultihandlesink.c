@@ -495,6 +495,9 @@ gst_multi_handle_sink_init (GstMultiHandleSink * this)
   this->clients = NULL;
 
   this->bufqueue = g_array_new (FALSE, TRUE, sizeof (GstBuffer *));
+  this->bufseq = -1;
+  this->clients_by_pos = g_sequence_new (NULL);
+  g_queue_init (&this->clients_by_activity);
   this->unit_format = DEFAULT_UNIT_FORMAT;
   this->units_max = DEFAULT_UNITS_MAX;
   this->units_soft_max = DEFAULT_UNITS_SOFT_MAX;
@@ -523,6 +526,7 @@ gst_multi_handle_sink_finalize (GObject * object)
 
   CLIENTS_LOCK_CLEAR (this);
   g_array_free (this->bufqueue, TRUE);
+  g_sequence_free (this->clients_by_pos);
   g_hash_table_destroy (this->handle_hash);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -602,11 +606,13 @@ gst_multi_handle_sink_client_init (GstMultiHandleClient * client,
   GTimeVal now;
 
   client->status = GST_CLIENT_STATUS_OK;
-  client->bufpos = -1;
+  client->bufseq_iter = NULL;
   client->flushcount = -1;
   client->bufoffset = 0;
   client->sending = NULL;
   client->bytes_sent = 0;
+  client->send_calls = 0;
+  client->sendfile_bytes = 0;
   client->dropped_buffers = 0;
   client->avg_queue_size = 0;
   client->first_buffer_ts = GST_CLOCK_TIME_NONE;
@@ -623,6 +629,37 @@ gst_multi_handle_sink_client_init (GstMultiHandleClient * client,
   client->last_activity_time = client->connect_time;
 }
 
+static gint
+client_compare_bufseq (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const GstMultiHandleClient *ca = a, *cb = b;
+
+  return ca->bufseq < cb->bufseq ? -1 : ca->bufseq > cb->bufseq;
+}
+
+/* must be called with the CLIENTS_LOCK */
+void
+gst_multi_handle_sink_client_set_bufpos (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, gint bufpos)
+{
+  client->bufseq = sink->bufseq - bufpos;
+  if (client->bufseq_iter)
+    g_sequence_sort_changed (client->bufseq_iter, client_compare_bufseq, NULL);
+}
+
+/* must be called with the CLIENTS_LOCK */
+void
+gst_multi_handle_sink_client_set_activity (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, GstClockTime now)
+{
+  client->last_activity_time = now;
+  if (client->bufseq_iter) {
+    g_queue_unlink (&sink->clients_by_activity, &client->activity_link);
+    g_queue_push_tail_link (&sink->clients_by_activity,
+        &client->activity_link);
+  }
+}
+
 static void
 gst_multi_handle_sink_setup_dscp (GstMultiHandleSink * mhsink)
 {
@@ -689,6 +726,14 @@ gst_multi_handle_sink_add_full (GstMultiHandleSink * sink,
       mhsinkclass->handle_hash_key (mhclient->handle), clink);
   mhsink->clients_cookie++;
 
+  /* the client waits for the next buffer */
+  mhclient->bufseq = mhsink->bufseq + 1;
+  mhclient->bufseq_iter = g_sequence_insert_sorted (mhsink->clients_by_pos,
+      mhclient, client_compare_bufseq, NULL);
+  mhclient->activity_link.data = mhclient;
+  g_queue_push_tail_link (&mhsink->clients_by_activity,
+      &mhclient->activity_link);
+
 
   mhclient->burst_min_format = min_format;
   mhclient->burst_min_value = min_value;
@@ -804,7 +849,7 @@ gst_multi_handle_sink_remove_flush (GstMultiHandleSink * sink,
     /* take the position of the client as the number of buffers left to flush.
      * If the client was at position -1, we flush 0 buffers, 0 == flush 1
      * buffer, etc... */
-    mhclient->flushcount = mhclient->bufpos + 1;
+    mhclient->flushcount = CLIENT_BUFPOS (mhsink, mhclient) + 1;
     /* mark client as flushing. We can not remove the client right away because
      * it might have some buffers to flush in the ->sending queue. */
     mhclient->status = GST_CLIENT_STATUS_FLUSHING;
@@ -900,7 +945,9 @@ gst_multi_handle_sink_get_stats (GstMultiHandleSink * sink,
         "last-activity-time", G_TYPE_UINT64, mhclient->last_activity_time,
         "buffers-dropped", G_TYPE_UINT64, mhclient->dropped_buffers,
         "first-buffer-ts", G_TYPE_UINT64, mhclient->first_buffer_ts,
-        "last-buffer-ts", G_TYPE_UINT64, mhclient->last_buffer_ts, NULL);
+        "last-buffer-ts", G_TYPE_UINT64, mhclient->last_buffer_ts,
+        "send-calls", G_TYPE_UINT64, mhclient->send_calls,
+        "sendfile-bytes", G_TYPE_UINT64, mhclient->sendfile_bytes, NULL);
   }
 
 noclient:
@@ -936,6 +983,11 @@ gst_multi_handle_sink_remove_client_link (GstMultiHandleSink * sink,
     mhclient->currently_removing = TRUE;
   }
 
+  /* queueing buffers no longer looks at this client */
+  g_sequence_remove (mhclient->bufseq_iter);
+  mhclient->bufseq_iter = NULL;
+  g_queue_unlink (&sink->clients_by_activity, &mhclient->activity_link);
+
   /* FIXME: if we keep track of ip we can log it here and signal */
   switch (mhclient->status) {
     case GST_CLIENT_STATUS_OK:
@@ -1424,7 +1476,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
   switch (client->sync_method) {
     case GST_SYNC_METHOD_LATEST:
       /* no syncing, we are happy with whatever the client is going to get */
-      result = client->bufpos;
+      result = CLIENT_BUFPOS (sink, client);
       GST_DEBUG_OBJECT (sink,
           "%s SYNC_METHOD_LATEST, position %d", client->debug, result);
       break;
@@ -1434,9 +1486,9 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
        * is a sync point, we can proceed, otherwise we need to keep waiting */
       GST_LOG_OBJECT (sink,
           "%s new client, bufpos %d, waiting for keyframe",
-          client->debug, client->bufpos);
+          client->debug, CLIENT_BUFPOS (sink, client));
 
-      result = find_prev_syncframe (sink, client->bufpos);
+      result = find_prev_syncframe (sink, CLIENT_BUFPOS (sink, client));
       if (result != -1) {
         GST_DEBUG_OBJECT (sink,
             "%s SYNC_METHOD_NEXT_KEYFRAME: result %d", client->debug, result);
@@ -1448,7 +1500,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
       GST_LOG_OBJECT (sink,
           "%s new client, skipping buffer(s), no syncpoint found",
           client->debug);
-      client->bufpos = -1;
+      gst_multi_handle_sink_client_set_bufpos (sink, client, -1);
       break;
     }
     case GST_SYNC_METHOD_LATEST_KEYFRAME:
@@ -1471,7 +1523,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
           "%s SYNC_METHOD_LATEST_KEYFRAME: no keyframe found, "
           "switching to SYNC_METHOD_NEXT_KEYFRAME", client->debug);
       /* throw client to the waiting state */
-      client->bufpos = -1;
+      gst_multi_handle_sink_client_set_bufpos (sink, client, -1);
       /* and make client sync to next keyframe */
       client->sync_method = GST_SYNC_METHOD_NEXT_KEYFRAME;
       break;
@@ -1546,7 +1598,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
           "no prev keyframe found in BURST_KEYFRAME sync mode, waiting for next");
 
       /* throw client to the waiting state */
-      client->bufpos = -1;
+      gst_multi_handle_sink_client_set_bufpos (sink, client, -1);
       /* and make client sync to next keyframe */
       client->sync_method = GST_SYNC_METHOD_NEXT_KEYFRAME;
       result = -1;
@@ -1593,7 +1645,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
     }
     default:
       g_warning ("unknown sync method %d", client->sync_method);
-      result = client->bufpos;
+      result = CLIENT_BUFPOS (sink, client);
       break;
   }
   return result;
@@ -1611,13 +1663,14 @@ gst_multi_handle_sink_recover_client (GstMultiHandleSink * sink,
 
   GST_WARNING_OBJECT (sink,
       "%s client %p is lagging at %d, recover using policy %d",
-      client->debug, client, client->bufpos, sink->recover_policy);
+      client->debug, client, CLIENT_BUFPOS (sink, client),
+      sink->recover_policy);
 
   switch (sink->recover_policy) {
     case GST_RECOVER_POLICY_NONE:
       /* do nothing, client will catch up or get kicked out when it reaches
        * the hard max */
-      newbufpos = client->bufpos;
+      newbufpos = CLIENT_BUFPOS (sink, client);
       break;
     case GST_RECOVER_POLICY_RESYNC_LATEST:
       /* move to beginning of queue */
@@ -1652,6 +1705,28 @@ gst_multi_handle_sink_recover_client (GstMultiHandleSink * sink,
   return newbufpos;
 }
 
+/* remove a client that went over the hard max or the timeout, this releases
+ * the CLIENTS_LOCK for a while */
+static void
+gst_multi_handle_sink_remove_slow_client (GstMultiHandleSink * mhsink,
+    GstMultiHandleClient * mhclient)
+{
+  GstMultiHandleSinkClass *mhsinkclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
+  GList *clink;
+
+  GST_WARNING_OBJECT (mhsink, "%s client %p is too slow, removing",
+      mhclient->debug, mhclient);
+  /* remove the client, the handle set will be cleared and the select thread
+   * will be signaled */
+  mhclient->status = GST_CLIENT_STATUS_SLOW;
+  /* set client to invalid position while being removed */
+  gst_multi_handle_sink_client_set_bufpos (mhsink, mhclient, -1);
+  clink = g_hash_table_lookup (mhsink->handle_hash,
+      mhsinkclass->handle_hash_key (mhclient->handle));
+  gst_multi_handle_sink_remove_client_link (mhsink, clink);
+}
+
 /* Queue a buffer on the global queue.
  *
  * This function adds the buffer to the front of a GArray. It removes the
@@ -1660,21 +1735,24 @@ gst_multi_handle_sink_recover_client (GstMultiHandleSink * sink,
  * started writing out this buffer will still have a reference to it in the
  * mhclient->sending queue.
  *
- * After adding the buffer, we update all client positions in the queue. If
- * a client moves over the soft max, we start the recovery procedure for this
- * slow client. If it goes over the hard max, it is put into the slow list
- * and removed.
+ * Adding the buffer moves all clients one position further back in the
+ * queue, as their positions are relative to the sequence number of the
+ * newest buffer. If a client moves over the soft max, we start the recovery
+ * procedure for this slow client. If it goes over the hard max, it is put
+ * into the slow list and removed. Only the clients that lag behind the most
+ * need to be checked for this.
  *
  * Special care is taken of clients that were waiting for a new buffer (they
  * had a position of -1) because they can proceed after adding this new buffer.
  * This is done by adding the client back into the write fd_set and signaling
- * the select thread that the fd_set changed.
+ * the select thread that the fd_set changed. These clients are the ones that
+ * are furthest ahead.
  */
 static void
 gst_multi_handle_sink_queue_buffer (GstMultiHandleSink * mhsink,
     GstBuffer * buffer)
 {
-  GList *clients, *next;
+  GSequenceIter *iter;
   gint queuelen;
   gboolean hash_changed = FALSE;
   gint max_buffer_usage;
@@ -1682,15 +1760,15 @@ gst_multi_handle_sink_queue_buffer (GstMultiHandleSink * mhsink,
   GTimeVal nowtv;
   GstClockTime now;
   gint max_buffers, soft_max_buffers;
-  guint cookie;
   GstMultiHandleSink *sink = GST_MULTI_HANDLE_SINK (mhsink);
   GstMultiHandleSinkClass *mhsinkclass =
       GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
 
   CLIENTS_LOCK (mhsink);
-  /* add buffer to queue */
+  /* add buffer to queue, this updates all client positions */
   g_array_prepend_val (mhsink->bufqueue, buffer);
   queuelen = mhsink->bufqueue->len;
+  mhsink->bufseq++;
 
   if (mhsink->units_max > 0)
     max_buffers = get_buffers_max (mhsink, mhsink->units_max);
@@ -1704,78 +1782,93 @@ gst_multi_handle_sink_queue_buffer (GstMultiHandleSink * mhsink,
   GST_LOG_OBJECT (sink, "Using max %d, softmax %d", max_buffers,
       soft_max_buffers);
 
-  /* then loop over the clients and update the positions */
-  cookie = mhsink->clients_cookie;
-  for (clients = mhsink->clients; clients; clients = clients->next) {
-    GstMultiHandleClient *mhclient = clients->data;
+  /* check soft max if needed, recover clients. Recovering reorders the
+   * clients so collect them first. */
+  if (soft_max_buffers > 0) {
+    GSList *lagging = NULL, *walk;
 
-    mhclient->bufpos++;
-    GST_LOG_OBJECT (sink, "%s client %p at position %d",
-        mhclient->debug, mhclient, mhclient->bufpos);
+    for (iter = g_sequence_get_begin_iter (mhsink->clients_by_pos);
+        !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+      GstMultiHandleClient *mhclient = g_sequence_get (iter);
 
-    /* check soft max if needed, recover client */
-    if (soft_max_buffers > 0 && mhclient->bufpos >= soft_max_buffers) {
+      if (CLIENT_BUFPOS (mhsink, mhclient) < soft_max_buffers)
+        break;
+      lagging = g_slist_prepend (lagging, mhclient);
+    }
+
+    for (walk = lagging; walk; walk = walk->next) {
+      GstMultiHandleClient *mhclient = walk->data;
+      gint bufpos = CLIENT_BUFPOS (mhsink, mhclient);
       gint newpos;
 
       newpos = gst_multi_handle_sink_recover_client (mhsink, mhclient);
-      if (newpos != mhclient->bufpos) {
-        mhclient->dropped_buffers += mhclient->bufpos - newpos;
-        mhclient->bufpos = newpos;
+      if (newpos != bufpos) {
+        mhclient->dropped_buffers += bufpos - newpos;
+        gst_multi_handle_sink_client_set_bufpos (mhsink, mhclient, newpos);
         mhclient->discont = TRUE;
         GST_INFO_OBJECT (sink, "%s client %p position reset to %d",
-            mhclient->debug, mhclient, mhclient->bufpos);
+            mhclient->debug, mhclient, newpos);
       } else {
         GST_INFO_OBJECT (sink,
             "%s client %p not recovering position", mhclient->debug, mhclient);
       }
     }
+    g_slist_free (lagging);
   }
 
-  max_buffer_usage = 0;
   g_get_current_time (&nowtv);
   now = GST_TIMEVAL_TO_TIME (nowtv);
 
-  /* now check for new or slow clients */
-restart:
-  cookie = mhsink->clients_cookie;
-  for (clients = mhsink->clients; clients; clients = next) {
-    GstMultiHandleClient *mhclient = clients->data;
+  /* now check for slow clients, removing a client releases the lock so we
+   * look at the current first client each time */
+  while (max_buffers > 0) {
+    GstMultiHandleClient *mhclient;
 
-    if (cookie != mhsink->clients_cookie) {
-      GST_DEBUG_OBJECT (sink, "Clients cookie outdated, restarting");
-      goto restart;
-    }
+    iter = g_sequence_get_begin_iter (mhsink->clients_by_pos);
+    if (g_sequence_iter_is_end (iter))
+      break;
 
-    next = g_list_next (clients);
+    mhclient = g_sequence_get (iter);
+    if (CLIENT_BUFPOS (mhsink, mhclient) < max_buffers)
+      break;
 
-    /* check hard max and timeout, remove client */
-    if ((max_buffers > 0 && mhclient->bufpos >= max_buffers) ||
-        (mhsink->timeout > 0
-            && now - mhclient->last_activity_time > mhsink->timeout)) {
-      /* remove client */
-      GST_WARNING_OBJECT (sink, "%s client %p is too slow, removing",
-          mhclient->debug, mhclient);
-      /* remove the client, the handle set will be cleared and the select thread
-       * will be signaled */
-      mhclient->status = GST_CLIENT_STATUS_SLOW;
-      /* set client to invalid position while being removed */
-      mhclient->bufpos = -1;
-      gst_multi_handle_sink_remove_client_link (mhsink, clients);
-      hash_changed = TRUE;
-      continue;
-    } else if (mhclient->bufpos == 0 || mhclient->new_connection) {
-      /* can send data to this client now. need to signal the select thread that
-       * the handle_set changed */
+    gst_multi_handle_sink_remove_slow_client (mhsink, mhclient);
+    hash_changed = TRUE;
+  }
+  while (mhsink->timeout > 0 && mhsink->clients_by_activity.head) {
+    GstMultiHandleClient *mhclient = mhsink->clients_by_activity.head->data;
+
+    if (now - mhclient->last_activity_time <= mhsink->timeout)
+      break;
+
+    gst_multi_handle_sink_remove_slow_client (mhsink, mhclient);
+    hash_changed = TRUE;
+  }
+
+  /* the clients that were waiting are at position 0 now and can send data.
+   * Need to signal the select thread that the handle_set changed */
+  iter = g_sequence_get_end_iter (mhsink->clients_by_pos);
+  while (!g_sequence_iter_is_begin (iter)) {
+    GstMultiHandleClient *mhclient;
+    gint bufpos;
+
+    iter = g_sequence_iter_prev (iter);
+    mhclient = g_sequence_get (iter);
+    bufpos = CLIENT_BUFPOS (mhsink, mhclient);
+    if (bufpos > 0)
+      break;
+    if (bufpos == 0) {
       mhsinkclass->hash_adding (mhsink, mhclient);
       hash_changed = TRUE;
     }
-
-    /* keep track of maximum buffer usage */
-    if (mhclient->bufpos > max_buffer_usage) {
-      max_buffer_usage = mhclient->bufpos;
-    }
   }
 
+  /* keep track of maximum buffer usage */
+  max_buffer_usage = 0;
+  iter = g_sequence_get_begin_iter (mhsink->clients_by_pos);
+  if (!g_sequence_iter_is_end (iter))
+    max_buffer_usage = MAX (CLIENT_BUFPOS (mhsink, g_sequence_get (iter)), 0);
+
   /* make sure we respect bytes-min, buffers-min and time-min when they are set */
   {
     gint usage, max;
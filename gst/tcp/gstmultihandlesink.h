@@ -136,7 +136,10 @@ typedef struct {
 
   gchar debug[30];              /* a debug string used in debug calls to
                                    identify the client */
-  gint bufpos;                  /* position of this client in the global queue */
+  gint64 bufseq;                /* sequence number of the next buffer to send,
+                                   see CLIENT_BUFPOS () */
+  GSequenceIter *bufseq_iter;   /* position in the clients sorted by bufseq */
+  GList activity_link;          /* link in the clients sorted by activity */
   gint flushcount;              /* the remaining number of buffers to flush out or -1 if the 
                                    client is not flushing. */
 
@@ -169,6 +172,8 @@ typedef struct {
   guint64 avg_queue_size;
   guint64 first_buffer_ts;
   guint64 last_buffer_ts;
+  guint64 send_calls;           /* number of send/write calls made */
+  guint64 sendfile_bytes;       /* bytes sent with sendfile() */
 } GstMultiHandleClient;
 
 #define CLIENTS_LOCK_INIT(mhsink)       (g_rec_mutex_init(&(mhsink)->clientslock))
@@ -176,6 +181,10 @@ typedef struct {
 #define CLIENTS_LOCK(mhsink)            (g_rec_mutex_lock(&(mhsink)->clientslock))
 #define CLIENTS_UNLOCK(mhsink)          (g_rec_mutex_unlock(&(mhsink)->clientslock))
 
+/* position of a client in the global queue, 0 is the newest buffer and -1
+ * means that the client waits for the next buffer */
+#define CLIENT_BUFPOS(mhsink,client)    ((gint) ((mhsink)->bufseq - (client)->bufseq))
+
 gint gst_multi_handle_sink_setup_dscp_client (GstMultiHandleSink * sink, GstMultiHandleClient * client);
 gint
 gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
@@ -205,6 +214,13 @@ struct _GstMultiHandleSink {
   gint qos_dscp;
 
   GArray *bufqueue;     /* global queue of buffers */
+  gint64 bufseq;        /* sequence number of the newest queued buffer */
+
+  /* the clients sorted by their position in the queue, the client lagging
+   * behind the most first, and by their last activity, the longest idle
+   * client first. Queueing a buffer only looks at the ends of these. */
+  GSequence *clients_by_pos;
+  GQueue clients_by_activity;
 
   gboolean running;     /* the thread state */
   GThread *thread;      /* the sender thread */
@@ -286,6 +302,10 @@ void gst_multi_handle_sink_remove_client_link (GstMultiHandleSink * sink,
     GList * link);
 
 void gst_multi_handle_sink_client_init (GstMultiHandleClient * client, GstSyncMethod sync_method);
+void gst_multi_handle_sink_client_set_bufpos (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, gint bufpos);
+void gst_multi_handle_sink_client_set_activity (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, GstClockTime now);
 
 #define GST_TYPE_RECOVER_POLICY (gst_multi_handle_sink_recover_policy_get_type())
 GType gst_multi_handle_sink_recover_policy_get_type (void);
@@ -97,6 +97,14 @@
  * buffers to the clients. This behaviour can be disabled by setting the sync
  * property to FALSE. Multisocketsink will by default not do QoS and will never
  * drop late buffers.
+ *
+ * With many clients the number of send calls can become the bottleneck. When
+ * the #GstMultiSocketSink:batch-size property is larger than 1, multisocketsink
+ * sends up to that many queued buffers to a client with a single vectored
+ * send. For datagram sockets each buffer is still sent as a separate message,
+ * but all messages of a batch are passed to the kernel at once. The number of
+ * send calls made for a client is available as "send-calls" in the
+ * #GstMultiSocketSink::get-stats structure.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -139,12 +147,17 @@ enum
 
 #define DEFAULT_SEND_DISPATCHED FALSE
 #define DEFAULT_SEND_MESSAGES   FALSE
+#define DEFAULT_BATCH_SIZE      1
+
+/* the maximum number of memories that are sent with one batch */
+#define BATCH_VECTORS_MAX       64
 
 enum
 {
   PROP_0,
   PROP_SEND_DISPATCHED,
   PROP_SEND_MESSAGES,
+  PROP_BATCH_SIZE,
   PROP_LAST
 };
 
@@ -260,6 +273,19 @@ gst_multi_socket_sink_class_init (GstMultiSocketSinkClass * klass)
       g_param_spec_boolean ("send-messages", "Send Messages",
           "If GstNetworkMessage events should be pushed", DEFAULT_SEND_MESSAGES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMultiSocketSink:batch-size:
+   *
+   * The maximum number of queued buffers that are sent to a client with one
+   * send call. A value of 1 sends every buffer separately.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Maximum number of buffers to send to a client with one call",
+          1, BATCH_VECTORS_MAX, DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstMultiSocketSink::add:
@@ -451,6 +477,7 @@ gst_multi_socket_sink_init (GstMultiSocketSink * this)
   this->cancellable = g_cancellable_new ();
   this->send_dispatched = DEFAULT_SEND_DISPATCHED;
   this->send_messages = DEFAULT_SEND_MESSAGES;
+  this->batch_size = DEFAULT_BATCH_SIZE;
 }
 
 static void
@@ -797,6 +824,215 @@ gst_multi_socket_sink_write (GstMultiSocketSink * sink,
   return wrote;
 }
 
+static gboolean
+gst_buffer_has_cmsg (GstBuffer * buf)
+{
+  return gst_buffer_get_meta (buf, GST_NET_CONTROL_MESSAGE_META_API_TYPE) !=
+      NULL;
+}
+
+#if GLIB_CHECK_VERSION (2, 44, 0)
+/* send every buffer in @sending as a separate datagram, with one call */
+static gssize
+gst_multi_socket_sink_write_messages (GstMultiSocketSink * sink,
+    GSocket * sock, GSList * sending, guint batch_size,
+    GCancellable * cancellable, GError ** err)
+{
+  GstMapInfo maps[BATCH_VECTORS_MAX];
+  GOutputVector vec[BATCH_VECTORS_MAX];
+  GOutputMessage msgs[BATCH_VECTORS_MAX];
+  GSocketControlMessage *cmsgs[CMSG_MAX];
+  guint n_msgs = 0, n_vec = 0;
+  gssize wrote = 0;
+  gint i, sent;
+  GSList *walk;
+
+  for (walk = sending; walk && n_msgs < batch_size; walk = walk->next) {
+    GstBuffer *buf = walk->data;
+    guint mapped;
+
+    if (walk != sending) {
+      /* a datagram must be sent completely and only the first message
+       * carries control messages */
+      if (gst_buffer_n_memory (buf) > BATCH_VECTORS_MAX - n_vec ||
+          gst_buffer_has_cmsg (buf))
+        break;
+    }
+
+    if (gst_buffer_get_size (buf) > 0)
+      mapped = map_n_memory_output_vector (buf, 0, &vec[n_vec], &maps[n_vec],
+          BATCH_VECTORS_MAX - n_vec);
+    else
+      mapped = 0;
+
+    msgs[n_msgs].address = NULL;
+    msgs[n_msgs].vectors = &vec[n_vec];
+    msgs[n_msgs].num_vectors = mapped;
+    msgs[n_msgs].bytes_sent = 0;
+    if (walk == sending) {
+      msgs[n_msgs].control_messages = cmsgs;
+      msgs[n_msgs].num_control_messages =
+          gst_buffer_get_cmsg_list (buf, cmsgs, CMSG_MAX);
+    } else {
+      msgs[n_msgs].control_messages = NULL;
+      msgs[n_msgs].num_control_messages = 0;
+    }
+    n_vec += mapped;
+    n_msgs++;
+  }
+
+  GST_LOG_OBJECT (sink, "sending %u messages", n_msgs);
+
+  sent = g_socket_send_messages (sock, msgs, n_msgs, 0, cancellable, err);
+
+  if (n_vec > 0)
+    unmap_n_memorys (maps, n_vec);
+
+  if (sent < 0)
+    return -1;
+
+  /* datagrams are sent completely or not at all, report the size of the sent
+   * buffers so that they are all removed from the queue */
+  for (i = 0, walk = sending; i < sent; i++, walk = walk->next)
+    wrote += gst_buffer_get_size (walk->data);
+
+  return wrote;
+}
+#endif
+
+/* send the buffers in @sending, starting at @bufoffset in the first buffer,
+ * with one call */
+static gssize
+gst_multi_socket_sink_write_batch (GstMultiSocketSink * sink,
+    GSocket * sock, GSList * sending, gsize bufoffset, guint batch_size,
+    GCancellable * cancellable, GError ** err)
+{
+  GstMapInfo maps[BATCH_VECTORS_MAX];
+  GOutputVector vec[BATCH_VECTORS_MAX];
+  GSocketControlMessage *cmsgs[CMSG_MAX];
+  gsize msg_count;
+  guint n_bufs = 0, n_vec = 0;
+  gssize wrote;
+  GSList *walk;
+
+  if (g_socket_get_socket_type (sock) == G_SOCKET_TYPE_DATAGRAM) {
+#if GLIB_CHECK_VERSION (2, 44, 0)
+    /* a buffer that has more memories than fit in one batch, or that was
+     * partly sent already, is sent on its own */
+    if (bufoffset == 0
+        && gst_buffer_n_memory (sending->data) <= BATCH_VECTORS_MAX)
+      return gst_multi_socket_sink_write_messages (sink, sock, sending,
+          batch_size, cancellable, err);
+#endif
+    /* coalescing would merge the datagrams */
+    return gst_multi_socket_sink_write (sink, sock, sending->data, bufoffset,
+        cancellable, err);
+  }
+
+  msg_count = gst_buffer_get_cmsg_list (sending->data, cmsgs, CMSG_MAX);
+
+  for (walk = sending; walk && n_bufs < batch_size && n_vec < BATCH_VECTORS_MAX;
+      walk = walk->next, n_bufs++) {
+    GstBuffer *buf = walk->data;
+    gsize offset = 0;
+
+    if (walk == sending)
+      offset = bufoffset;
+    else if (gst_buffer_has_cmsg (buf))
+      /* the control messages of this buffer must be sent with its data */
+      break;
+
+    if (offset < gst_buffer_get_size (buf))
+      n_vec += map_n_memory_output_vector (buf, offset, &vec[n_vec],
+          &maps[n_vec], BATCH_VECTORS_MAX - n_vec);
+  }
+
+  GST_LOG_OBJECT (sink, "sending %u buffers in %u vectors", n_bufs, n_vec);
+
+  wrote =
+      g_socket_send_message (sock, NULL, vec, n_vec, cmsgs, msg_count, 0,
+      cancellable, err);
+
+  if (n_vec > 0)
+    unmap_n_memorys (maps, n_vec);
+
+  return wrote;
+}
+
+/* queue the next buffer from the global queue for @client */
+static void
+gst_multi_socket_sink_client_take_buffer (GstMultiSocketSink * sink,
+    GstMultiHandleClient * mhclient)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstMultiHandleSinkClass *mhsinkclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
+  GstBuffer *buf;
+  GstClockTime timestamp;
+  gint bufpos;
+
+  /* grab buffer */
+  bufpos = CLIENT_BUFPOS (mhsink, mhclient);
+  buf = g_array_index (mhsink->bufqueue, GstBuffer *, bufpos);
+  gst_multi_handle_sink_client_set_bufpos (mhsink, mhclient, bufpos - 1);
+
+  /* update stats */
+  timestamp = GST_BUFFER_TIMESTAMP (buf);
+  if (mhclient->first_buffer_ts == GST_CLOCK_TIME_NONE)
+    mhclient->first_buffer_ts = timestamp;
+  if (timestamp != -1)
+    mhclient->last_buffer_ts = timestamp;
+
+  /* decrease flushcount */
+  if (mhclient->flushcount != -1)
+    mhclient->flushcount--;
+
+  GST_LOG_OBJECT (sink, "%s client %p at position %d",
+      mhclient->debug, mhclient, bufpos - 1);
+
+  /* queueing a buffer will ref it */
+  mhsinkclass->client_queue_buffer (mhsink, mhclient, buf);
+}
+
+/* remove the buffers that were completely written from the sending queue of
+ * @client and update the offset in the first remaining buffer */
+static void
+gst_multi_socket_sink_client_sent (GstMultiSocketSink * sink,
+    GstMultiHandleClient * mhclient, gsize wrote)
+{
+  while (mhclient->sending) {
+    GstBuffer *head = GST_BUFFER (mhclient->sending->data);
+    gsize remaining = gst_buffer_get_size (head) - mhclient->bufoffset;
+
+    if (wrote < remaining) {
+      if (wrote > 0) {
+        /* partial write, try again now */
+        GST_LOG_OBJECT (sink,
+            "partial write on %p of %" G_GSIZE_FORMAT " bytes",
+            mhclient->handle.socket, wrote);
+        mhclient->bufoffset += wrote;
+      }
+      break;
+    }
+
+    if (sink->send_dispatched) {
+      gst_pad_push_event (GST_BASE_SINK_PAD (sink),
+          gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+              gst_structure_new ("GstNetworkMessageDispatched",
+                  "object", G_TYPE_OBJECT, mhclient->handle.socket,
+                  "buffer", GST_TYPE_BUFFER, head, NULL)));
+    }
+    /* complete buffer was written, we can proceed to the next one */
+    mhclient->sending = g_slist_delete_link (mhclient->sending,
+        mhclient->sending);
+    gst_buffer_unref (head);
+    /* make sure we start from byte 0 for the next buffer */
+    mhclient->bufoffset = 0;
+
+    wrote -= remaining;
+  }
+}
+
 /* Handle a write on a client,
  * which indicates a read request from a client.
  *
@@ -828,22 +1064,22 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
   GstClockTime now;
   GTimeVal nowtv;
   GError *err = NULL;
+  guint batch_size;
   GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
   GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
-  GstMultiHandleSinkClass *mhsinkclass =
-      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
 
 
   g_get_current_time (&nowtv);
   now = GST_TIMEVAL_TO_TIME (nowtv);
 
   flushing = mhclient->status == GST_CLIENT_STATUS_FLUSHING;
+  batch_size = sink->batch_size;
 
   more = TRUE;
   do {
     if (!mhclient->sending) {
       /* client is not working on a buffer */
-      if (mhclient->bufpos == -1) {
+      if (CLIENT_BUFPOS (mhsink, mhclient) == -1) {
         /* client is too fast, remove from write queue until new buffer is
          * available */
         gst_multi_socket_sink_stop_sending (sink, client);
@@ -855,8 +1091,6 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
         return TRUE;
       } else {
         /* client can pick a buffer from the global queue */
-        GstBuffer *buf;
-        GstClockTime timestamp;
 
         /* for new connections, we need to find a good spot in the
          * bufqueue to start streaming from */
@@ -867,7 +1101,8 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
           if (position >= 0) {
             /* we got a valid spot in the queue */
             mhclient->new_connection = FALSE;
-            mhclient->bufpos = position;
+            gst_multi_handle_sink_client_set_bufpos (mhsink, mhclient,
+                position);
           } else {
             /* cannot send data to this client yet */
             gst_multi_socket_sink_stop_sending (sink, client);
@@ -879,42 +1114,41 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
         if (mhclient->flushcount == 0)
           goto flushed;
 
-        /* grab buffer */
-        buf = g_array_index (mhsink->bufqueue, GstBuffer *, mhclient->bufpos);
-        mhclient->bufpos--;
-
-        /* update stats */
-        timestamp = GST_BUFFER_TIMESTAMP (buf);
-        if (mhclient->first_buffer_ts == GST_CLOCK_TIME_NONE)
-          mhclient->first_buffer_ts = timestamp;
-        if (timestamp != -1)
-          mhclient->last_buffer_ts = timestamp;
-
-        /* decrease flushcount */
-        if (mhclient->flushcount != -1)
-          mhclient->flushcount--;
-
-        GST_LOG_OBJECT (sink, "%s client %p at position %d",
-            mhclient->debug, client, mhclient->bufpos);
-
-        /* queueing a buffer will ref it */
-        mhsinkclass->client_queue_buffer (mhsink, mhclient, buf);
+        gst_multi_socket_sink_client_take_buffer (sink, mhclient);
 
         /* need to start from the first byte for this new buffer */
         mhclient->bufoffset = 0;
       }
     }
 
+    /* when batching, queue more of the available buffers so that they can
+     * all be sent with one call */
+    if (batch_size > 1) {
+      guint n_sending = g_slist_length (mhclient->sending);
+
+      while (CLIENT_BUFPOS (mhsink, mhclient) != -1 &&
+          !mhclient->new_connection &&
+          mhclient->flushcount != 0 && n_sending < batch_size) {
+        gst_multi_socket_sink_client_take_buffer (sink, mhclient);
+        n_sending++;
+      }
+    }
+
     /* see if we need to send something */
     if (mhclient->sending) {
       gssize wrote;
-      GstBuffer *head;
-
-      /* pick first buffer from list */
-      head = GST_BUFFER (mhclient->sending->data);
 
-      wrote = gst_multi_socket_sink_write (sink, mhclient->handle.socket, head,
-          mhclient->bufoffset, sink->cancellable, &err);
+      if (batch_size > 1) {
+        wrote = gst_multi_socket_sink_write_batch (sink,
+            mhclient->handle.socket, mhclient->sending, mhclient->bufoffset,
+            batch_size, sink->cancellable, &err);
+      } else {
+        /* pick first buffer from list */
+        wrote = gst_multi_socket_sink_write (sink, mhclient->handle.socket,
+            GST_BUFFER (mhclient->sending->data), mhclient->bufoffset,
+            sink->cancellable, &err);
+      }
+      mhclient->send_calls++;
 
       if (wrote < 0) {
         /* hmm error.. */
@@ -930,29 +1164,11 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
           goto write_error;
         }
       } else {
-        if (wrote < (gst_buffer_get_size (head) - mhclient->bufoffset)) {
-          /* partial write, try again now */
-          GST_LOG_OBJECT (sink,
-              "partial write on %p of %" G_GSSIZE_FORMAT " bytes",
-              mhclient->handle.socket, wrote);
-          mhclient->bufoffset += wrote;
-        } else {
-          if (sink->send_dispatched) {
-            gst_pad_push_event (GST_BASE_SINK_PAD (mhsink),
-                gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
-                    gst_structure_new ("GstNetworkMessageDispatched",
-                        "object", G_TYPE_OBJECT, mhclient->handle.socket,
-                        "buffer", GST_TYPE_BUFFER, head, NULL)));
-          }
-          /* complete buffer was written, we can proceed to the next one */
-          mhclient->sending = g_slist_remove (mhclient->sending, head);
-          gst_buffer_unref (head);
-          /* make sure we start from byte 0 for the next buffer */
-          mhclient->bufoffset = 0;
-        }
+        gst_multi_socket_sink_client_sent (sink, mhclient, wrote);
+
         /* update stats */
         mhclient->bytes_sent += wrote;
-        mhclient->last_activity_time = now;
+        gst_multi_handle_sink_client_set_activity (mhsink, mhclient, now);
         mhsink->bytes_served += wrote;
       }
     }
@@ -1185,6 +1401,9 @@ gst_multi_socket_sink_set_property (GObject * object, guint prop_id,
     case PROP_SEND_MESSAGES:
       sink->send_messages = g_value_get_boolean (value);
       break;
+    case PROP_BATCH_SIZE:
+      sink->batch_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1204,6 +1423,9 @@ gst_multi_socket_sink_get_property (GObject * object, guint prop_id,
     case PROP_SEND_MESSAGES:
       g_value_set_boolean (value, sink->send_messages);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, sink->batch_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -70,6 +70,7 @@ struct _GstMultiSocketSink {
   GCancellable *cancellable;
   gboolean send_messages;
   gboolean send_dispatched;
+  guint batch_size;
 };
 
 struct _GstMultiSocketSinkClass {
@@ -42,6 +42,10 @@
  * As compared to #fdsrc socketsrc is socket specific and deals with #GSocket
  * objects rather than sockets via integer file-descriptors.
  *
+ * For datagram sockets the #GstSocketSrc:batch-size property allows receiving
+ * multiple datagrams with a single system call. The additional datagrams are
+ * queued and returned by the following create calls.
+ *
  * @see_also: #multisocketsink
  */
 
@@ -54,6 +58,11 @@
 #include "gstsocketsrc.h"
 #include "gsttcp.h"
 
+#ifdef G_OS_UNIX
+#include <errno.h>
+#include <unistd.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (socketsrc_debug);
 #define GST_CAT_DEFAULT socketsrc_debug
 
@@ -67,13 +76,16 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
 
 
 #define DEFAULT_SEND_MESSAGES FALSE
+#define DEFAULT_BATCH_SIZE 1
+#define MAX_BATCH_SIZE 64
 
 enum
 {
   PROP_0,
   PROP_SOCKET,
   PROP_CAPS,
-  PROP_SEND_MESSAGES
+  PROP_SEND_MESSAGES,
+  PROP_BATCH_SIZE
 };
 
 enum
@@ -92,8 +104,11 @@ static void gst_socket_src_finalize (GObject * gobject);
 
 static GstCaps *gst_socketsrc_getcaps (GstBaseSrc * src, GstCaps * filter);
 static gboolean gst_socketsrc_event (GstBaseSrc * src, GstEvent * event);
+static GstFlowReturn gst_socket_src_create (GstPushSrc * psrc,
+    GstBuffer ** outbuf);
 static GstFlowReturn gst_socket_src_fill (GstPushSrc * psrc,
     GstBuffer * outbuf);
+static gboolean gst_socket_src_stop (GstBaseSrc * bsrc);
 static gboolean gst_socket_src_unlock (GstBaseSrc * bsrc);
 static gboolean gst_socket_src_unlock_stop (GstBaseSrc * bsrc);
 
@@ -149,6 +164,20 @@ gst_socket_src_class_init (GstSocketSrcClass * klass)
           "If GstNetworkMessage events should be handled",
           DEFAULT_SEND_MESSAGES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSocketSrc:batch-size:
+   *
+   * The maximum number of datagrams to receive with one system call. This
+   * only has an effect on datagram sockets.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Maximum number of datagrams to receive with one call",
+          1, MAX_BATCH_SIZE, DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_socket_src_signals[CONNECTION_CLOSED_BY_PEER] =
       g_signal_new ("connection-closed-by-peer", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_FIRST, G_STRUCT_OFFSET (GstSocketSrcClass,
@@ -164,9 +193,11 @@ gst_socket_src_class_init (GstSocketSrcClass * klass)
 
   gstbasesrc_class->event = gst_socketsrc_event;
   gstbasesrc_class->get_caps = gst_socketsrc_getcaps;
+  gstbasesrc_class->stop = gst_socket_src_stop;
   gstbasesrc_class->unlock = gst_socket_src_unlock;
   gstbasesrc_class->unlock_stop = gst_socket_src_unlock_stop;
 
+  gstpush_src_class->create = gst_socket_src_create;
   gstpush_src_class->fill = gst_socket_src_fill;
 
   GST_DEBUG_CATEGORY_INIT (socketsrc_debug, "socketsrc", 0, "Socket Source");
@@ -178,6 +209,8 @@ gst_socket_src_init (GstSocketSrc * this)
   this->socket = NULL;
   this->cancellable = g_cancellable_new ();
   this->send_messages = DEFAULT_SEND_MESSAGES;
+  this->batch_size = DEFAULT_BATCH_SIZE;
+  g_queue_init (&this->pending);
 }
 
 static void
@@ -187,6 +220,10 @@ gst_socket_src_finalize (GObject * gobject)
 
   if (this->caps)
     gst_caps_unref (this->caps);
+  g_queue_foreach (&this->pending, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&this->pending);
+  g_clear_object (&this->batch_socket);
+  g_clear_object (&this->batch_socket_parent);
   g_clear_object (&this->cancellable);
   g_clear_object (&this->socket);
 
@@ -272,6 +309,268 @@ gst_socketsrc_getcaps (GstBaseSrc * src, GstCaps * filter)
   return result;
 }
 
+/* we've hit EOS on @socket, emit the connection-closed-by-peer signal to
+ * allow someone to change our socket before we send EOS downstream. Returns
+ * %TRUE when @socket was replaced by a new socket to retry with. */
+static gboolean
+gst_socket_src_closed_by_peer (GstSocketSrc * src, GSocket ** socket)
+{
+  GSocket *tmp = NULL;
+
+  GST_DEBUG_OBJECT (src, "Received EOS on socket %p fd %i", *socket,
+      g_socket_get_fd (*socket));
+
+  g_signal_emit (src, gst_socket_src_signals[CONNECTION_CLOSED_BY_PEER], 0);
+
+  GST_OBJECT_LOCK (src);
+
+  if (src->socket)
+    tmp = g_object_ref (src->socket);
+
+  GST_OBJECT_UNLOCK (src);
+
+  /* Do this dance with tmp to avoid unreffing with the lock held */
+  if (tmp != NULL && tmp != *socket) {
+    SWAP (*socket, tmp);
+    g_clear_object (&tmp);
+
+    GST_INFO_OBJECT (src, "New socket available after EOS %p fd %i: Retrying",
+        *socket, g_socket_get_fd (*socket));
+
+    return TRUE;
+  }
+
+  g_clear_object (&tmp);
+  GST_INFO_OBJECT (src, "Forwarding EOS downstream");
+
+  return FALSE;
+}
+
+static void
+gst_socket_src_clear_pending (GstSocketSrc * src)
+{
+  g_queue_foreach (&src->pending, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&src->pending);
+  src->pending_eos = FALSE;
+}
+
+#if GLIB_CHECK_VERSION (2, 48, 0) && defined (G_OS_UNIX)
+#define HAVE_RECEIVE_BATCH
+
+/* g_socket_receive_messages() on a blocking socket only returns when the
+ * whole batch was received. The available datagrams are taken from a
+ * non-blocking socket on a duplicate of the file descriptor instead, which
+ * leaves the blocking mode of the socket of the application untouched */
+static GSocket *
+gst_socket_src_get_batch_socket (GstSocketSrc * src, GSocket * socket)
+{
+  GError *err = NULL;
+  gint fd;
+
+  if (src->batch_socket != NULL && src->batch_socket_parent == socket)
+    return src->batch_socket;
+
+  g_clear_object (&src->batch_socket);
+  g_clear_object (&src->batch_socket_parent);
+
+  fd = dup (g_socket_get_fd (socket));
+  if (fd < 0) {
+    GST_WARNING_OBJECT (src, "Failed to duplicate socket: %s",
+        g_strerror (errno));
+    return NULL;
+  }
+
+  src->batch_socket = g_socket_new_from_fd (fd, &err);
+  if (src->batch_socket == NULL) {
+    GST_WARNING_OBJECT (src, "Failed to create batch socket: %s",
+        err->message);
+    g_clear_error (&err);
+    close (fd);
+    return NULL;
+  }
+  g_socket_set_blocking (src->batch_socket, FALSE);
+  src->batch_socket_parent = g_object_ref (socket);
+
+  return src->batch_socket;
+}
+
+/* receive up to @batch_size datagrams with one call, the first one is
+ * returned in @outbuf and the others are queued for the next create calls */
+static GstFlowReturn
+gst_socket_src_receive_batch (GstSocketSrc * src, GSocket * socket,
+    guint batch_size, GstBuffer ** outbuf)
+{
+  GstBaseSrc *bsrc = GST_BASE_SRC (src);
+  GstBuffer *bufs[MAX_BATCH_SIZE];
+  GstMapInfo maps[MAX_BATCH_SIZE];
+  GInputVector ivecs[MAX_BATCH_SIZE];
+  GInputMessage msgs[MAX_BATCH_SIZE];
+  GSocketControlMessage **messages[MAX_BATCH_SIZE];
+  guint num_messages[MAX_BATCH_SIZE];
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GSocket *batch_socket;
+  GError *err = NULL;
+  guint blocksize, received, i, j;
+  gint n;
+
+  g_object_ref (socket);
+
+retry:
+  if (!(batch_socket = gst_socket_src_get_batch_socket (src, socket)))
+    goto no_batch_socket;
+
+  blocksize = gst_base_src_get_blocksize (bsrc);
+  gst_base_src_get_allocator (bsrc, &allocator, &params);
+
+  for (i = 0; i < batch_size; i++) {
+    bufs[i] = gst_buffer_new_allocate (allocator, blocksize, &params);
+    gst_buffer_map (bufs[i], &maps[i], GST_MAP_READWRITE);
+    ivecs[i].buffer = maps[i].data;
+    ivecs[i].size = maps[i].size;
+
+    messages[i] = NULL;
+    num_messages[i] = 0;
+
+    msgs[i].address = NULL;
+    msgs[i].vectors = &ivecs[i];
+    msgs[i].num_vectors = 1;
+    msgs[i].bytes_received = 0;
+    msgs[i].flags = 0;
+    msgs[i].control_messages = &messages[i];
+    msgs[i].num_control_messages = &num_messages[i];
+  }
+
+  if (allocator)
+    gst_object_unref (allocator);
+
+  /* wait for the first datagram, then take everything that is available
+   * without blocking for the rest of the batch */
+  do {
+    if (!g_socket_condition_wait (socket, G_IO_IN, src->cancellable, &err)) {
+      n = -1;
+      break;
+    }
+    n = g_socket_receive_messages (batch_socket, msgs, batch_size, 0,
+        src->cancellable, &err);
+    if (n < 0 && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+      g_clear_error (&err);
+    else
+      break;
+  } while (TRUE);
+
+  /* a zero-byte read is EOS like in fill(), the datagrams before it are
+   * returned first */
+  for (received = 0; received < (guint) MAX (n, 0); received++) {
+    if (msgs[received].bytes_received == 0)
+      break;
+  }
+
+  for (i = 0; i < batch_size; i++) {
+    gst_buffer_unmap (bufs[i], &maps[i]);
+
+    for (j = 0; j < num_messages[i]; j++) {
+      if (i < received)
+        gst_buffer_add_net_control_message_meta (bufs[i], messages[i][j]);
+      g_object_unref (messages[i][j]);
+    }
+    g_free (messages[i]);
+
+    if (i >= received) {
+      gst_buffer_unref (bufs[i]);
+      continue;
+    }
+
+    gst_buffer_resize (bufs[i], 0, msgs[i].bytes_received);
+
+    if (i == 0)
+      *outbuf = bufs[i];
+    else
+      g_queue_push_tail (&src->pending, bufs[i]);
+  }
+
+  if (n < 0) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      ret = GST_FLOW_FLUSHING;
+      GST_DEBUG_OBJECT (src, "Cancelled reading from socket");
+    } else {
+      ret = GST_FLOW_ERROR;
+      GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+          ("Failed to read from socket: %s", err->message));
+    }
+    g_clear_error (&err);
+  } else if (received < (guint) n || n == 0) {
+    if (received > 0) {
+      /* handle the EOS once the queued datagrams are pushed */
+      src->pending_eos = TRUE;
+    } else if (gst_socket_src_closed_by_peer (src, &socket)) {
+      /* retry with our new socket */
+      goto retry;
+    } else {
+      ret = GST_FLOW_EOS;
+    }
+  }
+
+  GST_LOG_OBJECT (src, "received %u datagrams with one call", received);
+
+  g_object_unref (socket);
+
+  return ret;
+
+  /* ERRORS */
+no_batch_socket:
+  {
+    g_object_unref (socket);
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("Failed to create a socket for receiving batches"));
+    return GST_FLOW_ERROR;
+  }
+}
+#endif
+
+static GstFlowReturn
+gst_socket_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
+{
+  GstSocketSrc *src = GST_SOCKET_SRC (psrc);
+  GstFlowReturn ret;
+  GSocket *socket = NULL;
+  guint batch_size;
+
+  /* datagrams received with a previous batch */
+  if ((*outbuf = g_queue_pop_head (&src->pending)))
+    return GST_FLOW_OK;
+
+  GST_OBJECT_LOCK (src);
+  batch_size = src->batch_size;
+  if (src->socket)
+    socket = g_object_ref (src->socket);
+  GST_OBJECT_UNLOCK (src);
+
+  /* the last batch ended with EOS */
+  if (G_UNLIKELY (src->pending_eos) && socket != NULL) {
+    src->pending_eos = FALSE;
+    if (!gst_socket_src_closed_by_peer (src, &socket)) {
+      g_object_unref (socket);
+      return GST_FLOW_EOS;
+    }
+  }
+#ifdef HAVE_RECEIVE_BATCH
+  if (batch_size > 1 && socket != NULL &&
+      g_socket_get_socket_type (socket) == G_SOCKET_TYPE_DATAGRAM) {
+    ret = gst_socket_src_receive_batch (src, socket, batch_size, outbuf);
+    g_object_unref (socket);
+    return ret;
+  }
+#endif
+  g_clear_object (&socket);
+
+  /* allocates a buffer and reads into it with fill */
+  ret = GST_PUSH_SRC_CLASS (parent_class)->create (psrc, outbuf);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_socket_src_fill (GstPushSrc * psrc, GstBuffer * outbuf)
 {
@@ -318,36 +617,11 @@ retry:
   g_free (messages);
 
   if (rret == 0) {
-    GSocket *tmp = NULL;
-    GST_DEBUG_OBJECT (src, "Received EOS on socket %p fd %i", socket,
-        g_socket_get_fd (socket));
-
-    /* We've hit EOS but we'll send this signal to allow someone to change
-     * our socket before we send EOS downstream. */
-    g_signal_emit (src, gst_socket_src_signals[CONNECTION_CLOSED_BY_PEER], 0);
-
-    GST_OBJECT_LOCK (src);
-
-    if (src->socket)
-      tmp = g_object_ref (src->socket);
-
-    GST_OBJECT_UNLOCK (src);
-
-    /* Do this dance with tmp to avoid unreffing with the lock held */
-    if (tmp != NULL && tmp != socket) {
-      SWAP (socket, tmp);
-      g_clear_object (&tmp);
-
-      GST_INFO_OBJECT (src, "New socket available after EOS %p fd %i: Retrying",
-          socket, g_socket_get_fd (socket));
-
-      /* retry with our new socket: */
+    /* retry with our new socket: */
+    if (gst_socket_src_closed_by_peer (src, &socket))
       goto retry;
-    } else {
-      g_clear_object (&tmp);
-      GST_INFO_OBJECT (src, "Forwarding EOS downstream");
-      ret = GST_FLOW_EOS;
-    }
+
+    ret = GST_FLOW_EOS;
   } else if (rret < 0) {
     if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
       ret = GST_FLOW_FLUSHING;
@@ -424,6 +698,11 @@ gst_socket_src_set_property (GObject * object, guint prop_id,
     case PROP_SEND_MESSAGES:
       socketsrc->send_messages = g_value_get_boolean (value);
       break;
+    case PROP_BATCH_SIZE:
+      GST_OBJECT_LOCK (socketsrc);
+      socketsrc->batch_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (socketsrc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -448,12 +727,30 @@ gst_socket_src_get_property (GObject * object, guint prop_id,
     case PROP_SEND_MESSAGES:
       g_value_set_boolean (value, socketsrc->send_messages);
       break;
+    case PROP_BATCH_SIZE:
+      GST_OBJECT_LOCK (socketsrc);
+      g_value_set_uint (value, socketsrc->batch_size);
+      GST_OBJECT_UNLOCK (socketsrc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static gboolean
+gst_socket_src_stop (GstBaseSrc * bsrc)
+{
+  GstSocketSrc *src = GST_SOCKET_SRC (bsrc);
+
+  /* drop the datagrams of an unfinished batch */
+  gst_socket_src_clear_pending (src);
+  g_clear_object (&src->batch_socket);
+  g_clear_object (&src->batch_socket_parent);
+
+  return TRUE;
+}
+
 static gboolean
 gst_socket_src_unlock (GstBaseSrc * bsrc)
 {
@@ -473,5 +770,9 @@ gst_socket_src_unlock_stop (GstBaseSrc * bsrc)
   GST_DEBUG_OBJECT (src, "unset flushing");
   g_cancellable_reset (src->cancellable);
 
+  /* called with the stream lock on FLUSH_STOP, the datagrams received before
+   * the flush are stale */
+  gst_socket_src_clear_pending (src);
+
   return TRUE;
 }
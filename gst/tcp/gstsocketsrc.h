@@ -52,6 +52,12 @@ struct _GstSocketSrc {
   GSocket *socket;
   gboolean send_messages;
   GCancellable *cancellable;
+
+  guint batch_size;
+  GQueue pending;       /* datagrams received with the last batch */
+  gboolean pending_eos; /* the last batch ended with a zero-byte read */
+  GSocket *batch_socket;        /* non-blocking socket for receiving batches */
+  GSocket *batch_socket_parent; /* the socket batch_socket duplicates */
 };
 
 struct _GstSocketSrcClass {
@@ -69,6 +69,7 @@ G_DEFINE_TYPE (GstVideoConvert, gst_video_convert, GST_TYPE_VIDEO_FILTER);
 #define DEFAULT_PROP_GAMMA_MODE GST_VIDEO_GAMMA_MODE_NONE
 #define DEFAULT_PROP_PRIMARIES_MODE GST_VIDEO_PRIMARIES_MODE_NONE
 #define DEFAULT_PROP_N_THREADS 1
+#define DEFAULT_PROP_MAX_IN_FLIGHT 1
 
 enum
 {
@@ -82,7 +83,8 @@ enum
   PROP_MATRIX_MODE,
   PROP_GAMMA_MODE,
   PROP_PRIMARIES_MODE,
-  PROP_N_THREADS
+  PROP_N_THREADS,
+  PROP_MAX_IN_FLIGHT
 };
 
 #define CSP_VIDEO_CAPS GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL) ";" \
@@ -585,6 +587,12 @@ gst_video_convert_class_init (GstVideoConvertClass * klass)
       g_param_spec_uint ("n-threads", "Threads",
           "Maximum number of threads to use", 0, G_MAXUINT,
           DEFAULT_PROP_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MAX_IN_FLIGHT,
+      g_param_spec_uint ("max-in-flight", "Max In Flight",
+          "Maximum number of frames being converted before the oldest one is "
+          "pushed, adds max-in-flight - 1 frames of latency (1 = disabled)",
+          1, 16, DEFAULT_PROP_MAX_IN_FLIGHT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -600,6 +608,7 @@ gst_video_convert_init (GstVideoConvert * space)
   space->gamma_mode = DEFAULT_PROP_GAMMA_MODE;
   space->primaries_mode = DEFAULT_PROP_PRIMARIES_MODE;
   space->n_threads = DEFAULT_PROP_N_THREADS;
+  space->max_in_flight = DEFAULT_PROP_MAX_IN_FLIGHT;
 }
 
 void
@@ -641,6 +650,11 @@ gst_video_convert_set_property (GObject * object, guint property_id,
     case PROP_N_THREADS:
       csp->n_threads = g_value_get_uint (value);
       break;
+    case PROP_MAX_IN_FLIGHT:
+      csp->max_in_flight = g_value_get_uint (value);
+      gst_video_filter_set_max_in_flight (GST_VIDEO_FILTER (csp),
+          csp->max_in_flight);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -686,6 +700,9 @@ gst_video_convert_get_property (GObject * object, guint property_id,
     case PROP_N_THREADS:
       g_value_set_uint (value, csp->n_threads);
       break;
+    case PROP_MAX_IN_FLIGHT:
+      g_value_set_uint (value, csp->max_in_flight);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -57,6 +57,7 @@ struct _GstVideoConvert {
   GstVideoPrimariesMode primaries_mode;
   gdouble alpha_value;
   gint n_threads;
+  guint max_in_flight;
 };
 
 struct _GstVideoConvertClass
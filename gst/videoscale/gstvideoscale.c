@@ -93,6 +93,7 @@ GST_DEBUG_CATEGORY_STATIC (CAT_PERFORMANCE);
 #define DEFAULT_PROP_ENVELOPE     2.0
 #define DEFAULT_PROP_GAMMA_DECODE FALSE
 #define DEFAULT_PROP_N_THREADS    1
+#define DEFAULT_PROP_MAX_IN_FLIGHT 1
 
 enum
 {
@@ -105,7 +106,8 @@ enum
   PROP_SUBMETHOD,
   PROP_ENVELOPE,
   PROP_GAMMA_DECODE,
-  PROP_N_THREADS
+  PROP_N_THREADS,
+  PROP_MAX_IN_FLIGHT
 };
 
 #undef GST_VIDEO_SIZE_RANGE
@@ -191,6 +193,14 @@ static GstCaps *gst_video_scale_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter);
 static GstCaps *gst_video_scale_fixate_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * othercaps);
+static gboolean gst_video_scale_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query);
+static gboolean gst_video_scale_decide_allocation (GstBaseTransform * trans,
+    GstQuery * query);
+static GstFlowReturn gst_video_scale_prepare_output_buffer (GstBaseTransform *
+    trans, GstBuffer * input, GstBuffer ** outbuf);
+static GstFlowReturn gst_video_scale_transform (GstBaseTransform * trans,
+    GstBuffer * inbuf, GstBuffer * outbuf);
 
 static gboolean gst_video_scale_set_info (GstVideoFilter * filter,
     GstCaps * in, GstVideoInfo * in_info, GstCaps * out,
@@ -270,6 +280,13 @@ gst_video_scale_class_init (GstVideoScaleClass * klass)
           DEFAULT_PROP_N_THREADS,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_MAX_IN_FLIGHT,
+      g_param_spec_uint ("max-in-flight", "Max In Flight",
+          "Maximum number of frames being scaled before the oldest one is "
+          "pushed, adds max-in-flight - 1 frames of latency (1 = disabled)",
+          1, 16, DEFAULT_PROP_MAX_IN_FLIGHT,
+          G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class,
       "Video scaler", "Filter/Converter/Video/Scaler",
       "Resizes video", "Wim Taymans <wim.taymans@gmail.com>");
@@ -283,6 +300,13 @@ gst_video_scale_class_init (GstVideoScaleClass * klass)
       GST_DEBUG_FUNCPTR (gst_video_scale_transform_caps);
   trans_class->fixate_caps = GST_DEBUG_FUNCPTR (gst_video_scale_fixate_caps);
   trans_class->src_event = GST_DEBUG_FUNCPTR (gst_video_scale_src_event);
+  trans_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_scale_propose_allocation);
+  trans_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_scale_decide_allocation);
+  trans_class->prepare_output_buffer =
+      GST_DEBUG_FUNCPTR (gst_video_scale_prepare_output_buffer);
+  trans_class->transform = GST_DEBUG_FUNCPTR (gst_video_scale_transform);
 
   filter_class->set_info = GST_DEBUG_FUNCPTR (gst_video_scale_set_info);
   filter_class->transform_frame =
@@ -301,6 +325,7 @@ gst_video_scale_init (GstVideoScale * videoscale)
   videoscale->envelope = DEFAULT_PROP_ENVELOPE;
   videoscale->gamma_decode = DEFAULT_PROP_GAMMA_DECODE;
   videoscale->n_threads = DEFAULT_PROP_N_THREADS;
+  videoscale->max_in_flight = DEFAULT_PROP_MAX_IN_FLIGHT;
 }
 
 static void
@@ -308,6 +333,8 @@ gst_video_scale_finalize (GstVideoScale * videoscale)
 {
   if (videoscale->convert)
     gst_video_converter_free (videoscale->convert);
+  if (videoscale->options)
+    gst_structure_free (videoscale->options);
 
   G_OBJECT_CLASS (parent_class)->finalize (G_OBJECT (videoscale));
 }
@@ -365,6 +392,13 @@ gst_video_scale_set_property (GObject * object, guint prop_id,
       vscale->n_threads = g_value_get_uint (value);
       GST_OBJECT_UNLOCK (vscale);
       break;
+    case PROP_MAX_IN_FLIGHT:
+      GST_OBJECT_LOCK (vscale);
+      vscale->max_in_flight = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (vscale);
+      gst_video_filter_set_max_in_flight (GST_VIDEO_FILTER (vscale),
+          g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -423,6 +457,11 @@ gst_video_scale_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_uint (value, vscale->n_threads);
       GST_OBJECT_UNLOCK (vscale);
       break;
+    case PROP_MAX_IN_FLIGHT:
+      GST_OBJECT_LOCK (vscale);
+      g_value_set_uint (value, vscale->max_in_flight);
+      GST_OBJECT_UNLOCK (vscale);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -636,6 +675,15 @@ gst_video_scale_set_info (GstVideoFilter * filter, GstCaps * in,
           GST_VIDEO_GAMMA_MODE_REMAP, NULL);
     }
 
+    /* keep the options around, a crop meta on the input makes us
+     * recreate the converter for another source rectangle */
+    if (videoscale->options)
+      gst_structure_free (videoscale->options);
+    videoscale->options = gst_structure_copy (options);
+    videoscale->crop_x = videoscale->crop_y = 0;
+    videoscale->crop_w = in_info->width;
+    videoscale->crop_h = in_info->height;
+
     if (videoscale->convert)
       gst_video_converter_free (videoscale->convert);
     videoscale->convert = gst_video_converter_new (in_info, out_info, options);
@@ -1090,6 +1138,190 @@ done:
   return othercaps;
 }
 
+/* Checks if the crop meta selects exactly the output frame so that the input
+ * memory can be passed on with the crop meta instead of being copied. */
+static gboolean
+gst_video_scale_is_pure_crop (GstVideoScale * videoscale,
+    GstVideoCropMeta * crop)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (videoscale);
+  GstVideoInfo *in_info = &filter->in_info;
+  GstVideoInfo *out_info = &filter->out_info;
+
+  if (GST_VIDEO_INFO_FORMAT (in_info) != GST_VIDEO_INFO_FORMAT (out_info))
+    return FALSE;
+  if (GST_VIDEO_INFO_INTERLACE_MODE (in_info) !=
+      GST_VIDEO_INFO_INTERLACE_MODE (out_info))
+    return FALSE;
+  if (in_info->par_n != out_info->par_n || in_info->par_d != out_info->par_d)
+    return FALSE;
+  if (videoscale->borders_w != 0 || videoscale->borders_h != 0)
+    return FALSE;
+  if (crop->width != out_info->width || crop->height != out_info->height)
+    return FALSE;
+  if (crop->x + crop->width > in_info->width ||
+      crop->y + crop->height > in_info->height)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Recreates the converter when the crop meta of the input selects another
+ * source rectangle than the one we are configured for. */
+static gboolean
+gst_video_scale_update_crop (GstVideoScale * videoscale,
+    GstVideoFrame * in_frame)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (videoscale);
+  GstVideoCropMeta *crop;
+  GstStructure *options;
+  gint x, y, w, h;
+
+  crop = gst_buffer_get_video_crop_meta (in_frame->buffer);
+  if (crop) {
+    x = MIN (crop->x, GST_VIDEO_FRAME_WIDTH (in_frame));
+    y = MIN (crop->y, GST_VIDEO_FRAME_HEIGHT (in_frame));
+    w = MIN (crop->width, GST_VIDEO_FRAME_WIDTH (in_frame) - x);
+    h = MIN (crop->height, GST_VIDEO_FRAME_HEIGHT (in_frame) - y);
+  } else {
+    x = y = 0;
+    w = GST_VIDEO_FRAME_WIDTH (in_frame);
+    h = GST_VIDEO_FRAME_HEIGHT (in_frame);
+  }
+
+  if (w <= 0 || h <= 0) {
+    GST_WARNING_OBJECT (videoscale, "ignoring empty crop rectangle");
+    x = y = 0;
+    w = GST_VIDEO_FRAME_WIDTH (in_frame);
+    h = GST_VIDEO_FRAME_HEIGHT (in_frame);
+  }
+
+  if (x == videoscale->crop_x && y == videoscale->crop_y &&
+      w == videoscale->crop_w && h == videoscale->crop_h)
+    return TRUE;
+
+  GST_DEBUG_OBJECT (videoscale, "scaling from crop rectangle %dx%d at %d,%d",
+      w, h, x, y);
+
+  options = gst_structure_copy (videoscale->options);
+  gst_structure_set (options,
+      GST_VIDEO_CONVERTER_OPT_SRC_X, G_TYPE_INT, x,
+      GST_VIDEO_CONVERTER_OPT_SRC_Y, G_TYPE_INT, y,
+      GST_VIDEO_CONVERTER_OPT_SRC_WIDTH, G_TYPE_INT, w,
+      GST_VIDEO_CONVERTER_OPT_SRC_HEIGHT, G_TYPE_INT, h, NULL);
+
+  if (videoscale->convert)
+    gst_video_converter_free (videoscale->convert);
+  videoscale->convert =
+      gst_video_converter_new (&filter->in_info, &filter->out_info, options);
+  if (videoscale->convert == NULL) {
+    GST_ELEMENT_ERROR (videoscale, CORE, NEGOTIATION, (NULL),
+        ("failed to create converter for crop rectangle"));
+    videoscale->crop_w = videoscale->crop_h = 0;
+    return FALSE;
+  }
+
+  videoscale->crop_x = x;
+  videoscale->crop_y = y;
+  videoscale->crop_w = w;
+  videoscale->crop_h = h;
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_scale_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query)
+{
+  if (!GST_BASE_TRANSFORM_CLASS (parent_class)->propose_allocation (trans,
+          decide_query, query))
+    return FALSE;
+
+  /* passthrough, downstream answered */
+  if (decide_query == NULL)
+    return TRUE;
+
+  /* we either scale from the crop rectangle or pass it on */
+  if (!gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL))
+    gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+  gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE, NULL);
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_scale_decide_allocation (GstBaseTransform * trans, GstQuery * query)
+{
+  GstVideoScale *videoscale = GST_VIDEO_SCALE_CAST (trans);
+
+  videoscale->crop_meta_downstream =
+      gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL)
+      && gst_query_find_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE,
+      NULL);
+
+  GST_DEBUG_OBJECT (videoscale, "downstream %s crop meta",
+      videoscale->crop_meta_downstream ? "supports" : "does not support");
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->decide_allocation (trans,
+      query);
+}
+
+static GstFlowReturn
+gst_video_scale_prepare_output_buffer (GstBaseTransform * trans,
+    GstBuffer * input, GstBuffer ** outbuf)
+{
+  GstVideoScale *videoscale = GST_VIDEO_SCALE_CAST (trans);
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstVideoCropMeta *crop;
+  GstVideoInfo *info;
+
+  videoscale->zero_copy_crop = FALSE;
+
+  if (gst_base_transform_is_passthrough (trans)
+      || !videoscale->crop_meta_downstream || !filter->negotiated)
+    goto fallback;
+
+  crop = gst_buffer_get_video_crop_meta (input);
+  if (crop == NULL || !gst_video_scale_is_pure_crop (videoscale, crop))
+    goto fallback;
+
+  GST_CAT_DEBUG_OBJECT (CAT_PERFORMANCE, filter, "zero-copy crop %ux%u at "
+      "%u,%u", crop->width, crop->height, crop->x, crop->y);
+
+  /* shares the memory and copies the crop meta, downstream only shows the
+   * crop rectangle of the full input frame */
+  *outbuf = gst_buffer_copy (input);
+
+  if (gst_buffer_get_video_meta (*outbuf) == NULL) {
+    info = &filter->in_info;
+    gst_buffer_add_video_meta_full (*outbuf, GST_VIDEO_FRAME_FLAG_NONE,
+        GST_VIDEO_INFO_FORMAT (info), GST_VIDEO_INFO_WIDTH (info),
+        GST_VIDEO_INFO_HEIGHT (info), GST_VIDEO_INFO_N_PLANES (info),
+        info->offset, info->stride);
+  }
+  videoscale->zero_copy_crop = TRUE;
+
+  return GST_FLOW_OK;
+
+fallback:
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->prepare_output_buffer (trans,
+      input, outbuf);
+}
+
+static GstFlowReturn
+gst_video_scale_transform (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstVideoScale *videoscale = GST_VIDEO_SCALE_CAST (trans);
+
+  /* zero-copy crop, nothing to scale */
+  if (videoscale->zero_copy_crop)
+    return GST_FLOW_OK;
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->transform (trans, inbuf,
+      outbuf);
+}
+
 #define GET_LINE(frame, line) \
     (gpointer)(((guint8*)(GST_VIDEO_FRAME_PLANE_DATA (frame, 0))) + \
      GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0) * (line))
@@ -1103,6 +1335,9 @@ gst_video_scale_transform_frame (GstVideoFilter * filter,
 
   GST_CAT_DEBUG_OBJECT (CAT_PERFORMANCE, filter, "doing video scaling");
 
+  if (!gst_video_scale_update_crop (videoscale, in_frame))
+    return GST_FLOW_ERROR;
+
   gst_video_converter_frame (videoscale->convert, in_frame, out_frame);
 
   return ret;
@@ -89,11 +89,24 @@ struct _GstVideoScale {
   double envelope;
   gboolean gamma_decode;
   gint n_threads;
+  guint max_in_flight;
 
   GstVideoConverter *convert;
+  GstStructure *options;
 
   gint borders_h;
   gint borders_w;
+
+  /* source rectangle the converter was made for */
+  gint crop_x;
+  gint crop_y;
+  gint crop_w;
+  gint crop_h;
+
+  /* downstream accepts GstVideoCropMeta */
+  gboolean crop_meta_downstream;
+  /* the current output buffer is the input passed on with its crop meta */
+  gboolean zero_copy_crop;
 };
 
 struct _GstVideoScaleClass {
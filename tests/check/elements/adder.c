@@ -29,6 +29,7 @@
 #endif
 
 #include <unistd.h>
+#include <string.h>
 
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstconsistencychecker.h>
@@ -1124,6 +1125,373 @@ GST_START_TEST (test_flush_start_flush_stop)
 GST_END_TEST;
 #endif
 
+static void
+handoff_first_buffer_cb (GstElement * fakesink, GstBuffer * buffer,
+    GstPad * pad, gpointer user_data)
+{
+  GstBuffer **first = user_data;
+
+  if (*first == NULL)
+    *first = gst_buffer_ref (buffer);
+}
+
+/* check that the mix-minus pads output the mix of the other pads */
+GST_START_TEST (test_mix_minus)
+{
+  GstElement *bin, *src[3], *adder, *sink[4];
+  GstBuffer *buffers[4] = { NULL, };
+  GstMapInfo map[4];
+  gdouble volumes[3] = { 0.1, 0.2, 0.4 };
+  gdouble total = 0.7;
+  GstCaps *caps;
+  GstBus *bus;
+  gint i;
+  guint j;
+
+  bin = gst_pipeline_new ("pipeline");
+  bus = gst_element_get_bus (bin);
+  gst_bus_add_signal_watch_full (bus, G_PRIORITY_HIGH);
+
+  g_signal_connect (bus, "message::error", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::warning", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::eos", (GCallback) message_received, bin);
+
+  adder = gst_element_factory_make ("adder", "adder");
+  caps = gst_caps_from_string ("audio/x-raw, format = (string) "
+      GST_AUDIO_NE (F32) ", channels = (int) 1");
+  g_object_set (adder, "mix-minus", TRUE, "caps", caps, NULL);
+  gst_caps_unref (caps);
+  gst_bin_add (GST_BIN (bin), adder);
+
+  for (i = 0; i < 4; i++) {
+    sink[i] = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (sink[i], "signal-handoffs", TRUE, NULL);
+    g_signal_connect (sink[i], "handoff", (GCallback) handoff_first_buffer_cb,
+        &buffers[i]);
+    gst_bin_add (GST_BIN (bin), sink[i]);
+  }
+  fail_unless (gst_element_link (adder, sink[3]));
+
+  for (i = 0; i < 3; i++) {
+    gchar *name;
+
+    src[i] = gst_element_factory_make ("audiotestsrc", NULL);
+    /* a square wave, all samples are +/- volume */
+    g_object_set (src[i], "wave", 1, "volume", volumes[i], "num-buffers", 2,
+        NULL);
+    gst_bin_add (GST_BIN (bin), src[i]);
+    fail_unless (gst_element_link (src[i], adder));
+
+    /* every sink pad got a mix-minus src pad */
+    name = g_strdup_printf ("src_%d", i);
+    fail_unless (gst_element_link_pads (adder, name, sink[i], "sink"));
+    g_free (name);
+  }
+
+  play_and_wait (bin);
+
+  for (i = 0; i < 4; i++) {
+    fail_unless (buffers[i] != NULL);
+    gst_buffer_map (buffers[i], &map[i], GST_MAP_READ);
+    ck_assert_int_eq (map[i].size, map[3].size);
+  }
+
+  for (j = 0; j < map[3].size / sizeof (gfloat); j++) {
+    gfloat mix = ((gfloat *) map[3].data)[j];
+
+    fail_unless (ABS (ABS (mix) - total) < 0.0001, "%f", mix);
+    for (i = 0; i < 3; i++) {
+      gfloat minus = ((gfloat *) map[i].data)[j];
+
+      fail_unless (ABS (minus - mix * (total - volumes[i]) / total) < 0.0001,
+          "pad %d sample %d: %f", i, j, minus);
+    }
+  }
+
+  for (i = 0; i < 4; i++) {
+    gst_buffer_unmap (buffers[i], &map[i]);
+    gst_buffer_unref (buffers[i]);
+  }
+
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+static void
+handoff_append_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  GByteArray *data = user_data;
+  GstMapInfo map;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  g_byte_array_append (data, map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+}
+
+static GByteArray *
+run_mix (guint n_threads, gboolean accumulate, gdouble volume)
+{
+  GstElement *bin, *src, *adder, *sink;
+  GByteArray *data;
+  GstCaps *caps;
+  GstBus *bus;
+  gint i;
+
+  data = g_byte_array_new ();
+
+  bin = gst_pipeline_new ("pipeline");
+  bus = gst_element_get_bus (bin);
+  gst_bus_add_signal_watch_full (bus, G_PRIORITY_HIGH);
+
+  g_signal_connect (bus, "message::error", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::warning", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::eos", (GCallback) message_received, bin);
+
+  adder = gst_element_factory_make ("adder", "adder");
+  caps = gst_caps_from_string ("audio/x-raw, format = (string) "
+      GST_AUDIO_NE (S16) ", channels = (int) 2");
+  g_object_set (adder, "n-threads", n_threads, "accumulate", accumulate,
+      "caps", caps, NULL);
+  gst_caps_unref (caps);
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", (GCallback) handoff_append_cb, data);
+  gst_bin_add_many (GST_BIN (bin), adder, sink, NULL);
+  fail_unless (gst_element_link (adder, sink));
+
+  /* enough inputs and samples to be split over the threads */
+  for (i = 0; i < 8; i++) {
+    GstPad *srcpad, *sinkpad;
+
+    src = gst_element_factory_make ("audiotestsrc", NULL);
+    g_object_set (src, "freq", 100.0 * (i + 1), "volume", volume,
+        "samplesperbuffer", 16384, "num-buffers", 3, NULL);
+    gst_bin_add (GST_BIN (bin), src);
+    fail_unless (gst_element_link (src, adder));
+
+    /* scale half of the inputs on the adder pads */
+    srcpad = gst_element_get_static_pad (src, "src");
+    sinkpad = gst_pad_get_peer (srcpad);
+    if (i & 1)
+      g_object_set (sinkpad, "volume", 0.5, NULL);
+    gst_object_unref (sinkpad);
+    gst_object_unref (srcpad);
+  }
+
+  play_and_wait (bin);
+
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+
+  return data;
+}
+
+static void
+assert_same_data (GByteArray * a, GByteArray * b)
+{
+  fail_unless (a->len > 0);
+  ck_assert_int_eq (a->len, b->len);
+  fail_unless (memcmp (a->data, b->data, a->len) == 0);
+
+  g_byte_array_unref (a);
+  g_byte_array_unref (b);
+}
+
+/* mixing on several threads gives the same result as on one, also when
+ * the inputs are loud enough to clip */
+GST_START_TEST (test_threads)
+{
+  assert_same_data (run_mix (1, FALSE, 0.5), run_mix (4, FALSE, 0.5));
+  assert_same_data (run_mix (1, TRUE, 0.5), run_mix (4, TRUE, 0.5));
+}
+
+GST_END_TEST;
+
+/* mixes one buffer from each of the @n_inputs appsrcs, @inputs holds
+ * @n_samples samples per input */
+static GstBuffer *
+run_mix_samples (const gchar * format, gboolean accumulate,
+    const gint64 * inputs, gint n_inputs, gint n_samples)
+{
+  GstElement *bin, *src, *adder, *sink;
+  const GstAudioFormatInfo *finfo;
+  GstBuffer *buffer, *result = NULL;
+  GstFlowReturn ret;
+  GstMapInfo map;
+  GstCaps *caps;
+  GstBus *bus;
+  gint i, j;
+
+  finfo = gst_audio_format_get_info (gst_audio_format_from_string (format));
+
+  bin = gst_pipeline_new ("pipeline");
+  bus = gst_element_get_bus (bin);
+  gst_bus_add_signal_watch_full (bus, G_PRIORITY_HIGH);
+
+  g_signal_connect (bus, "message::error", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::warning", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::eos", (GCallback) message_received, bin);
+
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING, format,
+      "layout", G_TYPE_STRING, "interleaved", "rate", G_TYPE_INT, 8000,
+      "channels", G_TYPE_INT, 1, NULL);
+
+  adder = gst_element_factory_make ("adder", "adder");
+  g_object_set (adder, "accumulate", accumulate, "caps", caps, NULL);
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", (GCallback) handoff_first_buffer_cb,
+      &result);
+  gst_bin_add_many (GST_BIN (bin), adder, sink, NULL);
+  fail_unless (gst_element_link (adder, sink));
+
+  for (i = 0; i < n_inputs; i++) {
+    src = gst_element_factory_make ("appsrc", NULL);
+    g_object_set (src, "caps", caps, "format", GST_FORMAT_TIME, NULL);
+    gst_bin_add (GST_BIN (bin), src);
+    fail_unless (gst_element_link (src, adder));
+
+    buffer = gst_buffer_new_and_alloc (n_samples * finfo->width / 8);
+    gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < n_samples; j++) {
+      gint64 v = inputs[i * n_samples + j];
+
+      switch (finfo->width) {
+        case 8:
+          ((guint8 *) map.data)[j] = v;
+          break;
+        case 16:
+          ((guint16 *) map.data)[j] = v;
+          break;
+        default:
+          ((guint32 *) map.data)[j] = v;
+          break;
+      }
+    }
+    gst_buffer_unmap (buffer, &map);
+    GST_BUFFER_PTS (buffer) = 0;
+    GST_BUFFER_DURATION (buffer) =
+        gst_util_uint64_scale_int (n_samples, GST_SECOND, 8000);
+
+    g_signal_emit_by_name (src, "push-buffer", buffer, &ret);
+    ck_assert_int_eq (ret, GST_FLOW_OK);
+    gst_buffer_unref (buffer);
+    g_signal_emit_by_name (src, "end-of-stream", &ret);
+  }
+  gst_caps_unref (caps);
+
+  play_and_wait (bin);
+
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+
+  fail_unless (result != NULL);
+  return result;
+}
+
+static gint64
+get_mixed_sample (GstBuffer * buffer, const gchar * format, gint idx)
+{
+  const GstAudioFormatInfo *finfo;
+  GstMapInfo map;
+  gint64 v;
+
+  finfo = gst_audio_format_get_info (gst_audio_format_from_string (format));
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  switch (finfo->width) {
+    case 8:
+      v = GST_AUDIO_FORMAT_INFO_IS_SIGNED (finfo) ?
+          ((gint8 *) map.data)[idx] : ((guint8 *) map.data)[idx];
+      break;
+    case 16:
+      v = GST_AUDIO_FORMAT_INFO_IS_SIGNED (finfo) ?
+          ((gint16 *) map.data)[idx] : ((guint16 *) map.data)[idx];
+      break;
+    default:
+      v = GST_AUDIO_FORMAT_INFO_IS_SIGNED (finfo) ?
+          ((gint32 *) map.data)[idx] : ((guint32 *) map.data)[idx];
+      break;
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  return v;
+}
+
+/* when nothing clips, summing in a wider integer gives the same result */
+GST_START_TEST (test_accumulate)
+{
+  assert_same_data (run_mix (1, FALSE, 0.1), run_mix (1, TRUE, 0.1));
+}
+
+GST_END_TEST;
+
+/* Two loud inputs and one of opposite polarity. Whatever order the inputs
+ * are added in, one of the samples saturates after the first two inputs in
+ * the default mode, while the accumulate mode gives the exact sum. */
+#define LOUD_INPUTS(a) {                \
+  (a), (a), -(a), 0,                    \
+  (a), -(a), (a), 0,                    \
+  -(a), (a), (a), 0                     \
+}
+
+GST_START_TEST (test_accumulate_no_partial_clipping)
+{
+  struct
+  {
+    const gchar *format;
+    gint64 bias;
+    gint64 loud;
+  } formats[] = {
+    {GST_AUDIO_NE (S16), 0, 30000},
+    {GST_AUDIO_NE (S32), 0, 2000000000},
+    {"U8", 0x80, 100},
+  };
+  gint f, i;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    const gchar *format = formats[f].format;
+    gint64 loud = formats[f].loud, bias = formats[f].bias;
+    const gint64 signed_inputs[] = LOUD_INPUTS (loud);
+    gint64 inputs[G_N_ELEMENTS (signed_inputs)];
+    GstBuffer *def, *acc;
+    gboolean clipped = FALSE;
+
+    for (i = 0; i < G_N_ELEMENTS (inputs); i++)
+      inputs[i] = signed_inputs[i] + bias;
+
+    def = run_mix_samples (format, FALSE, inputs, 3, 4);
+    acc = run_mix_samples (format, TRUE, inputs, 3, 4);
+
+    for (i = 0; i < 4; i++) {
+      gint64 exact = signed_inputs[i] + signed_inputs[4 + i] +
+          signed_inputs[8 + i] + bias;
+
+      fail_unless (get_mixed_sample (acc, format, i) == exact,
+          "%s sample %d: %" G_GINT64_FORMAT " != %" G_GINT64_FORMAT, format,
+          i, get_mixed_sample (acc, format, i), exact);
+      if (get_mixed_sample (def, format, i) != exact)
+        clipped = TRUE;
+    }
+
+    /* unsigned samples are added without removing the bias in the default
+     * mode, there is no exact mix to compare with */
+    if (bias == 0)
+      fail_unless (clipped, "%s did not clip in the default mode", format);
+
+    gst_buffer_unref (def);
+    gst_buffer_unref (acc);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 adder_suite (void)
 {
@@ -1143,6 +1511,10 @@ adder_suite (void)
   tcase_add_test (tc_chain, test_duration_is_max);
   tcase_add_test (tc_chain, test_duration_unknown_overrides);
   tcase_add_test (tc_chain, test_loop);
+  tcase_add_test (tc_chain, test_mix_minus);
+  tcase_add_test (tc_chain, test_threads);
+  tcase_add_test (tc_chain, test_accumulate);
+  tcase_add_test (tc_chain, test_accumulate_no_partial_clipping);
   /* This test is racy and occasionally fails in interesting ways
    * https://bugzilla.gnome.org/show_bug.cgi?id=708891
    * It's unlikely that it will ever be fixed for adder, works with audiomixer */
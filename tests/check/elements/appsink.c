@@ -503,6 +503,164 @@ GST_START_TEST (test_pull_with_timeout)
 
 GST_END_TEST;
 
+GST_START_TEST (test_lock_free)
+{
+  GstElement *sink;
+  GstBuffer *buffer;
+  GstSample *s;
+  guint i;
+
+  sink = setup_appsink ();
+  g_object_set (sink, "lock-free", TRUE, NULL);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  for (i = 1; i <= 4; i++) {
+    buffer = gst_buffer_new_and_alloc (i);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* samples come out in order and keep the negotiated caps */
+  for (i = 1; i <= 4; i++) {
+    s = gst_app_sink_try_pull_sample (GST_APP_SINK (sink), 0);
+    fail_unless (s != NULL);
+    fail_unless_equals_int (gst_buffer_get_size (gst_sample_get_buffer (s)),
+        i);
+    fail_unless (gst_sample_get_caps (s) != NULL);
+    gst_sample_unref (s);
+  }
+
+  s = gst_app_sink_try_pull_sample (GST_APP_SINK (sink), 0);
+  fail_unless (s == NULL);
+
+  /* a waiting pull is woken up by a lock-free push */
+  buffer = gst_buffer_new_and_alloc (5);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  s = gst_app_sink_try_pull_sample (GST_APP_SINK (sink), GST_SECOND);
+  fail_unless (s != NULL);
+  gst_sample_unref (s);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  fail_unless (gst_app_sink_is_eos (GST_APP_SINK (sink)));
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsink (sink);
+}
+
+GST_END_TEST;
+
+static gpointer
+pull_sample_thread (gpointer data)
+{
+  return gst_app_sink_pull_sample (GST_APP_SINK (data));
+}
+
+GST_START_TEST (test_lock_free_blocked_pull)
+{
+  GstElement *sink;
+  GstSample *s;
+  GThread *thread;
+  guint i;
+
+  sink = setup_appsink ();
+  g_object_set (sink, "lock-free", TRUE, NULL);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  /* the first buffer prerolls and goes through the locked path */
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_new_and_alloc (1)) ==
+      GST_FLOW_OK);
+  s = gst_app_sink_pull_sample (GST_APP_SINK (sink));
+  fail_unless (s != NULL);
+  gst_sample_unref (s);
+
+  /* a puller blocked on another thread is woken up by lock-free pushes */
+  for (i = 2; i <= 5; i++) {
+    thread = g_thread_new ("pull", pull_sample_thread, sink);
+    g_usleep (G_USEC_PER_SEC / 20);
+
+    fail_unless (gst_pad_push (mysrcpad, gst_buffer_new_and_alloc (i)) ==
+        GST_FLOW_OK);
+
+    s = g_thread_join (thread);
+    fail_unless (s != NULL);
+    fail_unless_equals_int (gst_buffer_get_size (gst_sample_get_buffer (s)),
+        i);
+    gst_sample_unref (s);
+  }
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsink (sink);
+}
+
+GST_END_TEST;
+
+static GstFlowReturn
+new_samples_callback (GstAppSink * appsink, gpointer callback_data)
+{
+  g_atomic_int_inc ((gint *) callback_data);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_pull_samples)
+{
+  GstElement *sink;
+  GstBuffer *buffer;
+  GstSample *samples[4];
+  GstAppSinkCallbacks callbacks = { NULL };
+  gint notified = 0;
+  guint i, n;
+
+  sink = setup_appsink ();
+
+  callbacks.new_samples = new_samples_callback;
+  gst_app_sink_set_callbacks (GST_APP_SINK (sink), &callbacks, &notified,
+      NULL);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  for (i = 1; i <= 6; i++) {
+    buffer = gst_buffer_new_and_alloc (i);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  /* only the first queued buffer is announced */
+  fail_unless_equals_int (notified, 1);
+
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4, 0);
+  fail_unless_equals_int (n, 4);
+  for (i = 0; i < n; i++) {
+    fail_unless_equals_int (gst_buffer_get_size (gst_sample_get_buffer
+            (samples[i])), i + 1);
+    gst_sample_unref (samples[i]);
+  }
+
+  n = gst_app_sink_pull_samples (GST_APP_SINK (sink), samples, 4);
+  fail_unless_equals_int (n, 2);
+  for (i = 0; i < n; i++) {
+    fail_unless_equals_int (gst_buffer_get_size (gst_sample_get_buffer
+            (samples[i])), i + 5);
+    gst_sample_unref (samples[i]);
+  }
+
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4, 0);
+  fail_unless_equals_int (n, 0);
+
+  /* announced again after a pull */
+  buffer = gst_buffer_new_and_alloc (7);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  fail_unless_equals_int (notified, 2);
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4,
+      GST_SECOND);
+  fail_unless_equals_int (n, 1);
+  gst_sample_unref (samples[0]);
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsink (sink);
+}
+
+GST_END_TEST;
+
 static Suite *
 appsink_suite (void)
 {
@@ -520,6 +678,9 @@ appsink_suite (void)
   tcase_add_test (tc_chain, test_buffer_list_signal);
   tcase_add_test (tc_chain, test_segment);
   tcase_add_test (tc_chain, test_pull_with_timeout);
+  tcase_add_test (tc_chain, test_lock_free);
+  tcase_add_test (tc_chain, test_lock_free_blocked_pull);
+  tcase_add_test (tc_chain, test_pull_samples);
 
   return s;
 }
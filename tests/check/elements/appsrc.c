@@ -419,6 +419,66 @@ GST_START_TEST (test_appsrc_caps_in_push_modes)
 
 GST_END_TEST;
 
+static void
+wait_for_buffers (guint n)
+{
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < n)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+}
+
+GST_START_TEST (test_appsrc_lock_free)
+{
+  GstElement *src;
+  GstCaps *caps;
+  GList *l;
+  guint i;
+
+  src = setup_appsrc ();
+  g_object_set (src, "lock-free", TRUE, NULL);
+
+  caps = gst_caps_from_string (SAMPLE_CAPS);
+  gst_app_src_set_caps (GST_APP_SRC (src), caps);
+  gst_caps_unref (caps);
+
+  ASSERT_SET_STATE (src, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  /* give the streaming thread time to block on the empty queue, a lock-free
+   * push has to wake it up */
+  g_usleep (G_USEC_PER_SEC / 10);
+  fail_unless (gst_app_src_push_buffer (GST_APP_SRC (src),
+          gst_buffer_new_and_alloc (1)) == GST_FLOW_OK);
+  wait_for_buffers (1);
+
+  /* a caps change in between sends the following buffers through the
+   * locked queue, all of them still come out in order */
+  for (i = 2; i <= 50; i++) {
+    if (i == 25) {
+      caps = gst_caps_from_string (SAMPLE_CAPS ", n=(int)2");
+      gst_app_src_set_caps (GST_APP_SRC (src), caps);
+      gst_caps_unref (caps);
+    }
+    fail_unless (gst_app_src_push_buffer (GST_APP_SRC (src),
+            gst_buffer_new_and_alloc (i)) == GST_FLOW_OK);
+  }
+  wait_for_buffers (50);
+
+  for (l = buffers, i = 1; l; l = l->next, i++)
+    fail_unless_equals_int (gst_buffer_get_size (GST_BUFFER (l->data)), i);
+
+  caps = gst_pad_get_current_caps (mysinkpad);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_field (gst_caps_get_structure (caps, 0),
+          "n"));
+  gst_caps_unref (caps);
+
+  ASSERT_SET_STATE (src, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsrc (src);
+}
+
+GST_END_TEST;
+
 static Suite *
 appsrc_suite (void)
 {
@@ -428,6 +488,7 @@ appsrc_suite (void)
   tcase_add_test (tc_chain, test_appsrc_non_null_caps);
   tcase_add_test (tc_chain, test_appsrc_set_caps_twice);
   tcase_add_test (tc_chain, test_appsrc_caps_in_push_modes);
+  tcase_add_test (tc_chain, test_appsrc_lock_free);
 
   if (RUNNING_ON_VALGRIND)
     tcase_add_loop_test (tc_chain, test_appsrc_block_deadlock, 0, 5);
@@ -25,6 +25,7 @@
 #endif
 
 #include <gst/check/gstcheck.h>
+#include <gst/allocators/gstfdmemory.h>
 
 static GstPad *mysrcpad;
 
@@ -946,6 +947,139 @@ GST_START_TEST (test_client_kick)
 
 GST_END_TEST;
 
+/* test serving clients in epoll mode */
+GST_START_TEST (test_use_epoll)
+{
+  GstElement *sink;
+  GstCaps *caps;
+  int pfd1[2];
+  int pfd2[2];
+  gint i;
+
+  sink = setup_multifdsink ();
+  g_object_set (sink, "use-epoll", TRUE, NULL);
+
+  fail_if (pipe (pfd1) == -1);
+  fail_if (pipe (pfd2) == -1);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  /* add the clients */
+  g_signal_emit_by_name (sink, "add", pfd1[1]);
+  g_signal_emit_by_name (sink, "add", pfd2[1]);
+
+  for (i = 0; i < 3; i++) {
+    GstBuffer *buffer = gst_new_buffer_big (i);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  for (i = 0; i < 3; i++) {
+    fail_unless_read_big ("client 1", pfd1[0], i);
+    fail_unless_read_big ("client 2", pfd2[0], i);
+  }
+  fail_unless_num_handles (sink, 2);
+
+  /* the remaining client keeps receiving data */
+  g_signal_emit_by_name (sink, "remove", pfd1[1]);
+  fail_unless_num_handles (sink, 1);
+
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer_big (3)) == GST_FLOW_OK);
+  fail_unless_read_big ("client 2", pfd2[0], 3);
+
+  GST_DEBUG ("cleaning up multifdsink");
+  g_signal_emit_by_name (sink, "remove", pfd2[1]);
+
+  fail_unless (close (pfd1[1]) == 0);
+  fail_unless (close (pfd2[1]) == 0);
+  fail_unless_eof ("client 1", pfd1[0]);
+  fail_unless_eof ("client 2", pfd2[0]);
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multifdsink (sink);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+/* test sending fd backed memory with sendfile */
+GST_START_TEST (test_use_sendfile)
+{
+  GstElement *sink;
+  GstAllocator *alloc;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstStructure *stats;
+  guint64 bytes_sent, sendfile_bytes;
+  gchar *tmpfilename;
+  int pfd[2];
+  int fd;
+
+  sink = setup_multifdsink ();
+  g_object_set (sink, "use-sendfile", TRUE, NULL);
+
+  fail_if (pipe (pfd) == -1);
+
+  fd = g_file_open_tmp (NULL, &tmpfilename, NULL);
+  fail_if (fd == -1);
+  fail_unless (write (fd, "deadbeef", 8) == 8);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  g_signal_emit_by_name (sink, "add", pfd[1]);
+
+  /* send the second half of the file */
+  alloc = gst_fd_allocator_new ();
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer, gst_fd_allocator_alloc (alloc, fd, 8,
+          GST_FD_MEMORY_FLAG_DONT_CLOSE));
+  gst_buffer_resize (buffer, 4, 4);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  /* and a buffer with system memory */
+  buffer = gst_buffer_new_and_alloc (4);
+  gst_buffer_fill (buffer, 0, "dead", 4);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  fail_unless_read ("client", pfd[0], 4, "beef");
+  fail_unless_read ("client", pfd[0], 4, "dead");
+  wait_bytes_served (sink, 8);
+
+  /* only the fd backed buffer was sent with sendfile */
+  g_signal_emit_by_name (sink, "get-stats", pfd[1], &stats);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-sent", &bytes_sent));
+  fail_unless (gst_structure_get_uint64 (stats, "sendfile-bytes",
+          &sendfile_bytes));
+  fail_unless_equals_uint64 (bytes_sent, 8);
+#ifdef HAVE_SYS_SENDFILE_H
+  fail_unless_equals_uint64 (sendfile_bytes, 4);
+#endif
+  gst_structure_free (stats);
+
+  GST_DEBUG ("cleaning up multifdsink");
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multifdsink (sink);
+
+  gst_object_unref (alloc);
+  close (fd);
+  unlink (tmpfilename);
+  g_free (tmpfilename);
+  close (pfd[0]);
+  close (pfd[1]);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 /* FIXME: add test simulating chained oggs where:
  * sync-method is burst-on-connect
  * (when multifdsink actually does burst-on-connect based on byte size, not
@@ -970,6 +1104,8 @@ multifdsink_suite (void)
   tcase_add_test (tc_chain, test_burst_client_bytes_with_keyframe);
   tcase_add_test (tc_chain, test_client_next_keyframe);
   tcase_add_test (tc_chain, test_client_kick);
+  tcase_add_test (tc_chain, test_use_epoll);
+  tcase_add_test (tc_chain, test_use_sendfile);
 
   return s;
 }
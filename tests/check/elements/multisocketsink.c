@@ -28,7 +28,7 @@
 #include <gio/gio.h>
 #include <gst/check/gstcheck.h>
 
-static GstPad *mysrcpad;
+static GstPad *mysrcpad, *mysinkpad;
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -36,6 +36,11 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_STATIC_CAPS ("application/x-gst-check")
     );
 
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
 static GstElement *
 setup_multisocketsink (void)
 {
@@ -623,6 +628,185 @@ gst_new_buffer (int i)
 }
 
 
+/* burst 5 buffers to a client with batching enabled, they should be sent
+ * with fewer send calls than buffers */
+GST_START_TEST (test_batch_send)
+{
+  GstElement *sink;
+  GstCaps *caps;
+  GstStructure *stats;
+  GSocket *socket[2];
+  guint64 bytes_sent, send_calls;
+  gchar data[80];
+  gint i;
+
+  sink = setup_multisocketsink ();
+  g_object_set (sink, "bytes-min", 100, NULL);
+  g_object_set (sink, "sync-method", 3, NULL);  /* 3 = burst */
+  g_object_set (sink, "burst-format", GST_FORMAT_BYTES, NULL);
+  g_object_set (sink, "burst-value", (guint64) 80, NULL);
+  g_object_set (sink, "batch-size", 8, NULL);
+
+  fail_unless (setup_handles (&socket[0], &socket[1]));
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  /* push buffers in, 9 * 16 bytes = 144 bytes */
+  for (i = 0; i < 9; i++) {
+    GstBuffer *buffer = gst_new_buffer (i);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  g_signal_emit_by_name (sink, "add", socket[0]);
+  fail_unless_num_handles (sink, 1);
+
+  /* push last buffer to make client fds ready for reading */
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (9)) == GST_FLOW_OK);
+
+  /* the last 5 buffers (5 * 16 = 80 bytes) arrive in order */
+  fail_unless (read_handle_n_bytes_exactly (socket[1], data, 80));
+  for (i = 0; i < 5; i++) {
+    gchar expected[16];
+
+    g_snprintf (expected, 16, "deadbee%08x", i + 5);
+    fail_unless (memcmp (data + i * 16, expected, 16) == 0);
+  }
+  wait_bytes_served (sink, 80);
+
+  g_signal_emit_by_name (sink, "get-stats", socket[0], &stats);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-sent", &bytes_sent));
+  fail_unless (gst_structure_get_uint64 (stats, "send-calls", &send_calls));
+  fail_unless_equals_uint64 (bytes_sent, 80);
+  fail_unless (send_calls > 0 && send_calls < 5,
+      "%" G_GUINT64_FORMAT " send calls for 5 buffers", send_calls);
+  gst_structure_free (stats);
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multisocketsink (sink);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+
+  g_object_unref (socket[0]);
+  g_object_unref (socket[1]);
+}
+
+GST_END_TEST;
+
+/* burst 5 buffers to a UDP client with batching enabled and receive them
+ * with a batching socketsrc, every buffer should arrive as one datagram */
+GST_START_TEST (test_batch_udp_round_trip)
+{
+  GstElement *sink, *src;
+  GstCaps *caps;
+  GstStructure *stats;
+  GSocket *sender, *receiver;
+  GInetAddress *loopback;
+  GSocketAddress *addr, *bound;
+  guint64 bytes_sent, send_calls;
+  GError *err = NULL;
+  GList *l;
+  gint i;
+
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (loopback, 0);
+  receiver = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+  fail_unless (receiver != NULL, "could not create socket: %s",
+      err ? err->message : "");
+  fail_unless (g_socket_bind (receiver, addr, FALSE, &err));
+  bound = g_socket_get_local_address (receiver, &err);
+  fail_unless (bound != NULL);
+  sender = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+  fail_unless (sender != NULL);
+  fail_unless (g_socket_connect (sender, bound, NULL, &err));
+
+  src = gst_check_setup_element ("socketsrc");
+  g_object_set (src, "socket", receiver, "batch-size", 8, NULL);
+  mysinkpad = gst_check_setup_sink_pad (src, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+  ASSERT_SET_STATE (src, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  sink = setup_multisocketsink ();
+  g_object_set (sink, "bytes-min", 100, NULL);
+  g_object_set (sink, "sync-method", 3, NULL);  /* 3 = burst */
+  g_object_set (sink, "burst-format", GST_FORMAT_BYTES, NULL);
+  g_object_set (sink, "burst-value", (guint64) 80, NULL);
+  g_object_set (sink, "batch-size", 8, NULL);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  /* push buffers in, 9 * 16 bytes = 144 bytes */
+  for (i = 0; i < 9; i++) {
+    GstBuffer *buffer = gst_new_buffer (i);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  g_signal_emit_by_name (sink, "add", sender);
+  fail_unless_num_handles (sink, 1);
+
+  /* push last buffer to make client fds ready for reading */
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (9)) == GST_FLOW_OK);
+  wait_bytes_served (sink, 80);
+
+  g_signal_emit_by_name (sink, "get-stats", sender, &stats);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-sent", &bytes_sent));
+  fail_unless (gst_structure_get_uint64 (stats, "send-calls", &send_calls));
+  fail_unless_equals_uint64 (bytes_sent, 80);
+#if GLIB_CHECK_VERSION (2, 44, 0)
+  fail_unless (send_calls > 0 && send_calls < 5,
+      "%" G_GUINT64_FORMAT " send calls for 5 buffers", send_calls);
+#endif
+  gst_structure_free (stats);
+
+  /* the last 5 buffers arrive in order, one per datagram */
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 5)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  for (i = 0, l = buffers; l != NULL; i++, l = l->next) {
+    GstMapInfo info;
+    gchar expected[16];
+
+    fail_unless (i < 5, "received more than 5 datagrams");
+    g_snprintf (expected, 16, "deadbee%08x", i + 5);
+    gst_buffer_map (l->data, &info, GST_MAP_READ);
+    fail_unless_equals_int (info.size, 16);
+    fail_unless (memcmp (info.data, expected, 16) == 0);
+    gst_buffer_unmap (l->data, &info);
+  }
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multisocketsink (sink);
+
+  ASSERT_SET_STATE (src, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  gst_check_drop_buffers ();
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_sink_pad (src);
+  gst_check_teardown_element (src);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+
+  g_object_unref (sender);
+  g_object_unref (receiver);
+  g_object_unref (bound);
+  g_object_unref (addr);
+  g_object_unref (loopback);
+}
+
+GST_END_TEST;
+
 /* keep 100 bytes and burst 80 bytes to clients */
 GST_START_TEST (test_burst_client_bytes)
 {
@@ -988,6 +1172,8 @@ multisocketsink_suite (void)
   tcase_add_test (tc_chain, test_burst_client_bytes_keyframe);
   tcase_add_test (tc_chain, test_burst_client_bytes_with_keyframe);
   tcase_add_test (tc_chain, test_client_next_keyframe);
+  tcase_add_test (tc_chain, test_batch_send);
+  tcase_add_test (tc_chain, test_batch_udp_round_trip);
 
   return s;
 }
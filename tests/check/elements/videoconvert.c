@@ -28,6 +28,7 @@
 #endif
 
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 #include <gst/video/video.h>
 
 static guint
@@ -117,6 +118,46 @@ GST_START_TEST (test_template_formats)
 
 GST_END_TEST;
 
+GST_START_TEST (test_max_in_flight)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstVideoInfo info;
+  guint i;
+
+  h = gst_harness_new ("videoconvert");
+  g_object_set (h->element, "max-in-flight", 3, NULL);
+  gst_harness_set_caps_str (h,
+      "video/x-raw,format=I420,width=64,height=48,framerate=30/1",
+      "video/x-raw,format=RGBx,width=64,height=48,framerate=30/1");
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, 64, 48);
+
+  for (i = 0; i < 10; i++) {
+    buf = gst_harness_create_buffer (h, GST_VIDEO_INFO_SIZE (&info));
+    GST_BUFFER_PTS (buf) = gst_util_uint64_scale (i, GST_SECOND, 30);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  /* no more than two frames are held back */
+  fail_unless (gst_harness_buffers_received (h) >= 8);
+
+  /* and they are all pushed before EOS, in order */
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_received (h), 10);
+
+  for (i = 0; i < 10; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf),
+        gst_util_uint64_scale (i, GST_SECOND, 30));
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 videoconvert_suite (void)
 {
@@ -126,6 +167,7 @@ videoconvert_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_template_formats);
+  tcase_add_test (tc_chain, test_max_in_flight);
 
   return s;
 }
@@ -24,6 +24,7 @@
 #include <gst/base/gstbasesink.h>
 
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 #include <string.h>
 
 /* kids, don't do this at home, skipping checks is *BAD* */
@@ -989,6 +990,99 @@ GST_START_TEST (test_basetransform_negotiation)
 
 GST_END_TEST;
 
+#define CROP_IN_CAPS "video/x-raw,format=GRAY8,width=64,height=48," \
+    "framerate=30/1,pixel-aspect-ratio=1/1"
+#define CROP_OUT_CAPS "video/x-raw,format=GRAY8,width=32,height=24," \
+    "framerate=30/1,pixel-aspect-ratio=1/1"
+
+/* 64x48 GRAY8 frame, 255 inside the 32x24 crop rectangle at 16,12 and 0
+ * outside of it */
+static GstBuffer *
+create_crop_buffer (void)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  GstVideoCropMeta *crop;
+  gint i, j;
+
+  buf = gst_buffer_new_and_alloc (64 * 48);
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  for (i = 0; i < 48; i++) {
+    for (j = 0; j < 64; j++)
+      map.data[i * 64 + j] = (i >= 12 && i < 36 && j >= 16 && j < 48) ? 255 : 0;
+  }
+  gst_buffer_unmap (buf, &map);
+
+  crop = gst_buffer_add_video_crop_meta (buf);
+  crop->x = 16;
+  crop->y = 12;
+  crop->width = 32;
+  crop->height = 24;
+
+  return buf;
+}
+
+GST_START_TEST (test_crop_meta)
+{
+  GstHarness *h;
+  GstBuffer *inbuf, *outbuf;
+  GstVideoCropMeta *crop;
+  GstVideoMeta *vmeta;
+  GstMapInfo map;
+  gint i;
+
+  /* downstream handles the crop meta, the input memory is passed on */
+  h = gst_harness_new ("videoscale");
+  gst_harness_add_propose_allocation_meta (h, GST_VIDEO_META_API_TYPE, NULL);
+  gst_harness_add_propose_allocation_meta (h, GST_VIDEO_CROP_META_API_TYPE,
+      NULL);
+  gst_harness_set_caps_str (h, CROP_IN_CAPS, CROP_OUT_CAPS);
+
+  inbuf = create_crop_buffer ();
+  fail_unless_equals_int (gst_harness_push (h, gst_buffer_ref (inbuf)),
+      GST_FLOW_OK);
+  outbuf = gst_harness_pull (h);
+  fail_unless (outbuf != NULL);
+
+  fail_unless (gst_buffer_peek_memory (outbuf, 0) ==
+      gst_buffer_peek_memory (inbuf, 0));
+  crop = gst_buffer_get_video_crop_meta (outbuf);
+  fail_unless (crop != NULL);
+  fail_unless_equals_int (crop->x, 16);
+  fail_unless_equals_int (crop->y, 12);
+  fail_unless_equals_int (crop->width, 32);
+  fail_unless_equals_int (crop->height, 24);
+  vmeta = gst_buffer_get_video_meta (outbuf);
+  fail_unless (vmeta != NULL);
+  fail_unless_equals_int (vmeta->width, 64);
+  fail_unless_equals_int (vmeta->height, 48);
+
+  gst_buffer_unref (outbuf);
+  gst_buffer_unref (inbuf);
+  gst_harness_teardown (h);
+
+  /* downstream does not know the crop meta, scale from the crop rectangle */
+  h = gst_harness_new ("videoscale");
+  gst_harness_set_caps_str (h, CROP_IN_CAPS, CROP_OUT_CAPS);
+
+  fail_unless_equals_int (gst_harness_push (h, create_crop_buffer ()),
+      GST_FLOW_OK);
+  outbuf = gst_harness_pull (h);
+  fail_unless (outbuf != NULL);
+
+  fail_unless (gst_buffer_get_video_crop_meta (outbuf) == NULL);
+  fail_unless (gst_buffer_map (outbuf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, 32 * 24);
+  for (i = 0; i < 32 * 24; i++)
+    fail_unless_equals_int (map.data[i], 255);
+  gst_buffer_unmap (outbuf, &map);
+
+  gst_buffer_unref (outbuf);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 #endif /* !defined(VSCALE_TEST_GROUP) */
 
 static Suite *
@@ -1010,6 +1104,7 @@ videoscale_suite (void)
   tcase_add_test (tc_chain, test_reverse_negotiation);
 #endif
   tcase_add_test (tc_chain, test_basetransform_negotiation);
+  tcase_add_test (tc_chain, test_crop_meta);
 #elif VSCALE_TEST_GROUP == 1
   tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_0);
   tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_1);
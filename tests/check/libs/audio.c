@@ -705,6 +705,583 @@ GST_START_TEST (test_fill_silence)
 
 GST_END_TEST;
 
+GST_START_TEST (test_resampler_shared_tables)
+{
+  GstAudioResamplerFilterMode modes[] = {
+    GST_AUDIO_RESAMPLER_FILTER_MODE_FULL,
+    GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+  };
+  GstAudioResamplerFlags flags[] = {
+    GST_AUDIO_RESAMPLER_FLAG_NONE,
+    GST_AUDIO_RESAMPLER_FLAG_VARIABLE_RATE,
+  };
+  gint16 in[1024], out[3][1024];
+  gint i, m, f;
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = (i * 997) % 32768 - 16384;
+
+  for (m = 0; m < G_N_ELEMENTS (modes); m++) {
+    for (f = 0; f < G_N_ELEMENTS (flags); f++) {
+      GstAudioResampler *resampler[3];
+      GstStructure *options;
+      gsize out_frames = 0;
+
+      options = gst_structure_new_empty ("options");
+      gst_audio_resampler_options_set_quality
+          (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+          GST_AUDIO_RESAMPLER_QUALITY_DEFAULT, 48000, 44100, options);
+      gst_structure_set (options, GST_AUDIO_RESAMPLER_OPT_FILTER_MODE,
+          GST_TYPE_AUDIO_RESAMPLER_FILTER_MODE, modes[m], NULL);
+
+      /* the second resampler uses the tables of the first one, the third
+       * one the tables that are left after freeing the first one */
+      for (i = 0; i < 3; i++) {
+        gpointer ins[1] = { in }, outs[1] = { out[i] };
+
+        resampler[i] = gst_audio_resampler_new
+            (GST_AUDIO_RESAMPLER_METHOD_KAISER, flags[f],
+            GST_AUDIO_FORMAT_S16, 1, 48000, 44100, options);
+        fail_unless (resampler[i] != NULL);
+
+        if (i == 0)
+          out_frames = gst_audio_resampler_get_out_frames (resampler[i],
+              G_N_ELEMENTS (in));
+        fail_unless_equals_int (gst_audio_resampler_get_out_frames
+            (resampler[i], G_N_ELEMENTS (in)), out_frames);
+        gst_audio_resampler_resample (resampler[i], ins, G_N_ELEMENTS (in),
+            outs, out_frames);
+
+        if (i > 0)
+          fail_unless (memcmp (out[0], out[i], out_frames * 2) == 0);
+        if (i == 1)
+          gst_audio_resampler_free (resampler[0]);
+      }
+      gst_audio_resampler_free (resampler[1]);
+      gst_audio_resampler_free (resampler[2]);
+      gst_structure_free (options);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_resampler_threads)
+{
+  GstAudioResamplerFlags flags[] = {
+    GST_AUDIO_RESAMPLER_FLAG_NONE,
+    GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_IN |
+        GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_OUT,
+  };
+  const gint channels = 7, in_frames = 512;
+  gint16 *in, *out[2];
+  gint i, c, f, t;
+
+  in = g_new (gint16, channels * in_frames);
+  for (i = 0; i < channels * in_frames; i++)
+    in[i] = (i * 997) % 32768 - 16384;
+  out[0] = g_new0 (gint16, channels * in_frames);
+  out[1] = g_new0 (gint16, channels * in_frames);
+
+  for (f = 0; f < G_N_ELEMENTS (flags); f++) {
+    gsize out_frames = 0;
+
+    /* 1 thread and 3 threads for 7 channels must give the same result */
+    for (t = 0; t < 2; t++) {
+      GstAudioResampler *resampler;
+      GstStructure *options;
+      gpointer ins[7], outs[7];
+      gint round;
+
+      options = gst_structure_new_empty ("options");
+      gst_audio_resampler_options_set_quality
+          (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+          GST_AUDIO_RESAMPLER_QUALITY_DEFAULT, 48000, 44100, options);
+      gst_structure_set (options, GST_AUDIO_RESAMPLER_OPT_THREADS,
+          G_TYPE_UINT, t == 0 ? 1 : 3, NULL);
+
+      resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+          flags[f], GST_AUDIO_FORMAT_S16, channels, 48000, 44100, options);
+      fail_unless (resampler != NULL);
+      gst_structure_free (options);
+
+      for (c = 0; c < channels; c++) {
+        if (flags[f] == GST_AUDIO_RESAMPLER_FLAG_NONE) {
+          ins[c] = in;
+          outs[c] = out[t];
+        } else {
+          ins[c] = in + c * in_frames;
+          outs[c] = out[t] + c * (in_frames / 2);
+        }
+      }
+
+      /* a couple of rounds to also cover the sample history */
+      for (round = 0; round < 2; round++) {
+        out_frames = gst_audio_resampler_get_out_frames (resampler,
+            in_frames / 2);
+        gst_audio_resampler_resample (resampler, ins, in_frames / 2, outs,
+            out_frames);
+      }
+      gst_audio_resampler_free (resampler);
+    }
+    fail_unless (memcmp (out[0], out[1],
+            channels * in_frames * sizeof (gint16)) == 0);
+  }
+
+  g_free (in);
+  g_free (out[0]);
+  g_free (out[1]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_converter_fuse_stages)
+{
+  struct
+  {
+    GstAudioFormat in_format;
+    gint in_channels, in_rate;
+    GstAudioFormat out_format;
+    gint out_channels, out_rate;
+    GstAudioDitherMethod dither;
+  } conversions[] = {
+    {GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_FORMAT_F32, 1, 44100,
+        GST_AUDIO_DITHER_NONE},
+    {GST_AUDIO_FORMAT_S16, 6, 48000, GST_AUDIO_FORMAT_F32, 2, 48000,
+        GST_AUDIO_DITHER_NONE},
+    {GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_FORMAT_S16, 1, 44100,
+        GST_AUDIO_DITHER_NONE},
+    {GST_AUDIO_FORMAT_U8, 1, 44100, GST_AUDIO_FORMAT_S24, 2, 44100,
+        GST_AUDIO_DITHER_NONE},
+    {GST_AUDIO_FORMAT_S32, 2, 44100, GST_AUDIO_FORMAT_F64, 2, 44100,
+        GST_AUDIO_DITHER_NONE},
+    {GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_FORMAT_S16, 2, 48000,
+        GST_AUDIO_DITHER_TPDF},
+    {GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_FORMAT_S16, 2, 48000,
+        GST_AUDIO_DITHER_TPDF_HF},
+  };
+  const gint in_frames = 1001;
+  gint c;
+
+  for (c = 0; c < G_N_ELEMENTS (conversions); c++) {
+    GstAudioInfo in_info, out_info;
+    GstAudioConverter *convert[2];
+    guint8 *in, *out[2];
+    gint i, round;
+
+    gst_audio_info_set_format (&in_info, conversions[c].in_format,
+        conversions[c].in_rate, conversions[c].in_channels, NULL);
+    gst_audio_info_set_format (&out_info, conversions[c].out_format,
+        conversions[c].out_rate, conversions[c].out_channels, NULL);
+
+    in = g_malloc (in_frames * in_info.bpf);
+    if (conversions[c].in_format == GST_AUDIO_FORMAT_F32) {
+      for (i = 0; i < in_frames * in_info.channels; i++)
+        ((gfloat *) in)[i] = ((i * 997) % 2000 - 1000) / 1000.0;
+    } else {
+      for (i = 0; i < in_frames * in_info.bpf; i++)
+        in[i] = i * 997;
+    }
+    out[0] = g_malloc0 (2 * in_frames * out_info.bpf);
+    out[1] = g_malloc0 (2 * in_frames * out_info.bpf);
+
+    /* converting in one pass per stage and in one fused pass must give the
+     * same result */
+    for (i = 0; i < 2; i++) {
+      convert[i] = gst_audio_converter_new (0, &in_info, &out_info,
+          gst_structure_new ("options", GST_AUDIO_CONVERTER_OPT_FUSE_STAGES,
+              G_TYPE_BOOLEAN, i == 1, GST_AUDIO_CONVERTER_OPT_DITHER_METHOD,
+              GST_TYPE_AUDIO_DITHER_METHOD, conversions[c].dither, NULL));
+      fail_unless (convert[i] != NULL);
+    }
+
+    /* the last round converts silence */
+    for (round = 0; round < 3; round++) {
+      gsize out_frames;
+
+      out_frames = gst_audio_converter_get_out_frames (convert[0], in_frames);
+      fail_unless (out_frames <= 2 * in_frames);
+
+      for (i = 0; i < 2; i++) {
+        gpointer ins[1] = { in };
+        gpointer outs[1] = { out[i] };
+
+        fail_unless_equals_int (gst_audio_converter_get_out_frames (convert[i],
+                in_frames), out_frames);
+        fail_unless (gst_audio_converter_samples (convert[i], 0,
+                round < 2 ? ins : NULL, in_frames, outs, out_frames));
+      }
+      fail_unless (memcmp (out[0], out[1], out_frames * out_info.bpf) == 0);
+    }
+
+    gst_audio_converter_free (convert[0]);
+    gst_audio_converter_free (convert[1]);
+    g_free (in);
+    g_free (out[0]);
+    g_free (out[1]);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_channel_mixer_formats)
+{
+#define S (1.0 / G_SQRT2)
+  /* the matrices for the default positions before normalization, indexed
+   * [in][out] */
+  static const struct
+  {
+    gint in_channels, out_channels;
+    gdouble matrix[8][6];
+  } layouts[] = {
+    {1, 2, {{1, 1}}},
+    {2, 1, {{0.5}, {0.5}}},
+    /* FL FR FC LFE RL RR -> FL FR */
+    {6, 2, {{1, 0}, {0, 1}, {S, S}, {1, 1}, {0.5, 0}, {0, 0.5}}},
+    /* FL FR FC LFE RL RR SL SR -> FL FR */
+    {8, 2, {{1, 0}, {0, 1}, {S, S}, {1, 1}, {0.5, 0}, {0, 0.5}, {S, 0},
+            {0, S}}},
+    /* FL FR -> FL FR FC LFE RL RR */
+    {2, 6, {{1, 0, S, 1, 0.5, 0}, {0, 1, S, 1, 0, 0.5}}},
+    /* FL FR FC LFE RL RR -> MONO */
+    {6, 1, {{1}, {1}, {S}, {1}, {0.5}, {0.5}}},
+    /* FL FR RL RR -> FL FR FC LFE RL RR */
+    {4, 6, {{1, 0, S, 1, 0, 0}, {0, 1, S, 1, 0, 0}, {0, 0, 0, S, 1, 0},
+            {0, 0, 0, S, 0, 1}}},
+  };
+#undef S
+  GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_S32, GST_AUDIO_FORMAT_F32,
+    GST_AUDIO_FORMAT_F64
+  };
+  const gint frames = 13;
+  gint l, f, i, j, n;
+
+  /* all formats use different mixing functions and must agree with a plain
+   * dense matrix product within the precision of the format */
+  for (l = 0; l < G_N_ELEMENTS (layouts); l++) {
+    GstAudioInfo in_info, out_info;
+    GstAudioChannelMixer *mix;
+    gint in_channels = layouts[l].in_channels;
+    gint out_channels = layouts[l].out_channels;
+    gint in_samples = frames * in_channels;
+    gint out_samples = frames * out_channels;
+    gdouble in[8 * 13], expected[8 * 13], top = 0;
+    gpointer ins[1], outs[1];
+
+    gst_audio_info_set_format (&in_info, GST_AUDIO_FORMAT_F64, 48000,
+        in_channels, NULL);
+    gst_audio_info_set_format (&out_info, GST_AUDIO_FORMAT_F64, 48000,
+        out_channels, NULL);
+
+    for (i = 0; i < in_samples; i++)
+      in[i] = ((i * 997) % 1000 - 500) / 1000.0;
+
+    /* the mixer scales the matrix so that the largest sum of the
+     * coefficients of an output channel is 1 */
+    for (j = 0; j < out_channels; j++) {
+      gdouble sum = 0;
+
+      for (i = 0; i < in_channels; i++)
+        sum += ABS (layouts[l].matrix[i][j]);
+      top = MAX (top, sum);
+    }
+
+    for (n = 0; n < frames; n++) {
+      for (j = 0; j < out_channels; j++) {
+        gdouble res = 0;
+
+        for (i = 0; i < in_channels; i++)
+          res += in[n * in_channels + i] * layouts[l].matrix[i][j] / top;
+        expected[n * out_channels + j] = res;
+      }
+    }
+
+    for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+      gint64 in_buf[8 * 13], out_buf[8 * 13];
+      gdouble tolerance;
+
+      for (i = 0; i < in_samples; i++) {
+        if (formats[f] == GST_AUDIO_FORMAT_S16)
+          ((gint16 *) in_buf)[i] = in[i] * 32768;
+        else if (formats[f] == GST_AUDIO_FORMAT_S32)
+          ((gint32 *) in_buf)[i] = in[i] * 2147483648.0;
+        else if (formats[f] == GST_AUDIO_FORMAT_F32)
+          ((gfloat *) in_buf)[i] = in[i];
+        else
+          ((gdouble *) in_buf)[i] = in[i];
+      }
+
+      mix = gst_audio_channel_mixer_new (0, formats[f], in_info.channels,
+          in_info.position, out_info.channels, out_info.position);
+      fail_unless (mix != NULL);
+      ins[0] = in_buf;
+      outs[0] = out_buf;
+      gst_audio_channel_mixer_samples (mix, ins, outs, frames);
+      gst_audio_channel_mixer_free (mix);
+
+      for (i = 0; i < out_samples; i++) {
+        gdouble res;
+
+        if (formats[f] == GST_AUDIO_FORMAT_S16) {
+          res = ((gint16 *) out_buf)[i] / 32768.0;
+          tolerance = 0.01;
+        } else if (formats[f] == GST_AUDIO_FORMAT_S32) {
+          res = ((gint32 *) out_buf)[i] / 2147483648.0;
+          tolerance = 0.01;
+        } else if (formats[f] == GST_AUDIO_FORMAT_F32) {
+          res = ((gfloat *) out_buf)[i];
+          tolerance = 1e-5;
+        } else {
+          res = ((gdouble *) out_buf)[i];
+          tolerance = 1e-5;
+        }
+
+        fail_unless (ABS (res - expected[i]) < tolerance,
+            "%d -> %d channels, format %s, sample %d: %f != %f",
+            in_channels, out_channels,
+            gst_audio_format_to_string (formats[f]), i, res, expected[i]);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_quantize_noise_shaping)
+{
+  const gint channels = 3, frames = 200;
+  const guint quantizer = 1 << 8;
+  gint32 in[3 * 200], out[3 * 200], mono_in[200], mono_out[200];
+  gint dither, ns, i, c;
+
+  for (i = 0; i < channels * frames; i++)
+    in[i] = (gint32) ((i * 2654435761u) >> 2) - (1 << 29);
+
+  for (dither = GST_AUDIO_DITHER_NONE; dither <= GST_AUDIO_DITHER_TPDF_HF;
+      dither++) {
+    for (ns = GST_AUDIO_NOISE_SHAPING_NONE; ns <= GST_AUDIO_NOISE_SHAPING_HIGH;
+        ns++) {
+      GstAudioQuantize *quant;
+      gpointer ins[1], outs[1];
+      gint64 sum[3] = { 0, 0, 0 };
+
+      quant = gst_audio_quantize_new (dither, ns, 0, GST_AUDIO_FORMAT_S32,
+          channels, quantizer);
+      fail_unless (quant != NULL);
+      ins[0] = in;
+      outs[0] = out;
+      /* in two parts to check that the history is kept */
+      gst_audio_quantize_samples (quant, ins, outs, 77);
+      ins[0] = in + 77 * channels;
+      outs[0] = out + 77 * channels;
+      gst_audio_quantize_samples (quant, ins, outs, frames - 77);
+      gst_audio_quantize_free (quant);
+
+      for (i = 0; i < channels * frames; i++) {
+        fail_unless ((out[i] & (quantizer - 1)) == 0,
+            "dither %d, ns %d: sample %d not quantized", dither, ns, i);
+        sum[i % channels] += out[i] - in[i];
+      }
+
+      /* error feedback keeps the accumulated error of each channel within
+       * a few quantization steps */
+      if (ns == GST_AUDIO_NOISE_SHAPING_ERROR_FEEDBACK) {
+        for (c = 0; c < channels; c++)
+          fail_unless (ABS (sum[c]) <= 4 * quantizer,
+              "dither %d: channel %d drifted by %" G_GINT64_FORMAT, dither, c,
+              sum[c]);
+      }
+
+      if (dither != GST_AUDIO_DITHER_NONE)
+        continue;
+
+      /* without dither each channel is quantized as if it was on its own */
+      for (c = 0; c < channels; c++) {
+        for (i = 0; i < frames; i++)
+          mono_in[i] = in[i * channels + c];
+
+        quant = gst_audio_quantize_new (dither, ns, 0, GST_AUDIO_FORMAT_S32,
+            1, quantizer);
+        fail_unless (quant != NULL);
+        ins[0] = mono_in;
+        outs[0] = mono_out;
+        gst_audio_quantize_samples (quant, ins, outs, frames);
+        gst_audio_quantize_free (quant);
+
+        for (i = 0; i < frames; i++) {
+          fail_unless_equals_int (mono_out[i], out[i * channels + c]);
+          if (ns == GST_AUDIO_NOISE_SHAPING_NONE)
+            fail_unless_equals_int (mono_out[i],
+                (mono_in[i] + (gint32) quantizer / 2) & ~(quantizer - 1));
+        }
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+typedef GstAudioRingBuffer TestRingBuffer;
+typedef GstAudioRingBufferClass TestRingBufferClass;
+
+G_DEFINE_TYPE (TestRingBuffer, test_ring_buffer, GST_TYPE_AUDIO_RING_BUFFER);
+
+static gboolean
+test_ring_buffer_open_device (GstAudioRingBuffer * buf)
+{
+  return TRUE;
+}
+
+static gboolean
+test_ring_buffer_acquire (GstAudioRingBuffer * buf,
+    GstAudioRingBufferSpec * spec)
+{
+  buf->size = spec->segtotal * spec->segsize;
+  buf->memory = g_malloc0 (buf->size);
+
+  return TRUE;
+}
+
+static gboolean
+test_ring_buffer_release (GstAudioRingBuffer * buf)
+{
+  g_free (buf->memory);
+  buf->memory = NULL;
+
+  return TRUE;
+}
+
+static gboolean
+test_ring_buffer_state (GstAudioRingBuffer * buf)
+{
+  return TRUE;
+}
+
+static void
+test_ring_buffer_class_init (TestRingBufferClass * klass)
+{
+  klass->open_device = test_ring_buffer_open_device;
+  klass->acquire = test_ring_buffer_acquire;
+  klass->release = test_ring_buffer_release;
+  klass->start = test_ring_buffer_state;
+  klass->pause = test_ring_buffer_state;
+  klass->resume = test_ring_buffer_state;
+  klass->stop = test_ring_buffer_state;
+}
+
+static void
+test_ring_buffer_init (TestRingBuffer * buf)
+{
+}
+
+static gint device_running;
+static gint device_hold;
+
+/* plays like a device: consumes one segment every millisecond */
+static gpointer
+device_thread_func (gpointer data)
+{
+  GstAudioRingBuffer *buf = data;
+
+  while (g_atomic_int_get (&device_running)) {
+    gint segment, len;
+    guint8 *readptr;
+
+    if (!g_atomic_int_get (&device_hold)
+        && gst_audio_ring_buffer_prepare_read (buf, &segment, &readptr,
+            &len)) {
+      gst_audio_ring_buffer_clear (buf, segment);
+      gst_audio_ring_buffer_advance (buf, 1);
+    }
+    g_usleep (1000);
+  }
+
+  return NULL;
+}
+
+typedef struct
+{
+  GstAudioRingBuffer *buf;
+  guint64 sample;
+  guint8 *data;
+  gint len;
+  gint written;
+} CommitData;
+
+static gpointer
+commit_thread_func (gpointer data)
+{
+  CommitData *c = data;
+  gint accum = 0;
+
+  c->written = gst_audio_ring_buffer_commit (c->buf, &c->sample, c->data,
+      c->len, c->len, &accum);
+
+  return NULL;
+}
+
+GST_START_TEST (test_ring_buffer_wakeup)
+{
+  GstAudioRingBuffer *buf;
+  GstCaps *caps;
+  GThread *device, *writer;
+  CommitData c;
+  gint sps, segtotal;
+
+  buf = g_object_new (test_ring_buffer_get_type (), NULL);
+
+  caps = gst_caps_from_string ("audio/x-raw, format=S16LE, "
+      "layout=interleaved, rate=8000, channels=1");
+  buf->spec.latency_time = 10000;
+  buf->spec.buffer_time = 40000;
+  fail_unless (gst_audio_ring_buffer_parse_caps (&buf->spec, caps));
+  gst_caps_unref (caps);
+
+  fail_unless (gst_audio_ring_buffer_open_device (buf));
+  fail_unless (gst_audio_ring_buffer_acquire (buf, &buf->spec));
+  gst_audio_ring_buffer_set_flushing (buf, FALSE);
+  gst_audio_ring_buffer_may_start (buf, TRUE);
+
+  sps = buf->samples_per_seg;
+  segtotal = buf->spec.segtotal;
+  fail_unless_equals_int (sps, 80);
+  fail_unless_equals_int (segtotal, 4);
+
+  g_atomic_int_set (&device_running, 1);
+  g_atomic_int_set (&device_hold, 0);
+  device = g_thread_new ("device", device_thread_func, buf);
+
+  /* five times the size of the ringbuffer, the writer has to be woken up by
+   * the device thread to complete this */
+  c.buf = buf;
+  c.sample = 0;
+  c.len = 5 * segtotal * sps;
+  c.data = g_malloc0 (c.len * 2);
+  commit_thread_func (&c);
+  fail_unless_equals_int (c.written, c.len);
+  fail_unless (g_atomic_int_get (&buf->segdone) >= 4 * segtotal);
+
+  /* now block the writer on a full ringbuffer and check that flushing wakes
+   * it up */
+  g_atomic_int_set (&device_hold, 1);
+  writer = g_thread_new ("writer", commit_thread_func, &c);
+  g_usleep (G_USEC_PER_SEC / 10);
+  gst_audio_ring_buffer_set_flushing (buf, TRUE);
+  g_thread_join (writer);
+  fail_unless (c.written < c.len);
+
+  g_atomic_int_set (&device_running, 0);
+  g_thread_join (device);
+
+  g_free (c.data);
+  fail_unless (gst_audio_ring_buffer_release (buf));
+  fail_unless (gst_audio_ring_buffer_close_device (buf));
+  gst_object_unref (buf);
+}
+
+GST_END_TEST;
+
 static Suite *
 audio_suite (void)
 {
@@ -732,6 +1309,12 @@ audio_suite (void)
   tcase_add_test (tc_chain, test_audio_format_s8);
   tcase_add_test (tc_chain, test_audio_format_u8);
   tcase_add_test (tc_chain, test_fill_silence);
+  tcase_add_test (tc_chain, test_resampler_shared_tables);
+  tcase_add_test (tc_chain, test_resampler_threads);
+  tcase_add_test (tc_chain, test_converter_fuse_stages);
+  tcase_add_test (tc_chain, test_channel_mixer_formats);
+  tcase_add_test (tc_chain, test_quantize_noise_shaping);
+  tcase_add_test (tc_chain, test_ring_buffer_wakeup);
 
   return s;
 }
@@ -0,0 +1,303 @@
+/* GStreamer
+ *
+ * unit tests for GstAudioBaseSink
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+#include <gst/audio/audio.h>
+
+#define RATE 8000
+#define SAMPLES_PER_BUFFER 400
+
+/* rate of the master clock relative to the internal clock of the sink */
+#define CLOCK_RATE_NUM 21
+#define CLOCK_RATE_DENOM 20
+
+#define CAPS_STRING \
+    "audio/x-raw, format = (string) " GST_AUDIO_NE (F32) ", " \
+    "layout = (string) interleaved, rate = (int) 8000, channels = (int) 1"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS (CAPS_STRING));
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS (CAPS_STRING));
+
+/* audio sink that records all samples written to the device and consumes
+ * them in real time */
+#define GST_TYPE_TEST_AUDIO_SINK (gst_test_audio_sink_get_type ())
+#define GST_TEST_AUDIO_SINK(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_TEST_AUDIO_SINK, \
+    GstTestAudioSink))
+
+typedef struct _GstTestAudioSink GstTestAudioSink;
+typedef struct _GstTestAudioSinkClass GstTestAudioSinkClass;
+
+struct _GstTestAudioSink
+{
+  GstAudioSink parent;
+
+  GMutex lock;
+  GArray *written;
+};
+
+struct _GstTestAudioSinkClass
+{
+  GstAudioSinkClass parent_class;
+};
+
+GType gst_test_audio_sink_get_type (void);
+
+G_DEFINE_TYPE (GstTestAudioSink, gst_test_audio_sink, GST_TYPE_AUDIO_SINK);
+
+static gboolean
+gst_test_audio_sink_open (GstAudioSink * sink)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_audio_sink_prepare (GstAudioSink * sink, GstAudioRingBufferSpec * spec)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_audio_sink_unprepare (GstAudioSink * sink)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_audio_sink_close (GstAudioSink * sink)
+{
+  return TRUE;
+}
+
+static gint
+gst_test_audio_sink_write (GstAudioSink * sink, gpointer data, guint length)
+{
+  GstTestAudioSink *self = GST_TEST_AUDIO_SINK (sink);
+  guint n_samples = length / sizeof (gfloat);
+
+  g_mutex_lock (&self->lock);
+  g_array_append_vals (self->written, data, n_samples);
+  g_mutex_unlock (&self->lock);
+
+  g_usleep (gst_util_uint64_scale_int (n_samples, G_USEC_PER_SEC, RATE));
+
+  return length;
+}
+
+static guint
+gst_test_audio_sink_delay (GstAudioSink * sink)
+{
+  return 0;
+}
+
+static void
+gst_test_audio_sink_reset (GstAudioSink * sink)
+{
+}
+
+static void
+gst_test_audio_sink_finalize (GObject * object)
+{
+  GstTestAudioSink *self = GST_TEST_AUDIO_SINK (object);
+
+  g_array_free (self->written, TRUE);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_test_audio_sink_parent_class)->finalize (object);
+}
+
+static void
+gst_test_audio_sink_class_init (GstTestAudioSinkClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstAudioSinkClass *audiosink_class = GST_AUDIO_SINK_CLASS (klass);
+
+  gobject_class->finalize = gst_test_audio_sink_finalize;
+
+  gst_element_class_add_static_pad_template (element_class, &sinktemplate);
+  gst_element_class_set_static_metadata (element_class, "Test audio sink",
+      "Sink/Audio", "Records the written samples", "GStreamer");
+
+  audiosink_class->open = gst_test_audio_sink_open;
+  audiosink_class->prepare = gst_test_audio_sink_prepare;
+  audiosink_class->unprepare = gst_test_audio_sink_unprepare;
+  audiosink_class->close = gst_test_audio_sink_close;
+  audiosink_class->write = gst_test_audio_sink_write;
+  audiosink_class->delay = gst_test_audio_sink_delay;
+  audiosink_class->reset = gst_test_audio_sink_reset;
+}
+
+static void
+gst_test_audio_sink_init (GstTestAudioSink * self)
+{
+  g_mutex_init (&self->lock);
+  self->written = g_array_new (FALSE, TRUE, sizeof (gfloat));
+}
+
+static GstPad *mysrcpad;
+static guint64 pushed_samples;
+
+/* push a buffer with a ramp starting at @start, or silence when @start is 0 */
+static GstFlowReturn
+push_samples (gfloat start)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gfloat *data;
+  gint i;
+
+  buf = gst_buffer_new_allocate (NULL, SAMPLES_PER_BUFFER * sizeof (gfloat),
+      NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  data = (gfloat *) map.data;
+  for (i = 0; i < SAMPLES_PER_BUFFER; i++)
+    data[i] = start != 0.0 ? start + i : 0.0;
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_PTS (buf) =
+      gst_util_uint64_scale_int (pushed_samples, GST_SECOND, RATE);
+  GST_BUFFER_DURATION (buf) =
+      gst_util_uint64_scale_int (SAMPLES_PER_BUFFER, GST_SECOND, RATE);
+  GST_BUFFER_OFFSET (buf) = pushed_samples;
+  pushed_samples += SAMPLES_PER_BUFFER;
+
+  return gst_pad_push (mysrcpad, buf);
+}
+
+static gpointer
+push_silence_thread (gpointer user_data)
+{
+  return GINT_TO_POINTER (push_samples (0.0));
+}
+
+GST_START_TEST (test_resample_slaving)
+{
+  GstTestAudioSink *self;
+  GstElement *sink;
+  GstClock *clock, *provided;
+  GstClockTime internal, external;
+  GstCaps *caps;
+  GThread *thread;
+  gfloat *out;
+  guint i, n_in, first, last;
+  gdouble step;
+
+  sink = g_object_new (GST_TYPE_TEST_AUDIO_SINK, "slave-method",
+      GST_AUDIO_BASE_SINK_SLAVE_RESAMPLE, NULL);
+  self = GST_TEST_AUDIO_SINK (sink);
+
+  mysrcpad = gst_check_setup_src_pad (sink, &srctemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  pushed_samples = 0;
+
+  clock = gst_test_clock_new ();
+  gst_element_set_clock (sink, clock);
+  gst_element_set_base_time (sink, 0);
+
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string (CAPS_STRING);
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* the first buffer prerolls and then waits for the latency on the master
+   * clock, after which the sink is slaved to it */
+  thread = g_thread_new ("push", push_silence_thread, NULL);
+  gst_test_clock_wait_for_next_pending_id (GST_TEST_CLOCK (clock), NULL);
+  gst_test_clock_process_next_clock_id (GST_TEST_CLOCK (clock));
+  fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (thread)),
+      GST_FLOW_OK);
+
+  /* give the master clock a known rate instead of letting the sink estimate
+   * it from observations */
+  provided = gst_element_provide_clock (sink);
+  fail_unless (provided != NULL);
+  fail_unless (provided != clock);
+  gst_clock_set_master (provided, NULL);
+  gst_clock_get_calibration (provided, &internal, &external, NULL, NULL);
+  gst_clock_set_calibration (provided, internal, external, CLOCK_RATE_NUM,
+      CLOCK_RATE_DENOM);
+  gst_object_unref (provided);
+
+  n_in = 0;
+  for (i = 0; i < 5; i++) {
+    fail_unless_equals_int (push_samples (1.0 + n_in), GST_FLOW_OK);
+    n_in += SAMPLES_PER_BUFFER;
+  }
+  /* push out the ramp through the ringbuffer */
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (push_samples (0.0), GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+
+  g_mutex_lock (&self->lock);
+  out = (gfloat *) self->written->data;
+  for (first = 0; first < self->written->len && out[first] == 0.0; first++);
+  fail_unless (first < self->written->len);
+  for (last = self->written->len - 1; out[last] == 0.0; last--);
+
+  /* the number of samples follows the rate of the master clock */
+  GST_DEBUG ("wrote %u samples for %u input samples", last - first + 1, n_in);
+  fail_unless (ABS ((gint) (last - first + 1) -
+          (gint) (n_in * CLOCK_RATE_DENOM / CLOCK_RATE_NUM)) <= 8);
+
+  /* and the ramp is sampled evenly, without dropping or repeating samples */
+  step = (gdouble) CLOCK_RATE_NUM / CLOCK_RATE_DENOM;
+  for (i = first + 8; i < last - 8; i++) {
+    gdouble diff = out[i + 1] - out[i];
+
+    fail_unless (diff > step / 2 && diff < step * 3 / 2,
+        "sample %u: step %f, expected %f", i - first, diff, step);
+  }
+  g_mutex_unlock (&self->lock);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (sink);
+  gst_element_set_clock (sink, NULL);
+  gst_object_unref (clock);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
+static Suite *
+audiobasesink_suite (void)
+{
+  Suite *s = suite_create ("audiobasesink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_resample_slaving);
+
+  return s;
+}
+
+GST_CHECK_MAIN (audiobasesink);
@@ -1336,6 +1336,111 @@ GST_START_TEST (test_rtp_buffer_get_payload_bytes)
 GST_END_TEST;
 
 
+GST_START_TEST (test_rtp_buffer_peek_header)
+{
+  GstRTPHeaderInfo info;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf, *split;
+  guint8 header[4];
+
+  buf = gst_rtp_buffer_new_allocate (16, 0, 2);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_marker (&rtp, TRUE);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, 0xf2f3);
+  gst_rtp_buffer_set_timestamp (&rtp, 0x44454647);
+  gst_rtp_buffer_set_ssrc (&rtp, 0x01020304);
+  gst_rtp_buffer_unmap (&rtp);
+
+  memset (&info, 0, sizeof (info));
+  fail_unless (gst_rtp_buffer_peek_header (buf, &info));
+  fail_unless (info.buffer == buf);
+  fail_unless_equals_int (info.marker, TRUE);
+  fail_unless_equals_int (info.payload_type, 96);
+  fail_unless_equals_int (info.seq, 0xf2f3);
+  fail_unless_equals_int64 (info.timestamp, 0x44454647);
+  fail_unless_equals_int64 (info.ssrc, 0x01020304);
+  fail_unless_equals_int (info.csrc_count, 2);
+  fail_unless_equals_int (info.padding, FALSE);
+  fail_unless_equals_int (info.extension, FALSE);
+  fail_unless_equals_int (info.header_len, 12 + 2 * 4);
+
+  /* header split over two memories */
+  split = gst_buffer_new ();
+  gst_buffer_extract (buf, 0, header, sizeof (header));
+  gst_buffer_append_memory (split,
+      gst_memory_new_wrapped (0, g_memdup (header, 4), 4, 0, 4, NULL, g_free));
+  split = gst_buffer_append_region (split, gst_buffer_ref (buf), 4, -1);
+  fail_unless_equals_int (gst_buffer_n_memory (split), 2);
+
+  memset (&info, 0, sizeof (info));
+  fail_unless (gst_rtp_buffer_peek_header (split, &info));
+  fail_unless (info.buffer == split);
+  fail_unless_equals_int (info.seq, 0xf2f3);
+  fail_unless_equals_int64 (info.ssrc, 0x01020304);
+  gst_buffer_unref (split);
+
+  /* CSRCs missing */
+  gst_buffer_resize (buf, 0, 16);
+  fail_if (gst_rtp_buffer_peek_header (buf, &info));
+  gst_buffer_set_size (buf, 32);
+
+  /* wrong version */
+  gst_buffer_memset (buf, 0, 0x40, 1);
+  fail_if (gst_rtp_buffer_peek_header (buf, &info));
+
+  /* RTCP payload type */
+  gst_buffer_memset (buf, 0, 0x80, 1);
+  gst_buffer_memset (buf, 1, 200, 1);
+  fail_if (gst_rtp_buffer_peek_header (buf, &info));
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtp_buffer_list_peek_headers)
+{
+  GstRTPHeaderInfo infos[4];
+  GstBufferList *list;
+  GstBuffer *buf;
+  guint i;
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 4; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    buf = gst_rtp_buffer_new_allocate (8, 0, 0);
+    gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_seq (&rtp, 65534 + i);
+    gst_rtp_buffer_unmap (&rtp);
+
+    /* make the third packet invalid */
+    if (i == 2)
+      gst_buffer_memset (buf, 0, 0, 1);
+
+    gst_buffer_list_add (list, buf);
+  }
+
+  fail_unless_equals_int (gst_rtp_buffer_list_peek_headers (list, infos,
+          G_N_ELEMENTS (infos)), 3);
+  fail_unless (infos[0].buffer == gst_buffer_list_get (list, 0));
+  fail_unless_equals_int (infos[0].seq, 65534);
+  fail_unless (infos[1].buffer == gst_buffer_list_get (list, 1));
+  fail_unless_equals_int (infos[1].seq, 65535);
+  fail_unless (infos[2].buffer == gst_buffer_list_get (list, 3));
+  fail_unless_equals_int (infos[2].seq, 1);
+
+  /* stops when the array is full */
+  fail_unless_equals_int (gst_rtp_buffer_list_peek_headers (list, infos, 1),
+      1);
+  fail_unless_equals_int (infos[0].seq, 65534);
+
+  gst_buffer_list_unref (list);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtp_buffer_empty_payload)
 {
   GstRTPBuffer rtp = { NULL };
@@ -1386,6 +1491,8 @@ rtp_suite (void)
   tcase_add_test (tc_chain, test_rtp_buffer_get_payload_bytes);
   tcase_add_test (tc_chain, test_rtp_buffer_get_extension_bytes);
   tcase_add_test (tc_chain, test_rtp_buffer_empty_payload);
+  tcase_add_test (tc_chain, test_rtp_buffer_peek_header);
+  tcase_add_test (tc_chain, test_rtp_buffer_list_peek_headers);
 
   //tcase_add_test (tc_chain, test_rtp_buffer_list);
 
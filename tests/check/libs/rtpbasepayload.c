@@ -25,6 +25,11 @@
 
 #define DEFAULT_CLOCK_RATE (42)
 #define BUFFER_BEFORE_LIST (10)
+#define PACKET_PAYLOAD_SIZE (4)
+
+/* when set, the dummy payloader splits its input into packets of
+ * PACKET_PAYLOAD_SIZE bytes with gst_rtp_base_payload_add_packet() */
+static gboolean use_packet_builder = FALSE;
 
 /* GstRtpDummyPay */
 
@@ -118,6 +123,22 @@ gst_rtp_dummy_pay_handle_buffer (GstRTPBasePayload * pay, GstBuffer * buffer)
     }
   }
 
+  if (use_packet_builder) {
+    gsize offset, size = gst_buffer_get_size (buffer);
+    guint8 index = 0;
+
+    for (offset = 0; offset < size; offset += PACKET_PAYLOAD_SIZE) {
+      gsize len = MIN (PACKET_PAYLOAD_SIZE, size - offset);
+
+      fail_unless (gst_rtp_base_payload_add_packet (pay, &index, 1, buffer,
+              offset, len, offset + len == size));
+      index++;
+    }
+    gst_buffer_unref (buffer);
+
+    return gst_rtp_base_payload_push_packets (pay);
+  }
+
   paybuffer = gst_rtp_buffer_new_allocate (0, 0, 0);
 
   GST_BUFFER_PTS (paybuffer) = GST_BUFFER_PTS (buffer);
@@ -1842,6 +1863,76 @@ GST_START_TEST (rtp_base_payload_max_framerate_attribute)
 
 GST_END_TEST;
 
+/* build packets with the packet builder API. the payload of each packet
+ * should reference the memory of the input buffer, be preceded by the
+ * payload header and the packets should be pushed as one list with
+ * sequential seqnums and the same rtptime.
+ */
+GST_START_TEST (rtp_base_payload_packet_builder_test)
+{
+  static const guint8 data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  State *state;
+  GstBuffer *buf;
+  GstMemory *mem;
+  guint32 rtptime;
+  guint16 seq;
+  guint i;
+
+  use_packet_builder = TRUE;
+
+  state = create_payloader ("application/x-rtp", &sinktmpl,
+      "perfect-rtptime", FALSE, NULL);
+
+  set_state (state, GST_STATE_PLAYING);
+
+  buf = gst_buffer_new_allocate (NULL, sizeof (data), NULL);
+  gst_buffer_fill (buf, 0, data, sizeof (data));
+  GST_BUFFER_PTS (buf) = 0;
+  mem = gst_memory_ref (gst_buffer_peek_memory (buf, 0));
+  fail_unless_equals_int (gst_pad_push (state->srcpad, buf), GST_FLOW_OK);
+
+  validate_buffers_received (3);
+
+  get_buffer_field (0, "rtptime", &rtptime, "seq", &seq, NULL);
+
+  for (i = 0; i < 3; i++) {
+    GstRTPBuffer rtp = { NULL };
+    GstBuffer *packet;
+    GstMemory *pmem;
+    guint8 *payload;
+    guint j, len;
+
+    validate_buffer (i, "pts", 0 * GST_SECOND, "rtptime", rtptime,
+        "seq", seq + i, NULL);
+
+    packet = GST_BUFFER (g_list_nth_data (buffers, i));
+    fail_unless_equals_int (gst_buffer_n_memory (packet), 2);
+    pmem = gst_buffer_peek_memory (packet, 1);
+    fail_unless (pmem == mem || pmem->parent == mem);
+
+    fail_unless (gst_rtp_buffer_map (packet, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_marker (&rtp), i == 2);
+    len = gst_rtp_buffer_get_payload_len (&rtp);
+    fail_unless_equals_int (len, 1 + MIN (PACKET_PAYLOAD_SIZE,
+            sizeof (data) - i * PACKET_PAYLOAD_SIZE));
+    payload = gst_rtp_buffer_get_payload (&rtp);
+    fail_unless_equals_int (payload[0], i);
+    for (j = 1; j < len; j++)
+      fail_unless_equals_int (payload[j], data[i * PACKET_PAYLOAD_SIZE + j - 1]);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+
+  gst_memory_unref (mem);
+
+  set_state (state, GST_STATE_NULL);
+
+  destroy_payloader (state);
+
+  use_packet_builder = FALSE;
+}
+
+GST_END_TEST;
+
 static Suite *
 rtp_basepayloading_suite (void)
 {
@@ -1853,6 +1944,7 @@ rtp_basepayloading_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, rtp_base_payload_buffer_test);
   tcase_add_test (tc_chain, rtp_base_payload_buffer_list_test);
+  tcase_add_test (tc_chain, rtp_base_payload_packet_builder_test);
 
   tcase_add_test (tc_chain, rtp_base_payload_normal_rtptime_test);
   tcase_add_test (tc_chain, rtp_base_payload_perfect_rtptime_test);
@@ -37,6 +37,7 @@
 #include <gst/video/gstvideometa.h>
 #include <gst/video/video-overlay-composition.h>
 #include <string.h>
+#include <math.h>
 
 /* These are from the current/old videotestsrc; we check our new public API
  * in libgstvideo against the old one to make sure the sizes and offsets
@@ -2277,6 +2278,109 @@ GST_START_TEST (test_video_scaler)
 
 GST_END_TEST;
 
+/* same rounding as the scaler uses to make the integer taps */
+static void
+scaler_taps_to_s16 (const gdouble * src, gint16 * dest, guint n,
+    guint precision)
+{
+  gdouble offset, l_offset, h_offset;
+  guint i, j;
+
+  l_offset = 0.0;
+  h_offset = 1.0;
+  offset = 0.5;
+
+  for (i = 0; i < 64; i++) {
+    gint sum = 0;
+
+    for (j = 0; j < n; j++) {
+      dest[j] = floor (offset + src[j] * (1 << precision));
+      sum += dest[j];
+    }
+    if (sum == (1 << precision) || l_offset == h_offset)
+      break;
+
+    if (sum < (1 << precision)) {
+      if (offset > l_offset)
+        l_offset = offset;
+      offset += (h_offset - l_offset) / 2;
+    } else {
+      if (offset < h_offset)
+        h_offset = offset;
+      offset -= (h_offset - l_offset) / 2;
+    }
+  }
+}
+
+/* scalar version of the ORC _lq n-tap kernels: 16 bit wrapping products and
+ * sums, rounded, shifted by 6 and saturated */
+static guint8
+scaler_ntap_u8_lq (const guint8 * pixels, gsize pixel_stride,
+    const gint16 * taps, guint n_taps)
+{
+  gint16 sum = 0;
+  guint k;
+
+  for (k = 0; k < n_taps; k++)
+    sum = (gint16) (sum + (gint16) (pixels[k * pixel_stride] * taps[k]));
+  sum = ((gint16) (sum + 32)) >> 6;
+
+  return CLAMP (sum, 0, 255);
+}
+
+GST_START_TEST (test_video_scaler_taps)
+{
+  const guint n_taps[] = { 4, 8, 12 };
+  GstVideoScaler *hscale, *vscale;
+  guint8 src[150], hdest[100], vdest[100][37], lines[150][37];
+  gpointer srcs[12];
+  gint16 taps_s16[12];
+  guint i, j, k, in_line, taps;
+
+  for (i = 0; i < G_N_ELEMENTS (src); i++) {
+    src[i] = (i * 73) ^ (i >> 2);
+    for (j = 0; j < 37; j++)
+      lines[i][j] = src[i] ^ (j * 29);
+  }
+
+  /* compare the horizontal and the vertical scaler against a scalar
+   * reference, this covers the vector and the remainder part of the SIMD
+   * kernels as well as the ORC code */
+  for (i = 0; i < G_N_ELEMENTS (n_taps); i++) {
+    hscale = gst_video_scaler_new (GST_VIDEO_RESAMPLER_METHOD_LANCZOS,
+        GST_VIDEO_SCALER_FLAG_NONE, n_taps[i], 150, 100, NULL);
+    vscale = gst_video_scaler_new (GST_VIDEO_RESAMPLER_METHOD_LANCZOS,
+        GST_VIDEO_SCALER_FLAG_NONE, n_taps[i], 150, 100, NULL);
+
+    gst_video_scaler_horizontal (hscale, GST_VIDEO_FORMAT_GRAY8, src, hdest,
+        0, 100);
+
+    for (j = 0; j < 100; j++) {
+      const gdouble *coeff;
+
+      coeff = gst_video_scaler_get_coeff (hscale, j, &in_line, &taps);
+      fail_unless (taps <= G_N_ELEMENTS (taps_s16));
+      scaler_taps_to_s16 (coeff, taps_s16, taps, 6);
+      fail_unless_equals_int (hdest[j],
+          scaler_ntap_u8_lq (src + in_line, 1, taps_s16, taps));
+
+      coeff = gst_video_scaler_get_coeff (vscale, j, &in_line, &taps);
+      scaler_taps_to_s16 (coeff, taps_s16, taps, 6);
+      for (k = 0; k < taps; k++)
+        srcs[k] = lines[in_line + k];
+      gst_video_scaler_vertical (vscale, GST_VIDEO_FORMAT_GRAY8, srcs,
+          vdest[j], j, 37);
+      for (k = 0; k < 37; k++)
+        fail_unless_equals_int (vdest[j][k],
+            scaler_ntap_u8_lq (&lines[in_line][k], 37, taps_s16, taps));
+    }
+    gst_video_scaler_free (hscale);
+    gst_video_scaler_free (vscale);
+  }
+}
+
+GST_END_TEST;
+
 #define WIDTH 320
 #define HEIGHT 240
 #define TIME 0.01
@@ -2527,6 +2631,445 @@ GST_START_TEST (test_video_convert)
 
 GST_END_TEST;
 
+GST_START_TEST (test_video_convert_shared_pool)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe;
+  GstBuffer *inbuffer, *outbuffer, *refbuffer = NULL;
+  GstVideoConverter *convert[4];
+  GstMapInfo map;
+  guint i, j;
+  gsize k;
+
+  gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_I420, 640, 960);
+  inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (k = 0; k < map.size; k++)
+    map.data[k] = k * 7;
+  gst_buffer_unmap (inbuffer, &map);
+  gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
+
+  gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_BGRx, 320, 800);
+
+  /* private threads, shared pool with several converters active at once,
+   * equal slices and small bands must all give the same result */
+  for (i = 0; i < G_N_ELEMENTS (convert); i++) {
+    convert[i] = gst_video_converter_new (&ininfo, &outinfo,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 4,
+            GST_VIDEO_CONVERTER_OPT_SHARED_POOL, G_TYPE_BOOLEAN, i > 0,
+            GST_VIDEO_CONVERTER_OPT_BAND_LINES, G_TYPE_UINT,
+            i > 1 ? 7 * i : 0, NULL));
+    fail_unless (convert[i] != NULL);
+  }
+
+  for (j = 0; j < 3; j++) {
+    for (i = 0; i < G_N_ELEMENTS (convert); i++) {
+      outbuffer = gst_buffer_new_and_alloc (outinfo.size);
+      gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+      gst_video_converter_frame (convert[i], &inframe, &outframe);
+      gst_video_frame_unmap (&outframe);
+
+      if (refbuffer == NULL) {
+        refbuffer = outbuffer;
+        continue;
+      }
+      gst_buffer_map (refbuffer, &map, GST_MAP_READ);
+      fail_unless (gst_buffer_memcmp (outbuffer, 0, map.data, map.size) == 0);
+      gst_buffer_unmap (refbuffer, &map);
+      gst_buffer_unref (outbuffer);
+    }
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (convert); i++)
+    gst_video_converter_free (convert[i]);
+
+  gst_buffer_unref (refbuffer);
+  gst_video_frame_unmap (&inframe);
+  gst_buffer_unref (inbuffer);
+}
+
+GST_END_TEST;
+
+#define BAND_TEST_HEIGHT 480
+
+static gint band_unpack_count[BAND_TEST_HEIGHT];
+static gint band_pack_count[BAND_TEST_HEIGHT];
+
+static void
+count_unpack (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
+    gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
+    const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
+{
+  const GstVideoFormatInfo *finfo = gst_video_format_get_info (info->format);
+
+  fail_unless (y >= 0 && y < BAND_TEST_HEIGHT);
+  g_atomic_int_inc (&band_unpack_count[y]);
+  finfo->unpack_func (finfo, flags, dest, data, stride, x, y, width);
+}
+
+static void
+count_pack (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
+    const gpointer src, gint sstride, gpointer data[GST_VIDEO_MAX_PLANES],
+    const gint stride[GST_VIDEO_MAX_PLANES], GstVideoChromaSite chroma_site,
+    gint y, gint width)
+{
+  const GstVideoFormatInfo *finfo = gst_video_format_get_info (info->format);
+
+  fail_unless (y >= 0 && y < BAND_TEST_HEIGHT);
+  g_atomic_int_inc (&band_pack_count[y]);
+  finfo->pack_func (finfo, flags, src, sstride, data, stride, chroma_site, y,
+      width);
+}
+
+GST_START_TEST (test_video_convert_band_lines)
+{
+  GstVideoFormat out_formats[] = { GST_VIDEO_FORMAT_xRGB,
+    GST_VIDEO_FORMAT_ARGB
+  };
+  GstVideoFormatInfo in_finfo, out_finfo;
+  GstVideoInfo ininfo, outinfo;
+  GstVideoConverter *convert;
+  GstVideoFrame inframe, outframe;
+  GstBuffer *inbuffer, *outbuffer;
+  guint i, j, y;
+
+  /* count the lines that are unpacked and packed by copies of the format
+   * infos, every line has to be handled exactly once no matter which thread
+   * picks up which band */
+  in_finfo = *gst_video_format_get_info (GST_VIDEO_FORMAT_GBR);
+  in_finfo.unpack_func = count_unpack;
+  gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_GBR, 64,
+      BAND_TEST_HEIGHT);
+  ininfo.finfo = &in_finfo;
+  inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+  gst_buffer_memset (inbuffer, 0, 0x80, ininfo.size);
+  gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
+
+  for (i = 0; i < G_N_ELEMENTS (out_formats); i++) {
+    out_finfo = *gst_video_format_get_info (out_formats[i]);
+    out_finfo.pack_func = count_pack;
+    gst_video_info_set_format (&outinfo, out_formats[i], 64,
+        BAND_TEST_HEIGHT);
+    outinfo.finfo = &out_finfo;
+
+    convert = gst_video_converter_new (&ininfo, &outinfo,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 4,
+            GST_VIDEO_CONVERTER_OPT_BAND_LINES, G_TYPE_UINT, 8, NULL));
+    fail_unless (convert != NULL);
+
+    outbuffer = gst_buffer_new_and_alloc (outinfo.size);
+    gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+
+    for (j = 0; j < 3; j++) {
+      memset (band_unpack_count, 0, sizeof (band_unpack_count));
+      memset (band_pack_count, 0, sizeof (band_pack_count));
+
+      gst_video_converter_frame (convert, &inframe, &outframe);
+
+      for (y = 0; y < BAND_TEST_HEIGHT; y++) {
+        fail_unless_equals_int (band_unpack_count[y], 1);
+        /* ARGB is the unpack format and written in place without packing */
+        fail_unless_equals_int (band_pack_count[y],
+            out_formats[i] == GST_VIDEO_FORMAT_ARGB ? 0 : 1);
+      }
+    }
+
+    gst_video_frame_unmap (&outframe);
+    gst_buffer_unref (outbuffer);
+    gst_video_converter_free (convert);
+  }
+
+  gst_video_frame_unmap (&inframe);
+  gst_buffer_unref (inbuffer);
+  gst_video_converter_clear_cache ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_convert_cache)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoConverter *convert, *convert2, *convert3;
+
+  gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_I420, 320, 240);
+  gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_RGBx, 160, 120);
+
+  convert = gst_video_converter_new (&ininfo, &outinfo, NULL);
+  fail_unless (convert != NULL);
+  gst_video_converter_free (convert);
+
+  /* a different config does not pick up the cached converter */
+  convert2 = gst_video_converter_new (&ininfo, &outinfo,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_FILL_BORDER, G_TYPE_BOOLEAN, FALSE, NULL));
+  fail_unless (convert2 != NULL);
+  fail_unless (convert2 != convert);
+
+  /* the same infos and config reuse it */
+  convert3 = gst_video_converter_new (&ininfo, &outinfo,
+      gst_structure_new_empty ("options"));
+  fail_unless (convert3 == convert);
+
+  gst_video_converter_free (convert3);
+  gst_video_converter_free (convert2);
+  gst_video_converter_clear_cache ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_convert_cache_threads)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoConverter *convert, *convert2;
+  GstVideoFrame inframe, outframe;
+  GstBuffer *inbuffer, *outbuffer;
+  guint i;
+
+  gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_I420, 320, 240);
+  gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_RGBx, 160, 120);
+
+  inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+  gst_buffer_memset (inbuffer, 0, 0x80, -1);
+  outbuffer = gst_buffer_new_and_alloc (outinfo.size);
+  gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
+  gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+
+  /* converters with private threads stop them while cached and start them
+   * again when handed out */
+  for (i = 0; i < 3; i++) {
+    convert = gst_video_converter_new (&ininfo, &outinfo,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 4,
+            GST_VIDEO_CONVERTER_OPT_SHARED_POOL, G_TYPE_BOOLEAN, FALSE, NULL));
+    fail_unless (convert != NULL);
+    gst_video_converter_frame (convert, &inframe, &outframe);
+    gst_video_converter_free (convert);
+  }
+
+  gst_video_converter_clear_cache ();
+
+  convert2 = gst_video_converter_new (&ininfo, &outinfo,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 4,
+          GST_VIDEO_CONVERTER_OPT_SHARED_POOL, G_TYPE_BOOLEAN, FALSE, NULL));
+  fail_unless (convert2 != NULL);
+  gst_video_converter_frame (convert2, &inframe, &outframe);
+  gst_video_converter_free (convert2);
+  gst_video_converter_clear_cache ();
+
+  gst_video_frame_unmap (&outframe);
+  gst_video_frame_unmap (&inframe);
+  gst_buffer_unref (outbuffer);
+  gst_buffer_unref (inbuffer);
+}
+
+GST_END_TEST;
+
+/* fill all components with gradients so that misplaced chroma, bad
+ * interpolation and broken edges show up in the output */
+static void
+fill_video_gradient (GstVideoFrame * frame)
+{
+  guint c, x, y;
+
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (frame); c++) {
+    gint w = GST_VIDEO_FRAME_COMP_WIDTH (frame, c);
+    gint h = GST_VIDEO_FRAME_COMP_HEIGHT (frame, c);
+    gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, c);
+    gint stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, c);
+    guint8 *data = GST_VIDEO_FRAME_COMP_DATA (frame, c);
+
+    for (y = 0; y < h; y++) {
+      for (x = 0; x < w; x++) {
+        guint v;
+
+        if (c == 0)
+          v = 16 + (x * 110) / w + (y * 110) / h;
+        else if (c == 1)
+          v = 16 + (x * 224) / w;
+        else
+          v = 240 - (y * 224) / h;
+
+        data[y * stride + x * pstride] = v;
+      }
+    }
+  }
+}
+
+GST_START_TEST (test_video_convert_fused_scale)
+{
+  const struct
+  {
+    GstVideoFormat format;
+    gint in_width, in_height, out_width, out_height;
+    GstVideoChromaSite site;
+  } tests[] = {
+    {
+    GST_VIDEO_FORMAT_I420, 1920, 1080, 1280, 720, 0}, {
+    GST_VIDEO_FORMAT_NV12, 1920, 1080, 1280, 720, 0}, {
+    GST_VIDEO_FORMAT_I420, 320, 240, 704, 576, 0}, {
+    GST_VIDEO_FORMAT_NV12, 640, 480, 640, 480, 0}, {
+    GST_VIDEO_FORMAT_I420, 640, 480, 320, 240, GST_VIDEO_CHROMA_SITE_COSITED}
+  };
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe[2];
+  GstBuffer *inbuffer, *outbuffer[2];
+  GstVideoConverter *convert;
+  GstMapInfo map[2];
+  GTimer *timer;
+  gdouble elapsed, mpix;
+  gint count;
+  guint i, j;
+  gsize k;
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    gst_video_info_set_format (&ininfo, tests[i].format, tests[i].in_width,
+        tests[i].in_height);
+    if (tests[i].site)
+      ininfo.chroma_site = tests[i].site;
+    inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+    gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_WRITE);
+    fill_video_gradient (&inframe);
+
+    gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_BGRx,
+        tests[i].out_width, tests[i].out_height);
+    mpix = (outinfo.width * outinfo.height) / 1000000.0;
+
+    /* 0: fused fast path, 1: a dither quantization other than 1 keeps the
+     * converter on the generic line chain */
+    for (j = 0; j < 2; j++) {
+      outbuffer[j] = gst_buffer_new_and_alloc (outinfo.size);
+      gst_video_frame_map (&outframe[j], &outinfo, outbuffer[j],
+          GST_MAP_WRITE);
+
+      convert = gst_video_converter_new (&ininfo, &outinfo,
+          gst_structure_new ("options",
+              GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+              GST_TYPE_VIDEO_DITHER_METHOD, GST_VIDEO_DITHER_NONE,
+              GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION, G_TYPE_UINT,
+              j == 0 ? 1 : 0, NULL));
+
+      /* warmup */
+      gst_video_converter_frame (convert, &inframe, &outframe[j]);
+
+      count = 0;
+      g_timer_start (timer);
+      while (TRUE) {
+        gst_video_converter_frame (convert, &inframe, &outframe[j]);
+
+        count++;
+        elapsed = g_timer_elapsed (timer, NULL);
+        if (elapsed >= TIME)
+          break;
+      }
+
+      GST_DEBUG ("%s->BGRx %dx%d->%dx%d %s: %f ms/megapixel",
+          gst_video_format_to_string (tests[i].format), tests[i].in_width,
+          tests[i].in_height, tests[i].out_width, tests[i].out_height,
+          j == 0 ? "fused" : "generic", (elapsed * 1000.0) / (count * mpix));
+
+      gst_video_converter_free (convert);
+      gst_video_frame_unmap (&outframe[j]);
+    }
+
+    gst_buffer_map (outbuffer[0], &map[0], GST_MAP_READ);
+    gst_buffer_map (outbuffer[1], &map[1], GST_MAP_READ);
+    if (tests[i].site) {
+      /* other sitings are not handled by the fused path */
+      fail_unless (memcmp (map[0].data, map[1].data, map[0].size) == 0);
+    } else {
+      for (k = 0; k < map[0].size; k++) {
+        /* skip the padding byte */
+        if ((k & 3) == 3)
+          continue;
+        /* the fused path upsamples chroma by duplication */
+        fail_unless (ABS (map[0].data[k] - map[1].data[k]) <= 6,
+            "test %u: byte %" G_GSIZE_FORMAT " differs: %d != %d", i, k,
+            map[0].data[k], map[1].data[k]);
+      }
+    }
+    gst_buffer_unmap (outbuffer[1], &map[1]);
+    gst_buffer_unmap (outbuffer[0], &map[0]);
+
+    gst_buffer_unref (outbuffer[1]);
+    gst_buffer_unref (outbuffer[0]);
+    gst_video_frame_unmap (&inframe);
+    gst_buffer_unref (inbuffer);
+  }
+
+  g_timer_destroy (timer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_convert_detile)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe[2];
+  GstBuffer *inbuffer, *outbuffer[2];
+  GstVideoConverter *convert;
+  GstMapInfo map;
+  gint i, j, k;
+  gsize n;
+
+  /* not a multiple of the tile size to also cover partial tiles */
+  gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_NV12_64Z32, 200, 90);
+  inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (n = 0; n < map.size; n++)
+    map.data[n] = g_random_int_range (16, 236);
+  gst_buffer_unmap (inbuffer, &map);
+  gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
+
+  gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_NV12, 200, 90);
+
+  /* 0: detile fast path on 2 threads, 1: generic unpack of the tiles */
+  for (i = 0; i < 2; i++) {
+    outbuffer[i] = gst_buffer_new_and_alloc (outinfo.size);
+    gst_buffer_memset (outbuffer[i], 0, 0, -1);
+    gst_video_frame_map (&outframe[i], &outinfo, outbuffer[i], GST_MAP_WRITE);
+
+    convert = gst_video_converter_new (&ininfo, &outinfo,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+            GST_TYPE_VIDEO_DITHER_METHOD, GST_VIDEO_DITHER_NONE,
+            GST_VIDEO_CONVERTER_OPT_CHROMA_MODE,
+            GST_TYPE_VIDEO_CHROMA_MODE, GST_VIDEO_CHROMA_MODE_NONE,
+            GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION, G_TYPE_UINT,
+            i == 0 ? 1 : 0, GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT,
+            i == 0 ? 2 : 1, NULL));
+    gst_video_converter_frame (convert, &inframe, &outframe[i]);
+    gst_video_converter_free (convert);
+  }
+
+  for (i = 0; i < 2; i++) {
+    gint lines = i == 0 ? 90 : 45;
+
+    for (j = 0; j < lines; j++) {
+      guint8 *l0 = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe[0], i) +
+          j * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe[0], i);
+      guint8 *l1 = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe[1], i) +
+          j * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe[1], i);
+
+      for (k = 0; k < 200; k++)
+        fail_unless_equals_int (l0[k], l1[k]);
+    }
+  }
+
+  for (i = 0; i < 2; i++) {
+    gst_video_frame_unmap (&outframe[i]);
+    gst_buffer_unref (outbuffer[i]);
+  }
+  gst_video_frame_unmap (&inframe);
+  gst_buffer_unref (inbuffer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_video_transfer)
 {
   gint i, j;
@@ -2859,9 +3402,16 @@ video_suite (void)
   tcase_add_test (tc_chain, test_video_pack_unpack2);
   tcase_add_test (tc_chain, test_video_chroma);
   tcase_add_test (tc_chain, test_video_scaler);
+  tcase_add_test (tc_chain, test_video_scaler_taps);
   tcase_add_test (tc_chain, test_video_color_convert);
   tcase_add_test (tc_chain, test_video_size_convert);
   tcase_add_test (tc_chain, test_video_convert);
+  tcase_add_test (tc_chain, test_video_convert_shared_pool);
+  tcase_add_test (tc_chain, test_video_convert_band_lines);
+  tcase_add_test (tc_chain, test_video_convert_cache);
+  tcase_add_test (tc_chain, test_video_convert_cache_threads);
+  tcase_add_test (tc_chain, test_video_convert_fused_scale);
+  tcase_add_test (tc_chain, test_video_convert_detile);
   tcase_add_test (tc_chain, test_video_transfer);
   tcase_add_test (tc_chain, test_overlay_blend);
   tcase_add_test (tc_chain, test_video_center_rect);
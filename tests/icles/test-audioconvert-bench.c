@@ -0,0 +1,127 @@
+/* GStreamer audio converter benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Times some common conversions with one pass over the samples per
+ * conversion step and with the steps fused into a single pass. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+#define BLOCK_FRAMES 1024
+
+typedef struct
+{
+  GstAudioFormat in_format;
+  gint in_channels, in_rate;
+  GstAudioFormat out_format;
+  gint out_channels, out_rate;
+} Conversion;
+
+static const Conversion conversions[] = {
+  {GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {GST_AUDIO_FORMAT_S16, 6, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_FORMAT_F32, 1, 44100},
+  {GST_AUDIO_FORMAT_S16, 6, 48000, GST_AUDIO_FORMAT_F32, 2, 44100},
+  {GST_AUDIO_FORMAT_F32, 6, 48000, GST_AUDIO_FORMAT_S16, 2, 48000},
+  {GST_AUDIO_FORMAT_F32, 2, 44100, GST_AUDIO_FORMAT_S16, 2, 48000},
+};
+
+static gdouble
+run_bench (const Conversion * conv, gboolean fuse, gint seconds)
+{
+  GstAudioInfo in_info, out_info;
+  GstAudioConverter *convert;
+  gpointer in, out;
+  gint i, blocks;
+  gint64 start, elapsed;
+
+  gst_audio_info_set_format (&in_info, conv->in_format, conv->in_rate,
+      conv->in_channels, NULL);
+  gst_audio_info_set_format (&out_info, conv->out_format, conv->out_rate,
+      conv->out_channels, NULL);
+
+  convert = gst_audio_converter_new (0, &in_info, &out_info,
+      gst_structure_new ("options", GST_AUDIO_CONVERTER_OPT_FUSE_STAGES,
+          G_TYPE_BOOLEAN, fuse, NULL));
+
+  in = g_malloc0 (BLOCK_FRAMES * in_info.bpf);
+  out = g_malloc0 (2 * BLOCK_FRAMES * out_info.bpf);
+  /* something that isn't silence */
+  for (i = 0; i < BLOCK_FRAMES * in_info.channels; i++) {
+    if (conv->in_format == GST_AUDIO_FORMAT_S16)
+      ((gint16 *) in)[i] = g_random_int_range (-16384, 16384);
+    else
+      ((gfloat *) in)[i] = g_random_double_range (-0.5, 0.5);
+  }
+
+  blocks = seconds * conv->in_rate / BLOCK_FRAMES;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < blocks; i++) {
+    gpointer ins[1] = { in };
+    gpointer outs[1] = { out };
+    gsize out_frames;
+
+    out_frames = gst_audio_converter_get_out_frames (convert, BLOCK_FRAMES);
+    gst_audio_converter_samples (convert, 0, ins, BLOCK_FRAMES, outs,
+        out_frames);
+  }
+  elapsed = g_get_monotonic_time () - start;
+
+  g_free (in);
+  g_free (out);
+  gst_audio_converter_free (convert);
+
+  return elapsed / 1000.0;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint seconds = 10;
+  guint c;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = MAX (atoi (argv[1]), 1);
+
+  g_print ("converting %d s of audio\n", seconds);
+
+  for (c = 0; c < G_N_ELEMENTS (conversions); c++) {
+    const Conversion *conv = &conversions[c];
+    gdouble separate, fused;
+
+    separate = run_bench (conv, FALSE, seconds);
+    fused = run_bench (conv, TRUE, seconds);
+
+    g_print ("%-5s %d ch %5d Hz -> %-5s %d ch %5d Hz: %8.2f ms separate, "
+        "%8.2f ms fused (%4.2fx)\n", gst_audio_format_to_string
+        (conv->in_format), conv->in_channels, conv->in_rate,
+        gst_audio_format_to_string (conv->out_format), conv->out_channels,
+        conv->out_rate, separate, fused, fused > 0 ? separate / fused : 0.0);
+  }
+
+  return 0;
+}
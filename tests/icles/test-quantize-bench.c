@@ -0,0 +1,109 @@
+/* GStreamer audio quantizer benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Times the quantization of S32 samples to 16 bits with every dither and
+ * noise shaping method. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+#define BLOCK_FRAMES 1024
+#define RATE 48000
+
+static gdouble
+run_bench (GstAudioDitherMethod dither, GstAudioNoiseShapingMethod ns,
+    gint channels, gint seconds)
+{
+  GstAudioQuantize *quant;
+  gint32 *in, *out;
+  gint i, blocks;
+  gint64 start, elapsed;
+
+  quant = gst_audio_quantize_new (dither, ns, 0, GST_AUDIO_FORMAT_S32,
+      channels, 1 << 16);
+
+  in = g_new (gint32, BLOCK_FRAMES * channels);
+  out = g_new (gint32, BLOCK_FRAMES * channels);
+  for (i = 0; i < BLOCK_FRAMES * channels; i++)
+    in[i] = g_random_int_range (G_MININT32 / 2, G_MAXINT32 / 2);
+
+  blocks = seconds * RATE / BLOCK_FRAMES;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < blocks; i++) {
+    gpointer ins[1] = { in };
+    gpointer outs[1] = { out };
+
+    gst_audio_quantize_samples (quant, ins, outs, BLOCK_FRAMES);
+  }
+  elapsed = g_get_monotonic_time () - start;
+
+  g_free (in);
+  g_free (out);
+  gst_audio_quantize_free (quant);
+
+  return elapsed / 1000.0;
+}
+
+static const gchar *
+enum_nick (GType type, gint value)
+{
+  GEnumClass *klass = g_type_class_ref (type);
+  const gchar *nick = g_enum_get_value (klass, value)->value_nick;
+
+  g_type_class_unref (klass);
+
+  return nick;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint seconds = 10;
+  gint channels[] = { 1, 2, 6 };
+  gint dither, ns;
+  guint c;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = MAX (atoi (argv[1]), 1);
+
+  g_print ("quantizing %d s of audio at %d Hz\n", seconds, RATE);
+
+  for (ns = GST_AUDIO_NOISE_SHAPING_NONE; ns <= GST_AUDIO_NOISE_SHAPING_HIGH;
+      ns++) {
+    for (dither = GST_AUDIO_DITHER_NONE; dither <= GST_AUDIO_DITHER_TPDF_HF;
+        dither++) {
+      g_print ("%-14s %-8s", enum_nick (GST_TYPE_AUDIO_NOISE_SHAPING_METHOD,
+              ns), enum_nick (GST_TYPE_AUDIO_DITHER_METHOD, dither));
+      for (c = 0; c < G_N_ELEMENTS (channels); c++)
+        g_print (" %8.2f ms (%d ch)", run_bench (dither, ns, channels[c],
+                seconds), channels[c]);
+      g_print ("\n");
+    }
+  }
+
+  return 0;
+}
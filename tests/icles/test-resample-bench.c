@@ -0,0 +1,150 @@
+/* GStreamer audio resampler benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Times 48000 -> 44100 Hz conversions with the kaiser resampler for all
+ * sample formats and filter modes. The fastest kernels the CPU supports are
+ * used, run with GST_AUDIO_RESAMPLER_NO_AVX2=1 to compare against the SSE
+ * versions and with ORC_CODE=backup to compare against plain C. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+#define IN_RATE 48000
+#define OUT_RATE 44100
+#define BLOCK_FRAMES 1024
+
+typedef struct
+{
+  const gchar *name;
+  GstAudioResamplerFilterMode mode;
+  GstAudioResamplerFilterInterpolation interpolation;
+} Mode;
+
+static const Mode modes[] = {
+  {"full", GST_AUDIO_RESAMPLER_FILTER_MODE_FULL,
+      GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_NONE},
+  {"linear", GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+      GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_LINEAR},
+  {"cubic", GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+      GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_CUBIC},
+};
+
+static const GstAudioFormat formats[] = {
+  GST_AUDIO_FORMAT_S16,
+  GST_AUDIO_FORMAT_S32,
+  GST_AUDIO_FORMAT_F32,
+  GST_AUDIO_FORMAT_F64,
+};
+
+static void
+run_bench (GstAudioFormat format, const Mode * mode, gint channels,
+    gint seconds)
+{
+  GstAudioResampler *resampler;
+  GstStructure *options;
+  const GstAudioFormatInfo *finfo = gst_audio_format_get_info (format);
+  gsize bpf = channels * GST_AUDIO_FORMAT_INFO_WIDTH (finfo) / 8;
+  gsize out_frames, total = 0;
+  gpointer in, out;
+  gint i, blocks;
+  gint64 start, elapsed;
+
+  options = gst_structure_new_empty ("options");
+  gst_audio_resampler_options_set_quality (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_QUALITY_DEFAULT, IN_RATE, OUT_RATE, options);
+  gst_structure_set (options,
+      GST_AUDIO_RESAMPLER_OPT_FILTER_MODE, GST_TYPE_AUDIO_RESAMPLER_FILTER_MODE,
+      mode->mode, GST_AUDIO_RESAMPLER_OPT_FILTER_INTERPOLATION,
+      GST_TYPE_AUDIO_RESAMPLER_FILTER_INTERPOLATION, mode->interpolation, NULL);
+
+  resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_FLAG_NONE, format, channels, IN_RATE, OUT_RATE,
+      options);
+  gst_structure_free (options);
+
+  in = g_malloc0 (BLOCK_FRAMES * bpf);
+  out = g_malloc0 ((BLOCK_FRAMES + 64) * bpf);
+  /* something that isn't silence */
+  for (i = 0; i < BLOCK_FRAMES * channels; i++) {
+    switch (format) {
+      case GST_AUDIO_FORMAT_S16:
+        ((gint16 *) in)[i] = g_random_int_range (-16384, 16384);
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        ((gint32 *) in)[i] = g_random_int_range (-(1 << 30), 1 << 30);
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        ((gfloat *) in)[i] = g_random_double_range (-0.5, 0.5);
+        break;
+      default:
+        ((gdouble *) in)[i] = g_random_double_range (-0.5, 0.5);
+        break;
+    }
+  }
+
+  blocks = seconds * IN_RATE / BLOCK_FRAMES;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < blocks; i++) {
+    gpointer ins[1] = { in }, outs[1] = { out };
+
+    out_frames = gst_audio_resampler_get_out_frames (resampler, BLOCK_FRAMES);
+    gst_audio_resampler_resample (resampler, ins, BLOCK_FRAMES, outs,
+        out_frames);
+    total += out_frames;
+  }
+  elapsed = g_get_monotonic_time () - start;
+
+  g_print ("%-5s %-7s %d ch: %8.2f ms for %d s of audio (%5.0fx realtime), "
+      "%" G_GSIZE_FORMAT " frames out\n", gst_audio_format_to_string (format),
+      mode->name, channels, elapsed / 1000.0, seconds,
+      elapsed > 0 ? (seconds * 1e6) / elapsed : 0.0, total);
+
+  g_free (in);
+  g_free (out);
+  gst_audio_resampler_free (resampler);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint seconds = 10, channels = 2;
+  guint f, m;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = MAX (atoi (argv[1]), 1);
+  if (argc > 2)
+    channels = CLAMP (atoi (argv[2]), 1, 64);
+
+  g_print ("resampling %d -> %d Hz%s\n", IN_RATE, OUT_RATE,
+      g_getenv ("GST_AUDIO_RESAMPLER_NO_AVX2") ? ", AVX2 disabled" : "");
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++)
+    for (m = 0; m < G_N_ELEMENTS (modes); m++)
+      run_bench (formats[f], &modes[m], channels, seconds);
+
+  return 0;
+}
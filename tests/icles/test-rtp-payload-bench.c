@@ -0,0 +1,255 @@
+/* GStreamer RTP payloading benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Measures the packets per second a payloader can produce when it allocates
+ * and fills every packet itself, compared to building the packets with
+ * gst_rtp_base_payload_add_packet(). */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/rtp/rtp.h>
+
+#define FRAME_SIZE (64 * 1024)
+#define PACKET_PAYLOAD_SIZE 1400
+#define PAYLOAD_HEADER_SIZE 2
+
+typedef enum
+{
+  BENCH_MODE_BUFFER,
+  BENCH_MODE_LIST,
+  BENCH_MODE_BUILDER
+} BenchMode;
+
+static const gchar *mode_names[] = { "buffer", "list", "builder" };
+
+static BenchMode bench_mode;
+static guint64 packets;
+
+typedef GstRTPBasePayload GstRtpBenchPay;
+typedef GstRTPBasePayloadClass GstRtpBenchPayClass;
+
+static GType gst_rtp_bench_pay_get_type (void);
+G_DEFINE_TYPE (GstRtpBenchPay, gst_rtp_bench_pay, GST_TYPE_RTP_BASE_PAYLOAD);
+
+static GstStaticPadTemplate bench_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate bench_src_template =
+GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstBuffer *
+allocate_packet (GstBuffer * buffer, gsize offset, gsize len,
+    const guint8 * header, gboolean marker)
+{
+  GstRTPBuffer rtp = { NULL };
+  GstBuffer *packet;
+  guint8 *payload;
+
+  packet = gst_rtp_buffer_new_allocate (PAYLOAD_HEADER_SIZE + len, 0, 0);
+  gst_rtp_buffer_map (packet, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_marker (&rtp, marker);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  memcpy (payload, header, PAYLOAD_HEADER_SIZE);
+  gst_buffer_extract (buffer, offset, payload + PAYLOAD_HEADER_SIZE, len);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_BUFFER_PTS (packet) = GST_BUFFER_PTS (buffer);
+
+  return packet;
+}
+
+static GstFlowReturn
+gst_rtp_bench_pay_handle_buffer (GstRTPBasePayload * pay, GstBuffer * buffer)
+{
+  GstBufferList *list = NULL;
+  GstFlowReturn ret = GST_FLOW_OK;
+  gsize offset, size;
+
+  if (!gst_pad_has_current_caps (GST_RTP_BASE_PAYLOAD_SRCPAD (pay)))
+    gst_rtp_base_payload_set_outcaps (pay, NULL);
+
+  if (bench_mode == BENCH_MODE_LIST)
+    list = gst_buffer_list_new ();
+
+  size = gst_buffer_get_size (buffer);
+  for (offset = 0; offset < size && ret == GST_FLOW_OK;
+      offset += PACKET_PAYLOAD_SIZE) {
+    gsize len = MIN (PACKET_PAYLOAD_SIZE, size - offset);
+    gboolean marker = offset + len == size;
+    guint8 header[PAYLOAD_HEADER_SIZE];
+
+    GST_WRITE_UINT16_BE (header, offset / PACKET_PAYLOAD_SIZE);
+
+    switch (bench_mode) {
+      case BENCH_MODE_BUFFER:
+        ret = gst_rtp_base_payload_push (pay,
+            allocate_packet (buffer, offset, len, header, marker));
+        break;
+      case BENCH_MODE_LIST:
+        gst_buffer_list_add (list,
+            allocate_packet (buffer, offset, len, header, marker));
+        break;
+      case BENCH_MODE_BUILDER:
+        gst_rtp_base_payload_add_packet (pay, header, PAYLOAD_HEADER_SIZE,
+            buffer, offset, len, marker);
+        break;
+    }
+  }
+  gst_buffer_unref (buffer);
+
+  if (bench_mode == BENCH_MODE_LIST)
+    ret = gst_rtp_base_payload_push_list (pay, list);
+  else if (bench_mode == BENCH_MODE_BUILDER)
+    ret = gst_rtp_base_payload_push_packets (pay);
+
+  return ret;
+}
+
+static void
+gst_rtp_bench_pay_class_init (GstRtpBenchPayClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class,
+      &bench_sink_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &bench_src_template);
+  gst_element_class_set_static_metadata (element_class, "RTP bench payloader",
+      "Codec/Payloader/Network/RTP", "Payloads buffers for benchmarking",
+      "GStreamer maintainers");
+
+  klass->handle_buffer = gst_rtp_bench_pay_handle_buffer;
+}
+
+static void
+gst_rtp_bench_pay_init (GstRtpBenchPay * pay)
+{
+  gst_rtp_base_payload_set_options (pay, "application", TRUE, "BENCH", 90000);
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  packets++;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  packets += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static gdouble
+run_bench (BenchMode mode, gint seconds)
+{
+  GstElement *pay;
+  GstPad *srcpad, *sinkpad, *paysink, *paysrc;
+  GstBuffer *frame;
+  GstSegment segment;
+  gint64 start, end, elapsed;
+  guint64 n;
+
+  bench_mode = mode;
+  packets = 0;
+
+  pay = g_object_new (gst_rtp_bench_pay_get_type (), NULL);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_chain_list_function (sinkpad, sink_chain_list);
+
+  paysink = gst_element_get_static_pad (pay, "sink");
+  paysrc = gst_element_get_static_pad (pay, "src");
+  gst_pad_link (srcpad, paysink);
+  gst_pad_link (paysrc, sinkpad);
+  gst_object_unref (paysink);
+  gst_object_unref (paysrc);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (pay, GST_STATE_PLAYING);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("bench"));
+  gst_pad_push_event (srcpad,
+      gst_event_new_caps (gst_caps_new_empty_simple ("application/x-bench")));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  frame = gst_buffer_new_allocate (NULL, FRAME_SIZE, NULL);
+  gst_buffer_memset (frame, 0, 0xa5, FRAME_SIZE);
+
+  start = g_get_monotonic_time ();
+  end = start + seconds * G_USEC_PER_SEC;
+  for (n = 0;; n++) {
+    GstBuffer *buf = gst_buffer_copy (frame);
+
+    GST_BUFFER_PTS (buf) = n * GST_MSECOND;
+    if (gst_pad_push (srcpad, buf) != GST_FLOW_OK)
+      break;
+    if ((n & 63) == 0 && g_get_monotonic_time () >= end)
+      break;
+  }
+  elapsed = g_get_monotonic_time () - start;
+
+  gst_buffer_unref (frame);
+
+  gst_element_set_state (pay, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (pay);
+
+  return packets * (gdouble) G_USEC_PER_SEC / elapsed;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint seconds = 5;
+  BenchMode mode;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = MAX (atoi (argv[1]), 1);
+
+  g_print ("payloading %d byte frames into %d byte packets for %d s\n",
+      FRAME_SIZE, PACKET_PAYLOAD_SIZE, seconds);
+
+  for (mode = BENCH_MODE_BUFFER; mode <= BENCH_MODE_BUILDER; mode++)
+    g_print ("%-8s %12.0f packets/s\n", mode_names[mode],
+        run_bench (mode, seconds));
+
+  return 0;
+}